@@ -34,6 +34,7 @@ class DenseHiddenLayerDescriptor : public LayerDescriptor {
 private:
   uint32_t nodes_;
   float keep_prob_ = 1.0;
+  float sparsity_ = 0;
   std::string weight_type_;
   std::string act_func_;
 public:
@@ -45,11 +46,14 @@ public:
   float GetKeepProb() const { return keep_prob_; }
   void SetWeightType(std::string weight_type) {weight_type_ = weight_type; }
   std::string GetWeightType() const { return weight_type_; }
+  void SetSparsity(float sparsity) { sparsity_ = sparsity; }
+  float GetSparsity() const { return sparsity_; }
 };
 
 class DenseOutputLayerDescriptor : public LayerDescriptor {
 private:
   uint32_t nodes_;
+  float sparsity_ = 0;
   std::string weight_type_;
   std::string act_func_;
 public:
@@ -59,6 +63,8 @@ public:
   std::string GetActivationFunction() const { return act_func_; }
   void SetWeightType(std::string weight_type) {weight_type_ = weight_type; }
   std::string GetWeightType() const { return weight_type_; }
+  void SetSparsity(float sparsity) { sparsity_ = sparsity; }
+  float GetSparsity() const { return sparsity_; }
 };
 
 class ModelWrapper {
@@ -106,6 +112,9 @@ public:
   std::vector<uint8_t> ToWasm() {
     return model_.ModuleManager().ToWasm().data;
   }
+  std::vector<uint8_t> WeightsBlob() {
+    return model_.WeightsBlob();
+  }
   bool Validate() {
     return model_.Validate();
   }
@@ -135,11 +144,13 @@ public:
   void AddDenseHiddenLayer(DenseHiddenLayerDescriptor desc) {
     layers_.push_back(NewLayer<DenseHiddenLayer>(desc.GetNodes(), StringToActivationFunction(desc.GetActivationFunction()))
         ->KeepProb(desc.GetKeepProb())
-        ->WeightType(StringToWeightDistribution(desc.GetWeightType())));
+        ->WeightType(StringToWeightDistribution(desc.GetWeightType()))
+        ->Sparsity(desc.GetSparsity()));
   }
   void AddDenseOutputLayer(DenseOutputLayerDescriptor desc) {
     layers_.push_back(NewLayer<DenseOutputLayer>(desc.GetNodes(), StringToActivationFunction(desc.GetActivationFunction()))
-        ->WeightType(StringToWeightDistribution(desc.GetWeightType())));
+        ->WeightType(StringToWeightDistribution(desc.GetWeightType()))
+        ->Sparsity(desc.GetSparsity()));
   }
 };
 
@@ -157,6 +168,23 @@ EMSCRIPTEN_BINDINGS(model_options) {
         WEIGHT_DISTRIBUTION_OPTIONS(constant_value)
         WEIGHT_DISTRIBUTION_OPTIONS(seed);
 
+    enum_<OptimizerType>("OptimizerType")
+        .value("SGD", SGD)
+        .value("Momentum", Momentum)
+        .value("Nesterov", Nesterov)
+        .value("RMSProp", RMSProp)
+        .value("Adam", Adam);
+
+#define OPTIMIZER_OPTIONS(name) \
+  .property(#name, &OptimizerOptions::name)
+
+    class_<OptimizerOptions>("OptimizerOptions")
+        .constructor<>()
+        OPTIMIZER_OPTIONS(type)
+        OPTIMIZER_OPTIONS(beta1)
+        OPTIMIZER_OPTIONS(beta2)
+        OPTIMIZER_OPTIONS(epsilon);
+
 #define ACTIVATION_OPTIONS(name) \
   .property(#name, &ActivationOptions::name)
 
@@ -164,7 +192,8 @@ EMSCRIPTEN_BINDINGS(model_options) {
         .constructor<>()
         ACTIVATION_OPTIONS(linear_slope)
         ACTIVATION_OPTIONS(leaky_relu_slope)
-        ACTIVATION_OPTIONS(elu_slope);
+        ACTIVATION_OPTIONS(elu_slope)
+        ACTIVATION_OPTIONS(derivative_from_output);
 
 #define MODEL_BYTECODE_OPTIONS(name) \
   .property(#name, &ModelBytecodeOptions::name)
@@ -179,7 +208,25 @@ EMSCRIPTEN_BINDINGS(model_options) {
       MODEL_BYTECODE_OPTIONS(gen_testing_confusion_matrix)
       MODEL_BYTECODE_OPTIONS(gen_forward_profiling)
       MODEL_BYTECODE_OPTIONS(gen_backward_profiling)
-      MODEL_BYTECODE_OPTIONS(use_simd);
+      MODEL_BYTECODE_OPTIONS(use_simd)
+      MODEL_BYTECODE_OPTIONS(simd_reduction_accumulators)
+      MODEL_BYTECODE_OPTIONS(use_kernel_functions)
+      MODEL_BYTECODE_OPTIONS(split_layer_functions)
+      MODEL_BYTECODE_OPTIONS(training_workers)
+      MODEL_BYTECODE_OPTIONS(gradient_accumulation_steps)
+      MODEL_BYTECODE_OPTIONS(parallel_gemm_threads)
+      MODEL_BYTECODE_OPTIONS(parallel_gemm_min_nodes)
+      MODEL_BYTECODE_OPTIONS(passive_weights)
+      MODEL_BYTECODE_OPTIONS(separate_weights)
+      MODEL_BYTECODE_OPTIONS(inference_only)
+      MODEL_BYTECODE_OPTIONS(live_prediction_batch)
+      MODEL_BYTECODE_OPTIONS(live_training_batch)
+      MODEL_BYTECODE_OPTIONS(growable_training_batches)
+      MODEL_BYTECODE_OPTIONS(training_data_slots)
+      MODEL_BYTECODE_OPTIONS(resident_training_samples)
+      MODEL_BYTECODE_OPTIONS(resident_training_max_epochs)
+      MODEL_BYTECODE_OPTIONS(bf16_activations)
+      MODEL_BYTECODE_OPTIONS(int8_prediction_weights);
 
 #define MODEL_OPTIONS(name) \
   .property(#name, &ModelOptions::name)
@@ -188,7 +235,8 @@ EMSCRIPTEN_BINDINGS(model_options) {
       .constructor<>()
       MODEL_OPTIONS(bytecode_options)
       MODEL_OPTIONS(activation_options)
-      MODEL_OPTIONS(weights_options);
+      MODEL_OPTIONS(weights_options)
+      MODEL_OPTIONS(optimizer_options);
 
 #define MODEL_WRAPPER(name) \
   .function(#name, &ModelWrapper::name)
@@ -196,6 +244,7 @@ EMSCRIPTEN_BINDINGS(model_options) {
   class_<ModelWrapper>("Model")
       .constructor<ModelOptions>()
       MODEL_WRAPPER(ToWasm)
+      MODEL_WRAPPER(WeightsBlob)
       MODEL_WRAPPER(ToWat)
       MODEL_WRAPPER(Validate)
       MODEL_WRAPPER(AddDenseInputLayer)
@@ -222,7 +271,9 @@ EMSCRIPTEN_BINDINGS(model_options) {
     DENSE_HIDDEN_LAYER(SetWeightType)
     DENSE_HIDDEN_LAYER(GetWeightType)
     DENSE_HIDDEN_LAYER(SetKeepProb)
-    DENSE_HIDDEN_LAYER(GetKeepProb);
+    DENSE_HIDDEN_LAYER(GetKeepProb)
+    DENSE_HIDDEN_LAYER(SetSparsity)
+    DENSE_HIDDEN_LAYER(GetSparsity);
 
 #define DENSE_OUTPUT_LAYER(name) \
   .function(#name, &DenseOutputLayerDescriptor::name)
@@ -232,7 +283,9 @@ EMSCRIPTEN_BINDINGS(model_options) {
     DENSE_OUTPUT_LAYER(GetNodes)
     DENSE_OUTPUT_LAYER(GetActivationFunction)
     DENSE_OUTPUT_LAYER(SetWeightType)
-    DENSE_OUTPUT_LAYER(GetWeightType);
+    DENSE_OUTPUT_LAYER(GetWeightType)
+    DENSE_OUTPUT_LAYER(SetSparsity)
+    DENSE_OUTPUT_LAYER(GetSparsity);
 
   register_vector<uint8_t>("ByteArray");
 }
@@ -1,8 +1,15 @@
 #include <src/nn-builder/src/arch/model.h>
 #include <src/nn-builder/src/arch/layers/dense.h>
+#include <src/nn-builder/src/arch/cache.h>
+#include <src/nn-builder/src/runtime/runtime.h>
 #include <iostream>
 #include <getopt.h>
 #include <fstream>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <iterator>
 
 using namespace nn;
 using namespace nn::arch;
@@ -11,7 +18,25 @@ using namespace wabt;
 
 bool FLAG_to_wasm = false;
 bool FLAG_to_wat = false;
+bool FLAG_kernel_functions = false;
+bool FLAG_report = false;
+bool FLAG_layer_functions = false;
+bool FLAG_execute = false;
+bool FLAG_no_simd = false;
+bool FLAG_passive_weights = false;
+bool FLAG_separate_weights = false;
+bool FLAG_inference = false;
+bool FLAG_bf16 = false;
+bool FLAG_int8 = false;
+bool FLAG_latency = false;
+bool FLAG_compare_optimizers = false;
 std::string output_file;
+std::string cache_directory;
+uint32_t codegen_threads = 0;
+uint32_t training_workers = 1;
+OptimizerType optimizer = SGD;
+const char* optimizer_names[] = {"sgd", "momentum", "nesterov", "rmsprop", "adam"};
+float sparsity = 0;
 
 void PrintUsage() {
   std::cout
@@ -20,6 +45,27 @@ void PrintUsage() {
       << "    -w, --to-wasm       Print wasm" << std::endl
       << "    -W, --to-wat        Print wat" << std::endl
       << "    -o, --output        Output file" << std::endl
+      << "    -k, --kernels       Generate kernel functions" << std::endl
+      << "    -r, --report        Print a size report with and without kernel functions" << std::endl
+      << "    -l, --layers        Generate a function per layer" << std::endl
+      << "    -x, --execute       Train in-process on random batches" << std::endl
+      << "    -n, --no-simd       Do not use SIMD instructions" << std::endl
+      << "    -c, --cache         Cache directory of the wasm output" << std::endl
+      << "    -j, --threads       Number of code generation threads" << std::endl
+      << "    -p, --workers       Number of training workers (see run_mnist_wasm.js)" << std::endl
+      << "    -i, --passive       Initialize the weights from passive data segments" << std::endl
+      << "    -s, --separate      Write the weights in a separate blob (output file + .weights)" << std::endl
+      << "    -e, --inference     Build only the prediction functions" << std::endl
+      << "    -z, --optimizer     Optimizer: sgd (default), momentum, nesterov, rmsprop or adam" << std::endl
+      << "    -b, --bf16          Store the testing and prediction activations in bf16. With -x, report"
+      << std::endl
+      << "                        the testing error and hits delta against f32 activations" << std::endl
+      << "    -q, --int8          Predict with int8 weights quantized per row" << std::endl
+      << "    -y, --sparsity      Fraction of the hidden and output weights pruned for prediction" << std::endl
+      << "    -t, --latency       Print the prediction latency for several sparsity levels" << std::endl
+      << "    -a, --compare       Write a module per optimizer (output file + .<optimizer>) for" << std::endl
+      << "                        run_mnist_wasm.js --compare, which prints the epochs each one takes" << std::endl
+      << "                        to reach an accuracy on mnist and its time per epoch" << std::endl
       << "    -h, --help          Display this help message" << std::endl;
 }
 
@@ -30,13 +76,30 @@ void InitParams(int argc, char *argv[]) {
       {"to-wasm", no_argument, 0, 'w'},
       {"to-wat", no_argument, 0, 'W'},
       {"output", required_argument, 0, 'o'},
+      {"kernels", no_argument, 0, 'k'},
+      {"report", no_argument, 0, 'r'},
+      {"layers", no_argument, 0, 'l'},
+      {"execute", no_argument, 0, 'x'},
+      {"no-simd", no_argument, 0, 'n'},
+      {"cache", required_argument, 0, 'c'},
+      {"threads", required_argument, 0, 'j'},
+      {"workers", required_argument, 0, 'p'},
+      {"passive", no_argument, 0, 'i'},
+      {"separate", no_argument, 0, 's'},
+      {"inference", no_argument, 0, 'e'},
+      {"optimizer", required_argument, 0, 'z'},
+      {"bf16", no_argument, 0, 'b'},
+      {"int8", no_argument, 0, 'q'},
+      {"sparsity", required_argument, 0, 'y'},
+      {"latency", no_argument, 0, 't'},
+      {"compare", no_argument, 0, 'a'},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}
   };
 
   int optionIndex = 0;
   int c;
-  while ((c = getopt_long(argc, argv, "hwWo:", longOptions, &optionIndex)) != -1) {
+  while ((c = getopt_long(argc, argv, "hwWo:krlxnc:j:p:isez:bqy:ta", longOptions, &optionIndex)) != -1) {
     switch (c) {
       case 'w':
         FLAG_to_wasm = true;
@@ -47,6 +110,64 @@ void InitParams(int argc, char *argv[]) {
       case 'o':
         output_file = optarg;
         break;
+      case 'k':
+        FLAG_kernel_functions = true;
+        break;
+      case 'r':
+        FLAG_report = true;
+        break;
+      case 'l':
+        FLAG_layer_functions = true;
+        break;
+      case 'x':
+        FLAG_execute = true;
+        break;
+      case 'n':
+        FLAG_no_simd = true;
+        break;
+      case 'c':
+        cache_directory = optarg;
+        break;
+      case 'j':
+        codegen_threads = (uint32_t) std::stoul(optarg);
+        break;
+      case 'p':
+        training_workers = (uint32_t) std::stoul(optarg);
+        break;
+      case 'i':
+        FLAG_passive_weights = true;
+        break;
+      case 's':
+        FLAG_separate_weights = true;
+        break;
+      case 'e':
+        FLAG_inference = true;
+        break;
+      case 'z': {
+        auto name = std::find(std::begin(optimizer_names), std::end(optimizer_names), std::string(optarg));
+        if(name == std::end(optimizer_names)) {
+          std::cerr << "Unknown optimizer: " << optarg << std::endl;
+          PrintUsage();
+          exit(1);
+        }
+        optimizer = (OptimizerType) (FIRST_OPTIMIZER + (name - std::begin(optimizer_names)));
+        break;
+      }
+      case 'b':
+        FLAG_bf16 = true;
+        break;
+      case 'q':
+        FLAG_int8 = true;
+        break;
+      case 'y':
+        sparsity = std::stof(optarg);
+        break;
+      case 't':
+        FLAG_latency = true;
+        break;
+      case 'a':
+        FLAG_compare_optimizers = true;
+        break;
       case 'h':
         PrintUsage();
         exit(0);
@@ -56,53 +177,344 @@ void InitParams(int argc, char *argv[]) {
   }
 }
 
-int main(int argc, char *argv[]) {
-  InitParams(argc, argv);
-
-  if((!FLAG_to_wat && !FLAG_to_wasm) || output_file.empty()) {
-    PrintUsage();
-    exit(0);
-  }
+// Build arguments
+const uint32_t training_batch_size = 1;
+uint32_t training_batches_in_memory = 1;
+const uint32_t testing_batch_size = 1;
+const uint32_t testing_batches_in_memory = 1;
+const uint32_t prediction_batch_size = 1;
+const float l1_regularizer = 0.0001;
+const float l2_regularizer = 0.0001;
 
+Model* NewModel(bool kernel_functions, bool bf16_activations, OptimizerType optimizer_type, float weights_sparsity) {
   ModelOptions options;
   options.bytecode_options.gen_training_accuracy           = true;
   options.bytecode_options.gen_training_error              = true;
-  options.bytecode_options.gen_training_confusion_matrix   = true;
+  options.bytecode_options.gen_training_confusion_matrix   = training_workers == 1;
   options.bytecode_options.gen_testing_accuracy            = true;
   options.bytecode_options.gen_testing_error               = true;
   options.bytecode_options.gen_testing_confusion_matrix    = true;
-  options.bytecode_options.gen_forward_profiling           = true;
-  options.bytecode_options.gen_backward_profiling          = true;
-  options.bytecode_options.use_simd                        = true;
-  Model model(options);
-  model.SetLayers({
+  options.bytecode_options.gen_forward_profiling           = training_workers == 1;
+  options.bytecode_options.gen_backward_profiling          = training_workers == 1;
+  options.bytecode_options.use_simd                        = !FLAG_no_simd;
+  options.bytecode_options.use_kernel_functions            = kernel_functions;
+  options.bytecode_options.split_layer_functions           = FLAG_layer_functions;
+  options.bytecode_options.codegen_threads                 = kernel_functions ? 0 : codegen_threads;
+  options.bytecode_options.training_workers                = training_workers;
+  options.bytecode_options.passive_weights                 = FLAG_passive_weights;
+  options.bytecode_options.separate_weights                = FLAG_separate_weights;
+  options.bytecode_options.bf16_activations                = bf16_activations;
+  options.bytecode_options.int8_prediction_weights         = FLAG_int8;
+  options.optimizer_options.type                           = optimizer_type;
+  if(FLAG_inference) {
+    options.bytecode_options.gen_training_accuracy         = false;
+    options.bytecode_options.gen_training_error            = false;
+    options.bytecode_options.gen_training_confusion_matrix = false;
+    options.bytecode_options.gen_testing_accuracy          = false;
+    options.bytecode_options.gen_testing_error             = false;
+    options.bytecode_options.gen_testing_confusion_matrix  = false;
+    options.bytecode_options.gen_forward_profiling         = false;
+    options.bytecode_options.gen_backward_profiling        = false;
+    options.bytecode_options.training_workers              = 1;
+    options.bytecode_options.inference_only                = true;
+  }
+  Model* model = new Model(options);
+  model->SetLayers({
      NewLayer<DenseInputLayer>(784)->WeightType(XavierUniform)->KeepProb(1),
-     NewLayer<DenseHiddenLayer>(64, model.Builtins().activation.Sigmoid())->WeightType(XavierUniform)->KeepProb(1),
-     NewLayer<DenseOutputLayer>(10, model.Builtins().activation.Softmax())->WeightType(LeCunUniform)
+     NewLayer<DenseHiddenLayer>(64, model->Builtins().activation.Sigmoid())->WeightType(XavierUniform)->KeepProb(1)
+         ->Sparsity(weights_sparsity),
+     NewLayer<DenseOutputLayer>(10, model->Builtins().activation.Softmax())->WeightType(LeCunUniform)
+         ->Sparsity(weights_sparsity)
   });
+  return model;
+}
+
+Model* MakeModel(bool kernel_functions, bool bf16_activations, OptimizerType optimizer_type,
+                 float weights_sparsity) {
+  Model* model = NewModel(kernel_functions, bf16_activations, optimizer_type, weights_sparsity);
+  model->Build(training_batch_size, training_batches_in_memory,
+               testing_batch_size, testing_batches_in_memory,
+               prediction_batch_size, model->Builtins().loss.SoftmaxCrossEntropy(),
+               l1_regularizer, l2_regularizer);
+  return model;
+}
+
+void WriteWeightsBlob(const std::vector<uint8_t>& blob) {
+  std::ofstream file(output_file + ".weights", std::ios::binary);
+  file << std::string(blob.begin(), blob.end());
+}
+
+std::vector<uint8_t> MakeCachedWasm(std::vector<uint8_t>* weights_blob) {
+  ModelCache cache(cache_directory);
+  std::unique_ptr<Model> model(NewModel(FLAG_kernel_functions, FLAG_bf16, optimizer, sparsity));
+  auto wasm = cache.BuildToWasm(model.get(), training_batch_size, training_batches_in_memory,
+                                testing_batch_size, testing_batches_in_memory,
+                                prediction_batch_size, model->Builtins().loss.SoftmaxCrossEntropy(),
+                                l1_regularizer, l2_regularizer, weights_blob);
+  std::cerr << "Cache hits: " << cache.Hits() << ", misses: " << cache.Misses() << std::endl;
+  return wasm;
+}
+
+void PrintReport() {
+  // Compare the module with specialized inlined
+  // dot products to the one using kernel functions.
+  // Engine compile time is reported by run_mnist_wasm.js
+  for(bool kernel_functions : {false, true}) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Model> model(MakeModel(kernel_functions, FLAG_bf16, optimizer, sparsity));
+    auto end = std::chrono::steady_clock::now();
+    assert(model->Validate());
+    std::cout
+        << (kernel_functions ? "Kernel functions" : "Specialized     ") << ": "
+        << model->ModuleManager().GetModule().funcs.size() << " functions, "
+        << model->Snippets().kernels->Functions() << " kernels for "
+        << model->Snippets().kernels->Calls() << " call sites, "
+        << model->ModuleManager().ToWasm().data.size() << " bytes, "
+        << model->ModuleManager().Memory().Pages() << " memory pages, "
+        << "generated in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms"
+        << std::endl;
+  }
+}
+
+const uint32_t inputs = 784;
+const uint32_t outputs = 10;
+
+// Fill batches with random pixels and one-hot labels
+void FillRandomBatches(float* data, float* labels, uint32_t batch_size, uint32_t batches,
+                       std::mt19937& generator) {
+  std::uniform_real_distribution<float> pixel(0, 1);
+  std::uniform_int_distribution<uint32_t> label(0, outputs - 1);
+  for(uint32_t i = 0; i < inputs * batch_size * batches; i++) {
+    data[i] = pixel(generator);
+  }
+  std::fill(labels, labels + outputs * batch_size * batches, 0.0f);
+  for(uint32_t b = 0; b < batches; b++) {
+    for(uint32_t col = 0; col < batch_size; col++) {
+      labels[b * outputs * batch_size + label(generator) * batch_size + col] = 1;
+    }
+  }
+}
+
+// Fill batches with a learnable pattern: the pixels of the
+// block of the label are brighter than the other pixels
+void FillLearnableBatches(float* data, float* labels, uint32_t batch_size, uint32_t batches,
+                          std::mt19937& generator) {
+  std::uniform_real_distribution<float> pixel(0, 0.5);
+  std::uniform_int_distribution<uint32_t> label(0, outputs - 1);
+  std::fill(labels, labels + outputs * batch_size * batches, 0.0f);
+  for(uint32_t b = 0; b < batches; b++) {
+    for(uint32_t col = 0; col < batch_size; col++) {
+      uint32_t digit = label(generator);
+      for(uint32_t row = 0; row < inputs; row++) {
+        float block = (row * outputs / inputs == digit) ? 0.5f : 0.0f;
+        data[b * inputs * batch_size + row * batch_size + col] = pixel(generator) + block;
+      }
+      labels[b * outputs * batch_size + digit * batch_size + col] = 1;
+    }
+  }
+}
+
+struct TestingResults {
+  float error = 0;
+  float hits = 0;
+};
+
+// Accuracy of the prediction function (which may use
+// other weights than the testing functions) over
+// several rounds of prediction batches
+float PredictionAccuracy(Model* model, runtime::ModelRuntime& runtime, uint32_t rounds, std::mt19937& generator) {
+  const uint32_t batch_size = model->PredictionBatchSize();
+  std::vector<float> labels(outputs * batch_size);
+  float hits = 0;
+  for(uint32_t r = 0; r < rounds; r++) {
+    FillRandomBatches(runtime.PredictionData(), labels.data(), batch_size, 1, generator);
+    runtime.PredictBatch();
+    float* result = runtime.PredictionResult();
+    for(uint32_t col = 0; col < batch_size; col++) {
+      uint32_t predicted = 0;
+      uint32_t expected = 0;
+      for(uint32_t row = 1; row < outputs; row++) {
+        if(result[row * batch_size + col] > result[predicted * batch_size + col]) {
+          predicted = row;
+        }
+        if(labels[row * batch_size + col] > labels[expected * batch_size + col]) {
+          expected = row;
+        }
+      }
+      hits += predicted == expected;
+    }
+  }
+  return hits / (rounds * batch_size);
+}
+
+TestingResults Execute(bool bf16_activations) {
+  // Drive the training loop from C++ using the
+  // in-process runtime. Batches are written directly
+  // in the linear memory of the module
+  std::unique_ptr<Model> model(MakeModel(FLAG_kernel_functions, bf16_activations, optimizer, sparsity));
+  assert(model->Validate());
+  runtime::ModelRuntime runtime(model.get());
+  runtime.SetLearningRate(0.01);
+
+  const uint32_t epochs = 10;
+  std::mt19937 generator;
+  for(uint32_t e = 0; e < epochs; e++) {
+    uint32_t batches = model->TrainingBatchesInMemory();
+    FillRandomBatches(runtime.TrainingData(), runtime.TrainingLabels(), model->TrainingBatchSize(), batches,
+                      generator);
+    auto start = std::chrono::steady_clock::now();
+    runtime.TrainBatchesInMemory(batches);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Epoch " << e + 1 << ": error " << runtime.TrainingBatchesError() << ", trained in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " us" << std::endl;
+  }
+  // Average the error and count the hits
+  // over several rounds of testing batches
+  const uint32_t testing_rounds = 100;
+  TestingResults results;
+  for(uint32_t t = 0; t < testing_rounds; t++) {
+    uint32_t batches = model->TestingBatchesInMemory();
+    FillRandomBatches(runtime.TestingData(), runtime.TestingLabels(), model->TestingBatchSize(), batches,
+                      generator);
+    runtime.TestBatchesInMemory(batches);
+    results.error += runtime.TestingBatchesError() / testing_rounds;
+    results.hits += runtime.TestingBatchesHits();
+  }
+  std::cout << "Testing (" << (bf16_activations ? "bf16" : "f32") << " activations): error " << results.error
+            << ", hits " << results.hits << std::endl;
+  if(FLAG_int8 || sparsity > 0) {
+    // The testing functions use the f32 weights, and only the
+    // prediction function uses the int8 or the pruned weights
+    float accuracy = results.hits / (testing_rounds * model->TestingBatchesInMemory() * model->TestingBatchSize());
+    std::cout << "Prediction (" << (FLAG_int8 ? "int8" : "f32") << " weights, sparsity " << sparsity
+              << "): accuracy " << PredictionAccuracy(model.get(), runtime, testing_rounds, generator)
+              << ", f32 testing accuracy " << accuracy << std::endl;
+  }
+  return results;
+}
+
+void WriteOptimizersModules() {
+  // Write a module per optimizer, all from the same
+  // initial weights, which run_mnist_wasm.js --compare
+  // trains on the mnist data
+  for(int type = FIRST_OPTIMIZER; type <= LAST_OPTIMIZER; type++) {
+    std::unique_ptr<Model> model(MakeModel(FLAG_kernel_functions, FLAG_bf16, (OptimizerType) type, sparsity));
+    assert(model->Validate());
+    std::ofstream file(output_file + "." + optimizer_names[type - FIRST_OPTIMIZER], std::ios::binary);
+    auto data = model->ModuleManager().ToWasm().data;
+    file << std::string(data.begin(), data.end());
+  }
+}
+
+void PrintLatency() {
+  // Average latency of a prediction with the
+  // hidden and output weights pruned at several
+  // sparsity levels (0 predicts with dense weights).
+  // The weights are trained, and so pruned, first
+  const uint32_t rounds = 100;
+  std::mt19937 generator;
+  std::uniform_real_distribution<float> pixel(0, 1);
+  for(float level : {0.0f, 0.5f, 0.75f, 0.9f, 0.95f}) {
+    std::unique_ptr<Model> model(MakeModel(FLAG_kernel_functions, FLAG_bf16, optimizer, level));
+    assert(model->Validate());
+    runtime::ModelRuntime runtime(model.get());
+    runtime.SetLearningRate(0.01);
+    uint32_t batches = model->TrainingBatchesInMemory();
+    FillLearnableBatches(runtime.TrainingData(), runtime.TrainingLabels(), model->TrainingBatchSize(), batches,
+                         generator);
+    runtime.TrainBatchesInMemory(batches);
+    float* data = runtime.PredictionData();
+    for(uint32_t i = 0; i < inputs * model->PredictionBatchSize(); i++) {
+      data[i] = pixel(generator);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t r = 0; r < rounds; r++) {
+      runtime.PredictBatch();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Sparsity " << level << ": "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / rounds
+              << " us per prediction" << std::endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  InitParams(argc, argv);
+  if(training_workers > 1) {
+    // Give each worker several batches per
+    // call to amortize the synchronization
+    training_batches_in_memory = 64 * training_workers;
+  }
+
+  if(FLAG_report) {
+    PrintReport();
+    exit(0);
+  }
+
+  if(FLAG_latency) {
+    if(FLAG_inference || training_workers > 1) {
+      std::cerr << "The latency cannot be measured in inference only models or with training workers" << std::endl;
+      exit(1);
+    }
+    PrintLatency();
+    exit(0);
+  }
+
+  if(FLAG_compare_optimizers) {
+    if(FLAG_inference || training_workers > 1 || FLAG_separate_weights || output_file.empty()) {
+      std::cerr << "Optimizers cannot be compared in inference only models, with training workers, separate "
+                   "weights or without an output file" << std::endl;
+      exit(1);
+    }
+    WriteOptimizersModules();
+    exit(0);
+  }
+
+  if(FLAG_execute) {
+    if(FLAG_inference) {
+      std::cerr << "Inference only models cannot be trained" << std::endl;
+      exit(1);
+    }
+    auto results = Execute(false);
+    if(FLAG_bf16) {
+      // Training is the same in f32, so both models
+      // test the same weights on the same batches
+      auto bf16_results = Execute(true);
+      std::cout << "bf16 activations: testing error delta " << bf16_results.error - results.error
+                << ", hits delta " << bf16_results.hits - results.hits << std::endl;
+    }
+    exit(0);
+  }
+
+  if((!FLAG_to_wat && !FLAG_to_wasm) || output_file.empty()) {
+    PrintUsage();
+    exit(0);
+  }
+
+  if(FLAG_to_wasm && !cache_directory.empty()) {
+    std::vector<uint8_t> weights_blob;
+    auto data = MakeCachedWasm(FLAG_separate_weights ? &weights_blob : nullptr);
+    std::ofstream file(output_file, std::ios::binary);
+    file << std::string(data.begin(), data.end());
+    if(FLAG_separate_weights) {
+      WriteWeightsBlob(weights_blob);
+    }
+    return 0;
+  }
 
-  uint32_t training_batch_size = 1;
-  uint32_t training_batches_in_memory = 1;
-  uint32_t testing_batch_size = 1;
-  uint32_t testing_batches_in_memory = 1;
-  uint32_t prediction_batch_size = 1;
-  float l1_regularizer = 0.0001;
-  float l2_regularizer = 0.0001;
-  auto loss = model.Builtins().loss.SoftmaxCrossEntropy();
-  model.Build(training_batch_size, training_batches_in_memory,
-              testing_batch_size, testing_batches_in_memory,
-              prediction_batch_size, loss,
-              l1_regularizer, l2_regularizer);
-
-  assert(model.Validate());
+  std::unique_ptr<Model> model(MakeModel(FLAG_kernel_functions, FLAG_bf16, optimizer, sparsity));
+  assert(model->Validate());
   if(!output_file.empty()) {
     std::ofstream file;
     file.open(output_file);
     if(FLAG_to_wasm) {
-      auto data = model.ModuleManager().ToWasm().data;
+      auto data = model->ModuleManager().ToWasm().data;
       file << std::string(data.begin(), data.end());
+      if(FLAG_separate_weights) {
+        WriteWeightsBlob(model->WeightsBlob());
+      }
     } else if(FLAG_to_wat) {
-      file << model.ModuleManager().ToWat(true, true);
+      file << model->ModuleManager().ToWat(true, true);
     }
     file.close();
   }
@@ -0,0 +1,52 @@
+#include <src/nn-builder/native/model.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace nn::native;
+
+// Train the mnist model compiled with wasm2c on random
+// batches and report the training time per epoch, to
+// compare with the time reported by run_mnist_wasm.js
+int main(int argc, char *argv[]) {
+  NativeModel model;
+  model.SetLearningRate(0.01);
+
+  const uint32_t inputs = 784;
+  const uint32_t outputs = 10;
+  const uint32_t epochs = 10;
+  const uint32_t batches_per_epoch = 60000;
+  uint32_t batch_size = model.TrainingBatchSize();
+  uint32_t batches_in_memory = model.TrainingBatchesInMemory();
+
+  std::mt19937 generator;
+  std::uniform_real_distribution<float> pixel(0, 1);
+  std::uniform_int_distribution<uint32_t> label(0, outputs - 1);
+  float* data = model.TrainingData();
+  float* labels = model.TrainingLabels();
+  for(uint32_t i = 0; i < inputs * batch_size * batches_in_memory; i++) {
+    data[i] = pixel(generator);
+  }
+  std::fill(labels, labels + outputs * batch_size * batches_in_memory, 0.0f);
+  for(uint32_t b = 0; b < batches_in_memory; b++) {
+    for(uint32_t col = 0; col < batch_size; col++) {
+      labels[b * outputs * batch_size + label(generator) * batch_size + col] = 1;
+    }
+  }
+
+  double total_time = 0;
+  for(uint32_t e = 0; e < epochs; e++) {
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t b = 0; b < batches_per_epoch; b += batches_in_memory) {
+      model.TrainBatchesInMemory(batches_in_memory);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double epoch_time = std::chrono::duration<double, std::milli>(end - start).count();
+    total_time += epoch_time;
+    std::cout << "Epoch " << e + 1 << std::endl
+              << ">> Epoch time: " << epoch_time << " ms" << std::endl
+              << ">> Total time: " << total_time << " ms" << std::endl;
+  }
+  return 0;
+}
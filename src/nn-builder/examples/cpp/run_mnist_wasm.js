@@ -7,43 +7,100 @@ const mnist = require('mnist');
 // Comment: https://github.com/nodejs/node/issues/14927#issuecomment-482919665
 require("../../../../third_party/gyp/trap-handler/build/Release/th");
 
-// Warning to enable SIMD in Node
+// Warning to enable SIMD, bulk memory and threads in Node
 process.on('unhandledRejection', error => {
-  console.error(">> Make sure SIMD is enabled (e.g. nodejs --experimental-wasm-simd)");
+  console.error(">> Make sure SIMD and bulk memory are enabled "
+                + "(e.g. nodejs --experimental-wasm-simd --experimental-wasm-bulk-memory)");
+  console.error(">> Models with training workers also need threads (e.g. nodejs --experimental-wasm-threads)");
   console.error(">> Error message:", error);
 });
 
-if(process.argv.length > 2) {
+// Load mnist data
+function LoadMnist() {
+  let mnist_data = mnist.set(2240*2,2240);
+  let data = {train_data: [], train_labels: [], test_data: [], test_labels: []};
+  mnist_data.training.forEach((x) => {data.train_data.push(x.input); data.train_labels.push(x.output)});
+  mnist_data.test.forEach((x) => {data.test_data.push(x.input); data.test_labels.push(x.output)});
+  return data;
+}
+
+// Train the modules written by mnist -a (one per optimizer,
+// from the same initial weights) on the same mnist data, and
+// print the epochs each one takes to reach a testing accuracy
+// and its training time per epoch
+async function CompareOptimizers(files) {
+  const max_epochs = 20;
+  const target_accuracy = 0.9;
+  const data = LoadMnist();
+  for(const file of files) {
+    const compiled_model = await CompiledModel.Instantiate(new Uint8Array(fs.readFileSync(file)));
+    let training = compiled_model.EncodeTrainingData(data.train_data, data.train_labels);
+    let testing = compiled_model.EncodeTestingData(data.test_data, data.test_labels);
+    let epoch = 0;
+    let accuracy = 0;
+    let training_time = 0;
+    while(epoch < max_epochs && accuracy < target_accuracy) {
+      let epoch_time = Date.now();
+      compiled_model.Train(training, {epochs: 1, learning_rate: 0.02});
+      training_time += Date.now() - epoch_time;
+      accuracy = compiled_model.Test(testing, {log_accuracy: true});
+      epoch++;
+    }
+    let summary = accuracy >= target_accuracy ? epoch + " epochs to reach an accuracy of " + target_accuracy
+                                              : "accuracy " + accuracy + " after " + max_epochs + " epochs";
+    console.log(file + ":", summary + ",", Math.round(training_time / epoch), "ms per epoch");
+  }
+}
+
+if(process.argv.length > 3 && process.argv[2] === "--compare") {
+  CompareOptimizers(process.argv.slice(3));
+} else if(process.argv.length > 2) {
   const buf = fs.readFileSync(process.argv[2]);
-  const lib = WebAssembly.instantiate(new Uint8Array(buf), CompiledModel.Imports());
-  lib.then( wasm => {
-    const compiled_model = new CompiledModel(wasm);
+  const compile_start = Date.now();
+  const lib = CompiledModel.Instantiate(new Uint8Array(buf));
+  lib.then(async compiled_model => {
+    console.log("Compiled", buf.length, "bytes in", Date.now() - compile_start, "ms,",
+                "rss", Math.round(process.memoryUsage().rss / (1024 * 1024)), "MB");
+    if(process.argv.length > 3) {
+      // Models built with separate weights (mnist -s) load
+      // their weights blob (e.g. mnist.wasm.weights)
+      compiled_model.LoadWeightsBlob(fs.readFileSync(process.argv[3]));
+    }
+    if("drop_initial_weights" in compiled_model.Exports()) {
+      // Models built with passive weights (mnist -i) are
+      // initialized once, so their segments can be released
+      compiled_model.DropInitialWeights();
+    }
 
-    // Load mnist data
-    let mnist_data = mnist.set(2240*2,2240);
-    let train_data    = [];
-    let train_labels  = [];
-    mnist_data.training.forEach((x) => {train_data.push(x.input); train_labels.push(x.output)});
-    let test_data    = [];
-    let test_labels  = [];
-    mnist_data.test.forEach((x) => {test_data.push(x.input); test_labels.push(x.output)});
-    
     // Encode data
-    let training = compiled_model.EncodeTrainingData(train_data, train_labels);
-    let testing = compiled_model.EncodeTestingData(test_data, test_labels);
-    let prediction = compiled_model.EncodePredictionData([train_data[0]]);
+    const data = LoadMnist();
+    let training = compiled_model.EncodeTrainingData(data.train_data, data.train_labels);
+    let testing = compiled_model.EncodeTestingData(data.test_data, data.test_labels);
+    let prediction = compiled_model.EncodePredictionData([data.train_data[0]]);
 
     console.log("Training ...");
-    compiled_model.Train(training, {
-      log_accuracy: true,
-      log_error: true,
-      log_time: true,
-      log_forward: true,
-      log_backward: true,
-      log_conf_mat: true,
-      epochs: 5,
-      learning_rate: 0.02
-    });
+    if(compiled_model._TrainingWorkers() > 1) {
+      // Models built with training workers (mnist -p)
+      await compiled_model.TrainWorkers(training, {
+        log_accuracy: true,
+        log_error: true,
+        log_time: true,
+        epochs: 5,
+        learning_rate: 0.02
+      });
+      await compiled_model.StopWorkers();
+    } else {
+      compiled_model.Train(training, {
+        log_accuracy: true,
+        log_error: true,
+        log_time: true,
+        log_forward: true,
+        log_backward: true,
+        log_conf_mat: true,
+        epochs: 5,
+        learning_rate: 0.02
+      });
+    }
 
     console.log("Testing ...");
     compiled_model.Test(testing, {
@@ -61,5 +118,5 @@ if(process.argv.length > 2) {
     });
   })
 } else {
-    console.log("Missing argument: mnist.wasm");
+    console.log("Missing argument: mnist.wasm [mnist.wasm.weights] or --compare mnist.wasm.sgd ...");
 }
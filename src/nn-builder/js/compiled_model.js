@@ -142,13 +142,94 @@ class CompiledModel {
   _wasm = null;
   _imports = {};
   _logger = new ModelLogger();
+  _bytes = null;
+  _workers = [];
+  _gemm_helpers = [];
   static _memory;
 
-  constructor(wasm) {
+  // Weights blob of a model built with separate weights: a
+  // header of little-endian u32 (magic, version, layout, number
+  // of regions, then the memory offset and byte size of each
+  // region) followed by the raw f32 of the regions in order
+  static _WEIGHTS_BLOB_MAGIC = 0x42574e4e; // "NNWB"
+  static _WEIGHTS_BLOB_VERSION = 2;
+
+  constructor(wasm, bytes) {
     this._wasm = wasm;
+    this._bytes = bytes || null;
     CompiledModel._memory = this.Exports().memory;
   }
 
+  // Instantiate a model from its bytecode. Models built
+  // with training workers import a shared memory, which
+  // is created here and later shared with the workers
+  static async Instantiate(bytes) {
+    let memory = null;
+    let limits = CompiledModel._ImportedMemoryLimits(bytes);
+    if(limits !== null) {
+      memory = new WebAssembly.Memory(limits);
+    }
+    let wasm = await WebAssembly.instantiate(bytes, CompiledModel.Imports(memory));
+    let compiled_model = new CompiledModel(wasm, bytes);
+    compiled_model.InitWeights();
+    return compiled_model;
+  }
+
+  // Find the limits of the memory imported by a module
+  // by reading its import section, or null if the
+  // module defines its own memory
+  static _ImportedMemoryLimits(bytes) {
+    let offset = 8; // Magic and version
+    let ReadU32 = () => {
+      let result = 0;
+      let shift = 0;
+      let byte;
+      do {
+        byte = bytes[offset++];
+        result += (byte & 0x7f) * Math.pow(2, shift);
+        shift += 7;
+      } while(byte & 0x80);
+      return result;
+    };
+    let ReadLimits = () => {
+      let flags = ReadU32();
+      let limits = {initial: ReadU32(), shared: (flags & 0x2) !== 0};
+      if(flags & 0x1) {
+        limits.maximum = ReadU32();
+      }
+      return limits;
+    };
+    while(offset < bytes.length) {
+      let id = bytes[offset++];
+      let size = ReadU32();
+      if(id !== 2) {
+        offset += size;
+        continue;
+      }
+      let count = ReadU32();
+      for(let i = 0; i < count; i++) {
+        // Skip module and field names
+        let module_length = ReadU32();
+        offset += module_length;
+        let field_length = ReadU32();
+        offset += field_length;
+        let kind = bytes[offset++];
+        if(kind === 0) {          // Function
+          ReadU32();
+        } else if(kind === 1) {   // Table
+          offset++;
+          ReadLimits();
+        } else if(kind === 2) {   // Memory
+          return ReadLimits();
+        } else {                  // Global
+          offset += 2;
+        }
+      }
+      return null;
+    }
+    return null;
+  }
+
   // Get exports from Wasm to JS
   Exports() {
     if (this._wasm == null) {
@@ -267,7 +348,7 @@ class CompiledModel {
     // Load model batch information
     let batch_size = this._TrainingBatchSize();
     let batches_in_memory = this._TrainingBatchesInMemory();
-    let number_of_batches = input.x_count / batch_size;
+    let number_of_batches = Math.floor(input.x_count / batch_size);
     
     // Configuration        Value                     Default
     config                  = config                  || {};
@@ -288,6 +369,7 @@ class CompiledModel {
     let total_time = 0.0;
     let data_offset = this._TrainingDataOffset();
     let labels_offset = this._TrainingLabelsOffset();
+    this._ResetConfusionMatrix("training");
 
     // Train for each epoch
     for(let e=0; e < config.epochs; e++) {
@@ -339,6 +421,385 @@ class CompiledModel {
     }
   }
   
+  // Train on encoded data copied once in batches reserved
+  // at the end of the memory, which grows to hold them all
+  TrainReserved(input, config) {
+    if(!input.good) {
+      console.log("Trainting input seems bad, skipping ...");
+      return false;
+    }
+    if(!("reserve_training_batches" in this.Exports())) {
+      console.log("Model was not built with growable training batches");
+      return false;
+    }
+    let batch_size = this._TrainingBatchSize();
+    let number_of_batches = Math.floor(input.x_count / batch_size);
+    if(this.Exports().reserve_training_batches(number_of_batches) === -1) {
+      console.log("Memory cannot grow to hold", number_of_batches, "batches");
+      return false;
+    }
+    this._CopyBatchesToMemory(input, this.Exports().reserved_training_data_offset(),
+                              this.Exports().reserved_training_labels_offset(), 0, batch_size, number_of_batches);
+
+    // Configuration        Value                     Default
+    config                  = config                  || {};
+    config.log_accuracy     = config.log_accuracy     || false;
+    config.log_error        = config.log_error        || false;
+    config.log_time         = config.log_time         || false;
+    config.epochs           = config.epochs           || 0;
+    config.learning_rate    = config.learning_rate    || 0.01;
+    this._SetLearningRate(config.learning_rate);
+
+    let total_time = 0.0;
+    for(let e=0; e < config.epochs; e++) {
+      let epoch_time = new Date().getTime();
+      this.Exports().train_reserved_batches(0, number_of_batches);
+      epoch_time = new Date().getTime() - epoch_time;
+      total_time += epoch_time;
+      console.log("Epoch", e+1);
+      if(config.log_accuracy) {
+        console.log(">> Accuracy:  ", this._TrainingBatchesAccuracy() / input.x_count);
+      }
+      if(config.log_error) {
+        console.log(">> Error:     ", this._TrainingBatchesError() / number_of_batches);
+      }
+      if(config.log_time) {
+        console.log(">> Epoch time:", epoch_time, "ms");
+        console.log(">> Total time:", total_time, "ms");
+      }
+    }
+    return true;
+  }
+
+  // Train on a stream of chunks. `next_chunk` returns (or
+  // resolves to) encoded training data of at most the number
+  // of batches in memory, or null at the end of the stream.
+  // The next chunk is requested before training on the
+  // current one, so it is read and encoded meanwhile
+  async TrainStream(next_chunk, config) {
+    if(!("train_training_slot" in this.Exports())) {
+      console.log("Model was not built with training data slots");
+      return false;
+    }
+    let batch_size = this._TrainingBatchSize();
+    let batches_in_memory = this._TrainingBatchesInMemory();
+
+    // Configuration        Value                     Default
+    config                  = config                  || {};
+    config.log_accuracy     = config.log_accuracy     || false;
+    config.log_error        = config.log_error        || false;
+    config.log_time         = config.log_time         || false;
+    config.learning_rate    = config.learning_rate    || 0.01;
+    this._SetLearningRate(config.learning_rate);
+
+    let total_hits = 0;
+    let total_cost = 0.0;
+    let total_batches = 0;
+    let total_time = new Date().getTime();
+    let pending = next_chunk();
+    let done = false;
+    while(true) {
+      // Fill the free slots
+      let slot = this.Exports().fill_training_slot();
+      while(!done && slot >= 0) {
+        let chunk = await pending;
+        if(chunk === null) {
+          done = true;
+          break;
+        }
+        if(!chunk.good) {
+          console.log("Trainting input seems bad, skipping ...");
+        } else {
+          let batches = this._CopyBatchesToMemory(chunk, this.Exports().training_slot_data_offset(slot),
+                                                  this.Exports().training_slot_labels_offset(slot), 0,
+                                                  batch_size, batches_in_memory);
+          this.Exports().commit_training_slot(batches);
+        }
+        pending = next_chunk();
+        slot = this.Exports().fill_training_slot();
+      }
+
+      // Train on the next filled slot
+      let batches = this.Exports().train_training_slot();
+      if(batches === 0) {
+        break;
+      }
+      total_batches += batches;
+      if(config.log_accuracy) {
+        total_hits += this._TrainingBatchesAccuracy();
+      }
+      if(config.log_error) {
+        total_cost += this._TrainingBatchesError();
+      }
+    }
+    if(config.log_accuracy) {
+      console.log(">> Accuracy:  ", total_hits / (total_batches * batch_size));
+    }
+    if(config.log_error) {
+      console.log(">> Error:     ", total_cost / total_batches);
+    }
+    if(config.log_time) {
+      console.log(">> Total time:", new Date().getTime() - total_time, "ms");
+    }
+    return true;
+  }
+
+  // Train on samples resident in the module memory. The
+  // data and labels are arrays of entries as for the other
+  // encoders, and are copied once. The module shuffles the
+  // samples at each epoch, so only the results are read back
+  TrainEpochs(data, labels, config) {
+    if(!("train_epochs" in this.Exports())) {
+      console.log("Model was not built with resident training samples");
+      return false;
+    }
+    let capacity = this.Exports().resident_training_samples();
+    let max_epochs = this.Exports().training_max_epochs();
+    let input_size = this._LayerSize(0);
+    let output_size = this._LayerSize(this._TotalLayers() - 1);
+    if(data.length !== labels.length) {
+      console.log("Data and labels should be equal");
+      return false;
+    }
+    if(data.length > capacity) {
+      console.log("Model can hold", capacity, "samples but received", data.length);
+      return false;
+    }
+    if(data.length < this._TrainingBatchSize()) {
+      console.log("Training needs at least one batch of", this._TrainingBatchSize(), "samples but received",
+                  data.length);
+      return false;
+    }
+
+    // Configuration        Value                     Default
+    config                  = config                  || {};
+    config.log_accuracy     = config.log_accuracy     || false;
+    config.log_error        = config.log_error        || false;
+    config.log_time         = config.log_time         || false;
+    config.epochs           = config.epochs           || 0;
+    config.learning_rate    = config.learning_rate    || 0.01;
+    if(config.seed !== undefined) {
+      this.Exports().set_shuffle_seed(config.seed);
+    }
+    this._SetLearningRate(config.learning_rate);
+
+    // Copy the samples as rows
+    let data_memory = new Float32Array(CompiledModel.Memory().buffer, this.Exports().resident_training_data_offset(),
+                                       data.length * input_size);
+    let labels_memory = new Float32Array(CompiledModel.Memory().buffer,
+                                         this.Exports().resident_training_labels_offset(),
+                                         labels.length * output_size);
+    for(let r=0; r < data.length; r++) {
+      if(data[r].length != input_size || labels[r].length != output_size) {
+        console.log("Input shape is incorrect at entry", r);
+        return false;
+      }
+      data_memory.set(data[r], r * input_size);
+      labels_memory.set(labels[r], r * output_size);
+    }
+
+    // Train in calls of at most the maximum number of epochs
+    let batches = Math.floor(data.length / this._TrainingBatchSize());
+    let total_time = new Date().getTime();
+    for(let e=0; e < config.epochs; e += max_epochs) {
+      let epochs = Math.min(max_epochs, config.epochs - e);
+      this.Exports().train_epochs(epochs, data.length);
+      let results = new Float32Array(CompiledModel.Memory().buffer,
+                                     this.Exports().training_epochs_results_offset(), 2 * epochs);
+      for(let i=0; i < epochs; i++) {
+        console.log("Epoch", e + i + 1);
+        if(config.log_accuracy) {
+          console.log(">> Accuracy:  ", results[2 * i + 1] / (batches * this._TrainingBatchSize()));
+        }
+        if(config.log_error) {
+          console.log(">> Error:     ", results[2 * i] / batches);
+        }
+      }
+    }
+    if(config.log_time) {
+      console.log(">> Total time:", new Date().getTime() - total_time, "ms");
+    }
+    return true;
+  }
+
+  _TrainingWorkers() {
+    let key = "training_workers";
+    return key in this.Exports() ? this.Exports()[key]() : 1;
+  }
+
+  // Start a Node worker thread per training worker. Each
+  // thread instantiates the model on the shared memory, which
+  // has no active data segments, so the weights are kept
+  async StartWorkers(worker_script) {
+    if(this._workers.length > 0) {
+      return true;
+    }
+    let workers = this._TrainingWorkers();
+    if(workers === 1 || this._bytes === null) {
+      console.error("Training workers require a model built with training workers and created by Instantiate()");
+      return false;
+    }
+    const {Worker} = require('worker_threads');
+    worker_script = worker_script || require('path').join(__dirname, 'training_worker.js');
+    let ready = [];
+    for(let w = 0; w < workers; w++) {
+      let worker = new Worker(worker_script, {
+        workerData: {bytes: this._bytes, memory: CompiledModel.Memory(), worker: w}
+      });
+      worker.on('error', (error) => {
+        console.error("Training worker", w, "failed:", error);
+      });
+      this._workers.push(worker);
+      ready.push(new Promise((resolve) => worker.once('message', resolve)));
+    }
+    await Promise.all(ready);
+    return true;
+  }
+
+  // Terminate the worker threads
+  async StopWorkers() {
+    await Promise.all(this._workers.map((worker) => worker.terminate()));
+    this._workers = [];
+  }
+
+  _GemmThreads() {
+    let key = "gemm_threads";
+    return key in this.Exports() ? this.Exports()[key]() : 1;
+  }
+
+  // Start a Node worker thread per helper of the parallel
+  // dot products. Each thread instantiates the model on the
+  // shared memory and runs gemm_helper() until stopped. The
+  // helpers must be started before training or predicting,
+  // otherwise the model waits for them indefinitely
+  async StartGemmHelpers(worker_script) {
+    if(this._gemm_helpers.length > 0) {
+      return true;
+    }
+    let threads = this._GemmThreads();
+    if(threads === 1 || this._bytes === null) {
+      console.error("GEMM helpers require a model built with parallel GEMM threads and created by Instantiate()");
+      return false;
+    }
+    const {Worker} = require('worker_threads');
+    worker_script = worker_script || require('path').join(__dirname, 'training_worker.js');
+    let ready = [];
+    for(let t = 1; t < threads; t++) {
+      let helper = new Worker(worker_script, {
+        workerData: {bytes: this._bytes, memory: CompiledModel.Memory(), helper: t}
+      });
+      helper.on('error', (error) => {
+        console.error("GEMM helper", t, "failed:", error);
+      });
+      this._gemm_helpers.push(helper);
+      ready.push(new Promise((resolve) => helper.once('message', resolve)));
+    }
+    await Promise.all(ready);
+    return true;
+  }
+
+  // Let the helper loops return and
+  // terminate the helper threads
+  async StopGemmHelpers() {
+    if(this._gemm_helpers.length === 0) {
+      return;
+    }
+    this.Exports().stop_gemm_helpers();
+    await Promise.all(this._gemm_helpers.map((helper) => helper.terminate()));
+    this._gemm_helpers = [];
+  }
+
+  // Train all workers on the batches in memory. Worker w
+  // trains on the batches w, w + n, w + 2n, ... and the
+  // gradients are averaged after each round of n batches
+  _TrainBatchesInMemoryWorkers(batches) {
+    return Promise.all(this._workers.map((worker) => new Promise((resolve) => {
+      worker.once('message', resolve);
+      worker.postMessage(batches);
+    })));
+  }
+
+  // Run train Wasm function on the training workers.
+  // Same as Train() but each update uses one batch per
+  // worker, and batches of an incomplete round are skipped
+  async TrainWorkers(input, config) {
+    if(!input.good) {
+      console.log("Trainting input seems bad, skipping ...");
+      return false;
+    }
+    if(!await this.StartWorkers(config && config.worker_script)) {
+      return false;
+    }
+    // Load model batch information
+    let batch_size = this._TrainingBatchSize();
+    let batches_in_memory = this._TrainingBatchesInMemory();
+    let number_of_batches = Math.floor(input.x_count / batch_size);
+    let workers = this._TrainingWorkers();
+    if(batches_in_memory % workers != 0) {
+      console.log("Batches in memory", batches_in_memory, "are not a multiple of the", workers, "workers");
+    }
+
+    // Configuration        Value                     Default
+    config                  = config                  || {};
+    config.log_epoch_num    = config.log_epoch_num    || true;
+    config.log_accuracy     = config.log_accuracy     || false;
+    config.log_error        = config.log_error        || false;
+    config.log_time         = config.log_time         || false;
+    config.epochs           = config.epochs           || 0;
+    config.learning_rate    = config.learning_rate    || 0.01;
+
+    // Update learning rate
+    this._SetLearningRate(config.learning_rate);
+
+    // Training variables
+    let total_time = 0.0;
+    let data_offset = this._TrainingDataOffset();
+    let labels_offset = this._TrainingLabelsOffset();
+
+    // Train for each epoch
+    for(let e=0; e < config.epochs; e++) {
+      // Epoch variables
+      let total_hits = 0;
+      let average_cost = 0.0;
+      let trained_batches = 0;
+      let epoch_time = new Date().getTime();
+      for(let i=0; i < number_of_batches; i += batches_in_memory) {
+        // Load new batches in memory and train
+        let batches_inserted = this._CopyBatchesToMemory(input, data_offset, labels_offset, i,
+                                                         batch_size, batches_in_memory);
+        // Start training
+        await this._TrainBatchesInMemoryWorkers(batches_inserted);
+        trained_batches += batches_inserted - batches_inserted % workers;
+
+        // Update training details
+        if(config.log_accuracy) {
+          total_hits += this._TrainingBatchesAccuracy();
+        }
+        if(config.log_error) {
+          average_cost += this._TrainingBatchesError();
+        }
+      }
+      // Update time
+      epoch_time = new Date().getTime() - epoch_time;
+      total_time += epoch_time;
+      // Log after end of epoch
+      if(config.log_epoch_num) {
+        console.log("Epoch",e+1);
+      }
+      if(config.log_accuracy) {
+        console.log(">> Accuracy:  ", total_hits / (trained_batches * batch_size));
+      }
+      if(config.log_error) {
+        console.log(">> Error:     ", average_cost / trained_batches);
+      }
+      if(config.log_time) {
+        console.log(">> Epoch time:", epoch_time, "ms");
+        console.log(">> Total time:", total_time, "ms");
+      }
+    }
+    return true;
+  }
+
   // Run test Wasm function
   Test(input, config) {
     if(!input.good) {
@@ -348,7 +809,7 @@ class CompiledModel {
     // Load model batch information
     let batch_size = this._TestingBatchSize();
     let batches_in_memory = this._TestingBatchesInMemory();
-    let number_of_batches = input.x_count / batch_size;
+    let number_of_batches = Math.floor(input.x_count / batch_size);
     
     // Configuration        Value                     Default
     config                  = config                  || {};
@@ -362,6 +823,7 @@ class CompiledModel {
     let average_cost = 0.0;
     let data_offset = this._TestingDataOffset();
     let labels_offset = this._TestingLabelsOffset();
+    this._ResetConfusionMatrix("testing");
     let test_time = new Date().getTime();
     for(let i=0; i < number_of_batches; i += batches_in_memory) {
       // Load new batches in memory and test
@@ -393,6 +855,8 @@ class CompiledModel {
     if(config.log_conf_mat) {
       this._LogTestingConfusionMatrix();
     }
+    // Hits are only counted when the accuracy is logged
+    return total_hits / input.x_count;
   }
 
   _GetLearningRate() {
@@ -538,6 +1002,15 @@ class CompiledModel {
     }
   }
 
+  // Clear the confusion matrix of a mode, which
+  // otherwise accumulates over the calls
+  _ResetConfusionMatrix(mode) {
+    let key = "reset_" + mode + "_confusion_matrix";
+    if(key in this.Exports()) {
+      this.Exports()[key]();
+    }
+  }
+
   _LogTrainingConfusionMatrix() {
     let matrix_offset_key = "training_confusion_matrix_offset";
     let matrix_side = this._LayerSize(this._TotalLayers() - 1);
@@ -577,6 +1050,43 @@ class CompiledModel {
     });
   }
 
+  // Predict up to a batch of entries and return the output
+  // of each entry. Models built with a live prediction batch
+  // only compute the given entries
+  PredictEntries(data) {
+    let batch_size = this._PredictionBatchSize();
+    let input_size = this._LayerSize(0);
+    let output_size = this._LayerSize(this._TotalLayers() - 1);
+    if(data.length === 0 || data.length > batch_size) {
+      console.log("Expecting between 1 and", batch_size, "entries but received", data.length);
+      return false;
+    }
+    // Entries are the first columns of the batch
+    let input = new Float32Array(CompiledModel.Memory().buffer, this._PredictionDataOffset(),
+                                 input_size * batch_size);
+    for(let r=0; r < data.length; r++) {
+      if(data[r].length != input_size) {
+        console.log("Input shape is incorrect. Expecting", input_size, "but received", data[r].length);
+        return false;
+      }
+      for(let c=0; c < input_size; c++) {
+        input[c * batch_size + r] = data[r][c];
+      }
+    }
+    this.Exports().predict_batch(data.length);
+    let output = new Float32Array(CompiledModel.Memory().buffer, this.Exports().prediction_result_offset(),
+                                  output_size * batch_size);
+    let results = [];
+    for(let r=0; r < data.length; r++) {
+      let result = [];
+      for(let c=0; c < output_size; c++) {
+        result.push(output[c * batch_size + r]);
+      }
+      results.push(result);
+    }
+    return results;
+  }
+
   // Run predict Wasm function
   Predict(input, config) {
     if(!input.good) {
@@ -586,7 +1096,7 @@ class CompiledModel {
 
     // Load model batch information
     let batch_size = this._PredictionBatchSize();
-    let number_of_batches = input.x_count / batch_size;
+    let number_of_batches = Math.floor(input.x_count / batch_size);
     
     // Configuration        Value                     Default
     config                  = config                  || {};
@@ -617,6 +1127,134 @@ class CompiledModel {
     }
   }
 
+  // Reset the weights to their initial values. Models built
+  // with passive weights or on a shared memory start with an
+  // empty memory and must be initialized once (done by
+  // Instantiate()), other models have their initial weights
+  // copied at instantiation only
+  InitWeights() {
+    if("init_weights" in this.Exports()) {
+      this.Exports().init_weights();
+    }
+  }
+
+  // Release the initial weights of a model built with
+  // passive weights. InitWeights() then traps
+  DropInitialWeights() {
+    this._CallExport("drop_initial_weights");
+  }
+
+  // Quantize the weights of a model built with int8
+  // prediction weights. Done by the training functions
+  // and the weights loaders, so only required after the
+  // weights are written directly in the memory
+  QuantizeWeights() {
+    this._CallExport("quantize_weights");
+  }
+
+  // Update the copies of the weights used for
+  // prediction once the weights are written
+  _UpdatePredictionWeights() {
+    if("quantize_weights" in this.Exports()) {
+      this.Exports().quantize_weights();
+    }
+    if("prune_weights" in this.Exports()) {
+      this.Exports().prune_weights();
+    }
+  }
+
+  // Prune the weights of the sparse layers. Done by the
+  // training functions and the weights loaders, so only
+  // required after the weights are written directly in
+  // the memory
+  PruneWeights() {
+    this._CallExport("prune_weights");
+  }
+
+  // Copy a weights blob (e.g. the .weights file written by
+  // the builder) in the memory, one copy per region
+  LoadWeightsBlob(bytes) {
+    let blob = new Uint8Array(bytes.buffer || bytes, bytes.byteOffset || 0, bytes.byteLength);
+    let header = new DataView(blob.buffer, blob.byteOffset, blob.byteLength);
+    if(blob.byteLength < 16 || header.getUint32(0, true) !== CompiledModel._WEIGHTS_BLOB_MAGIC) {
+      console.error("Not a weights blob");
+      return false;
+    }
+    if(header.getUint32(4, true) !== CompiledModel._WEIGHTS_BLOB_VERSION) {
+      console.error("Unsupported weights blob version", header.getUint32(4, true));
+      return false;
+    }
+    if(header.getUint32(8, true) !== this._WeightsLayout()) {
+      console.error("Weights blob of a model with a different layout");
+      return false;
+    }
+    let regions = header.getUint32(12, true);
+    let data_offset = 16 + 8 * regions;
+    let memory = new Uint8Array(CompiledModel.Memory().buffer);
+    for(let r = 0; r < regions; r++) {
+      let offset = header.getUint32(16 + 8 * r, true);
+      let byte_size = header.getUint32(20 + 8 * r, true);
+      if(data_offset + byte_size > blob.byteLength || offset + byte_size > memory.length) {
+        console.error("Weights blob region", r, "is out of bounds");
+        return false;
+      }
+      memory.set(blob.subarray(data_offset, data_offset + byte_size), offset);
+      data_offset += byte_size;
+    }
+    this._UpdatePredictionWeights();
+    return true;
+  }
+
+  // 32-bit FNV-1a hash of the offset and byte size of the
+  // weights and bias of each layer (same as Model::WeightsLayout)
+  _WeightsLayout() {
+    let hash = 0x811c9dc5;
+    let HashU32 = (val) => {
+      for(let i = 0; i < 4; i++) {
+        hash = Math.imul(hash ^ ((val >>> (8 * i)) & 0xff), 0x01000193) >>> 0;
+      }
+    };
+    for (let l = 0; l < this._TotalLayers(); l++) {
+      let weight_info = this._WeightInfo(l);
+      let bias_info = this._BiasInfo(l);
+      if (weight_info != null && bias_info != null) {
+        HashU32(weight_info.offset);
+        HashU32(weight_info.byte_size);
+        HashU32(bias_info.offset);
+        HashU32(bias_info.byte_size);
+      }
+    }
+    return hash;
+  }
+
+  // Make a weights blob of the current weights and biases
+  ExtractWeightsBlob() {
+    let regions = [];
+    for (let l = 0; l < this._TotalLayers(); l++) {
+      let weight_info = this._WeightInfo(l);
+      let bias_info = this._BiasInfo(l);
+      if (weight_info != null && bias_info != null) {
+        regions.push(weight_info, bias_info);
+      }
+    }
+    let header_size = 16 + 8 * regions.length;
+    let data_size = regions.reduce((size, region) => size + region.byte_size, 0);
+    let blob = new Uint8Array(header_size + data_size);
+    let header = new DataView(blob.buffer);
+    header.setUint32(0, CompiledModel._WEIGHTS_BLOB_MAGIC, true);
+    header.setUint32(4, CompiledModel._WEIGHTS_BLOB_VERSION, true);
+    header.setUint32(8, this._WeightsLayout(), true);
+    header.setUint32(12, regions.length, true);
+    let data_offset = header_size;
+    regions.forEach((region, r) => {
+      header.setUint32(16 + 8 * r, region.offset, true);
+      header.setUint32(20 + 8 * r, region.byte_size, true);
+      blob.set(new Uint8Array(CompiledModel.Memory().buffer, region.offset, region.byte_size), data_offset);
+      data_offset += region.byte_size;
+    });
+    return blob;
+  }
+
   ExtractWeights() {
     let weights = [];
     for (let l = 0; l < this._TotalLayers(); l++) {
@@ -658,6 +1296,7 @@ class CompiledModel {
         return false;
       }
     };
+    this._UpdatePredictionWeights();
     return true;
   }
 
@@ -715,8 +1354,9 @@ class CompiledModel {
     return table;
   }
 
-  // Initialize imports
-  static Imports() {
+  // Initialize imports. The memory is only
+  // imported by models with training workers
+  static Imports(memory) {
     let math_imports = {
       exp: Math.exp,
       log: Math.log,
@@ -752,11 +1392,15 @@ class CompiledModel {
         }
       }
     };
-    return {
+    let imports = {
       "Math": math_imports,
       "System": system_imports,
       "Test": test_imports,
     };
+    if(memory) {
+      imports["Memory"] = {memory: memory};
+    }
+    return imports;
   }
 }
 
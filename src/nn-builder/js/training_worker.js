@@ -0,0 +1,24 @@
+// Worker thread of a model built with training workers
+// (see CompiledModel.StartWorkers) or with parallel GEMM
+// threads (see CompiledModel.StartGemmHelpers). The thread
+// instantiates the model on the shared memory, then either
+// trains its batches each time it receives the number of
+// batches in memory, or runs the GEMM helper loop
+const {parentPort, workerData} = require('worker_threads');
+const {CompiledModel} = require('./compiled_model');
+
+CompiledModel._memory = workerData.memory;
+WebAssembly.instantiate(workerData.bytes, CompiledModel.Imports(workerData.memory)).then(wasm => {
+  if(workerData.helper !== undefined) {
+    parentPort.postMessage("ready");
+    // Blocks until stop_gemm_helpers() is called
+    wasm.instance.exports.gemm_helper(workerData.helper);
+    return;
+  }
+  const worker = workerData.worker;
+  parentPort.on('message', (batches) => {
+    wasm.instance.exports.train_batches_in_memory_worker(worker, batches);
+    parentPort.postMessage(batches);
+  });
+  parentPort.postMessage("ready");
+});
@@ -0,0 +1,140 @@
+#include <src/nn-builder/native/model.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+// Generated by wasm2c
+#include "module.h"
+#include "wasm-rt-impl.h"
+
+namespace {
+
+std::mt19937 generator;
+
+// System imports
+void PrintI32(u32 val) { std::cout << val << std::endl; }
+void PrintI64(u64 val) { std::cout << val << std::endl; }
+void PrintF32(f32 val) { std::cout << val << std::endl; }
+void PrintF64(f64 val) { std::cout << val << std::endl; }
+
+void PrintTableF32(u32 index, u32 rows, u32 cols) {
+  float* table = reinterpret_cast<float*>(Z_memory->data + index);
+  for(u32 row = 0; row < rows; row++) {
+    for(u32 col = 0; col < cols; col++) {
+      std::cout << (col == 0 ? "" : "\t") << table[row * cols + col];
+    }
+    std::cout << std::endl;
+  }
+}
+
+f64 Time() {
+  // Milliseconds, as returned by Date.getTime() in JS
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(now).count();
+}
+
+// Math imports
+f32 Exp(f32 val) { return std::exp(val); }
+f32 Log(f32 val) { return std::log(val); }
+f32 Random() { return std::uniform_real_distribution<float>(0, 1)(generator); }
+
+} // namespace
+
+// Imports expected by the generated module
+void (*Z_SystemZ_printZ_vi)(u32) = PrintI32;
+void (*Z_SystemZ_printZ_vj)(u64) = PrintI64;
+void (*Z_SystemZ_printZ_vf)(f32) = PrintF32;
+void (*Z_SystemZ_printZ_vd)(f64) = PrintF64;
+void (*Z_SystemZ_print_table_f32Z_viii)(u32, u32, u32) = PrintTableF32;
+f64 (*Z_SystemZ_timeZ_dv)(void) = Time;
+f32 (*Z_MathZ_expZ_ff)(f32) = Exp;
+f32 (*Z_MathZ_logZ_ff)(f32) = Log;
+f32 (*Z_MathZ_randomZ_fv)(void) = Random;
+
+// Run a call to the module and terminate
+// the program if the execution traps
+#define TRAP_GUARD(call)                                        \
+do {                                                            \
+  int trap = wasm_rt_impl_try();                                \
+  if(trap != 0) {                                               \
+    fprintf(stderr, "%s:%d\n", __FILE__, __LINE__);             \
+    fprintf(stderr, "Native model trapped (%d)\n", trap);       \
+    exit(1);                                                    \
+  }                                                             \
+  call;                                                         \
+} while(0)
+
+namespace nn {
+namespace native {
+
+NativeModel::NativeModel(uint32_t seed) {
+  static bool initialized = false;
+  if(!initialized) {
+    generator.seed(seed);
+    TRAP_GUARD(init());
+    initialized = true;
+  }
+}
+
+uint8_t* NativeModel::Memory() {
+  return Z_memory->data;
+}
+
+uint32_t NativeModel::MemoryBytes() {
+  return Z_memory->size;
+}
+
+#define OFFSET_ACCESSOR(method, name)                             \
+float* NativeModel::method() {                                    \
+  u32 offset = 0;                                                 \
+  TRAP_GUARD(offset = Z_##name##Z_iv());                          \
+  return reinterpret_cast<float*>(Memory() + offset);             \
+}
+OFFSET_ACCESSOR(TrainingData, training_data_offset)
+OFFSET_ACCESSOR(TrainingLabels, training_labels_offset)
+OFFSET_ACCESSOR(TestingData, testing_data_offset)
+OFFSET_ACCESSOR(TestingLabels, testing_labels_offset)
+OFFSET_ACCESSOR(PredictionData, prediction_data_offset)
+OFFSET_ACCESSOR(PredictionResult, prediction_result_offset)
+#undef OFFSET_ACCESSOR
+
+#define I32_ACCESSOR(method, name)                                \
+uint32_t NativeModel::method() {                                  \
+  u32 val = 0;                                                    \
+  TRAP_GUARD(val = Z_##name##Z_iv());                             \
+  return val;                                                     \
+}
+I32_ACCESSOR(TrainingBatchSize, training_batch_size)
+I32_ACCESSOR(TrainingBatchesInMemory, training_batches_in_memory)
+I32_ACCESSOR(TestingBatchSize, testing_batch_size)
+I32_ACCESSOR(TestingBatchesInMemory, testing_batches_in_memory)
+I32_ACCESSOR(PredictionBatchSize, prediction_batch_size)
+#undef I32_ACCESSOR
+
+void NativeModel::SetLearningRate(float learning_rate) {
+  TRAP_GUARD(Z_set_learning_rateZ_vf(learning_rate));
+}
+
+float NativeModel::LearningRate() {
+  f32 val = 0;
+  TRAP_GUARD(val = Z_get_learning_rateZ_fv());
+  return val;
+}
+
+void NativeModel::TrainBatchesInMemory(uint32_t batches) {
+  TRAP_GUARD(Z_train_batches_in_memoryZ_vi(batches));
+}
+
+void NativeModel::TestBatchesInMemory(uint32_t batches) {
+  TRAP_GUARD(Z_test_batches_in_memoryZ_vi(batches));
+}
+
+void NativeModel::PredictBatch() {
+  TRAP_GUARD(Z_predict_batchZ_vv());
+}
+
+} // namespace native
+} // namespace nn
@@ -0,0 +1,56 @@
+#ifndef NN_NATIVE_MODEL_H_
+#define NN_NATIVE_MODEL_H_
+
+#include <cstdint>
+
+namespace nn {
+namespace native {
+
+// Facade of a model compiled ahead-of-time using wasm2c
+// (see add_native_model in CMakeLists.txt). The module
+// instance is global, so all NativeModel objects share
+// the same memory and state. The System and Math imports
+// are implemented natively with the same behavior as
+// compiled_model.js
+class NativeModel {
+public:
+  // Instantiate the module on first use
+  explicit NativeModel(uint32_t seed = 0);
+
+  // Linear memory
+  uint8_t* Memory();
+  uint32_t MemoryBytes();
+
+  // Batches in memory. Each batch is stored as a matrix
+  // with one column per entry (e.g. a training batch of
+  // size n of a model with k inputs is a k x n matrix)
+  float* TrainingData();
+  float* TrainingLabels();
+  float* TestingData();
+  float* TestingLabels();
+  float* PredictionData();
+  float* PredictionResult();
+
+  // Batches information
+  uint32_t TrainingBatchSize();
+  uint32_t TrainingBatchesInMemory();
+  uint32_t TestingBatchSize();
+  uint32_t TestingBatchesInMemory();
+  uint32_t PredictionBatchSize();
+
+  // Learning rate
+  void SetLearningRate(float learning_rate);
+  float LearningRate();
+
+  // Train and test on the first batches in memory
+  void TrainBatchesInMemory(uint32_t batches);
+  void TestBatchesInMemory(uint32_t batches);
+
+  // Predict the batch in memory
+  void PredictBatch();
+};
+
+} // namespace native
+} // namespace nn
+
+#endif
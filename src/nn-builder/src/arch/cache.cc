@@ -0,0 +1,181 @@
+#include <src/nn-builder/src/arch/cache.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace nn {
+namespace arch {
+
+namespace {
+
+// Describe the configuration of a model in text
+std::string Describe(Model* model, uint32_t training_batch_size, uint32_t training_batches_in_memory,
+                     uint32_t testing_batch_size, uint32_t testing_batches_in_memory,
+                     uint32_t prediction_batch_size, builtins::LossFunction loss,
+                     float l1_regularizer, float l2_regularizer) {
+  std::stringstream ss;
+  ss << std::hexfloat;
+  ss << "codegen_version " << NN_CODEGEN_VERSION << std::endl
+     << "weights_blob_version " << NN_WEIGHTS_BLOB_VERSION << std::endl;
+#ifdef WABT_EXPERIMENTAL
+  ss << "wabt_experimental" << std::endl;
+#endif
+
+  // Options
+  auto& bytecode = model->Options().bytecode_options;
+  ss << "gen_training_accuracy " << bytecode.gen_training_accuracy << std::endl
+     << "gen_training_error " << bytecode.gen_training_error << std::endl
+     << "gen_training_confusion_matrix " << bytecode.gen_training_confusion_matrix << std::endl
+     << "gen_testing_accuracy " << bytecode.gen_testing_accuracy << std::endl
+     << "gen_testing_error " << bytecode.gen_testing_error << std::endl
+     << "gen_testing_confusion_matrix " << bytecode.gen_testing_confusion_matrix << std::endl
+     << "gen_forward_profiling " << bytecode.gen_forward_profiling << std::endl
+     << "gen_backward_profiling " << bytecode.gen_backward_profiling << std::endl
+     << "use_simd " << bytecode.use_simd << std::endl
+     << "use_kernel_functions " << bytecode.use_kernel_functions << std::endl
+     << "split_layer_functions " << bytecode.split_layer_functions << std::endl
+     << "training_workers " << bytecode.training_workers << std::endl
+     << "gradient_accumulation_steps " << bytecode.gradient_accumulation_steps << std::endl
+     << "parallel_gemm_threads " << bytecode.parallel_gemm_threads << std::endl
+     << "parallel_gemm_min_nodes " << bytecode.parallel_gemm_min_nodes << std::endl
+     << "passive_weights " << bytecode.passive_weights << std::endl
+     << "separate_weights " << bytecode.separate_weights << std::endl
+     << "inference_only " << bytecode.inference_only << std::endl
+     << "live_prediction_batch " << bytecode.live_prediction_batch << std::endl
+     << "live_training_batch " << bytecode.live_training_batch << std::endl
+     << "growable_training_batches " << bytecode.growable_training_batches << std::endl
+     << "training_data_slots " << bytecode.training_data_slots << std::endl
+     << "resident_training_samples " << bytecode.resident_training_samples << std::endl
+     << "resident_training_max_epochs " << bytecode.resident_training_max_epochs << std::endl
+     << "simd_reduction_accumulators " << bytecode.simd_reduction_accumulators << std::endl
+     << "bf16_activations " << bytecode.bf16_activations << std::endl
+     << "int8_prediction_weights " << bytecode.int8_prediction_weights << std::endl;
+  auto& activation = model->Options().activation_options;
+  ss << "linear_slope " << activation.linear_slope << std::endl
+     << "leaky_relu_slope " << activation.leaky_relu_slope << std::endl
+     << "elu_slope " << activation.elu_slope << std::endl
+     << "derivative_from_output " << activation.derivative_from_output << std::endl;
+  auto& weights = model->Options().weights_options;
+  ss << "gaussian_mean " << weights.gaussian_mean << std::endl
+     << "gaussian_std_dev " << weights.gaussian_std_dev << std::endl
+     << "uniform_low " << weights.uniform_low << std::endl
+     << "uniform_high " << weights.uniform_high << std::endl
+     << "constant_value " << weights.constant_value << std::endl
+     << "seed " << weights.seed << std::endl;
+  auto& optimizer = model->Options().optimizer_options;
+  ss << "optimizer " << optimizer.type << std::endl
+     << "beta1 " << optimizer.beta1 << std::endl
+     << "beta2 " << optimizer.beta2 << std::endl
+     << "epsilon " << optimizer.epsilon << std::endl;
+
+  // Layers
+  for(auto layer : model->Layers()) {
+    ss << "layer " << layer->Descriptor() << std::endl;
+  }
+
+  // Build arguments
+  ss << "training_batch_size " << training_batch_size << std::endl
+     << "training_batches_in_memory " << training_batches_in_memory << std::endl
+     << "testing_batch_size " << testing_batch_size << std::endl
+     << "testing_batches_in_memory " << testing_batches_in_memory << std::endl
+     << "prediction_batch_size " << prediction_batch_size << std::endl
+     << "loss " << loss.type << std::endl
+     << "l1_regularizer " << l1_regularizer << std::endl
+     << "l2_regularizer " << l2_regularizer << std::endl;
+  return ss.str();
+}
+
+// 64-bit FNV-1a hash
+uint64_t Hash(const std::string& str) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for(auto c : str) {
+    hash ^= (uint8_t) c;
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+// Key of a configuration description
+std::string DescriptionKey(const std::string& description) {
+  std::stringstream ss;
+  ss << std::hex << Hash(description);
+  return ss.str();
+}
+
+bool ReadFile(std::string path, std::string* content) {
+  std::ifstream file(path, std::ios::binary);
+  if(!file.good()) {
+    return false;
+  }
+  content->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+bool WriteFile(std::string path, const char* data, size_t size) {
+  std::ofstream file(path, std::ios::binary);
+  file.write(data, size);
+  return file.good();
+}
+
+} // namespace
+
+std::string ModelCache::Key(Model* model, uint32_t training_batch_size, uint32_t training_batches_in_memory,
+                            uint32_t testing_batch_size, uint32_t testing_batches_in_memory,
+                            uint32_t prediction_batch_size, builtins::LossFunction loss,
+                            float l1_regularizer, float l2_regularizer) {
+  return DescriptionKey(Describe(model, training_batch_size, training_batches_in_memory, testing_batch_size,
+                                 testing_batches_in_memory, prediction_batch_size, loss,
+                                 l1_regularizer, l2_regularizer));
+}
+
+std::vector<uint8_t> ModelCache::BuildToWasm(Model* model, uint32_t training_batch_size,
+                                             uint32_t training_batches_in_memory, uint32_t testing_batch_size,
+                                             uint32_t testing_batches_in_memory, uint32_t prediction_batch_size,
+                                             builtins::LossFunction loss, float l1_regularizer,
+                                             float l2_regularizer, std::vector<uint8_t>* weights_blob) {
+  assert(model != nullptr);
+  bool separate_weights = model->Options().bytecode_options.separate_weights;
+  ERROR_UNLESS(weights_blob == nullptr || separate_weights, "Weights are not separate");
+  std::string description = Describe(model, training_batch_size, training_batches_in_memory, testing_batch_size,
+                                     testing_batches_in_memory, prediction_batch_size, loss,
+                                     l1_regularizer, l2_regularizer);
+  std::string path = directory_ + "/" + DescriptionKey(description);
+
+  // The stored configuration is compared
+  // as well in case of a hash collision
+  std::string stored_description;
+  std::string stored_wasm;
+  std::string stored_weights;
+  if(ReadFile(path + ".config", &stored_description) && stored_description == description
+     && ReadFile(path + ".wasm", &stored_wasm)
+     && (!separate_weights || ReadFile(path + ".weights", &stored_weights))) {
+    hits_++;
+    if(weights_blob != nullptr) {
+      weights_blob->assign(stored_weights.begin(), stored_weights.end());
+    }
+    return std::vector<uint8_t>(stored_wasm.begin(), stored_wasm.end());
+  }
+
+  misses_++;
+  model->Build(training_batch_size, training_batches_in_memory, testing_batch_size, testing_batches_in_memory,
+               prediction_batch_size, loss, l1_regularizer, l2_regularizer);
+  std::vector<uint8_t> wasm = model->ModuleManager().ToWasm().data;
+  std::vector<uint8_t> weights;
+  if(separate_weights) {
+    weights = model->WeightsBlob();
+    if(weights_blob != nullptr) {
+      *weights_blob = weights;
+    }
+  }
+  // Write the bytecode before the configuration
+  // so that an interrupted write is never a hit
+  if(!WriteFile(path + ".wasm", (const char*) wasm.data(), wasm.size())
+     || (separate_weights && !WriteFile(path + ".weights", (const char*) weights.data(), weights.size()))
+     || !WriteFile(path + ".config", description.data(), description.size())) {
+    fprintf(stderr, "Failed to write the model to the cache at %s\n", path.c_str());
+  }
+  return wasm;
+}
+
+} // namespace arch
+} // namespace nn
@@ -0,0 +1,48 @@
+#ifndef NN_ARCH_CACHE_H_
+#define NN_ARCH_CACHE_H_
+
+#include <src/nn-builder/src/arch/model.h>
+
+namespace nn {
+namespace arch {
+
+// On-disk cache of built models bytecode. Entries are
+// identified by a hash of the model options, the layers
+// descriptors, the build arguments and the codegen version,
+// so a model is only generated once for a configuration
+class ModelCache {
+private:
+  std::string directory_;
+  uint32_t hits_ = 0;
+  uint32_t misses_ = 0;
+public:
+  // The directory must exist
+  explicit ModelCache(std::string directory) : directory_(directory) {}
+
+  // Get the bytecode of the model built with the arguments.
+  // On a hit the bytecode is read from the cache and the
+  // model is not built, otherwise the model is built and
+  // its bytecode is stored in the cache. The initial weights
+  // blob of a model with separate weights is cached as well,
+  // and returned in `weights_blob` if not null
+  std::vector<uint8_t> BuildToWasm(Model* model, uint32_t training_batch_size, uint32_t training_batches_in_memory,
+                                   uint32_t testing_batch_size, uint32_t testing_batches_in_memory,
+                                   uint32_t prediction_batch_size, builtins::LossFunction loss,
+                                   float l1_regularizer, float l2_regularizer,
+                                   std::vector<uint8_t>* weights_blob = nullptr);
+
+  // Key of a model configuration
+  static std::string Key(Model* model, uint32_t training_batch_size, uint32_t training_batches_in_memory,
+                         uint32_t testing_batch_size, uint32_t testing_batches_in_memory,
+                         uint32_t prediction_batch_size, builtins::LossFunction loss,
+                         float l1_regularizer, float l2_regularizer);
+
+  // Cache statistics
+  uint32_t Hits() const { return hits_; }
+  uint32_t Misses() const { return misses_; }
+};
+
+} // namespace arch
+} // namespace nn
+
+#endif
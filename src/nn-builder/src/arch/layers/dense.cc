@@ -1,6 +1,8 @@
 #include <src/nn-builder/src/arch/layers/dense.h>
 #include <src/nn-builder/src/arch/model.h>
 #include <src/wasmpp/wasm-instructions-gen.h>
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 namespace nn {
@@ -17,11 +19,79 @@ FullyConnectedLayer* FullyConnectedLayer::KeepProb(float keep_prob) {
   return this;
 }
 
+bool FullyConnectedLayer::DerivativeFromOutput() const {
+  // Dropout scales A[l] after the activation,
+  // so it no longer holds g(Z[l]) in that case
+  return activation_func_.has_output_derivative && keep_prob_ == KEEP_PROB_MAX;
+}
+
+bool FullyConnectedLayer::Bf16Activations(uint8_t mode_index) const {
+  // Training keeps A[l] in f32 for the back-propagation,
+  // and the output layer for the cost and the predictions
+  return NetworkModel()->Bf16Activations() && Position() == Hidden && mode_index != Model::Mode::Training;
+}
+
+bool FullyConnectedLayer::Int8Weights(uint8_t mode_index) const {
+  return NetworkModel()->Int8PredictionWeights() && Position() != Input && mode_index == Model::Mode::Prediction;
+}
+
+bool FullyConnectedLayer::SparseWeights(uint8_t mode_index) const {
+  return Sparse() && mode_index == Model::Mode::Prediction;
+}
+
+bool FullyConnectedLayer::ParallelDot(uint8_t mode_index) const {
+  // Training workers would fork on the same control block,
+  // so only the prediction is parallel when there are several
+  return NetworkModel()->ParallelGemmThreads() > 1
+         && nodes_ >= NetworkModel()->Options().bytecode_options.parallel_gemm_min_nodes
+         && (mode_index == Model::Mode::Prediction || NetworkModel()->TrainingWorkers() == 1);
+}
+
 FullyConnectedLayer* FullyConnectedLayer::WeightType(nn::arch::WeightDistributionType type) {
   weight_type_ = type;
   return this;
 }
 
+FullyConnectedLayer* FullyConnectedLayer::Sparsity(float sparsity) {
+  ERROR_UNLESS(Position() != Input, "Input layer has no weights to prune");
+  ERROR_UNLESS(sparsity >= 0 && sparsity < 1, "Sparsity must be between 0 (inclusive) and 1 (exclusive)");
+  sparsity_ = sparsity;
+  return this;
+}
+
+std::string FullyConnectedLayer::Descriptor() const {
+  std::stringstream ss;
+  ss << "fully_connected"
+     << " position=" << Position()
+     << " nodes=" << nodes_
+     << " weight_type=" << weight_type_
+     << " keep_prob=" << std::hexfloat << keep_prob_;
+  if(Position() != Input) {
+    ss << " activation=" << activation_func_.type;
+  }
+  if(Sparse()) {
+    ss << " sparsity=" << sparsity_;
+  }
+  return ss.str();
+}
+
+void FullyConnectedLayer::Validate() {
+  if(Sparse()) {
+    assert(LayerIndex() > 0);
+    auto prev_layer = NetworkModel()->Layers()[LayerIndex() - 1];
+    ERROR_UNLESS(prev_layer->Type() == FullyConnected &&
+                 static_cast<FullyConnectedLayer*>(prev_layer)->Nodes() % ds::SPARSE_BLOCK_WIDTH == 0,
+                 "The previous layer of a sparse layer must have a multiple of %u nodes", ds::SPARSE_BLOCK_WIDTH);
+    auto& bytecode = NetworkModel()->Options().bytecode_options;
+    ERROR_UNLESS(!bytecode.live_prediction_batch && !bytecode.int8_prediction_weights && !bytecode.bf16_activations,
+                 "Sparse layers cannot be used with the live prediction batch, int8 prediction weights "
+                 "or bf16 activations");
+  }
+#ifdef WABT_EXPERIMENTAL
+  ERROR_UNLESS(!Sparse(), "Sparse layers cannot be used with native dot products");
+#endif
+}
+
 #define START_TIME()                                                                                                  \
   if(mode_index == Model::Mode::Training && NetworkModel()->Options().bytecode_options.gen_forward_profiling) {       \
     Merge(e, NetworkModel()->DenseForwardTime().SetTime(MakeCall(NetworkModel()->Builtins().system.TimeF64(), {})));  \
@@ -38,9 +108,11 @@ FullyConnectedLayer* FullyConnectedLayer::WeightType(nn::arch::WeightDistributio
   }
 
 
-wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, Var input_begin, std::vector<Var> locals) {
+wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, uint32_t worker, Var input_begin,
+                                             std::vector<Var> locals) {
   assert(mode_index >= Model::Mode::FIRST_MODE && mode_index <= Model::Mode::LAST_MODE);
-  assert(locals.size() == 7);
+  assert(worker < A_[mode_index].size());
+  assert(locals.size() == 8);
   auto vi32_1 = locals[0];
   auto vi32_2 = locals[1];
   auto vi32_3 = locals[2];
@@ -48,6 +120,7 @@ wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, Var input_begin
   auto vi32_5 = locals[4];
   auto vf32_1 = locals[5];
   auto v128_1 = locals[6];
+  auto v128_2 = locals[7];
 
   ExprList* e = new ExprList();
   if(Position() != Input) {
@@ -62,22 +135,47 @@ wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, Var input_begin
 #ifdef WABT_EXPERIMENTAL
       Merge(e, MakeNativeCall(NetworkModel()->Natives().dot_product, {
         MakeI32Const(W_->Begin()),
-        (LayerIndex() == 1) ? MakeLocalGet(input_begin) : MakeI32Const(prev_fc_layer->A_[mode_index]->Begin()),
-        MakeI32Const(Z_[mode_index]->Begin()),
+        (LayerIndex() == 1) ? MakeLocalGet(input_begin) : MakeI32Const(prev_fc_layer->A_[mode_index][worker]->Begin()),
+        MakeI32Const(Z_[mode_index][worker]->Begin()),
         MakeI32Const(W_->Shape()[0]),
         MakeI32Const(W_->Shape()[1]),
-        MakeI32Const(prev_fc_layer->A_[mode_index]->Shape()[1])
+        MakeI32Const(prev_fc_layer->A_[mode_index][worker]->Shape()[1])
       }));
 #else
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixDot(W_, (LayerIndex() == 1) ?
-                                                                snippet::RelocMat(prev_fc_layer->A_[mode_index], input_begin) :
-                                                                snippet::RelocMat(prev_fc_layer->A_[mode_index]), Z_[mode_index],
-                                                            {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+      auto prev_A = (LayerIndex() == 1) ? snippet::RelocMat(prev_fc_layer->A_[mode_index][worker], input_begin) :
+                                          snippet::RelocMat(prev_fc_layer->A_[mode_index][worker]);
+      if(SparseWeights(mode_index)) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotSparse(W_sparse_, prev_A, Z_[mode_index][worker],
+                                                                    {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1,
+                                                                     v128_1}));
+      } else if(Int8Weights(mode_index)) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotInt8(W_int8_, prev_A, Z_[mode_index][worker],
+                                                                  {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1,
+                                                                   v128_1, v128_2}));
+      } else if(prev_fc_layer->Bf16Activations(mode_index)) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotBf16(W_, prev_A, Z_[mode_index][worker],
+                                                                  {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1,
+                                                                   v128_1, v128_2}));
+      } else if(ParallelDot(mode_index)) {
+        Merge(e, NetworkModel()->Snippets().parallel->MatrixDot(W_, prev_A, Z_[mode_index][worker], {vi32_1, vi32_2}));
+      } else if(NetworkModel()->Options().bytecode_options.use_kernel_functions) {
+        Merge(e, NetworkModel()->Snippets().kernels->MatrixDot(W_, prev_A, Z_[mode_index][worker]));
+      } else {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDot(W_, prev_A, Z_[mode_index][worker],
+                                                              {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+      }
 #endif
       END_TIME(A_1)
       START_TIME()
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixVectorAddition(Z_[mode_index], b_, Z_[mode_index],
-                                                                             {vi32_1, vi32_2, vi32_3, vi32_4}));
+      if(Int8Weights(mode_index)) {
+        // Z[l] = Z[l] * scales[l] + b[l]
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixVectorScaleAddition(Z_[mode_index][worker], W_scales_, b_,
+                                                                              Z_[mode_index][worker],
+                                                                              {vi32_1, vi32_2, vi32_3, vi32_4}));
+      } else {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixVectorAddition(Z_[mode_index][worker], b_, Z_[mode_index][worker],
+                                                                         {vi32_1, vi32_2, vi32_3, vi32_4}));
+      }
       END_TIME(A_2)
 
       // B) A[l] = g(Z[l])
@@ -85,13 +183,19 @@ wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, Var input_begin
       // Special case for softmax
       if(activation_func_ == NetworkModel()->Builtins().activation.Softmax()) {
         Merge(e, MakeCall(activation_func_.function, {
-          MakeI32Const(Z_[mode_index]->Begin()),
-          MakeI32Const(A_[mode_index]->Begin()),
-          MakeI32Const(Z_[mode_index]->Shape()[0]),
-          MakeI32Const(Z_[mode_index]->Shape()[1])
+          MakeI32Const(Z_[mode_index][worker]->Begin()),
+          MakeI32Const(A_[mode_index][worker]->Begin()),
+          MakeI32Const(Z_[mode_index][worker]->Shape()[0]),
+          MakeI32Const(Z_[mode_index][worker]->Shape()[1])
         }));
+      } else if(Bf16Activations(mode_index)) {
+        // Z[l] = g(Z[l]) then A[l] = bf16(Z[l])
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(Z_[mode_index][worker]), activation_func_, Z_[mode_index][worker],
+                                                                     {vi32_1, vi32_2}, false));
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixNarrowBf16(Z_[mode_index][worker], A_[mode_index][worker],
+                                                                     {vi32_1, vi32_2}));
       } else {
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(Z_[mode_index]), activation_func_, A_[mode_index],
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(Z_[mode_index][worker]), activation_func_, A_[mode_index][worker],
                                                                      {vi32_1, vi32_2}, false));
       }
       END_TIME(B)
@@ -108,50 +212,65 @@ wabt::ExprList* FullyConnectedLayer::Forward(uint8_t mode_index, Var input_begin
   // Only apply for training forward algorithm
   // Skip dropout for output
   if(Position() != Output && keep_prob_ != KEEP_PROB_MAX && mode_index == Model::Mode::Training) {
-    assert(LayerIndex() < NetworkModel()->Layers().size() - 1);
-
-    // Generate a mask matrix
-    Merge(e, MakeCall(NetworkModel()->Builtins().math.MaskMatrix(), {
-        MakeI32Const(inverted_dropout_->Memory()->Begin()),
-        MakeI32Const(inverted_dropout_->Memory()->End()),
-        MakeF32Const(keep_prob_)
-    }));
-
-    // A[l] = (1/keep_prob) * (A[l] * inverted_dropout[l])
-    // 1) A[l] = A[l] * inverted_dropout[l]
-    // 2) A[l] = A[l] * (1/keep_prob)
-    Merge(e, NetworkModel()->Snippets().matrix->MatrixMultiplication(A_[mode_index], inverted_dropout_, A_[mode_index],
-                                                                             {vi32_1, vi32_2}));
-    auto scalar = MakeBinary(Opcode::F32Div, MakeF32Const(1.0f), MakeF32Const(keep_prob_));
-    Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(A_[mode_index], scalar, A_[mode_index], {vi32_1, vi32_2, vf32_1}));
+    Merge(e, Dropout(worker, {vi32_1, vi32_2, vf32_1}));
   }
   return e;
 }
 
-wabt::ExprList* DenseOutputLayer::ComputeCost(uint8_t mode_index, wabt::Var target_begin) {
+wabt::ExprList* FullyConnectedLayer::Dropout(uint32_t worker, std::vector<Var> locals) {
+  assert(LayerIndex() < NetworkModel()->Layers().size() - 1);
+  assert(locals.size() == 3);
+  auto vi32_1 = locals[0];
+  auto vi32_2 = locals[1];
+  auto vf32_1 = locals[2];
+
+  const uint8_t mode_index = Model::Mode::Training;
+  ExprList* e = new ExprList();
+
+  // Generate a mask matrix
+  Merge(e, MakeCall(NetworkModel()->Builtins().math.MaskMatrix(), {
+      MakeI32Const(inverted_dropout_[worker]->Memory()->Begin()),
+      MakeI32Const(inverted_dropout_[worker]->Memory()->End()),
+      MakeF32Const(keep_prob_)
+  }));
+
+  // A[l] = (1/keep_prob) * (A[l] * inverted_dropout[l])
+  // 1) A[l] = A[l] * inverted_dropout[l]
+  // 2) A[l] = A[l] * (1/keep_prob)
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixMultiplication(A_[mode_index][worker], inverted_dropout_[worker], A_[mode_index][worker],
+                                                                           {vi32_1, vi32_2}));
+  auto scalar = MakeBinary(Opcode::F32Div, MakeF32Const(1.0f), MakeF32Const(keep_prob_));
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(A_[mode_index][worker], scalar, A_[mode_index][worker], {vi32_1, vi32_2, vf32_1}));
+  return e;
+}
+
+wabt::ExprList* DenseOutputLayer::ComputeCost(uint8_t mode_index, uint32_t worker, wabt::Var target_begin) {
   assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Testing);
+  assert(worker < A_[mode_index].size());
   return MakeCall(NetworkModel()->Loss().J, {
       MakeLocalGet(target_begin),
-      MakeI32Const(A_[mode_index]->Begin()),
-      MakeI32Const(A_[mode_index]->Shape()[0]),
-      MakeI32Const(A_[mode_index]->Shape()[1])
+      MakeI32Const(A_[mode_index][worker]->Begin()),
+      MakeI32Const(A_[mode_index][worker]->Shape()[0]),
+      MakeI32Const(A_[mode_index][worker]->Shape()[1])
   });
 }
 
 wabt::ExprList* FullyConnectedLayer::ComputeL1Cost(uint8_t mode_index, std::vector<Var> locals) {
   assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Testing);
 
-  assert(locals.size() == 3);
+  assert(locals.size() >= 3);
   auto vi32_1 = locals[0];
-  auto v128_1 = locals[1];
-  auto result = locals[2];
+  auto result = locals[1];
+  // Remaining locals are reduction accumulators
+  std::vector<Var> abs_sum_locals = {vi32_1};
+  abs_sum_locals.insert(abs_sum_locals.end(), locals.begin() + 2, locals.end());
 
   // Compute l1_loss
   // (l1_decay/2m) SUM(ABS(W[l]))
   // 1) local = SUM(ABS(W[l]))
   // 2) local = (l1_decay/2m) local
   ExprList* e = new ExprList();
-  Merge(e, NetworkModel()->Snippets().matrix->MatrixAbsSum(W_, result, {vi32_1, v128_1}));
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixAbsSum(W_, result, abs_sum_locals));
   Merge(e, GenerateCompoundAssignment(result, Opcode::F32Mul, MakeF32Const(NetworkModel()->L1Regularizer() /
                                                                            (2 * NetworkModel()->BatchSzie(mode_index)))));
   Merge(e, MakeLocalGet(result));
@@ -161,18 +280,20 @@ wabt::ExprList* FullyConnectedLayer::ComputeL1Cost(uint8_t mode_index, std::vect
 wabt::ExprList* FullyConnectedLayer::ComputeL2Cost(uint8_t mode_index, std::vector<Var> locals) {
   assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Testing);
 
-  assert(locals.size() == 4);
+  assert(locals.size() >= 4);
   auto vi32_1 = locals[0];
   auto vf32_1 = locals[1];
-  auto v128_1 = locals[2];
-  auto result = locals[3];
+  auto result = locals[2];
+  // Remaining locals are reduction accumulators
+  std::vector<Var> square_sum_locals = {vi32_1, vf32_1};
+  square_sum_locals.insert(square_sum_locals.end(), locals.begin() + 3, locals.end());
 
   // Compute l2 loss
   // (l2_decay/2m) SUM(W[l] * W[l])
   // 1) local = SUM(W[l] * W[l])
   // 2) local = (l2_decay/2m) local
   ExprList* e = new ExprList();
-  Merge(e, NetworkModel()->Snippets().matrix->MatrixSquareSum(W_, result, {vi32_1, vf32_1, v128_1}));
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixSquareSum(W_, result, square_sum_locals));
   Merge(e, GenerateCompoundAssignment(result, Opcode::F32Mul, MakeF32Const(NetworkModel()->L2Regularizer() /
                                                                            (2 * NetworkModel()->BatchSzie(mode_index)))));
   Merge(e, MakeLocalGet(result));
@@ -197,9 +318,22 @@ wabt::ExprList* FullyConnectedLayer::ComputeL2Cost(uint8_t mode_index, std::vect
                        NetworkModel()->DenseBackwardTime().Get##name())));                          \
   }
 
-wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var target_begin,
+wabt::ExprList* FullyConnectedLayer::Backward(uint32_t worker, wabt::Var input_begin, wabt::Var target_begin,
                                               std::vector<wabt::Var> locals) {
-  assert(locals.size() == 7);
+  return BackwardAlgorithm(worker, input_begin, target_begin, false, Var(), locals);
+}
+
+wabt::ExprList* FullyConnectedLayer::BackwardColumns(wabt::Var input_begin, wabt::Var target_begin,
+                                                     wabt::Var cols_bytes, std::vector<wabt::Var> locals) {
+  return BackwardAlgorithm(0, input_begin, target_begin, true, cols_bytes, locals);
+}
+
+wabt::ExprList* FullyConnectedLayer::BackwardAlgorithm(uint32_t worker, wabt::Var input_begin, wabt::Var target_begin,
+                                                       bool columns, wabt::Var cols_bytes,
+                                                       std::vector<wabt::Var> locals) {
+  assert(worker < NetworkModel()->TrainingWorkers());
+  assert(!columns || (worker == 0 && NetworkModel()->GradientAccumulationSteps() == 1));
+  assert(locals.size() >= 7);
   auto vi32_1 = locals[0];
   auto vi32_2 = locals[1];
   auto vi32_3 = locals[2];
@@ -207,6 +341,8 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
   auto vi32_5 = locals[4];
   auto vf32_1 = locals[5];
   auto v128_1 = locals[6];
+  // Remaining locals are reduction accumulators
+  std::vector<Var> v128_accumulators(locals.begin() + 6, locals.end());
 
   ExprList* e = new ExprList();
   if(Position() != Input) {
@@ -219,10 +355,10 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
       START_TIME()
       Merge(e, MakeCall(NetworkModel()->Loss().dJ, {
           MakeLocalGet(target_begin),
-          MakeI32Const(A_[Model::Mode::Training]->Begin()),
-          MakeI32Const(dA_->Begin()),
-          MakeI32Const(A_[Model::Mode::Training]->Shape()[0]),
-          MakeI32Const(A_[Model::Mode::Training]->Shape()[1])
+          MakeI32Const(A_[Model::Mode::Training][worker]->Begin()),
+          MakeI32Const(dA_[worker]->Begin()),
+          MakeI32Const(A_[Model::Mode::Training][worker]->Shape()[0]),
+          MakeI32Const(A_[Model::Mode::Training][worker]->Shape()[1])
       }));
       END_TIME(A)
     }
@@ -237,10 +373,10 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
         START_TIME()
         Merge(e, MakeCall(NetworkModel()->Loss().dJ, {
             MakeLocalGet(target_begin),
-            MakeI32Const(A_[Model::Mode::Training]->Begin()),
-            MakeI32Const(dZ_->Begin()),
-            MakeI32Const(A_[Model::Mode::Training]->Shape()[0]),
-            MakeI32Const(A_[Model::Mode::Training]->Shape()[1])
+            MakeI32Const(A_[Model::Mode::Training][worker]->Begin()),
+            MakeI32Const(dZ_[worker]->Begin()),
+            MakeI32Const(A_[Model::Mode::Training][worker]->Shape()[0]),
+            MakeI32Const(A_[Model::Mode::Training][worker]->Shape()[1])
         }));
         END_TIME(B)
       } else {
@@ -248,14 +384,39 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
         //    1) dZ[l] = g'(Z[l])
         //    2) dZ[l] = dA[l] * dZ[l]
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(Z_[Model::Mode::Training]),
-                                                                     activation_func_, dZ_, {vi32_1, vi32_2}, true));
+        if(DerivativeFromOutput()) {
+          // g'(Z[l]) is computed from A[l] = g(Z[l])
+          Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(A_[Model::Mode::Training][worker]),
+                                                                       activation_func_, dZ_[worker], {vi32_1, vi32_2}, true, true));
+        } else {
+          Merge(e, NetworkModel()->Snippets().matrix->MatrixActivation(snippet::RelocMat(Z_[Model::Mode::Training][worker]),
+                                                                       activation_func_, dZ_[worker], {vi32_1, vi32_2}, true));
+        }
         END_TIME(C_1)
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixMultiplication(dA_, dZ_, dZ_, {vi32_1, vi32_2}));
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixMultiplication(dA_[worker], dZ_[worker], dZ_[worker], {vi32_1, vi32_2}));
         END_TIME(C_2)
       }
 
+      // With gradient accumulation, the gradients of each
+      // micro-batch are computed apart and added to dW[l] and
+      // db[l], which are scaled and regularized for the batch
+      // of all micro-batches, i.e. m = K * micro-batch size
+      uint32_t steps = NetworkModel()->GradientAccumulationSteps();
+      auto dW = steps > 1 ? micro_dW_ : dW_[worker];
+      auto db = steps > 1 ? micro_db_ : db_[worker];
+      uint32_t batch_size = NetworkModel()->TrainingBatchSize() * steps;
+      float l1_regularizer = NetworkModel()->L1Regularizer() / steps;
+      float l2_regularizer = NetworkModel()->L2Regularizer() / steps;
+      // On the first columns, m is the number of columns
+      auto inverse_batch_size = [&]() -> ExprList* {
+        if(columns) {
+          auto cols = MakeBinary(Opcode::I32ShrU, MakeLocalGet(cols_bytes), MakeI32Const(TypeShiftLeft(Type::F32)));
+          return MakeBinary(Opcode::F32Div, MakeF32Const(1.0f), MakeUnary(Opcode::F32ConvertI32U, cols));
+        }
+        return MakeF32Const(1.0f / batch_size);
+      };
+
       // D) dW[l] = (1/m) dZ[l] . A[l-1]^T + (l2_decay/m) W[l] + (l1_decay/m) sign(W[l])
       //          = (1/m) (dZ[l] . A[l-1]^T + l2_decay W[l]) + l1_decay sign(W[l]))
       //    1) dW[l] = dZ[l] . A[l-1]^T
@@ -266,45 +427,54 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
       START_TIME()
 #ifdef WABT_EXPERIMENTAL
       Merge(e, MakeNativeCall(NetworkModel()->Natives().dot_product_rt, {
-          MakeI32Const(dZ_->Begin()),
-          (LayerIndex() == 1) ? MakeLocalGet(input_begin) : MakeI32Const(prev_fc_layer->A_[Model::Mode::Training]->Begin()),
-          MakeI32Const(dW_->Begin()),
-          MakeI32Const(dZ_->Shape()[0]),
-          MakeI32Const(dZ_->Shape()[1]),
-          MakeI32Const(prev_fc_layer->A_[Model::Mode::Training]->Shape()[0])
+          MakeI32Const(dZ_[worker]->Begin()),
+          (LayerIndex() == 1) ? MakeLocalGet(input_begin) : MakeI32Const(prev_fc_layer->A_[Model::Mode::Training][worker]->Begin()),
+          MakeI32Const(dW->Begin()),
+          MakeI32Const(dZ_[worker]->Shape()[0]),
+          MakeI32Const(dZ_[worker]->Shape()[1]),
+          MakeI32Const(prev_fc_layer->A_[Model::Mode::Training][worker]->Shape()[0])
       }));
 #else
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixDotRT(dZ_, (LayerIndex() == 1) ?
-                                                                   snippet::RelocMat(prev_fc_layer->A_[Model::Mode::Training],
-                                                                                     input_begin) :
-                                                                   snippet::RelocMat(prev_fc_layer->A_[Model::Mode::Training]), dW_,
-                                                              {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+      auto prev_A = (LayerIndex() == 1) ? snippet::RelocMat(prev_fc_layer->A_[Model::Mode::Training][worker], input_begin) :
+                                          snippet::RelocMat(prev_fc_layer->A_[Model::Mode::Training][worker]);
+      if(columns) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotRTColumns(dZ_[worker], prev_A, dW, cols_bytes,
+                                                                       {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1,
+                                                                        v128_1}));
+      } else if(ParallelDot(Model::Mode::Training)) {
+        Merge(e, NetworkModel()->Snippets().parallel->MatrixDotRT(dZ_[worker], prev_A, dW, {vi32_1, vi32_2}));
+      } else if(NetworkModel()->Options().bytecode_options.use_kernel_functions) {
+        Merge(e, NetworkModel()->Snippets().kernels->MatrixDotRT(dZ_[worker], prev_A, dW));
+      } else {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotRT(dZ_[worker], prev_A, dW,
+                                                                {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+      }
 #endif
       END_TIME(D_1)
       if(NetworkModel()->L1Regularizer() > 0 && NetworkModel()->L2Regularizer() > 0) {
         START_TIME()
         Merge(e, NetworkModel()->Snippets().matrix
-            ->MatrixAddRightSignScaleAddRightScale(dW_, W_, dW_, NetworkModel()->L1Regularizer(),
-                                                   NetworkModel()->L2Regularizer(), {vi32_1, vi32_2, vf32_1, v128_1}));
+            ->MatrixAddRightSignScaleAddRightScale(dW, W_, dW, l1_regularizer, l2_regularizer,
+                                                   {vi32_1, vi32_2, vf32_1, v128_1}));
         END_TIME(D_2_1)
       }
       if(NetworkModel()->L1Regularizer() > 0 && NetworkModel()->L2Regularizer() == 0) {
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddRightSignScale(dW_, W_, dW_, NetworkModel()->L1Regularizer(),
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddRightSignScale(dW, W_, dW, l1_regularizer,
                                                                         {vi32_1, vi32_2}));
         END_TIME(D_2_2_1)
       }
       if(NetworkModel()->L2Regularizer() > 0 && NetworkModel()->L1Regularizer() == 0) {
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddRightScale(dW_, W_, dW_,
-                                                                        MakeF32Const(NetworkModel()->L2Regularizer()),
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddRightScale(dW, W_, dW,
+                                                                        MakeF32Const(l2_regularizer),
                                                                         {vi32_1, vi32_2, vf32_1}));
         END_TIME(D_2_2_2)
       }
-      if(NetworkModel()->TrainingBatchSize() > 1) {
+      if(columns || batch_size > 1) {
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(dW_, MakeF32Const(1.0f / NetworkModel()->TrainingBatchSize()),
-                                                                 dW_, {vi32_1, vi32_2, vf32_1}));
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(dW, inverse_batch_size(),
+                                                                 dW, {vi32_1, vi32_2, vf32_1}));
         END_TIME(D_3)
       }
 
@@ -312,46 +482,78 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
       //    1) db[l] = SUM(dZ[l], row wise)
       //    2) db[l] = (1/m) db[l]
       START_TIME()
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixHorizontalSum(dZ_, db_,
-                                                                      {vi32_1, vi32_2, vi32_3, vf32_1, v128_1}));
+      std::vector<Var> horizontal_sum_locals = {vi32_1, vi32_2, vi32_3, vf32_1};
+      horizontal_sum_locals.insert(horizontal_sum_locals.end(), v128_accumulators.begin(), v128_accumulators.end());
+      if(columns) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixHorizontalSumColumns(dZ_[worker], db, cols_bytes,
+                                                                               {vi32_1, vi32_2, vi32_3, vf32_1,
+                                                                                v128_1}));
+      } else {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixHorizontalSum(dZ_[worker], db, horizontal_sum_locals));
+      }
       END_TIME(E_1)
-      if(NetworkModel()->TrainingBatchSize() > 1) {
+      if(columns || batch_size > 1) {
         START_TIME()
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(db_, MakeF32Const(1.0f/NetworkModel()->TrainingBatchSize()),
-                                                                 db_, {vi32_1, vi32_2, vf32_1}));
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixScalar(db, inverse_batch_size(),
+                                                                 db, {vi32_1, vi32_2, vf32_1}));
         END_TIME(E_2)
       }
 
+      if(steps > 1) {
+        // dW[l] = dW[l] + dW_micro[l]
+        // db[l] = db[l] + db_micro[l]
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddition(dW_[worker], dW, dW_[worker], {vi32_1, vi32_2}));
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddition(db_[worker], db, db_[worker], {vi32_1, vi32_2}));
+      }
+
       if(LayerIndex() > 1) {
         // F) dA[l-1] = W[l]^T . dZ[l]
         START_TIME()
 #ifdef WABT_EXPERIMENTAL
         Merge(e, MakeNativeCall(NetworkModel()->Natives().dot_product_lt, {
             MakeI32Const(W_->Begin()),
-            MakeI32Const(dZ_->Begin()),
-            MakeI32Const(prev_fc_layer->dA_->Begin()),
+            MakeI32Const(dZ_[worker]->Begin()),
+            MakeI32Const(prev_fc_layer->dA_[worker]->Begin()),
             MakeI32Const(W_->Shape()[1]),
             MakeI32Const(W_->Shape()[0]),
-            MakeI32Const(dZ_->Shape()[1])
+            MakeI32Const(dZ_[worker]->Shape()[1])
         }));
 #else
-        Merge(e, NetworkModel()->Snippets().matrix->MatrixDotLT(W_, dZ_, prev_fc_layer->dA_,
-                                                                {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+        if(columns) {
+          Merge(e, NetworkModel()->Snippets().matrix->MatrixDotLTColumns(W_, dZ_[worker], prev_fc_layer->dA_[worker],
+                                                                         cols_bytes, {vi32_1, vi32_2, vi32_3, vi32_4,
+                                                                                      vi32_5, vf32_1, v128_1}));
+        } else if(ParallelDot(Model::Mode::Training)) {
+          Merge(e, NetworkModel()->Snippets().parallel->MatrixDotLT(W_, dZ_[worker], prev_fc_layer->dA_[worker],
+                                                                    {vi32_1, vi32_2}));
+        } else if(NetworkModel()->Options().bytecode_options.use_kernel_functions) {
+          Merge(e, NetworkModel()->Snippets().kernels->MatrixDotLT(W_, dZ_[worker], prev_fc_layer->dA_[worker]));
+        } else {
+          Merge(e, NetworkModel()->Snippets().matrix->MatrixDotLT(W_, dZ_[worker], prev_fc_layer->dA_[worker],
+                                                                  {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+        }
 #endif
         END_TIME(F)
       }
 
-      // G) W[l] = W[l] - alpha * dW[l]
-      START_TIME()
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixSubRightScale(W_, dW_, W_, NetworkModel()->GetLearningRate(),
-                                                                      {vi32_1, vi32_2, vf32_1}));
-      END_TIME(G)
+      // With several training workers, the weights are
+      // updated after all workers computed their gradients,
+      // and the other optimizers update them with their states
+      if(!NetworkModel()->DeferredWeightsUpdate()) {
+        // G) W[l] = W[l] - alpha * dW[l]
+        START_TIME()
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixSubRightScale(W_, dW_[worker], W_,
+                                                                        NetworkModel()->GetLearningRate(),
+                                                                        {vi32_1, vi32_2, vf32_1}));
+        END_TIME(G)
 
-      // H) b[l] = b[l] - alpha * db[l]
-      START_TIME()
-      Merge(e, NetworkModel()->Snippets().matrix->MatrixSubRightScale(b_, db_, b_, NetworkModel()->GetLearningRate(),
-                                                               {vi32_1, vi32_2, vf32_1}));
-      END_TIME(H)
+        // H) b[l] = b[l] - alpha * db[l]
+        START_TIME()
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixSubRightScale(b_, db_[worker], b_,
+                                                                        NetworkModel()->GetLearningRate(),
+                                                                        {vi32_1, vi32_2, vf32_1}));
+        END_TIME(H)
+      }
     } else {
       assert(!"Not implemented!");
     }
@@ -363,39 +565,280 @@ wabt::ExprList* FullyConnectedLayer::Backward(wabt::Var input_begin, wabt::Var t
   return e;
 }
 
+namespace {
+
+// View of the part of an array updated by a worker. Parts
+// are multiples of four entries to keep the SIMD loops
+// on whole vectors, so the last workers may have no part
+ds::NDArray* WorkerPart(ds::NDArray* array, uint32_t worker, uint32_t workers) {
+  const uint32_t unit_size = TypeSize(Type::F32);
+  const uint32_t vector_entries = WASMPP_V128_SIZE / unit_size;
+  uint32_t entries = array->Shape()[0] * array->Shape()[1];
+  uint32_t part_entries = (entries + workers - 1) / workers;
+  part_entries = ((part_entries + vector_entries - 1) / vector_entries) * vector_entries;
+  uint32_t begin = std::min(entries, worker * part_entries);
+  uint32_t end = std::min(entries, begin + part_entries);
+  if(begin == end) {
+    return nullptr;
+  }
+  return new ds::NDArray(new wasmpp::Memory(array->Begin() + begin * unit_size, array->Begin() + end * unit_size),
+                         {1, end - begin}, unit_size);
+}
+
+} // namespace
+
+wabt::ExprList* FullyConnectedLayer::UpdateWeights(uint32_t worker, uint32_t workers, std::vector<wabt::Var> locals) {
+  assert(worker < workers && workers <= NetworkModel()->TrainingWorkers());
+  assert(locals.size() >= 3);
+  auto vi32_1 = locals[0];
+  auto vi32_2 = locals[1];
+  auto vf32_1 = locals[2];
+
+  ExprList* e = new ExprList();
+  if(Position() != Input && NetworkModel()->Optimizer() != SGD) {
+    // W[l] and b[l] are updated from dW[l] and db[l] and
+    // their optimizer states (a single worker is training)
+    assert(workers == 1);
+    Merge(e, NetworkModel()->Snippets().matrix->MatrixOptimizerUpdate(NetworkModel()->Options().optimizer_options,
+                                                                      W_, dW_[0], W_states_,
+                                                                      NetworkModel()->GetOptimizerRate(), locals));
+    Merge(e, NetworkModel()->Snippets().matrix->MatrixOptimizerUpdate(NetworkModel()->Options().optimizer_options,
+                                                                      b_, db_[0], b_states_,
+                                                                      NetworkModel()->GetOptimizerRate(), locals));
+  } else if(Position() != Input) {
+    // 1) dW_1[l] = dW_1[l] + ... + dW_n[l]
+    // 2) W[l] = W[l] - (alpha / n) * dW_1[l]
+    // (each worker updates a different part of W[l] and b[l])
+    auto update = [&](ds::NDArray* array, std::vector<ds::NDArray*>& gradients) {
+      auto part = WorkerPart(array, worker, workers);
+      if(part == nullptr) {
+        return;
+      }
+      auto gradient = WorkerPart(gradients[0], worker, workers);
+      for(uint32_t w = 1; w < workers; w++) {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixAddition(gradient, WorkerPart(gradients[w], worker, workers),
+                                                                   gradient, {vi32_1, vi32_2}));
+      }
+      auto rate = NetworkModel()->GetLearningRate();
+      if(workers > 1) {
+        rate = MakeBinary(Opcode::F32Mul, rate, MakeF32Const(1.0f / workers));
+      }
+      Merge(e, NetworkModel()->Snippets().matrix->MatrixSubRightScale(part, gradient, part, rate,
+                                                                      {vi32_1, vi32_2, vf32_1}));
+    };
+    update(W_, dW_);
+    update(b_, db_);
+  }
+
+  // Accumulate the next micro-batches from zero
+  if(Position() != Input && NetworkModel()->GradientAccumulationSteps() > 1) {
+    assert(workers == 1);
+    Merge(e, MakeMemoryFill(MakeI32Const(dW_[0]->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(dW_[0]->Memory()->Bytes())));
+    Merge(e, MakeMemoryFill(MakeI32Const(db_[0]->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(db_[0]->Memory()->Bytes())));
+  }
+
+  // Place a nop because an expression list
+  // cannot be empty
+  if(e->empty()) {
+    Merge(e, MakeNop());
+  }
+  return e;
+}
+
+wabt::ExprList* FullyConnectedLayer::QuantizeWeights(std::vector<Var> locals) {
+  ERROR_UNLESS(NetworkModel()->Int8PredictionWeights(), "Prediction weights are not int8");
+  ExprList* e = new ExprList();
+  if(Position() == Input) {
+    return e;
+  }
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixQuantizeRows(W_, W_int8_, W_scales_, locals));
+  return e;
+}
+
+wabt::ExprList* FullyConnectedLayer::PruneWeights(std::vector<Var> locals) {
+  ExprList* e = new ExprList();
+  if(!Sparse()) {
+    return e;
+  }
+  Merge(e, NetworkModel()->Snippets().matrix->MatrixPruneBlocks(W_, W_sparse_, W_block_norms_, locals));
+  return e;
+}
+
 #define ALLOCATE_MEMORY(array, rows, cols)                                                            \
   array = new ds::NDArray(                                                                            \
       NetworkModel()->ModuleManager().Memory().Allocate((rows) * (cols) * TypeSize(Type::F32)), \
       {rows, cols}, TypeSize(Type::F32));
 
+#define ALLOCATE_BF16_MEMORY(array, rows, cols)                                                       \
+  array = new ds::NDArray(                                                                            \
+      NetworkModel()->ModuleManager().Memory().Allocate((rows) * (cols) * snippet::BF16_SIZE),  \
+      {rows, cols}, snippet::BF16_SIZE);
+
 void FullyConnectedLayer::AllocateMemory() {
-  ALLOCATE_MEMORY(A_[Model::Model::Training], Nodes(), NetworkModel()->TrainingBatchSize());
-  ALLOCATE_MEMORY(A_[Model::Model::Testing], Nodes(), NetworkModel()->TestingBatchSize());
-  ALLOCATE_MEMORY(A_[Model::Model::Prediction], Nodes(), NetworkModel()->PredictionBatchSize());
+  // Training arrays are allocated for each worker, and
+  // only the prediction arrays are used for inference
+  bool training = !NetworkModel()->InferenceOnly();
+  uint32_t workers = training ? NetworkModel()->TrainingWorkers() : 0;
+  A_[Model::Mode::Training].resize(workers);
+  A_[Model::Mode::Testing].resize(training ? 1 : 0);
+  A_[Model::Mode::Prediction].resize(1);
+  for(uint32_t worker = 0; worker < workers; worker++) {
+    ALLOCATE_MEMORY(A_[Model::Model::Training][worker], Nodes(), NetworkModel()->TrainingBatchSize());
+  }
+  if(training) {
+    if(Bf16Activations(Model::Mode::Testing)) {
+      ALLOCATE_BF16_MEMORY(A_[Model::Model::Testing][0], Nodes(), NetworkModel()->TestingBatchSize());
+    } else {
+      ALLOCATE_MEMORY(A_[Model::Model::Testing][0], Nodes(), NetworkModel()->TestingBatchSize());
+    }
+  }
+  if(Bf16Activations(Model::Mode::Prediction)) {
+    ALLOCATE_BF16_MEMORY(A_[Model::Model::Prediction][0], Nodes(), NetworkModel()->PredictionBatchSize());
+  } else {
+    ALLOCATE_MEMORY(A_[Model::Model::Prediction][0], Nodes(), NetworkModel()->PredictionBatchSize());
+  }
   if(Position()!= Input) {
     assert(LayerIndex() > 0);
-    ALLOCATE_MEMORY(Z_[Model::Mode::Training], Nodes(), NetworkModel()->TrainingBatchSize());
-    ALLOCATE_MEMORY(Z_[Model::Mode::Testing], Nodes(), NetworkModel()->TestingBatchSize());
-    ALLOCATE_MEMORY(Z_[Model::Mode::Prediction], Nodes(), NetworkModel()->PredictionBatchSize());
-    ALLOCATE_MEMORY(dZ_, Nodes(), NetworkModel()->TrainingBatchSize());
-    ALLOCATE_MEMORY(dA_, Nodes(), NetworkModel()->TrainingBatchSize());
+    Z_[Model::Mode::Training].resize(workers);
+    Z_[Model::Mode::Testing].resize(training ? 1 : 0);
+    Z_[Model::Mode::Prediction].resize(1);
+    dZ_.resize(workers);
+    dA_.resize(workers);
+    db_.resize(workers);
+    dW_.resize(workers);
+    for(uint32_t worker = 0; worker < workers; worker++) {
+      ALLOCATE_MEMORY(Z_[Model::Mode::Training][worker], Nodes(), NetworkModel()->TrainingBatchSize());
+    }
+    if(training) {
+      ALLOCATE_MEMORY(Z_[Model::Mode::Testing][0], Nodes(), NetworkModel()->TestingBatchSize());
+    }
+    ALLOCATE_MEMORY(Z_[Model::Mode::Prediction][0], Nodes(), NetworkModel()->PredictionBatchSize());
+    for(uint32_t worker = 0; worker < workers; worker++) {
+      ALLOCATE_MEMORY(dZ_[worker], Nodes(), NetworkModel()->TrainingBatchSize());
+      ALLOCATE_MEMORY(dA_[worker], Nodes(), NetworkModel()->TrainingBatchSize());
+    }
     ALLOCATE_MEMORY(b_, Nodes(), 1);
-    ALLOCATE_MEMORY(db_, Nodes(), 1);
+    for(uint32_t worker = 0; worker < workers; worker++) {
+      ALLOCATE_MEMORY(db_[worker], Nodes(), 1);
+    }
+    bool accumulate = training && NetworkModel()->GradientAccumulationSteps() > 1;
+    if(accumulate) {
+      ALLOCATE_MEMORY(micro_db_, Nodes(), 1);
+    }
+    // Optimizer states start at zero
+    uint32_t states = training ? OptimizerStates(NetworkModel()->Optimizer()) : 0;
+    b_states_.resize(states);
+    for(uint32_t state = 0; state < states; state++) {
+      ALLOCATE_MEMORY(b_states_[state], Nodes(), 1);
+    }
 
     auto prev_layer = NetworkModel()->Layers()[LayerIndex() - 1];
     if(prev_layer->Type() == FullyConnected) {
       uint32_t prev_nodes = static_cast<FullyConnectedLayer*>(prev_layer)->Nodes();
       ALLOCATE_MEMORY(W_, Nodes(), prev_nodes);
-      ALLOCATE_MEMORY(dW_, Nodes(), prev_nodes);
+      if(Int8Weights(Model::Mode::Prediction)) {
+        W_int8_ = new ds::NDArray(
+            NetworkModel()->ModuleManager().Memory().Allocate(Nodes() * prev_nodes * snippet::INT8_SIZE),
+            {Nodes(), prev_nodes}, snippet::INT8_SIZE);
+        ALLOCATE_MEMORY(W_scales_, Nodes(), 1);
+      }
+      if(SparseWeights(Model::Mode::Prediction)) {
+        uint32_t blocks = ds::BlockSparseNDArray::KeptBlocks(prev_nodes, sparsity_);
+        ds::NDArray* values;
+        ALLOCATE_MEMORY(values, Nodes(), blocks * ds::SPARSE_BLOCK_WIDTH);
+        auto columns = new ds::NDArray(
+            NetworkModel()->ModuleManager().Memory().Allocate(Nodes() * blocks * TypeSize(Type::I32)),
+            {Nodes(), blocks}, TypeSize(Type::I32));
+        W_sparse_ = new ds::BlockSparseNDArray(values, columns, prev_nodes);
+        ALLOCATE_MEMORY(W_block_norms_, prev_nodes / ds::SPARSE_BLOCK_WIDTH, 1);
+      }
+      for(uint32_t worker = 0; worker < workers; worker++) {
+        ALLOCATE_MEMORY(dW_[worker], Nodes(), prev_nodes);
+      }
+      if(accumulate) {
+        ALLOCATE_MEMORY(micro_dW_, Nodes(), prev_nodes);
+      }
+      W_states_.resize(states);
+      for(uint32_t state = 0; state < states; state++) {
+        ALLOCATE_MEMORY(W_states_[state], Nodes(), prev_nodes);
+      }
     } else {
       assert(!"Not implemented!");
     }
   }
   if(Position() != Output) {
-    ALLOCATE_MEMORY(inverted_dropout_, Nodes(), NetworkModel()->TrainingBatchSize());
+    inverted_dropout_.resize(workers);
+    for(uint32_t worker = 0; worker < workers; worker++) {
+      ALLOCATE_MEMORY(inverted_dropout_[worker], Nodes(), NetworkModel()->TrainingBatchSize());
+    }
+  }
+}
+
+namespace {
+
+// Quantize the rows of a matrix to int8 as MatrixQuantizeRows does
+void QuantizeRows(const std::vector<DataEntry>& entries, uint32_t rows, uint32_t cols,
+                  std::vector<DataEntry>* quantized, std::vector<DataEntry>* scales) {
+  assert(entries.size() == rows * cols);
+  const float int8_max = 127;
+  for(uint32_t row = 0; row < rows; row++) {
+    float max = 0;
+    for(uint32_t col = 0; col < cols; col++) {
+      max = std::max(max, std::fabs(entries[row * cols + col].val.f32));
+    }
+    scales->push_back(DataEntry::MakeF32(max / int8_max));
+    // A row of zeros is quantized to zeros
+    float inv_scale = max > 0 ? int8_max / max : 0;
+    for(uint32_t col = 0; col < cols; col++) {
+      float value = std::nearbyint(entries[row * cols + col].val.f32 * inv_scale);
+      // NaN is quantized to zero as by the saturating conversion
+      quantized->push_back(DataEntry::MakeByte((uint8_t) (int8_t) (std::isnan(value) ? 0 : value)));
+    }
+  }
+}
+
+// Prune the rows of a matrix by blocks as MatrixPruneBlocks does
+void PruneBlocks(const std::vector<DataEntry>& entries, uint32_t rows, uint32_t cols, uint32_t kept_blocks,
+                 std::vector<DataEntry>* values, std::vector<DataEntry>* columns) {
+  assert(entries.size() == rows * cols);
+  uint32_t blocks = cols / ds::SPARSE_BLOCK_WIDTH;
+  for(uint32_t row = 0; row < rows; row++) {
+    std::vector<float> norms(blocks, 0);
+    for(uint32_t block = 0; block < blocks; block++) {
+      for(uint32_t lane = 0; lane < ds::SPARSE_BLOCK_WIDTH; lane++) {
+        norms[block] += std::fabs(entries[row * cols + block * ds::SPARSE_BLOCK_WIDTH + lane].val.f32);
+      }
+    }
+    // Keep the largest norms, the first ones on ties
+    // and a NaN norm being the lowest
+    for(auto& norm : norms) {
+      norm = std::isnan(norm) ? -1 : norm;
+    }
+    std::vector<bool> keep(blocks, false);
+    for(uint32_t k = 0; k < kept_blocks; k++) {
+      int32_t best = -1;
+      for(uint32_t block = 0; block < blocks; block++) {
+        if(!keep[block] && (best < 0 || norms[block] > norms[best])) {
+          best = block;
+        }
+      }
+      keep[best] = true;
+    }
+    for(uint32_t block = 0; block < blocks; block++) {
+      if(keep[block]) {
+        for(uint32_t lane = 0; lane < ds::SPARSE_BLOCK_WIDTH; lane++) {
+          values->push_back(entries[row * cols + block * ds::SPARSE_BLOCK_WIDTH + lane]);
+        }
+        columns->push_back(DataEntry::MakeI32(block * ds::SPARSE_BLOCK_WIDTH));
+      }
+    }
   }
 }
 
+} // namespace
+
 void FullyConnectedLayer::MakeData(wabt::Var memory) {
   // Input layer has no data to initialize
   if(Position() == Input) {
@@ -472,8 +915,117 @@ void FullyConnectedLayer::MakeData(wabt::Var memory) {
     default:
       assert(!"Weight distribution not implemented");
   }
-  NetworkModel()->ModuleManager().MakeData(memory, W_->Memory()->Begin(), weight_entries);
-  NetworkModel()->ModuleManager().MakeData(memory, b_->Memory()->Begin(), bias_entries);
+  if(NetworkModel()->Options().bytecode_options.separate_weights) {
+    NetworkModel()->AddWeightsRegion(W_->Memory(), weight_entries);
+    NetworkModel()->AddWeightsRegion(b_->Memory(), bias_entries);
+  } else if(NetworkModel()->PassiveWeights()) {
+    W_segment_ = NetworkModel()->ModuleManager().MakePassiveData(weight_entries);
+    b_segment_ = NetworkModel()->ModuleManager().MakePassiveData(bias_entries);
+  } else {
+    NetworkModel()->ModuleManager().MakeData(memory, W_->Memory()->Begin(), weight_entries);
+    NetworkModel()->ModuleManager().MakeData(memory, b_->Memory()->Begin(), bias_entries);
+  }
+
+  // The initial int8 W[l] is quantized here, so the
+  // prediction does not depend on a quantize call
+  if(Int8Weights(Model::Mode::Prediction)) {
+    std::vector<DataEntry> int8_entries;
+    std::vector<DataEntry> scale_entries;
+    QuantizeRows(weight_entries, W_->Shape()[0], W_->Shape()[1], &int8_entries, &scale_entries);
+    if(NetworkModel()->Options().bytecode_options.separate_weights) {
+      NetworkModel()->AddWeightsRegion(W_int8_->Memory(), int8_entries);
+      NetworkModel()->AddWeightsRegion(W_scales_->Memory(), scale_entries);
+    } else if(NetworkModel()->PassiveWeights()) {
+      W_int8_segment_ = NetworkModel()->ModuleManager().MakePassiveData(int8_entries);
+      W_scales_segment_ = NetworkModel()->ModuleManager().MakePassiveData(scale_entries);
+    } else {
+      NetworkModel()->ModuleManager().MakeData(memory, W_int8_->Memory()->Begin(), int8_entries);
+      NetworkModel()->ModuleManager().MakeData(memory, W_scales_->Memory()->Begin(), scale_entries);
+    }
+  }
+
+  // The initial block sparse W[l] is pruned here, so
+  // the prediction does not depend on a prune call
+  if(SparseWeights(Model::Mode::Prediction)) {
+    std::vector<DataEntry> value_entries;
+    std::vector<DataEntry> column_entries;
+    PruneBlocks(weight_entries, W_->Shape()[0], W_->Shape()[1], W_sparse_->RowBlocks(), &value_entries,
+                &column_entries);
+    auto values = W_sparse_->Values()->Memory();
+    auto columns = W_sparse_->Columns()->Memory();
+    if(NetworkModel()->Options().bytecode_options.separate_weights) {
+      NetworkModel()->AddWeightsRegion(values, value_entries);
+      NetworkModel()->AddWeightsRegion(columns, column_entries);
+    } else if(NetworkModel()->PassiveWeights()) {
+      W_sparse_values_segment_ = NetworkModel()->ModuleManager().MakePassiveData(value_entries);
+      W_sparse_columns_segment_ = NetworkModel()->ModuleManager().MakePassiveData(column_entries);
+    } else {
+      NetworkModel()->ModuleManager().MakeData(memory, values->Begin(), value_entries);
+      NetworkModel()->ModuleManager().MakeData(memory, columns->Begin(), column_entries);
+    }
+  }
+}
+
+wabt::ExprList* FullyConnectedLayer::InitData() {
+  ExprList* e = new ExprList();
+  if(Position() == Input) {
+    return e;
+  }
+  if(NetworkModel()->PassiveWeights()) {
+    Merge(e, MakeMemoryInit(W_segment_, MakeI32Const(W_->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(W_->Memory()->Bytes())));
+    Merge(e, MakeMemoryInit(b_segment_, MakeI32Const(b_->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(b_->Memory()->Bytes())));
+    if(Int8Weights(Model::Mode::Prediction)) {
+      Merge(e, MakeMemoryInit(W_int8_segment_, MakeI32Const(W_int8_->Memory()->Begin()), MakeI32Const(0),
+                              MakeI32Const(W_int8_->Memory()->Bytes())));
+      Merge(e, MakeMemoryInit(W_scales_segment_, MakeI32Const(W_scales_->Memory()->Begin()), MakeI32Const(0),
+                              MakeI32Const(W_scales_->Memory()->Bytes())));
+    }
+    if(SparseWeights(Model::Mode::Prediction)) {
+      auto values = W_sparse_->Values()->Memory();
+      auto columns = W_sparse_->Columns()->Memory();
+      Merge(e, MakeMemoryInit(W_sparse_values_segment_, MakeI32Const(values->Begin()), MakeI32Const(0),
+                              MakeI32Const(values->Bytes())));
+      Merge(e, MakeMemoryInit(W_sparse_columns_segment_, MakeI32Const(columns->Begin()), MakeI32Const(0),
+                              MakeI32Const(columns->Bytes())));
+    }
+  }
+  // Reset the accumulated gradients and the optimizer states
+  if(micro_dW_ != nullptr) {
+    Merge(e, MakeMemoryFill(MakeI32Const(dW_[0]->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(dW_[0]->Memory()->Bytes())));
+    Merge(e, MakeMemoryFill(MakeI32Const(db_[0]->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(db_[0]->Memory()->Bytes())));
+  }
+  for(auto state : W_states_) {
+    Merge(e, MakeMemoryFill(MakeI32Const(state->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(state->Memory()->Bytes())));
+  }
+  for(auto state : b_states_) {
+    Merge(e, MakeMemoryFill(MakeI32Const(state->Memory()->Begin()), MakeI32Const(0),
+                            MakeI32Const(state->Memory()->Bytes())));
+  }
+  return e;
+}
+
+wabt::ExprList* FullyConnectedLayer::DropData() {
+  ERROR_UNLESS(NetworkModel()->PassiveWeights(), "Layer data is not passive");
+  ExprList* e = new ExprList();
+  if(Position() == Input) {
+    return e;
+  }
+  Merge(e, MakeDataDrop(W_segment_));
+  Merge(e, MakeDataDrop(b_segment_));
+  if(Int8Weights(Model::Mode::Prediction)) {
+    Merge(e, MakeDataDrop(W_int8_segment_));
+    Merge(e, MakeDataDrop(W_scales_segment_));
+  }
+  if(SparseWeights(Model::Mode::Prediction)) {
+    Merge(e, MakeDataDrop(W_sparse_values_segment_));
+    Merge(e, MakeDataDrop(W_sparse_columns_segment_));
+  }
+  return e;
 }
 
 void FullyConnectedLayer::MakeFunctions() {
@@ -522,17 +1074,77 @@ void FullyConnectedLayer::MakeFunctions() {
   }
 }
 
+wabt::ExprList* FullyConnectedLayer::ForwardColumns(uint8_t mode_index, Var input_begin, Var cols_bytes,
+                                                    std::vector<Var> locals) {
+  assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Prediction);
+  assert(locals.size() == 7);
+  auto vi32_1 = locals[0];
+  auto vi32_2 = locals[1];
+  auto vi32_3 = locals[2];
+  auto vi32_4 = locals[3];
+  auto vi32_5 = locals[4];
+  auto vf32_1 = locals[5];
+  auto v128_1 = locals[6];
+
+  ExprList* e = new ExprList();
+  if(Position() != Input) {
+    assert(LayerIndex() > 0);
+    auto prev_layer = NetworkModel()->Layers()[LayerIndex() - 1];
+    if(prev_layer->Type() == FullyConnected) {
+      auto prev_fc_layer = static_cast<FullyConnectedLayer*>(prev_layer);
+      // Z[l] = W[l] . A[l-1] + b[l]
+      auto prev_A = (LayerIndex() == 1) ? snippet::RelocMat(prev_fc_layer->A_[mode_index][0], input_begin) :
+                                          snippet::RelocMat(prev_fc_layer->A_[mode_index][0]);
+      Merge(e, NetworkModel()->Snippets().matrix->MatrixDotColumns(W_, prev_A, Z_[mode_index][0], cols_bytes,
+                                                                   {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1,
+                                                                    v128_1}));
+      Merge(e, NetworkModel()->Snippets().matrix->MatrixVectorAdditionColumns(Z_[mode_index][0], b_,
+                                                                              Z_[mode_index][0], cols_bytes,
+                                                                              {vi32_1, vi32_2, vi32_3, vi32_4}));
+
+      // A[l] = g(Z[l])
+      // Softmax is applied on all the columns since
+      // the builtin bounds its loops with the matrix width
+      if(activation_func_ == NetworkModel()->Builtins().activation.Softmax()) {
+        Merge(e, MakeCall(activation_func_.function, {
+          MakeI32Const(Z_[mode_index][0]->Begin()),
+          MakeI32Const(A_[mode_index][0]->Begin()),
+          MakeI32Const(Z_[mode_index][0]->Shape()[0]),
+          MakeI32Const(Z_[mode_index][0]->Shape()[1])
+        }));
+      } else {
+        Merge(e, NetworkModel()->Snippets().matrix->MatrixActivationColumns(Z_[mode_index][0], activation_func_,
+                                                                            A_[mode_index][0], cols_bytes,
+                                                                            {vi32_1, vi32_2}));
+      }
+    } else {
+      assert(!"Not implemented!");
+    }
+  } else {
+    // Place a nop because an expression list
+    // cannot be empty
+    Merge(e, MakeNop());
+  }
+
+  // The dropout mask covers all the columns
+  if(Position() != Output && keep_prob_ != KEEP_PROB_MAX && mode_index == Model::Mode::Training) {
+    Merge(e, Dropout(0, {vi32_1, vi32_2, vf32_1}));
+  }
+  return e;
+}
+
 FullyConnectedLayer * DenseOutputLayer::KeepProb(float keep_prob) {
   ERROR_EXIT("Dense output layer cannot have a keep probability value "
              "because dropout regularization does not apply to it");
   return this;
 }
 
-wabt::ExprList* DenseOutputLayer::Forward(uint8_t mode_index, wabt::Var input_begin, std::vector<wabt::Var> locals) {
+wabt::ExprList* DenseOutputLayer::Forward(uint8_t mode_index, uint32_t worker, wabt::Var input_begin,
+                                          std::vector<wabt::Var> locals) {
   // Not need to assert the mode_index because it is done
   // when calling the parent function
 
-  assert(locals.size() == 8);
+  assert(locals.size() == 9);
   auto vi32_1 = locals[0];
   auto vi32_2 = locals[1];
   auto vi32_3 = locals[2];
@@ -541,25 +1153,29 @@ wabt::ExprList* DenseOutputLayer::Forward(uint8_t mode_index, wabt::Var input_be
   auto vf32_1 = locals[5];
   auto vf32_2 = locals[6];
   auto v128_1 = locals[7];
+  auto v128_2 = locals[8];
 
   ExprList* e = new ExprList();
-  Merge(e, FullyConnectedLayer::Forward(mode_index, input_begin, {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+  Merge(e, FullyConnectedLayer::Forward(mode_index, worker, input_begin,
+                                        {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1, v128_2}));
 
   // Apply hardmax
   if(ShouldHardmax(mode_index)) {
-    Merge(e, NetworkModel()->Snippets().matrix->MatrixColumnHardmax(Predictions(mode_index),
-                                                                    hardmax_[mode_index],
+    Merge(e, NetworkModel()->Snippets().matrix->MatrixColumnHardmax(Predictions(mode_index, worker),
+                                                                    hardmax_[mode_index][worker],
                                                                     {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5}));
   }
   return e;
 }
 
 void DenseHiddenLayer::Validate() {
+  FullyConnectedLayer::Validate();
   ERROR_UNLESS(activation_func_ != NetworkModel()->Builtins().activation.Softmax(),
                "Hidden layer cannot have softmax activation function");
 }
 
 void DenseOutputLayer::Validate() {
+  FullyConnectedLayer::Validate();
   ERROR_UNLESS(activation_func_ == NetworkModel()->Builtins().activation.Softmax()
                || activation_func_ == NetworkModel()->Builtins().activation.Sigmoid() ,
                "Output layer must sigmoid or softmax as activation function");
@@ -577,12 +1193,18 @@ void DenseOutputLayer::MakeFunctions() {
   // Create functions defined in parent
   FullyConnectedLayer::MakeFunctions();
 
-  // Create training confusion matrix functions
+  // Create training confusion matrix functions.
+  // The confusion matrices accumulate until reset
   if(NetworkModel()->Options().bytecode_options.gen_training_confusion_matrix) {
     NetworkModel()->ModuleManager().MakeFunction("training_confusion_matrix_offset", {{},{Type::I32}},{},
                                                  [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
       f.Insert(MakeI32Const(confusion_matrix_[Model::Mode::Training]->Begin()));
     });
+    NetworkModel()->ModuleManager().MakeFunction("reset_training_confusion_matrix", {}, {},
+                                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      f.Insert(MakeMemoryFill(MakeI32Const(confusion_matrix_[Model::Mode::Training]->Begin()), MakeI32Const(0),
+                              MakeI32Const(confusion_matrix_[Model::Mode::Training]->Memory()->Bytes())));
+    });
   }
 
   // Create testing confusion matrix functions
@@ -591,6 +1213,11 @@ void DenseOutputLayer::MakeFunctions() {
                                                  [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
       f.Insert(MakeI32Const(confusion_matrix_[Model::Mode::Testing]->Begin()));
     });
+    NetworkModel()->ModuleManager().MakeFunction("reset_testing_confusion_matrix", {}, {},
+                                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      f.Insert(MakeMemoryFill(MakeI32Const(confusion_matrix_[Model::Mode::Testing]->Begin()), MakeI32Const(0),
+                              MakeI32Const(confusion_matrix_[Model::Mode::Testing]->Memory()->Bytes())));
+    });
   }
 
   // Create function to get the prediction result offset
@@ -602,7 +1229,7 @@ void DenseOutputLayer::MakeFunctions() {
 
 wabt::ExprList* DenseOutputLayer::UpdateConfusionMatrix(uint8_t mode_index, wabt::Var target_begin, std::vector<wabt::Var> locals) {
   assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Testing);
-  assert(hardmax_[mode_index] != nullptr);
+  assert(!hardmax_[mode_index].empty());
   assert(locals.size() == 6);
   auto vi32_1 = locals[0];
   auto vi32_2 = locals[1];
@@ -614,16 +1241,16 @@ wabt::ExprList* DenseOutputLayer::UpdateConfusionMatrix(uint8_t mode_index, wabt
   wabt::ExprList *e = new ExprList();
   // Second update confusion matrix
   Merge(e, NetworkModel()->Snippets().analysis
-      ->ConfusionMatrixUpdate(confusion_matrix_[mode_index], hardmax_[mode_index],
+      ->ConfusionMatrixUpdate(confusion_matrix_[mode_index], hardmax_[mode_index][0],
                               snippet::RelocMat(Predictions(mode_index), target_begin),
                               {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vi32_6}));
   return e;
 }
 
-wabt::ExprList* DenseOutputLayer::CountCorrectPredictions(uint8_t mode_index, Var target_begin, Var result,
-                                                          std::vector<Var> locals) {
+wabt::ExprList* DenseOutputLayer::CountCorrectPredictions(uint8_t mode_index, uint32_t worker, Var target_begin,
+                                                          Var result, std::vector<Var> locals) {
   assert(mode_index == Model::Mode::Training || mode_index == Model::Mode::Testing);
-  assert(hardmax_[mode_index] != nullptr);
+  assert(worker < hardmax_[mode_index].size());
   assert(locals.size() == 5);
   auto vi32_1 = locals[0];
   auto vi32_2 = locals[1];
@@ -634,8 +1261,8 @@ wabt::ExprList* DenseOutputLayer::CountCorrectPredictions(uint8_t mode_index, Va
   wabt::ExprList* e = new ExprList();
   // Second count correct predictions
   Merge(e, NetworkModel()->Snippets().analysis
-      ->CorrectPredictions(hardmax_[mode_index],
-                           snippet::RelocMat(Predictions(mode_index), target_begin),
+      ->CorrectPredictions(hardmax_[mode_index][worker],
+                           snippet::RelocMat(Predictions(mode_index, worker), target_begin),
                            result, {vi32_1, vi32_2, vi32_3}));
   return e;
 }
@@ -656,10 +1283,14 @@ bool DenseOutputLayer::ShouldHardmax(uint8_t mode_index) const {
 void DenseOutputLayer::AllocateMemory() {
   FullyConnectedLayer::AllocateMemory();
   if(ShouldHardmax(Model::Mode::Training)) {
-    ALLOCATE_MEMORY(hardmax_[Model::Mode::Training], Nodes(), NetworkModel()->TrainingBatchSize());
+    hardmax_[Model::Mode::Training].resize(NetworkModel()->TrainingWorkers());
+    for(uint32_t worker = 0; worker < NetworkModel()->TrainingWorkers(); worker++) {
+      ALLOCATE_MEMORY(hardmax_[Model::Mode::Training][worker], Nodes(), NetworkModel()->TrainingBatchSize());
+    }
   }
   if(ShouldHardmax(Model::Mode::Testing)) {
-    ALLOCATE_MEMORY(hardmax_[Model::Mode::Testing], Nodes(), NetworkModel()->TestingBatchSize());
+    hardmax_[Model::Mode::Testing].resize(1);
+    ALLOCATE_MEMORY(hardmax_[Model::Mode::Testing][0], Nodes(), NetworkModel()->TestingBatchSize());
   }
   if(NetworkModel()->Options().bytecode_options.gen_training_confusion_matrix) {
     ALLOCATE_MEMORY(confusion_matrix_[Model::Mode::Training], Nodes(), Nodes());
@@ -669,14 +1300,15 @@ void DenseOutputLayer::AllocateMemory() {
   }
 }
 
-ds::NDArray* DenseOutputLayer::Predictions(uint8_t mode_index) const {
+ds::NDArray* DenseOutputLayer::Predictions(uint8_t mode_index, uint32_t worker) const {
   assert(mode_index >= Model::Mode::FIRST_MODE && mode_index <= Model::Mode::LAST_MODE);
-  return A_[mode_index];
+  assert(worker < A_[mode_index].size());
+  return A_[mode_index][worker];
 }
 
 ds::NDArray* DenseInputLayer::InputArray(uint8_t mode_index) const {
   assert(mode_index >= Model::Mode::FIRST_MODE && mode_index <= Model::Mode::LAST_MODE);
-  return A_[mode_index];
+  return A_[mode_index][0];
 }
 
 void DenseInputLayer::MakeFunctions() {
@@ -686,7 +1318,7 @@ void DenseInputLayer::MakeFunctions() {
   // Create a function to get offset of the prediction data
   NetworkModel()->ModuleManager().MakeFunction("prediction_data_offset", {{}, {Type::I32}}, {},
                                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
-    f.Insert(MakeI32Const(A_[Model::Mode::Prediction]->Begin()));
+    f.Insert(MakeI32Const(A_[Model::Mode::Prediction][0]->Begin()));
   });
 }
 
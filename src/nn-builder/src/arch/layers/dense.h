@@ -2,6 +2,7 @@
 #define NN_ARCH_LAYER_DENSE_H_
 
 #include <src/nn-builder/src/arch/layers/layer.h>
+#include <src/nn-builder/src/data_structure/sparse.h>
 
 namespace nn {
 namespace arch {
@@ -19,39 +20,106 @@ protected:
   const float KEEP_PROB_MAX = 1.0;
   const float KEEP_PROB_MIN = 0.0;
   float keep_prob_ = KEEP_PROB_MAX;
+  // Fraction of the W[l] blocks pruned for prediction
+  float sparsity_ = 0;
   // Feed-forward arrays
+  // Training arrays are indexed by worker
   ds::NDArray* W_ = nullptr;
-  ds::NDArray* Z_[3]; // Training, Testing, Prediction
-  ds::NDArray* A_[3]; // Training, Testing, Prediction
+  std::vector<ds::NDArray*> Z_[3]; // Training, Testing, Prediction
+  std::vector<ds::NDArray*> A_[3]; // Training, Testing, Prediction
   ds::NDArray* b_ = nullptr;
+  // Passive data segments of the initial W and b
+  wabt::Var W_segment_;
+  wabt::Var b_segment_;
+  // Int8 W[l] with a scale per row used for prediction
+  ds::NDArray* W_int8_ = nullptr;
+  ds::NDArray* W_scales_ = nullptr;
+  wabt::Var W_int8_segment_;
+  wabt::Var W_scales_segment_;
+  // Block sparse W[l] used for prediction
+  ds::BlockSparseNDArray* W_sparse_ = nullptr;
+  ds::NDArray* W_block_norms_ = nullptr;
+  wabt::Var W_sparse_values_segment_;
+  wabt::Var W_sparse_columns_segment_;
   // Back-propagation arrays
-  ds::NDArray* dW_ = nullptr;
-  ds::NDArray* dZ_ = nullptr;
-  ds::NDArray* dA_ = nullptr;
-  ds::NDArray* db_ = nullptr;
+  std::vector<ds::NDArray*> dW_;
+  std::vector<ds::NDArray*> dZ_;
+  std::vector<ds::NDArray*> dA_;
+  std::vector<ds::NDArray*> db_;
+  // Gradients of a micro-batch, accumulated in dW and db
+  ds::NDArray* micro_dW_ = nullptr;
+  ds::NDArray* micro_db_ = nullptr;
+  // Optimizer states of W and b
+  std::vector<ds::NDArray*> W_states_;
+  std::vector<ds::NDArray*> b_states_;
   // Regularization
-  ds::NDArray* inverted_dropout_ = nullptr;
+  std::vector<ds::NDArray*> inverted_dropout_;
+  // Check if the activation derivative can use A[l]
+  bool DerivativeFromOutput() const;
+  // Check if A[l] is stored in bf16 in a mode
+  bool Bf16Activations(uint8_t mode_index) const;
+  // Check if the int8 W[l] is used in a mode
+  bool Int8Weights(uint8_t mode_index) const;
+  // Check if the block sparse W[l] is used in a mode
+  bool SparseWeights(uint8_t mode_index) const;
+  // Check if the dot products of a mode
+  // are computed by the parallel GEMM threads
+  bool ParallelDot(uint8_t mode_index) const;
+  // Apply the dropout mask on the training A[l] of a worker
+  wabt::ExprList* Dropout(uint32_t worker, std::vector<wabt::Var> locals);
+  // Backward algorithm on the whole batch, or on its first
+  // columns up to `cols_bytes` when `columns` is set
+  wabt::ExprList* BackwardAlgorithm(uint32_t worker, wabt::Var input_begin, wabt::Var target_begin, bool columns,
+                                    wabt::Var cols_bytes, std::vector<wabt::Var> locals);
 public:
   FullyConnectedLayer(LayerPosition position, uint32_t nodes, builtins::ActivationFunction act_func) :
       TypedLayer(position), nodes_(nodes), activation_func_(act_func) {}
   uint32_t Nodes() const { return nodes_; }
-  wabt::ExprList* Forward(uint8_t mode_index, wabt::Var input_begin, std::vector<wabt::Var> locals) override;
-  wabt::ExprList* Backward(wabt::Var input_begin, wabt::Var taget_begin, std::vector<wabt::Var> locals) override;
+  bool Sparse() const { return sparsity_ > 0; }
+  // Weights and bias arrays (not allocated in the input layer)
+  ds::NDArray* W() const { return W_; }
+  ds::NDArray* b() const { return b_; }
+  wabt::ExprList* Forward(uint8_t mode_index, uint32_t worker, wabt::Var input_begin,
+                          std::vector<wabt::Var> locals) override;
+  wabt::ExprList* ForwardColumns(uint8_t mode_index, wabt::Var input_begin, wabt::Var cols_bytes,
+                                 std::vector<wabt::Var> locals) override;
+  wabt::ExprList* Backward(uint32_t worker, wabt::Var input_begin, wabt::Var taget_begin,
+                           std::vector<wabt::Var> locals) override;
+  wabt::ExprList* BackwardColumns(wabt::Var input_begin, wabt::Var target_begin, wabt::Var cols_bytes,
+                                  std::vector<wabt::Var> locals) override;
+  wabt::ExprList* UpdateWeights(uint32_t worker, uint32_t workers, std::vector<wabt::Var> locals) override;
+  // Quantize W[l] into the int8 W[l] used for prediction
+  wabt::ExprList* QuantizeWeights(std::vector<wabt::Var> locals);
+  // Prune W[l] into the block sparse W[l] used for prediction
+  wabt::ExprList* PruneWeights(std::vector<wabt::Var> locals);
 
   // Memory functions
   void AllocateMemory() override ;
   void MakeData(wabt::Var memory) override ;
+  wabt::ExprList* InitData() override;
+  wabt::ExprList* DropData() override;
 
   // Create functions
   void MakeFunctions() override;
 
+  // Layer configuration descriptor
+  std::string Descriptor() const override;
+
+  // Validate the layer configuration
+  void Validate() override;
+
   // Compute cost
+  // ! Note: trailing locals are used as reduction accumulators
   wabt::ExprList* ComputeL1Cost(uint8_t mode_index, std::vector<wabt::Var>locals);
   wabt::ExprList* ComputeL2Cost(uint8_t mode_index, std::vector<wabt::Var>locals);
 
   // Layer configuration
   virtual FullyConnectedLayer* KeepProb(float keep_prob);
   FullyConnectedLayer* WeightType(WeightDistributionType type);
+  // Predict with W[l] pruned by blocks of 4 columns, keeping
+  // the same number of blocks in each row. The number of nodes
+  // of the previous layer must be a multiple of 4
+  FullyConnectedLayer* Sparsity(float sparsity);
 };
 
 class DenseInputLayer : public FullyConnectedLayer {
@@ -78,24 +146,26 @@ public:
   // Allocate memory
   void AllocateMemory() override ;
   // Get arrays
-  ds::NDArray* Predictions(uint8_t mode_index) const;
+  ds::NDArray* Predictions(uint8_t mode_index, uint32_t worker = 0) const;
   // Error out on keep probability on the output layer
   FullyConnectedLayer* KeepProb(float keep_prob) override ;
   // Augment forward algorithm
-  wabt::ExprList* Forward(uint8_t mode_index, wabt::Var input_begin, std::vector<wabt::Var> locals) final;
+  wabt::ExprList* Forward(uint8_t mode_index, uint32_t worker, wabt::Var input_begin,
+                          std::vector<wabt::Var> locals) final;
   void MakeFunctions() override ;
   void Validate() override ;
 
   // Compute cost value
-  wabt::ExprList* ComputeCost(uint8_t mode_index, wabt::Var target_begin);
+  wabt::ExprList* ComputeCost(uint8_t mode_index, uint32_t worker, wabt::Var target_begin);
   // Update confusion matrix
   wabt::ExprList* UpdateConfusionMatrix(uint8_t mode_index, wabt::Var target_begin, std::vector<wabt::Var> locals);
   // Count number of correct predictions
-  wabt::ExprList* CountCorrectPredictions(uint8_t mode_index, wabt::Var target_begin, wabt::Var result, std::vector<wabt::Var> locals);
+  wabt::ExprList* CountCorrectPredictions(uint8_t mode_index, uint32_t worker, wabt::Var target_begin, wabt::Var result,
+                                          std::vector<wabt::Var> locals);
 private:
   // Check if hardmax is required
   bool ShouldHardmax(uint8_t mode_index) const;
-  ds::NDArray* hardmax_[2]          = {nullptr, nullptr}; // Training, Testing
+  std::vector<ds::NDArray*> hardmax_[2];                  // Training (by worker), Testing
   ds::NDArray* confusion_matrix_[2] = {nullptr, nullptr}; // Training, Testing
 };
 
@@ -34,11 +34,36 @@ public:
   void SetModel(Model* model) { model_ = model; }
   void SetIndex(uint32_t index) { index_ = index; }
   virtual void Validate() {};
-  virtual wabt::ExprList* Forward(uint8_t mode_index, wabt::Var input_begin, std::vector<wabt::Var> locals) = 0;
-  virtual wabt::ExprList* Backward(wabt::Var input_begin, wabt::Var target_begin, std::vector<wabt::Var> locals) = 0;
+  // The worker selects the training arrays used by the
+  // algorithms (it is always 0 for testing and prediction)
+  virtual wabt::ExprList* Forward(uint8_t mode_index, uint32_t worker, wabt::Var input_begin,
+                                  std::vector<wabt::Var> locals) = 0;
+  // Prediction or training forward algorithm on the first
+  // columns of the batch, up to the byte offset `cols_bytes`
+  virtual wabt::ExprList* ForwardColumns(uint8_t mode_index, wabt::Var input_begin, wabt::Var cols_bytes,
+                                         std::vector<wabt::Var> locals) = 0;
+  virtual wabt::ExprList* Backward(uint32_t worker, wabt::Var input_begin, wabt::Var target_begin,
+                                   std::vector<wabt::Var> locals) = 0;
+  // Backward algorithm of the first training worker on the
+  // first columns of the batch, averaging the gradients
+  // over the number of columns given by `cols_bytes`
+  virtual wabt::ExprList* BackwardColumns(wabt::Var input_begin, wabt::Var target_begin, wabt::Var cols_bytes,
+                                          std::vector<wabt::Var> locals) = 0;
+  // Update the worker part of the weights with
+  // the average gradients of the training workers
+  virtual wabt::ExprList* UpdateWeights(uint32_t worker, uint32_t workers, std::vector<wabt::Var> locals) = 0;
   virtual void AllocateMemory() = 0;
   virtual void MakeData(wabt::Var memory) = 0;
+  // Copy the initial data of the layer from its passive
+  // data segments and reset its training state, or drop
+  // the segments (only used when the data is made in
+  // passive segments or the memory is shared)
+  virtual wabt::ExprList* InitData() = 0;
+  virtual wabt::ExprList* DropData() = 0;
   virtual void MakeFunctions() = 0;
+  // Text describing the layer configuration
+  // (used to identify identical models)
+  virtual std::string Descriptor() const = 0;
 };
 
 template <LayerType type>
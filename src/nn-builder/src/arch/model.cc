@@ -13,6 +13,8 @@ using namespace wabt;
 using namespace layer;
 
 #define V128_IF_SIMD(t) (options_.bytecode_options.use_simd ? Type::V128 : (t))
+#define REDUCTION_ACCUMULATORS_IF_SIMD(t) (options_.bytecode_options.use_simd ?                   \
+    std::vector<Type>(options_.bytecode_options.simd_reduction_accumulators, Type::V128) : std::vector<Type>{(t)})
 
 #define DEFINE_TIME_MEMBERS(name)                                     \
 ExprList* DenseForwardTimeMembers::Get##name() {                      \
@@ -48,6 +50,14 @@ wabt::ExprList* Model::GetLearningRate() {
   return MakeF32Load(MakeI32Const(learning_rate_->Begin()));
 }
 
+wabt::ExprList* Model::GetOptimizerRate() {
+  if(Optimizer() == Adam) {
+    assert(optimizer_state_ != nullptr);
+    return MakeF32Load(MakeI32Const(optimizer_state_->Begin() + 2 * TypeSize(Type::F32)));
+  }
+  return GetLearningRate();
+}
+
 uint32_t Model::BatchSzie(uint8_t mode_index) const {
   if(mode_index == Mode::Training) {
     return TrainingBatchSize();
@@ -82,11 +92,97 @@ void Model::SetLayers(std::vector<Layer *> layers) {
 }
 
 Model::Model(ModelOptions options) : options_(options), builtins_(options_.activation_options) {
+  ERROR_UNLESS(options_.bytecode_options.simd_reduction_accumulators >= 1 &&
+               options_.bytecode_options.simd_reduction_accumulators <= 8,
+               "SIMD reduction accumulators must be between 1 and 8");
+  ERROR_UNLESS(options_.bytecode_options.codegen_threads == 0 || !options_.bytecode_options.use_kernel_functions,
+               "Kernel functions cannot be used with parallel code generation");
+  ERROR_UNLESS(options_.bytecode_options.training_workers >= 1, "Training workers must be at least 1");
+  ERROR_UNLESS(options_.bytecode_options.training_workers == 1 ||
+               (!options_.bytecode_options.gen_training_confusion_matrix &&
+                !options_.bytecode_options.gen_forward_profiling &&
+                !options_.bytecode_options.gen_backward_profiling),
+               "Training confusion matrix and profiling cannot be used with training workers");
+  ERROR_UNLESS(options_.bytecode_options.parallel_gemm_threads >= 1, "Parallel GEMM threads must be at least 1");
+  ERROR_UNLESS(options_.bytecode_options.parallel_gemm_threads == 1 || options_.bytecode_options.codegen_threads == 0,
+               "Parallel GEMM threads cannot be used with parallel code generation");
+  ERROR_UNLESS(!options_.bytecode_options.separate_weights || !options_.bytecode_options.passive_weights,
+               "Separate weights cannot be passive");
+  ERROR_UNLESS(options_.bytecode_options.resident_training_samples == 0 ||
+               (options_.bytecode_options.training_workers == 1 && !options_.bytecode_options.inference_only),
+               "Resident training samples cannot be used with training workers or in an inference only model");
+  ERROR_UNLESS(options_.bytecode_options.training_data_slots >= 1, "Training data slots must be at least 1");
+  ERROR_UNLESS(options_.bytecode_options.training_data_slots == 1 ||
+               (options_.bytecode_options.training_workers == 1 && !options_.bytecode_options.inference_only),
+               "Training data slots cannot be used with training workers or in an inference only model");
+  ERROR_UNLESS(!options_.bytecode_options.growable_training_batches ||
+               (options_.bytecode_options.training_workers == 1 &&
+                options_.bytecode_options.parallel_gemm_threads == 1 &&
+                !options_.bytecode_options.inference_only),
+               "Growable training batches cannot be used with a shared memory or in an inference only model");
+  ERROR_UNLESS(options_.bytecode_options.resident_training_max_epochs >= 1,
+               "Resident training max epochs must be at least 1");
+  ERROR_UNLESS(!options_.bytecode_options.inference_only ||
+               (options_.bytecode_options.training_workers == 1 &&
+                !options_.bytecode_options.gen_training_accuracy &&
+                !options_.bytecode_options.gen_training_error &&
+                !options_.bytecode_options.gen_training_confusion_matrix &&
+                !options_.bytecode_options.gen_testing_accuracy &&
+                !options_.bytecode_options.gen_testing_error &&
+                !options_.bytecode_options.gen_testing_confusion_matrix &&
+                !options_.bytecode_options.gen_forward_profiling &&
+                !options_.bytecode_options.gen_backward_profiling),
+               "Training and testing options cannot be used in an inference only model");
+  ERROR_UNLESS(options_.bytecode_options.gradient_accumulation_steps >= 1,
+               "Gradient accumulation steps must be at least 1");
+  ERROR_UNLESS(options_.bytecode_options.gradient_accumulation_steps == 1 ||
+               (options_.bytecode_options.training_workers == 1 && !options_.bytecode_options.inference_only),
+               "Gradient accumulation cannot be used with training workers or in an inference only model");
+  ERROR_UNLESS(!options_.bytecode_options.bf16_activations ||
+               (!options_.bytecode_options.live_prediction_batch &&
+                options_.bytecode_options.parallel_gemm_threads == 1),
+               "bf16 activations cannot be used with the live prediction batch or parallel GEMM threads");
+  ERROR_UNLESS(!options_.bytecode_options.int8_prediction_weights ||
+               (!options_.bytecode_options.live_prediction_batch &&
+                options_.bytecode_options.parallel_gemm_threads == 1 &&
+                !options_.bytecode_options.bf16_activations),
+               "int8 prediction weights cannot be used with the live prediction batch, parallel GEMM threads "
+               "or bf16 activations");
+  ERROR_UNLESS(!options_.bytecode_options.live_training_batch ||
+               (options_.bytecode_options.training_workers == 1 &&
+                options_.bytecode_options.gradient_accumulation_steps == 1 &&
+                !options_.bytecode_options.inference_only &&
+                !options_.bytecode_options.gen_training_accuracy &&
+                !options_.bytecode_options.gen_training_error &&
+                !options_.bytecode_options.gen_training_confusion_matrix),
+               "The live training batch cannot be used with training workers, gradient accumulation, "
+               "the training accuracy, error and confusion matrix or in an inference only model");
+#ifdef WABT_EXPERIMENTAL
+  ERROR_UNLESS(!options_.bytecode_options.live_training_batch,
+               "The live training batch cannot be used with native dot products");
+  ERROR_UNLESS(!options_.bytecode_options.bf16_activations, "bf16 activations cannot be used with native dot products");
+  ERROR_UNLESS(!options_.bytecode_options.int8_prediction_weights,
+               "int8 prediction weights cannot be used with native dot products");
+#endif
+  ERROR_UNLESS(options_.optimizer_options.type >= FIRST_OPTIMIZER && options_.optimizer_options.type <= LAST_OPTIMIZER,
+               "Unknown optimizer");
+  ERROR_UNLESS(options_.optimizer_options.type == SGD || options_.bytecode_options.training_workers == 1,
+               "Optimizers other than SGD cannot be used with training workers");
+  ERROR_UNLESS(options_.optimizer_options.beta1 >= 0 && options_.optimizer_options.beta1 < 1 &&
+               options_.optimizer_options.beta2 >= 0 && options_.optimizer_options.beta2 < 1,
+               "Optimizer decays must be between 0 (inclusive) and 1 (exclusive)");
+  ERROR_UNLESS(options_.optimizer_options.epsilon > 0, "Optimizer epsilon must be positive");
+  module_manager_.SetCodegenThreads(options_.bytecode_options.codegen_threads);
   AllocateMembers();
 #ifdef WABT_EXPERIMENTAL
   InitNativeImports();
 #endif
   InitBuiltinImports();
+  if(SharedMemory()) {
+    // All threads import the same shared memory. The
+    // number of pages is set once the memory is allocated
+    memory_ = module_manager_.MakeMemoryImport("Memory", "memory", 0, 0, true);
+  }
   InitBuiltinDefinitions();
   InitSnippets();
 }
@@ -101,6 +197,8 @@ void Model::Build(uint32_t training_batch_size, uint32_t training_batches_in_mem
   ERROR_UNLESS(testing_batches_in_memory >= 1, "testing batches in memory must be at least 1");
   ERROR_UNLESS(l1_regularizer >= 0, "l1 regularizer cannot be negative");
   ERROR_UNLESS(l2_regularizer >= 0, "l2 regularizer cannot be negative");
+  ERROR_UNLESS(ResidentTrainingSamples() == 0 || ResidentTrainingSamples() >= training_batch_size,
+               "resident training samples must fill at least one training batch");
   training_batch_size_ = training_batch_size;
   training_batches_in_memory_ = training_batches_in_memory;
   testing_batch_size_ = testing_batch_size;
@@ -119,9 +217,12 @@ void Model::Build(uint32_t training_batch_size, uint32_t training_batches_in_mem
   AllocateMemory();
   MakeLayersFunctions();
   MakeAlgorithmsFunctions();
-  MakeTrainingFunctions();
-  MakeTestingFunctions();
+  if(!InferenceOnly()) {
+    MakeTrainingFunctions();
+    MakeTestingFunctions();
+  }
   MakePredictionFunctions();
+  module_manager_.GenerateDeferredFunctions();
   MakeData();
 }
 
@@ -133,7 +234,6 @@ void Model::InitBuiltinImports() {
 }
 
 void Model::InitBuiltinDefinitions() {
-  // TODO Create simd option (same as snippets)
   builtins_.system.InitDefinitions(this, &module_manager_);
   builtins_.math.InitDefinitions(this, &module_manager_);
   builtins_.activation.InitDefinitions(this, &module_manager_);
@@ -148,6 +248,10 @@ void Model::InitSnippets() {
     snippets_.matrix = new snippet::MatrixSnippet(&module_manager_.Label(), &builtins_);
     snippets_.analysis = new snippet::AnalysisSnippetSimd(&module_manager_.Label(), &builtins_);
   }
+  snippets_.kernels = new snippet::MatrixKernels(&module_manager_, snippets_.matrix,
+                                                 options_.bytecode_options.use_simd);
+  snippets_.parallel = new snippet::ParallelKernels(&module_manager_, snippets_.matrix,
+                                                    options_.bytecode_options.use_simd, ParallelGemmThreads());
 }
 
 #ifdef WABT_EXPERIMENTAL
@@ -172,11 +276,21 @@ void Model::AllocateMemory() {
 }
 
 void Model::AllocateMembers() {
+  // Members are only used by the training and testing functions
+  if(InferenceOnly()) {
+    return;
+  }
   learning_rate_            = module_manager_.Memory().Allocate(TypeSize(Type::F32));
   training_hits_            = module_manager_.Memory().Allocate(TypeSize(Type::F32));
   training_error_           = module_manager_.Memory().Allocate(TypeSize(Type::F32));
   testing_hits_             = module_manager_.Memory().Allocate(TypeSize(Type::F32));
   testing_error_            = module_manager_.Memory().Allocate(TypeSize(Type::F32));
+  if(Optimizer() == Adam) {
+    optimizer_state_        = module_manager_.Memory().Allocate(3 * TypeSize(Type::F32));
+  }
+  if(GradientAccumulationSteps() > 1) {
+    accumulated_batches_    = module_manager_.Memory().Allocate(TypeSize(Type::I32));
+  }
 #define ALLOCATE_TIME_MEMBERS(name) \
   dense_forward_logging_members_.name = module_manager_.Memory().Allocate(TypeSize(Type::F64));
   DENSE_FORWARD_TIME_MEMBERS(ALLOCATE_TIME_MEMBERS)
@@ -186,6 +300,13 @@ void Model::AllocateMembers() {
   dense_backward_logging_members_.name = module_manager_.Memory().Allocate(TypeSize(Type::F64));
   DENSE_BACKWARD_TIME_MEMBERS(ALLOCATE_TIME_MEMBERS)
 #undef ALLOCATE_TIME_MEMBERS
+
+  if(TrainingWorkers() > 1) {
+    // Barrier count and generation
+    workers_barrier_        = module_manager_.Memory().Allocate(2 * TypeSize(Type::I32));
+    workers_hits_           = module_manager_.Memory().Allocate(TrainingWorkers() * TypeSize(Type::F32));
+    workers_error_          = module_manager_.Memory().Allocate(TrainingWorkers() * TypeSize(Type::F32));
+  }
 }
 
 void Model::AllocateLayers() {
@@ -194,12 +315,15 @@ void Model::AllocateLayers() {
   }
 }
 
-Var Model::ForwardAlgorithmFunction(uint8_t mode_index) {
+Var Model::ForwardAlgorithmFunction(uint8_t mode_index, uint32_t worker) {
   std::vector<Type> locals_types = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::F32,
                                     V128_IF_SIMD(Type::I32)};
-  return module_manager_.MakeFunction(nullptr, {{Type::I32},{}}, locals_types,
-                                      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
-    assert(locals.size() == 8);
+  if(Bf16Activations()) {
+    // Second accumulator of the bf16 dot products
+    locals_types.push_back(V128_IF_SIMD(Type::I32));
+  }
+  auto layer_forward = [mode_index, worker](Layer* layer, Var input_begin, std::vector<Var> locals) {
+    assert(locals.size() == 8 || locals.size() == 9);
     auto vi32_1 = locals[0];
     auto vi32_2 = locals[1];
     auto vi32_3 = locals[2];
@@ -208,48 +332,206 @@ Var Model::ForwardAlgorithmFunction(uint8_t mode_index) {
     auto vf32_1 = locals[5];
     auto vf32_2 = locals[6];
     auto v128_1 = locals[7];
+    auto v128_2 = locals.size() == 9 ? locals[8] : v128_1;
+
+    ExprList* e = new ExprList();
+    if(layer->Type() == FullyConnected) {
+      if(layer->Position() == Output) {
+        Merge(e, layer->Forward(mode_index, worker, input_begin,
+                                {vi32_1,vi32_2,vi32_3,vi32_4,vi32_5,vf32_1,vf32_2, v128_1, v128_2}));
+      } else {
+        Merge(e, layer->Forward(mode_index, worker, input_begin,
+                                {vi32_1,vi32_2,vi32_3,vi32_4,vi32_5,vf32_1, v128_1, v128_2}));
+      }
+    } else {
+      assert(!"Not implemented!");
+    }
+    return e;
+  };
+
+  if(options_.bytecode_options.split_layer_functions) {
+    // One function per layer called in order
+    std::vector<Var> layers_funcs;
+    for(auto layer : layers_) {
+      layers_funcs.push_back(module_manager_.MakeDeferredFunction(nullptr, {{Type::I32},{}}, locals_types,
+                                                                  [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+        assert(params.size() == 1);
+        f.Insert(layer_forward(layer, params[0], locals));
+      }));
+    }
+    return module_manager_.MakeFunction(nullptr, {{Type::I32},{}}, {},
+                                        [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      assert(params.size() == 1);
+      auto input_begin = params[0];
+      for(auto layer_func : layers_funcs) {
+        f.Insert(MakeCall(layer_func, {MakeLocalGet(input_begin)}));
+      }
+    });
+  }
 
+  return module_manager_.MakeDeferredFunction(nullptr, {{Type::I32},{}}, locals_types,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     assert(params.size() == 1);
     auto input_begin = params[0];
+    for(auto layer : layers_) {
+      f.Insert(layer_forward(layer, input_begin, locals));
+    }
+  });
+}
 
-    for(int l=0; l < layers_.size(); ++l) {
-      if(layers_[l]->Type() == FullyConnected) {
-        if(layers_[l]->Position() == Output) {
-          f.Insert(layers_[l]->Forward(mode_index, input_begin, {vi32_1,vi32_2,vi32_3,vi32_4,vi32_5,vf32_1,vf32_2, v128_1}));
-        } else {
-          f.Insert(layers_[l]->Forward(mode_index, input_begin, {vi32_1,vi32_2,vi32_3,vi32_4,vi32_5,vf32_1, v128_1}));
-        }
-      } else {
-        assert(!"Not implemented!");
-      }
+wabt::Var Model::ForwardColumnsFunction(uint8_t mode_index) {
+  std::vector<Type> locals_types = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+                                    V128_IF_SIMD(Type::I32)};
+  return module_manager_.MakeDeferredFunction(nullptr, {{Type::I32, Type::I32},{}}, locals_types,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 2);
+    auto input_begin = params[0];
+    auto cols_bytes = params[1];
+    for(auto layer : layers_) {
+      f.Insert(layer->ForwardColumns(mode_index, input_begin, cols_bytes, locals));
     }
   });
 }
 
-wabt::Var Model::BackwardAlgorithmFunction() {
-  std::vector<Type> locals_type = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
-                                   V128_IF_SIMD(Type::I32)};
-  return module_manager_.MakeFunction(nullptr, {{Type::I32, Type::I32},{}}, locals_type,
-                                      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
-    assert(locals.size() == 7);
+wabt::Var Model::BackwardAlgorithmFunction(uint32_t worker) {
+  std::vector<Type> locals_type = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32};
+  auto accumulators_types = REDUCTION_ACCUMULATORS_IF_SIMD(Type::I32);
+  locals_type.insert(locals_type.end(), accumulators_types.begin(), accumulators_types.end());
+  auto layer_backward = [worker](Layer* layer, Var input_begin, Var target_begin, std::vector<Var> locals) {
+    assert(locals.size() >= 7);
     auto vi32_1 = locals[0];
     auto vi32_2 = locals[1];
     auto vi32_3 = locals[2];
     auto vi32_4 = locals[3];
     auto vi32_5 = locals[4];
     auto vf32_1 = locals[5];
-    auto v128_1 = locals[6];
 
+    // Remaining locals are reduction accumulators
+    std::vector<Var> layer_locals = {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1};
+    layer_locals.insert(layer_locals.end(), locals.begin() + 6, locals.end());
+    return layer->Backward(worker, input_begin, target_begin, layer_locals);
+  };
+
+  if(options_.bytecode_options.split_layer_functions) {
+    // One function per layer called in reverse order
+    std::vector<Var> layers_funcs;
+    for(int64_t l = layers_.size()-1; l >= 0; --l) {
+      layers_funcs.push_back(module_manager_.MakeDeferredFunction(nullptr, {{Type::I32, Type::I32},{}}, locals_type,
+                                                                  [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+        assert(params.size() == 2);
+        f.Insert(layer_backward(layers_[l], params[0], params[1], locals));
+      }));
+    }
+    return module_manager_.MakeFunction(nullptr, {{Type::I32, Type::I32},{}}, {},
+                                        [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      assert(params.size() == 2);
+      auto input_begin = params[0];
+      auto target_begin = params[1];
+      for(auto layer_func : layers_funcs) {
+        f.Insert(MakeCall(layer_func, {MakeLocalGet(input_begin), MakeLocalGet(target_begin)}));
+      }
+    });
+  }
+
+  return module_manager_.MakeDeferredFunction(nullptr, {{Type::I32, Type::I32},{}}, locals_type,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     assert(params.size() == 2);
     auto input_begin = params[0];
     auto target_begin = params[1];
+    for(int64_t l = layers_.size()-1; l >= 0; --l) {
+      f.Insert(layer_backward(layers_[l], input_begin, target_begin, locals));
+    }
+  });
+}
 
+wabt::Var Model::BackwardColumnsFunction() {
+  std::vector<Type> locals_type = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32};
+  auto accumulators_types = REDUCTION_ACCUMULATORS_IF_SIMD(Type::I32);
+  locals_type.insert(locals_type.end(), accumulators_types.begin(), accumulators_types.end());
+  return module_manager_.MakeDeferredFunction(nullptr, {{Type::I32, Type::I32, Type::I32},{}}, locals_type,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 3);
+    auto input_begin = params[0];
+    auto target_begin = params[1];
+    auto cols_bytes = params[2];
     for(int64_t l = layers_.size()-1; l >= 0; --l) {
-      f.Insert(layers_[l]->Backward(input_begin, target_begin, {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5, vf32_1, v128_1}));
+      f.Insert(layers_[l]->BackwardColumns(input_begin, target_begin, cols_bytes, locals));
+    }
+  });
+}
+
+wabt::Var Model::UpdateWeightsFunction(uint32_t worker, uint32_t workers) {
+  std::vector<Type> locals = {Type::I32, Type::I32, Type::F32};
+  if(Optimizer() != SGD) {
+    // Gradient and moment, in f32 then in v128
+    locals.insert(locals.end(), {Type::F32, Type::F32, V128_IF_SIMD(Type::I32), V128_IF_SIMD(Type::I32)});
+  }
+  return module_manager_.MakeDeferredFunction(nullptr, {}, locals,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    if(Optimizer() == Adam) {
+      // Move to the next step t and correct the bias of the moments:
+      // alpha_t = alpha * sqrt(1 - beta2^t) / (1 - beta1^t)
+      auto state = [&](uint32_t index) {
+        return MakeI32Const(optimizer_state_->Begin() + index * TypeSize(Type::F32));
+      };
+      f.Insert(MakeF32Store(state(0), MakeBinary(Opcode::F32Mul, MakeF32Load(state(0)),
+                                                 MakeF32Const(options_.optimizer_options.beta1))));
+      f.Insert(MakeF32Store(state(1), MakeBinary(Opcode::F32Mul, MakeF32Load(state(1)),
+                                                 MakeF32Const(options_.optimizer_options.beta2))));
+      auto bias1 = MakeBinary(Opcode::F32Sub, MakeF32Const(1), MakeF32Load(state(0)));
+      auto bias2 = MakeUnary(Opcode::F32Sqrt, MakeBinary(Opcode::F32Sub, MakeF32Const(1), MakeF32Load(state(1))));
+      f.Insert(MakeF32Store(state(2), MakeBinary(Opcode::F32Div, MakeBinary(Opcode::F32Mul, GetLearningRate(), bias2),
+                                                 bias1)));
+    }
+    for(auto layer : layers_) {
+      f.Insert(layer->UpdateWeights(worker, workers, locals));
+    }
+  });
+}
+
+wabt::Var Model::QuantizeWeightsFunction() {
+  return module_manager_.MakeDeferredFunction(nullptr, {}, {Type::I32, Type::I32, Type::I32, Type::F32, Type::F32},
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    for(auto layer : layers_) {
+      if(layer->Type() == FullyConnected) {
+        f.Insert(static_cast<FullyConnectedLayer*>(layer)->QuantizeWeights(locals));
+      } else {
+        assert(!"Not implemented");
+      }
     }
   });
 }
 
+wabt::Var Model::PruneWeightsFunction() {
+  std::vector<Type> locals = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32};
+  return module_manager_.MakeDeferredFunction(nullptr, {}, locals,
+                                              [=](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    for(auto layer : layers_) {
+      if(layer->Type() == FullyConnected) {
+        f.Insert(static_cast<FullyConnectedLayer*>(layer)->PruneWeights(locals));
+      } else {
+        assert(!"Not implemented");
+      }
+    }
+  });
+}
+
+wabt::ExprList* Model::UpdatePredictionWeights() {
+  wabt::ExprList* e = new wabt::ExprList();
+  if(Int8PredictionWeights()) {
+    Merge(e, MakeCall(quantize_weights_func_, {}));
+  }
+  if(SparseLayers()) {
+    Merge(e, MakeCall(prune_weights_func_, {}));
+  }
+  // Place a nop because an expression list
+  // cannot be empty
+  if(e->empty()) {
+    Merge(e, MakeNop());
+  }
+  return e;
+}
+
 wabt::Var Model::ConfusionMatrixFunction(uint8_t mode_index) {
   std::vector<Type> locals = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32};
   return module_manager_.MakeFunction(nullptr, {{Type::I32}, {}}, locals,
@@ -276,7 +558,7 @@ wabt::Var Model::ConfusionMatrixFunction(uint8_t mode_index) {
   });
 }
 
-wabt::Var Model::CountCorrectPredictionsFunction(uint8_t mode_index) {
+wabt::Var Model::CountCorrectPredictionsFunction(uint8_t mode_index, uint32_t worker) {
   std::vector<Type> locals = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32};
   return module_manager_.MakeFunction(nullptr, {{Type::I32}, {Type::F32}}, locals,
                                       [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
@@ -295,7 +577,8 @@ wabt::Var Model::CountCorrectPredictionsFunction(uint8_t mode_index) {
     if(layers_.back()->Type() == FullyConnected) {
       auto out_layer = static_cast<DenseOutputLayer*>(layers_.back());
       // Count correct prediction
-      f.Insert(out_layer->CountCorrectPredictions(mode_index, target_begin, correct_count, {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5}));
+      f.Insert(out_layer->CountCorrectPredictions(mode_index, worker, target_begin, correct_count,
+                                                  {vi32_1, vi32_2, vi32_3, vi32_4, vi32_5}));
       // Return correct count
       f.Insert(MakeLocalGet(correct_count));
     } else {
@@ -305,20 +588,27 @@ wabt::Var Model::CountCorrectPredictionsFunction(uint8_t mode_index) {
 
 }
 
-wabt::Var Model::ComputeCostFunction(uint8_t mode_index) {
-  std::vector<Type> locals = {Type::F32, Type::I32, Type::F32, Type::F32, V128_IF_SIMD(Type::I32)};
+wabt::Var Model::ComputeCostFunction(uint8_t mode_index, uint32_t worker) {
+  std::vector<Type> locals = {Type::F32, Type::I32, Type::F32, Type::F32};
+  auto accumulators_types = REDUCTION_ACCUMULATORS_IF_SIMD(Type::I32);
+  locals.insert(locals.end(), accumulators_types.begin(), accumulators_types.end());
   return module_manager_.MakeFunction(nullptr, {{Type::I32}, {Type::F32}}, locals,
                                       [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
-    assert(locals.size() == 5);
+    assert(locals.size() >= 5);
     auto cost = locals[0];
     auto vi32_1 = locals[1];
     auto vf32_1 = locals[2];
     auto vf32_2 = locals[3];
-    auto v128_1 = locals[4];
 
     assert(params.size() == 1);
     auto target_begin = params[0];
 
+    // Remaining locals are reduction accumulators
+    std::vector<Var> l1_locals = {vi32_1, vf32_1};
+    l1_locals.insert(l1_locals.end(), locals.begin() + 4, locals.end());
+    std::vector<Var> l2_locals = {vi32_1, vf32_1, vf32_2};
+    l2_locals.insert(l2_locals.end(), locals.begin() + 4, locals.end());
+
     for(auto &layer : layers_) {
       if(layer->Type() == FullyConnected) {
         if(layer->Position() != Input) {
@@ -327,17 +617,17 @@ wabt::Var Model::ComputeCostFunction(uint8_t mode_index) {
           // Compute cost
           if(fc_layer->Position() == Output) {
             f.Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, static_cast<DenseOutputLayer*>(fc_layer)
-                ->ComputeCost(mode_index, target_begin)));
+                ->ComputeCost(mode_index, worker, target_begin)));
           }
 
           // Compute L1 cost
           if(L1Regularizer() > 0) {
-            f.Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, fc_layer->ComputeL1Cost(mode_index, {vi32_1, v128_1, vf32_1})));
+            f.Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, fc_layer->ComputeL1Cost(mode_index, l1_locals)));
           }
 
           // Compute L2 cost
           if(L2Regularizer() > 0) {
-             f.Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, fc_layer->ComputeL2Cost(mode_index, {vi32_1, vf32_1, v128_1, vf32_2})));
+             f.Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, fc_layer->ComputeL2Cost(mode_index, l2_locals)));
           }
         }
       } else {
@@ -351,11 +641,135 @@ wabt::Var Model::ComputeCostFunction(uint8_t mode_index) {
 }
 
 void Model::MakeData() {
-  Var memory = module_manager_.MakeMemory(module_manager_.Memory().Pages());
-  module_manager_.MakeMemoryExport("memory", memory);
+  if(SharedMemory()) {
+    // A shared memory requires a maximum
+    // size, so the threads memory cannot grow
+    module_manager_.SetMemoryPages(memory_, module_manager_.Memory().Pages(), module_manager_.Memory().Pages());
+  } else {
+    memory_ = module_manager_.MakeMemory(module_manager_.Memory().Pages());
+  }
+  module_manager_.MakeMemoryExport("memory", memory_);
   for(int l=1; l < layers_.size(); ++l) {
-    layers_[l]->MakeData(memory);
+    layers_[l]->MakeData(memory_);
+  }
+
+  // Batches are reserved after the static layout
+  if(options_.bytecode_options.growable_training_batches) {
+    module_manager_.MakeData(memory_, reserved_batches_state_->Begin(),
+                             {DataEntry::MakeI32(module_manager_.Memory().Pages() * WABT_PAGE_SIZE)});
+  }
+
+  // Initial state of the shuffling of the resident samples
+  uint32_t seed = options_.weights_options.seed;
+  std::vector<DataEntry> shuffle_entries = {DataEntry::MakeI32(seed != 0 ? seed : 1)};
+  // Powers of the decays at step 0
+  std::vector<DataEntry> optimizer_entries = {DataEntry::MakeF32(1), DataEntry::MakeF32(1), DataEntry::MakeF32(0)};
+
+  // Each instance on a shared memory would apply the
+  // active segments again, so init_weights() writes
+  // the initial state once instead
+  if(!SharedMemory()) {
+    if(ResidentTrainingSamples() > 0) {
+      module_manager_.MakeData(memory_, shuffle_state_->Begin(), shuffle_entries);
+    }
+    if(optimizer_state_ != nullptr) {
+      module_manager_.MakeData(memory_, optimizer_state_->Begin(), optimizer_entries);
+    }
+  }
+
+  if(PassiveWeights() || SharedMemory()) {
+    // Copy the initial weights from the passive segments (this
+    // traps once they are dropped) and reset the training state
+    module_manager_.MakeFunction("init_weights", {}, {}, [&](FuncBody f, std::vector<Var> params,
+                                                             std::vector<Var> locals) {
+      for(int l=1; l < layers_.size(); ++l) {
+        f.Insert(layers_[l]->InitData());
+      }
+      // No micro-batch is accumulated
+      if(accumulated_batches_ != nullptr) {
+        f.Insert(MakeI32Store(MakeI32Const(accumulated_batches_->Begin()), MakeI32Const(0)));
+      }
+      // The optimizer restarts from step 0
+      if(optimizer_state_ != nullptr) {
+        for(uint32_t i = 0; i < optimizer_entries.size(); i++) {
+          f.Insert(MakeF32Store(MakeI32Const(optimizer_state_->Begin() + i * TypeSize(Type::F32)),
+                                MakeF32Const(optimizer_entries[i].val.f32)));
+        }
+      }
+      if(SharedMemory() && ResidentTrainingSamples() > 0) {
+        f.Insert(MakeI32Store(MakeI32Const(shuffle_state_->Begin()), MakeI32Const(shuffle_entries[0].val.i32)));
+      }
+    });
+  }
+
+  if(PassiveWeights()) {
+    // Release the segments once the
+    // initial weights are not needed
+    module_manager_.MakeFunction("drop_initial_weights", {}, {}, [&](FuncBody f, std::vector<Var> params,
+                                                                     std::vector<Var> locals) {
+      for(int l=1; l < layers_.size(); ++l) {
+        f.Insert(layers_[l]->DropData());
+      }
+    });
+  }
+}
+
+void Model::AddWeightsRegion(wasmpp::Memory* memory, const std::vector<wasmpp::DataEntry>& entries) {
+  ERROR_UNLESS(options_.bytecode_options.separate_weights, "Weights are not separate");
+  auto data = DataEntry::Encode(entries);
+  ERROR_UNLESS(data.size() == memory->Bytes(), "Weights region size mismatch");
+  weights_regions_.push_back({memory, data});
+}
+
+std::vector<uint8_t> Model::WeightsBlob() const {
+  ERROR_UNLESS(options_.bytecode_options.separate_weights, "Weights are not separate");
+  std::vector<uint8_t> blob;
+  auto PushU32 = [&](uint32_t val) {
+    for(int i = 0; i < 4; i++) {
+      blob.push_back((uint8_t) (val >> (8 * i)));
+    }
+  };
+  PushU32(NN_WEIGHTS_BLOB_MAGIC);
+  PushU32(NN_WEIGHTS_BLOB_VERSION);
+  PushU32(WeightsLayout());
+  PushU32((uint32_t) weights_regions_.size());
+  for(auto& region : weights_regions_) {
+    PushU32(region.first->Begin());
+    PushU32(region.first->Bytes());
+  }
+  for(auto& region : weights_regions_) {
+    blob.insert(blob.end(), region.second.begin(), region.second.end());
+  }
+  return blob;
+}
+
+uint32_t Model::WeightsLayout() const {
+  uint32_t hash = 0x811c9dc5;
+  auto HashU32 = [&](uint32_t val) {
+    for(int i = 0; i < 4; i++) {
+      hash ^= (uint8_t) (val >> (8 * i));
+      hash *= 0x01000193;
+    }
+  };
+  for(auto layer : layers_) {
+    if(layer->Type() == FullyConnected && layer->Position() != Input) {
+      auto fc_layer = static_cast<FullyConnectedLayer*>(layer);
+      HashU32(fc_layer->W()->Begin());
+      HashU32(fc_layer->W()->Memory()->Bytes());
+      HashU32(fc_layer->b()->Begin());
+      HashU32(fc_layer->b()->Memory()->Bytes());
+    }
   }
+  return hash;
+}
+
+bool Model::SparseLayers() const {
+  for(auto layer : layers_) {
+    if(layer->Type() == FullyConnected && static_cast<FullyConnectedLayer*>(layer)->Sparse()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void Model::MakeLayersFunctions() {
@@ -365,12 +779,37 @@ void Model::MakeLayersFunctions() {
 }
 
 void Model::MakeAlgorithmsFunctions() {
-  forward_training_func_            = ForwardAlgorithmFunction(Mode::Training);
-  forward_testing_func_             = ForwardAlgorithmFunction(Mode::Testing);
-  forward_prediction_func_          = ForwardAlgorithmFunction(Mode::Prediction);
-  backward_func_                    = BackwardAlgorithmFunction();
-  compute_cost_training_func_       = ComputeCostFunction(Mode::Training);
-  compute_cost_testing_func_        = ComputeCostFunction(Mode::Testing);
+  if(Int8PredictionWeights()) {
+    quantize_weights_func_          = QuantizeWeightsFunction();
+  }
+  if(SparseLayers()) {
+    prune_weights_func_             = PruneWeightsFunction();
+  }
+  if(InferenceOnly()) {
+    forward_prediction_func_        = ForwardAlgorithmFunction(Mode::Prediction, 0);
+    return;
+  }
+  for(uint32_t worker = 0; worker < TrainingWorkers(); worker++) {
+    forward_training_funcs_.push_back(ForwardAlgorithmFunction(Mode::Training, worker));
+  }
+  forward_testing_func_             = ForwardAlgorithmFunction(Mode::Testing, 0);
+  forward_prediction_func_          = ForwardAlgorithmFunction(Mode::Prediction, 0);
+  for(uint32_t worker = 0; worker < TrainingWorkers(); worker++) {
+    backward_funcs_.push_back(BackwardAlgorithmFunction(worker));
+  }
+  if(TrainingWorkers() > 1) {
+    for(uint32_t worker = 0; worker < TrainingWorkers(); worker++) {
+      update_weights_funcs_.push_back(UpdateWeightsFunction(worker, TrainingWorkers()));
+    }
+  }
+  if(DeferredWeightsUpdate()) {
+    // Update of a single instance training alone
+    update_weights_func_            = UpdateWeightsFunction(0, 1);
+  }
+  for(uint32_t worker = 0; worker < TrainingWorkers(); worker++) {
+    compute_cost_training_funcs_.push_back(ComputeCostFunction(Mode::Training, worker));
+  }
+  compute_cost_testing_func_        = ComputeCostFunction(Mode::Testing, 0);
   if(options_.bytecode_options.gen_training_confusion_matrix) {
     confusion_matrix_training_func_ = ConfusionMatrixFunction(Mode::Training);
   }
@@ -378,10 +817,12 @@ void Model::MakeAlgorithmsFunctions() {
     confusion_matrix_testing_func_ = ConfusionMatrixFunction(Mode::Testing);
   }
   if(options_.bytecode_options.gen_training_accuracy) {
-    count_correct_predictions_training_func_ = CountCorrectPredictionsFunction(Mode::Training);
+    for(uint32_t worker = 0; worker < TrainingWorkers(); worker++) {
+      count_correct_predictions_training_funcs_.push_back(CountCorrectPredictionsFunction(Mode::Training, worker));
+    }
   }
   if(options_.bytecode_options.gen_testing_accuracy) {
-    count_correct_predictions_testing_func_ = CountCorrectPredictionsFunction(Mode::Testing);
+    count_correct_predictions_testing_func_ = CountCorrectPredictionsFunction(Mode::Testing, 0);
   }
 }
 
@@ -409,13 +850,13 @@ void Model::MakeTrainingFunctions() {
   uint32_t data_entry_bytes             = input_size * TypeSize(Type::F32);
   uint32_t data_batch_bytes             = data_entry_bytes * TrainingBatchSize();
   uint32_t data_batches_in_memory_bytes = data_batch_bytes * TrainingBatchesInMemory();
-  training_data_batches_ = module_manager_.Memory().Allocate(data_batches_in_memory_bytes);
+  training_data_batches_ = module_manager_.Memory().Allocate(data_batches_in_memory_bytes * TrainingDataSlots());
 
   // Allocate memory for labels
   uint32_t labels_entry_bytes             = output_size * TypeSize(Type::F32);
   uint32_t labels_batch_bytes             = labels_entry_bytes * TrainingBatchSize();
   uint32_t labels_batches_in_memory_bytes = labels_batch_bytes * TrainingBatchesInMemory();
-  training_labels_batches_ = module_manager_.Memory().Allocate(labels_batches_in_memory_bytes);
+  training_labels_batches_ = module_manager_.Memory().Allocate(labels_batches_in_memory_bytes * TrainingDataSlots());
 
   // Create function to get the offset for training data in memory
   module_manager_.MakeFunction("training_data_offset", {{},{Type::I32}}, {},
@@ -429,6 +870,31 @@ void Model::MakeTrainingFunctions() {
     f.Insert(MakeI32Const(training_labels_batches_->Begin()));
   });
 
+  // Create function to load batches resident elsewhere
+  // in memory into the training batches. The resident
+  // batches are their data followed by their labels.
+  // Only the first batches fitting in memory are loaded
+  module_manager_.MakeFunction("load_batch", {{Type::I32, Type::I32},{}}, {Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 2);
+    auto src_offset = params[0];
+    auto count = params[1];
+    assert(locals.size() == 1);
+    auto batches = locals[0];
+    f.Insert(MakeLocalSet(batches, MakeLocalGet(count)));
+    f.Insert(MakeIf(f.Label(), MakeBinary(Opcode::I32GtU, MakeLocalGet(batches),
+                                          MakeI32Const(TrainingBatchesInMemory())), {}, [&](BlockBody b, Var label) {
+      b.Insert(MakeLocalSet(batches, MakeI32Const(TrainingBatchesInMemory())));
+    }));
+    auto data_bytes = MakeBinary(Opcode::I32Mul, MakeLocalGet(batches), MakeI32Const(data_batch_bytes));
+    f.Insert(MakeMemoryCopy(MakeI32Const(training_data_batches_->Begin()), MakeLocalGet(src_offset), data_bytes));
+    // The labels follow the data of all the resident batches
+    auto labels_src = MakeBinary(Opcode::I32Add, MakeLocalGet(src_offset),
+                                 MakeBinary(Opcode::I32Mul, MakeLocalGet(count), MakeI32Const(data_batch_bytes)));
+    auto labels_bytes = MakeBinary(Opcode::I32Mul, MakeLocalGet(batches), MakeI32Const(labels_batch_bytes));
+    f.Insert(MakeMemoryCopy(MakeI32Const(training_labels_batches_->Begin()), labels_src, labels_bytes));
+  });
+
   // Create function to get the learning rate
   module_manager_.MakeFunction("get_learning_rate", {{},{Type::F32}}, {},
                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
@@ -441,51 +907,66 @@ void Model::MakeTrainingFunctions() {
     f.Insert(SetLearningRate(MakeLocalGet(params[0])));
   });
 
-  // Create training function
-  std::vector<Type> locals_type = {Type::F32, Type::F32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32};
-  module_manager_.MakeFunction("train_batches_in_memory", {{Type::I32},{}}, locals_type,
+  // Create training function on the batches
+  // at the data and labels addresses
+  std::vector<Type> locals_type = {Type::F32, Type::F32, Type::I32, Type::I32, Type::I32};
+  auto train_batches_at_func = module_manager_.MakeFunction(nullptr, {{Type::I32, Type::I32, Type::I32},{}},
+                                                            locals_type,
                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
-    assert(params.size() == 1);
-    auto batches_to_train_on = params[0];
+    assert(params.size() == 3);
+    auto train_addr = params[0];
+    auto label_addr = params[1];
+    auto batches_to_train_on = params[2];
 
-    assert(locals.size() == 7);
+    assert(locals.size() == 5);
     auto cost = locals[0];
     auto hits = locals[1];        // TODO Change to Type::I32
     auto counter = locals[2];
-    auto train_addr = locals[3];
-    auto label_addr = locals[4];
-    auto vi32_1 = locals[5];
-    auto vi32_2 = locals[6];
-
-    // Set the training pointer to the address of the first training batch
-    f.Insert(MakeLocalSet(train_addr, MakeI32Const(training_data_batches_->Begin())));
-    // Set the labels pointer to the address of the first labels batch
-    f.Insert(MakeLocalSet(label_addr, MakeI32Const(training_labels_batches_->Begin())));
+    auto vi32_1 = locals[3];
+    auto vi32_2 = locals[4];
 
     // Loop on batches in memory
     f.Insert(GenerateDoWhileLoop(f.Label(), counter, batches_to_train_on, 1, {}, [&](BlockBody* b1){
 
       // Forward algorithm
-      b1->Insert(MakeCall(forward_training_func_, {
+      b1->Insert(MakeCall(forward_training_funcs_[0], {
         MakeLocalGet(train_addr)
       }));
 
       // Backward algorithm
-      b1->Insert(MakeCall(backward_func_, {
+      b1->Insert(MakeCall(backward_funcs_[0], {
         MakeLocalGet(train_addr),
         MakeLocalGet(label_addr)
       }));
 
+      // With training workers, an optimizer other than
+      // SGD or gradient accumulation, the backward
+      // algorithm does not update the weights
+      if(GradientAccumulationSteps() > 1) {
+        // Update once K micro-batches are accumulated
+        b1->Insert(MakeI32Store(MakeI32Const(accumulated_batches_->Begin()),
+                                MakeBinary(Opcode::I32Add, MakeI32Load(MakeI32Const(accumulated_batches_->Begin())),
+                                           MakeI32Const(1))));
+        auto complete = MakeBinary(Opcode::I32Eq, MakeI32Load(MakeI32Const(accumulated_batches_->Begin())),
+                                   MakeI32Const(GradientAccumulationSteps()));
+        b1->Insert(MakeIf(f.Label(), complete, {}, [&](BlockBody b2, Var label) {
+          b2.Insert(MakeCall(update_weights_func_, {}));
+          b2.Insert(MakeI32Store(MakeI32Const(accumulated_batches_->Begin()), MakeI32Const(0)));
+        }));
+      } else if(DeferredWeightsUpdate()) {
+        b1->Insert(MakeCall(update_weights_func_, {}));
+      }
+
       // Count number of correct results
       if(options_.bytecode_options.gen_training_accuracy) {
-        b1->Insert(GenerateCompoundAssignment(hits, Opcode::F32Add, MakeCall(count_correct_predictions_training_func_, {
+        b1->Insert(GenerateCompoundAssignment(hits, Opcode::F32Add, MakeCall(count_correct_predictions_training_funcs_[0], {
             MakeLocalGet(label_addr)
         })));
       }
 
       // Compute training error
       if(options_.bytecode_options.gen_training_error) {
-        b1->Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, MakeCall(compute_cost_training_func_, {
+        b1->Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, MakeCall(compute_cost_training_funcs_[0], {
           MakeLocalGet(label_addr)
         })));
       }
@@ -512,6 +993,100 @@ void Model::MakeTrainingFunctions() {
     }
   });
 
+  // Create training function on the first batches in memory
+  auto train_batches_func = module_manager_.MakeFunction(nullptr, {{Type::I32},{}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 1);
+    f.Insert(MakeCall(train_batches_at_func, {
+      MakeI32Const(training_data_batches_->Begin()),
+      MakeI32Const(training_labels_batches_->Begin()),
+      MakeLocalGet(params[0])
+    }));
+  });
+  if(options_.bytecode_options.live_training_batch) {
+    auto forward_columns_func = ForwardColumnsFunction(Mode::Training);
+    auto backward_columns_func = BackwardColumnsFunction();
+
+    // Create training function on the first entries
+    // of the first batches in memory
+    auto train_columns_func = module_manager_.MakeFunction(nullptr, {{Type::I32, Type::I32},{}},
+                                                           {Type::I32, Type::I32, Type::I32},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      assert(params.size() == 2);
+      auto batches_to_train_on = params[0];
+      auto cols_bytes = params[1];
+
+      assert(locals.size() == 3);
+      auto train_addr = locals[0];
+      auto label_addr = locals[1];
+      auto counter = locals[2];
+
+      f.Insert(MakeLocalSet(train_addr, MakeI32Const(training_data_batches_->Begin())));
+      f.Insert(MakeLocalSet(label_addr, MakeI32Const(training_labels_batches_->Begin())));
+      f.Insert(GenerateDoWhileLoop(f.Label(), counter, batches_to_train_on, 1, {}, [&](BlockBody* b1){
+        b1->Insert(MakeCall(forward_columns_func, {MakeLocalGet(train_addr), MakeLocalGet(cols_bytes)}));
+        b1->Insert(MakeCall(backward_columns_func, {
+          MakeLocalGet(train_addr),
+          MakeLocalGet(label_addr),
+          MakeLocalGet(cols_bytes)
+        }));
+        if(DeferredWeightsUpdate()) {
+          b1->Insert(MakeCall(update_weights_func_, {}));
+        }
+        b1->Insert(GenerateCompoundAssignment(train_addr, Opcode::I32Add, MakeI32Const(data_batch_bytes)));
+        b1->Insert(GenerateCompoundAssignment(label_addr, Opcode::I32Add, MakeI32Const(labels_batch_bytes)));
+      }));
+    });
+
+    module_manager_.MakeFunction("train_batches_in_memory", {{Type::I32, Type::I32},{}}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      assert(params.size() == 2);
+      auto batches = params[0];
+      auto entries = params[1];
+
+      // Train on the first entries of the batches
+      auto partial = MakeBinary(Opcode::I32And, MakeBinary(Opcode::I32Ne, MakeLocalGet(entries), MakeI32Const(0)),
+                                MakeBinary(Opcode::I32LtU, MakeLocalGet(entries),
+                                           MakeI32Const(TrainingBatchSize())));
+      f.Insert(MakeIf(f.Label(), partial, {}, [&](BlockBody b, Var label) {
+        b.Insert(MakeCall(train_columns_func, {
+          MakeLocalGet(batches),
+          MakeBinary(Opcode::I32Shl, MakeLocalGet(entries), MakeI32Const(TypeShiftLeft(Type::F32)))
+        }));
+      }, [&](BlockBody b) {
+        b.Insert(MakeCall(train_batches_func, {MakeLocalGet(batches)}));
+      }));
+      f.Insert(UpdatePredictionWeights());
+    });
+  } else {
+    module_manager_.MakeFunction("train_batches_in_memory", {{Type::I32},{}}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+      assert(params.size() == 1);
+      f.Insert(MakeCall(train_batches_func, {MakeLocalGet(params[0])}));
+      f.Insert(UpdatePredictionWeights());
+    });
+  }
+
+  // Create the streaming functions on the data slots
+  if(TrainingDataSlots() > 1) {
+    MakeTrainingSlotsFunctions(train_batches_at_func, data_batches_in_memory_bytes, labels_batches_in_memory_bytes);
+  }
+
+  // Create the training functions on the reserved batches
+  if(options_.bytecode_options.growable_training_batches) {
+    MakeReservedBatchesFunctions(train_batches_at_func, data_batch_bytes, labels_batch_bytes);
+  }
+
+  // Create the training function of the workers
+  if(TrainingWorkers() > 1) {
+    MakeTrainingWorkersFunctions(data_batch_bytes, labels_batch_bytes);
+  }
+
+  // Create the training functions on resident samples
+  if(ResidentTrainingSamples() > 0) {
+    MakeTrainingEpochsFunctions(train_batches_func, data_entry_bytes, labels_entry_bytes);
+  }
+
   // Create function to access training batches hits
   if(options_.bytecode_options.gen_training_accuracy) {
     module_manager_.MakeFunction("training_batches_hits", {{},{Type::F32}}, {},
@@ -563,6 +1138,577 @@ void Model::MakeTrainingFunctions() {
   }
 }
 
+void Model::MakeTrainingWorkersFunctions(uint32_t data_batch_bytes, uint32_t labels_batch_bytes) {
+  assert(TrainingWorkers() > 1);
+  const uint32_t workers = TrainingWorkers();
+
+  // Create the training function of each worker
+  std::vector<Var> workers_funcs;
+  std::vector<Type> locals_type = {Type::F32, Type::F32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+                                   Type::I32, Type::I32};
+  for(uint32_t worker = 0; worker < workers; worker++) {
+    workers_funcs.push_back(module_manager_.MakeFunction(nullptr, {{Type::I32},{}}, locals_type,
+                                                         [&](FuncBody f, std::vector<Var> params,
+                                                             std::vector<Var> locals) {
+      assert(params.size() == 1);
+      auto batches_to_train_on = params[0];
+
+      assert(locals.size() == 9);
+      auto cost = locals[0];
+      auto hits = locals[1];
+      auto counter = locals[2];
+      auto rounds = locals[3];
+      auto train_addr = locals[4];
+      auto label_addr = locals[5];
+      auto barrier = locals[6];
+      auto generation = locals[7];
+      auto vi32_1 = locals[8];
+
+      // Worker w trains on the batches w, w + n, w + 2n, ...
+      // so each round trains all workers on n batches. The
+      // remaining batches of an incomplete round are skipped
+      f.Insert(MakeLocalSet(rounds, MakeBinary(Opcode::I32DivU, MakeLocalGet(batches_to_train_on),
+                                               MakeI32Const(workers))));
+      f.Insert(MakeLocalSet(train_addr, MakeI32Const(training_data_batches_->Begin() + worker * data_batch_bytes)));
+      f.Insert(MakeLocalSet(label_addr, MakeI32Const(training_labels_batches_->Begin() + worker * labels_batch_bytes)));
+      f.Insert(MakeLocalSet(barrier, MakeI32Const(workers_barrier_->Begin())));
+
+      // Loop on rounds
+      f.Insert(MakeIf(f.Label(), MakeLocalGet(rounds), {}, [&](BlockBody b, Var label) {
+        b.Insert(GenerateDoWhileLoop(f.Label(), counter, rounds, 1, {}, [&](BlockBody* b1) {
+
+          // Forward and backward algorithms
+          // on the arrays of the worker
+          b1->Insert(MakeCall(forward_training_funcs_[worker], {
+            MakeLocalGet(train_addr)
+          }));
+          b1->Insert(MakeCall(backward_funcs_[worker], {
+            MakeLocalGet(train_addr),
+            MakeLocalGet(label_addr)
+          }));
+
+          // Count number of correct results
+          if(options_.bytecode_options.gen_training_accuracy) {
+            b1->Insert(GenerateCompoundAssignment(hits, Opcode::F32Add,
+                                                  MakeCall(count_correct_predictions_training_funcs_[worker], {
+              MakeLocalGet(label_addr)
+            })));
+          }
+
+          // Compute training error
+          if(options_.bytecode_options.gen_training_error) {
+            b1->Insert(GenerateCompoundAssignment(cost, Opcode::F32Add, MakeCall(compute_cost_training_funcs_[worker], {
+              MakeLocalGet(label_addr)
+            })));
+          }
+
+          // Wait for the gradients of all workers, update
+          // the worker part of the weights, and wait for
+          // all parts before the next forward algorithm
+          b1->Insert(GenerateBarrier(f.Label(), barrier, MakeI32Const(workers), generation));
+          b1->Insert(MakeCall(update_weights_funcs_[worker], {}));
+          b1->Insert(GenerateBarrier(f.Label(), barrier, MakeI32Const(workers), generation));
+
+          // Move to the next data batch of the worker
+          b1->Insert(GenerateCompoundAssignment(train_addr, Opcode::I32Add, MakeI32Const(workers * data_batch_bytes)));
+          // Move to the next label batch of the worker
+          b1->Insert(GenerateCompoundAssignment(label_addr, Opcode::I32Add,
+                                                MakeI32Const(workers * labels_batch_bytes)));
+        }));
+      }));
+
+      // Store the worker results, and let the first worker
+      // add them once all workers have stored theirs
+      if(options_.bytecode_options.gen_training_error || options_.bytecode_options.gen_training_accuracy) {
+        f.Insert(MakeF32Store(MakeI32Const(workers_error_->Begin() + worker * TypeSize(Type::F32)),
+                              MakeLocalGet(cost)));
+        f.Insert(MakeF32Store(MakeI32Const(workers_hits_->Begin() + worker * TypeSize(Type::F32)),
+                              MakeLocalGet(hits)));
+        f.Insert(GenerateBarrier(f.Label(), barrier, MakeI32Const(workers), generation));
+        if(worker == 0) {
+          f.Insert(MakeLocalSet(cost, MakeF32Const(0)));
+          f.Insert(MakeLocalSet(hits, MakeF32Const(0)));
+          f.Insert(GenerateRangeLoop(f.Label(), vi32_1, 0, workers * TypeSize(Type::F32), TypeSize(Type::F32), {},
+                                     [&](BlockBody* b1) {
+            b1->Insert(GenerateCompoundAssignment(cost, Opcode::F32Add,
+                                                  MakeF32Load(MakeLocalGet(vi32_1), WABT_USE_NATURAL_ALIGNMENT,
+                                                              workers_error_->Begin())));
+            b1->Insert(GenerateCompoundAssignment(hits, Opcode::F32Add,
+                                                  MakeF32Load(MakeLocalGet(vi32_1), WABT_USE_NATURAL_ALIGNMENT,
+                                                              workers_hits_->Begin())));
+          }));
+          if(options_.bytecode_options.gen_training_error) {
+            f.Insert(MakeF32Store(MakeI32Const(training_error_->Begin()), MakeLocalGet(cost)));
+          }
+          if(options_.bytecode_options.gen_training_accuracy) {
+            f.Insert(MakeF32Store(MakeI32Const(training_hits_->Begin()), MakeLocalGet(hits)));
+          }
+        }
+      }
+
+      // The last barrier of a round waits for all parts of the
+      // weights, so the first worker can update the prediction
+      // weights alone
+      if(worker == 0) {
+        f.Insert(UpdatePredictionWeights());
+      }
+    }));
+  }
+
+  // Create the training function called by each worker with
+  // its index. All workers must train on the same number of
+  // batches in memory at the same time
+  module_manager_.MakeFunction("train_batches_in_memory_worker", {{Type::I32, Type::I32},{}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 2);
+    auto worker = params[0];
+    auto batches_to_train_on = params[1];
+    for(uint32_t w = 0; w < workers; w++) {
+      auto is_worker = MakeBinary(Opcode::I32Eq, MakeLocalGet(worker), MakeI32Const(w));
+      f.Insert(MakeIf(f.Label(), is_worker, {}, [&](BlockBody b, Var label) {
+        b.Insert(MakeCall(workers_funcs[w], {MakeLocalGet(batches_to_train_on)}));
+      }));
+    }
+  });
+
+  // Create function to access the number of training workers
+  module_manager_.MakeFunction("training_workers", {{}, {Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(workers));
+  });
+}
+
+void Model::MakeTrainingSlotsFunctions(Var train_batches_at_func, uint32_t data_slot_bytes,
+                                       uint32_t labels_slot_bytes) {
+  const uint32_t slots = TrainingDataSlots();
+  const uint32_t fill_offset = 0;
+  const uint32_t train_offset = TypeSize(Type::I32);
+  const uint32_t counts_offset = 2 * TypeSize(Type::I32);
+  training_slots_state_ = module_manager_.Memory().Allocate((slots + 2) * TypeSize(Type::I32));
+  const uint32_t state = training_slots_state_->Begin();
+
+  // The producer and the trainer can run on different threads
+  // when the memory is shared. Each index is written by one
+  // side only, and the counts hand the slots over
+  auto load_count = [&](Var slot) {
+    auto addr = MakeBinary(Opcode::I32Shl, MakeLocalGet(slot), MakeI32Const(TypeShiftLeft(Type::I32)));
+    if(SharedMemory()) {
+      return MakeI32AtomicLoad(addr, WABT_USE_NATURAL_ALIGNMENT, state + counts_offset);
+    }
+    return MakeI32Load(addr, WABT_USE_NATURAL_ALIGNMENT, state + counts_offset);
+  };
+  auto store_count = [&](BlockBody* b, Var slot, ExprList* count) {
+    auto addr = [&]() {
+      return MakeBinary(Opcode::I32Shl, MakeLocalGet(slot), MakeI32Const(TypeShiftLeft(Type::I32)));
+    };
+    if(SharedMemory()) {
+      b->Insert(MakeI32AtomicStore(addr(), count, WABT_USE_NATURAL_ALIGNMENT, state + counts_offset));
+      b->Insert(MakeAtomicNotify(addr(), MakeI32Const(1), WABT_USE_NATURAL_ALIGNMENT, state + counts_offset));
+      b->Insert(MakeDrop());
+    } else {
+      b->Insert(MakeI32Store(addr(), count, WABT_USE_NATURAL_ALIGNMENT, state + counts_offset));
+    }
+  };
+  auto next_slot = [&](Var slot) {
+    return MakeBinary(Opcode::I32RemU, MakeBinary(Opcode::I32Add, MakeLocalGet(slot), MakeI32Const(1)),
+                      MakeI32Const(slots));
+  };
+
+  // Create functions to access the slots
+  module_manager_.MakeFunction("training_data_slots", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(slots));
+  });
+  module_manager_.MakeFunction("training_slot_data_offset", {{Type::I32},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 1);
+    f.Insert(MakeBinary(Opcode::I32Add, MakeI32Const(training_data_batches_->Begin()),
+                        MakeBinary(Opcode::I32Mul, MakeLocalGet(params[0]), MakeI32Const(data_slot_bytes))));
+  });
+  module_manager_.MakeFunction("training_slot_labels_offset", {{Type::I32},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 1);
+    f.Insert(MakeBinary(Opcode::I32Add, MakeI32Const(training_labels_batches_->Begin()),
+                        MakeBinary(Opcode::I32Mul, MakeLocalGet(params[0]), MakeI32Const(labels_slot_bytes))));
+  });
+  module_manager_.MakeFunction("training_slots_state_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(state));
+  });
+
+  // Create function to get the slot to fill,
+  // or -1 if it has not been trained on yet
+  module_manager_.MakeFunction("fill_training_slot", {{},{Type::I32}}, {Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(locals.size() == 1);
+    auto slot = locals[0];
+    f.Insert(MakeLocalSet(slot, MakeI32Load(MakeI32Const(state + fill_offset))));
+    f.Insert(MakeIf(f.Label(), load_count(slot), {{},{Type::I32}}, [&](BlockBody b, Var label) {
+      b.Insert(MakeI32Const(-1));
+    }, [&](BlockBody b) {
+      b.Insert(MakeLocalGet(slot));
+    }));
+  });
+
+  // Create function to commit the batches copied in the
+  // slot to fill, and move to the next slot. The batches
+  // are ignored if the slot is still to be trained on
+  module_manager_.MakeFunction("commit_training_slot", {{Type::I32},{}}, {Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 1);
+    auto batches = params[0];
+    assert(locals.size() == 1);
+    auto slot = locals[0];
+    f.Insert(MakeIf(f.Label(), MakeBinary(Opcode::I32GtU, MakeLocalGet(batches),
+                                          MakeI32Const(TrainingBatchesInMemory())), {}, [&](BlockBody b, Var label) {
+      b.Insert(MakeLocalSet(batches, MakeI32Const(TrainingBatchesInMemory())));
+    }));
+    f.Insert(MakeLocalSet(slot, MakeI32Load(MakeI32Const(state + fill_offset))));
+    auto can_commit = MakeBinary(Opcode::I32And, MakeUnary(Opcode::I32Eqz, load_count(slot)),
+                                 MakeBinary(Opcode::I32Ne, MakeLocalGet(batches), MakeI32Const(0)));
+    f.Insert(MakeIf(f.Label(), can_commit, {}, [&](BlockBody b, Var label) {
+      store_count(&b, slot, MakeLocalGet(batches));
+      b.Insert(MakeI32Store(MakeI32Const(state + fill_offset), next_slot(slot)));
+    }));
+  });
+
+  // Create function to train on the next committed
+  // slot and release it. Returns the number of
+  // batches trained on, 0 if no slot is committed
+  module_manager_.MakeFunction("train_training_slot", {{},{Type::I32}}, {Type::I32, Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(locals.size() == 2);
+    auto slot = locals[0];
+    auto batches = locals[1];
+    f.Insert(MakeLocalSet(slot, MakeI32Load(MakeI32Const(state + train_offset))));
+    f.Insert(MakeIf(f.Label(), MakeLocalTree(batches, load_count(slot)), {}, [&](BlockBody b, Var label) {
+      b.Insert(MakeCall(train_batches_at_func, {
+        MakeBinary(Opcode::I32Add, MakeI32Const(training_data_batches_->Begin()),
+                   MakeBinary(Opcode::I32Mul, MakeLocalGet(slot), MakeI32Const(data_slot_bytes))),
+        MakeBinary(Opcode::I32Add, MakeI32Const(training_labels_batches_->Begin()),
+                   MakeBinary(Opcode::I32Mul, MakeLocalGet(slot), MakeI32Const(labels_slot_bytes))),
+        MakeLocalGet(batches)
+      }));
+      store_count(&b, slot, MakeI32Const(0));
+      b.Insert(MakeI32Store(MakeI32Const(state + train_offset), next_slot(slot)));
+      b.Insert(UpdatePredictionWeights());
+    }));
+    f.Insert(MakeLocalGet(batches));
+  });
+}
+
+void Model::MakeReservedBatchesFunctions(Var train_batches_at_func, uint32_t data_batch_bytes,
+                                         uint32_t labels_batch_bytes) {
+  const uint32_t batch_bytes = data_batch_bytes + labels_batch_bytes;
+  const uint32_t max_batches = UINT32_MAX / batch_bytes;
+  const uint32_t begin_offset = 0;
+  const uint32_t batches_offset = TypeSize(Type::I32);
+  // The begin address is set with the memory size in MakeData
+  reserved_batches_state_ = module_manager_.Memory().Allocate(2 * TypeSize(Type::I32));
+  const uint32_t state = reserved_batches_state_->Begin();
+
+  // Create function to reserve memory for batches
+  module_manager_.MakeFunction("reserve_training_batches", {{Type::I32},{Type::I32}},
+                               {Type::I32, Type::I32, Type::I32, Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 1);
+    auto batches = params[0];
+    assert(locals.size() == 4);
+    auto begin = locals[0];
+    auto end = locals[1];
+    auto pages = locals[2];
+    auto ok = locals[3];
+
+    // The end address must fit in 32 bits
+    f.Insert(MakeLocalSet(begin, MakeI32Load(MakeI32Const(state + begin_offset))));
+    f.Insert(MakeLocalSet(end, MakeBinary(Opcode::I32Add, MakeLocalGet(begin),
+                                          MakeBinary(Opcode::I32Mul, MakeLocalGet(batches),
+                                                     MakeI32Const(batch_bytes)))));
+    f.Insert(MakeLocalSet(ok, MakeBinary(Opcode::I32And,
+                                         MakeBinary(Opcode::I32LeU, MakeLocalGet(batches), MakeI32Const(max_batches)),
+                                         MakeBinary(Opcode::I32GeU, MakeLocalGet(end), MakeLocalGet(begin)))));
+
+    // Grow the memory to the pages of the end address
+    f.Insert(MakeIf(f.Label(), MakeLocalGet(ok), {}, [&](BlockBody b, Var label) {
+      auto full_pages = MakeBinary(Opcode::I32ShrU, MakeLocalGet(end), MakeI32Const(16));
+      auto partial_page = MakeBinary(Opcode::I32Ne, MakeBinary(Opcode::I32And, MakeLocalGet(end),
+                                                               MakeI32Const(WABT_PAGE_SIZE - 1)), MakeI32Const(0));
+      b.Insert(MakeLocalSet(pages, MakeBinary(Opcode::I32Sub, MakeBinary(Opcode::I32Add, full_pages, partial_page),
+                                              MakeMemorySize())));
+      auto must_grow = MakeBinary(Opcode::I32GtS, MakeLocalGet(pages), MakeI32Const(0));
+      b.Insert(MakeIf(f.Label(), must_grow, {}, [&](BlockBody b1, Var label1) {
+        b1.Insert(MakeLocalSet(ok, MakeBinary(Opcode::I32Ne, MakeMemoryGrow(MakeLocalGet(pages)),
+                                              MakeI32Const(-1))));
+      }));
+    }));
+    f.Insert(MakeIf(f.Label(), MakeLocalGet(ok), {{},{Type::I32}}, [&](BlockBody b, Var label) {
+      b.Insert(MakeI32Store(MakeI32Const(state + batches_offset), MakeLocalGet(batches)));
+      b.Insert(MakeLocalGet(begin));
+    }, [&](BlockBody b) {
+      b.Insert(MakeI32Const(-1));
+    }));
+  });
+
+  // Create functions to access the reserved batches
+  module_manager_.MakeFunction("reserved_training_batches", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Load(MakeI32Const(state + batches_offset)));
+  });
+  module_manager_.MakeFunction("reserved_training_data_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Load(MakeI32Const(state + begin_offset)));
+  });
+  module_manager_.MakeFunction("reserved_training_labels_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeBinary(Opcode::I32Add, MakeI32Load(MakeI32Const(state + begin_offset)),
+                        MakeBinary(Opcode::I32Mul, MakeI32Load(MakeI32Const(state + batches_offset)),
+                                   MakeI32Const(data_batch_bytes))));
+  });
+
+  // Create function to train on `count` reserved
+  // batches from the batch `first`. Batches past
+  // the reserved ones are not trained on
+  module_manager_.MakeFunction("train_reserved_batches", {{Type::I32, Type::I32},{}}, {Type::I32},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 2);
+    auto first = params[0];
+    auto count = params[1];
+    assert(locals.size() == 1);
+    auto reserved = locals[0];
+    f.Insert(MakeLocalSet(reserved, MakeI32Load(MakeI32Const(state + batches_offset))));
+    auto in_reserved = MakeBinary(Opcode::I32LtU, MakeLocalGet(first), MakeLocalGet(reserved));
+    f.Insert(MakeIf(f.Label(), in_reserved, {}, [&](BlockBody b, Var label) {
+      auto remaining = [&]() {
+        return MakeBinary(Opcode::I32Sub, MakeLocalGet(reserved), MakeLocalGet(first));
+      };
+      b.Insert(MakeIf(f.Label(), MakeBinary(Opcode::I32GtU, MakeLocalGet(count), remaining()), {},
+                      [&](BlockBody b1, Var label1) {
+        b1.Insert(MakeLocalSet(count, remaining()));
+      }));
+      b.Insert(MakeIf(f.Label(), MakeLocalGet(count), {}, [&](BlockBody b1, Var label1) {
+        auto begin = [&]() {
+          return MakeI32Load(MakeI32Const(state + begin_offset));
+        };
+        auto labels_begin = MakeBinary(Opcode::I32Add, begin(), MakeBinary(Opcode::I32Mul, MakeLocalGet(reserved),
+                                                                           MakeI32Const(data_batch_bytes)));
+        b1.Insert(MakeCall(train_batches_at_func, {
+          MakeBinary(Opcode::I32Add, begin(), MakeBinary(Opcode::I32Mul, MakeLocalGet(first),
+                                                         MakeI32Const(data_batch_bytes))),
+          MakeBinary(Opcode::I32Add, labels_begin, MakeBinary(Opcode::I32Mul, MakeLocalGet(first),
+                                                              MakeI32Const(labels_batch_bytes))),
+          MakeLocalGet(count)
+        }));
+        b1.Insert(UpdatePredictionWeights());
+      }));
+    }));
+  });
+}
+
+void Model::MakeTrainingEpochsFunctions(Var train_batches_func, uint32_t data_entry_bytes,
+                                        uint32_t labels_entry_bytes) {
+  const uint32_t samples = ResidentTrainingSamples();
+  const uint32_t max_epochs = options_.bytecode_options.resident_training_max_epochs;
+  const uint32_t batch_size = TrainingBatchSize();
+  // Error and hits of an epoch
+  const uint32_t epoch_result_bytes = 2 * TypeSize(Type::F32);
+
+  // Allocate memory for the samples and their shuffling
+  resident_data_        = module_manager_.Memory().Allocate(samples * data_entry_bytes);
+  resident_labels_      = module_manager_.Memory().Allocate(samples * labels_entry_bytes);
+  resident_permutation_ = module_manager_.Memory().Allocate(samples * TypeSize(Type::I32));
+  shuffle_state_        = module_manager_.Memory().Allocate(TypeSize(Type::I32));
+  epochs_results_       = module_manager_.Memory().Allocate(max_epochs * epoch_result_bytes);
+
+  // Create functions to get the offset of the resident samples
+  module_manager_.MakeFunction("resident_training_data_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(resident_data_->Begin()));
+  });
+  module_manager_.MakeFunction("resident_training_labels_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(resident_labels_->Begin()));
+  });
+
+  // Create function to access the number of resident samples
+  module_manager_.MakeFunction("resident_training_samples", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(samples));
+  });
+
+  // Create functions to access the results of the epochs
+  module_manager_.MakeFunction("training_epochs_results_offset", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(epochs_results_->Begin()));
+  });
+  module_manager_.MakeFunction("training_max_epochs", {{},{Type::I32}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    f.Insert(MakeI32Const(max_epochs));
+  });
+
+  // Create function to seed the shuffling. The
+  // xorshift state cannot be 0 so 0 is replaced by 1
+  module_manager_.MakeFunction("set_shuffle_seed", {{Type::I32},{}}, {},
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+    assert(params.size() == 1);
+    auto seed = params[0];
+    f.Insert(MakeI32Store(MakeI32Const(shuffle_state_->Begin()),
+                          MakeBinary(Opcode::I32Or, MakeLocalGet(seed), MakeUnary(Opcode::I32Eqz, MakeLocalGet(seed)))));
+  });
+
+  // Create the training function on the resident samples.
+  // Each epoch shuffles the indices of the samples, then
+  // gathers the samples of each batch in the first batch
+  // in memory and trains on it. The remaining samples of an
+  // incomplete batch are skipped in the epoch. The error and
+  // hits of the epoch e are stored at the results offset + 8e
+  std::vector<Type> locals_type = {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+                                   Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+                                   Type::F32, Type::F32};
+  module_manager_.MakeFunction("train_epochs", {{Type::I32, Type::I32},{}}, locals_type,
+                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 2);
+    auto epochs = params[0];
+    auto num_samples = params[1];
+
+    assert(locals.size() == 15);
+    auto batches = locals[0];
+    auto batch = locals[1];
+    auto i = locals[2];
+    auto j = locals[3];
+    auto tmp = locals[4];
+    auto state = locals[5];
+    auto pos_addr = locals[6];
+    auto col = locals[7];
+    auto src = locals[8];
+    auto end = locals[9];
+    auto dst = locals[10];
+    auto result_addr = locals[11];
+    auto result_end = locals[12];
+    auto error = locals[13];
+    auto hits = locals[14];
+
+    // Clamp the arguments to the memory capacity
+    auto clamp = [&](Var var, uint32_t max) {
+      return MakeIf(f.Label(), MakeBinary(Opcode::I32GtU, MakeLocalGet(var), MakeI32Const(max)), {},
+                    [&](BlockBody b, Var label) {
+        b.Insert(MakeLocalSet(var, MakeI32Const(max)));
+      });
+    };
+    f.Insert(clamp(epochs, max_epochs));
+    f.Insert(clamp(num_samples, samples));
+    f.Insert(MakeLocalSet(batches, MakeBinary(Opcode::I32DivU, MakeLocalGet(num_samples), MakeI32Const(batch_size))));
+
+    // Copy an entry of `entry_bytes` bytes at `src` in the column
+    // `col` of a batch beginning at `batch_begin`. Batches store
+    // one entry per column, so a single entry is contiguous only
+    // if the batch size is 1
+    auto gather = [&](BlockBody* b, uint32_t entry_bytes, uint32_t batch_begin) {
+      if(batch_size == 1) {
+        b->Insert(MakeMemoryCopy(MakeI32Const(batch_begin), MakeLocalGet(src), MakeI32Const(entry_bytes)));
+        return;
+      }
+      b->Insert(MakeLocalSet(end, MakeBinary(Opcode::I32Add, MakeLocalGet(src), MakeI32Const(entry_bytes))));
+      b->Insert(MakeLocalSet(dst, MakeBinary(Opcode::I32Add, MakeI32Const(batch_begin),
+                                             MakeBinary(Opcode::I32Mul, MakeLocalGet(col),
+                                                        MakeI32Const(TypeSize(Type::F32))))));
+      b->Insert(GenerateDoWhileLoop(f.Label(), src, end, TypeSize(Type::F32), {}, [&](BlockBody* b1) {
+        b1->Insert(MakeF32Store(MakeLocalGet(dst), MakeF32Load(MakeLocalGet(src))));
+        b1->Insert(GenerateCompoundAssignment(dst, Opcode::I32Add, MakeI32Const(batch_size * TypeSize(Type::F32))));
+      }));
+    };
+
+    auto has_work = MakeBinary(Opcode::I32And, MakeBinary(Opcode::I32Ne, MakeLocalGet(batches), MakeI32Const(0)),
+                               MakeBinary(Opcode::I32Ne, MakeLocalGet(epochs), MakeI32Const(0)));
+    f.Insert(MakeIf(f.Label(), has_work, {}, [&](BlockBody b, Var label) {
+
+      // Start from the identity permutation
+      b.Insert(GenerateRangeLoop(f.Label(), i, 0, num_samples, 1, {}, [&](BlockBody* b1) {
+        b1->Insert(MakeI32Store(MakeBinary(Opcode::I32Shl, MakeLocalGet(i), MakeI32Const(TypeShiftLeft(Type::I32))),
+                                MakeLocalGet(i), WABT_USE_NATURAL_ALIGNMENT, resident_permutation_->Begin()));
+      }));
+      b.Insert(MakeLocalSet(state, MakeI32Load(MakeI32Const(shuffle_state_->Begin()))));
+      b.Insert(MakeLocalSet(result_addr, MakeI32Const(epochs_results_->Begin())));
+      b.Insert(MakeLocalSet(result_end, MakeBinary(Opcode::I32Add, MakeI32Const(epochs_results_->Begin()),
+                                                   MakeBinary(Opcode::I32Mul, MakeLocalGet(epochs),
+                                                              MakeI32Const(epoch_result_bytes)))));
+
+      // Loop on epochs
+      b.Insert(GenerateDoWhileLoop(f.Label(), result_addr, result_end, epoch_result_bytes, {}, [&](BlockBody* b1) {
+
+        // Fisher-Yates shuffle of the indices
+        // using a xorshift32 generator
+        b1->Insert(MakeLocalSet(i, MakeBinary(Opcode::I32Sub, MakeLocalGet(num_samples), MakeI32Const(1))));
+        b1->Insert(MakeIf(f.Label(), MakeLocalGet(i), {}, [&](BlockBody b2, Var label2) {
+          b2.Insert(MakeLoop(f.Label(), {}, [&](BlockBody b3, Var loop_label) {
+            for(auto shift : {std::make_pair(Opcode::I32Shl, 13), std::make_pair(Opcode::I32ShrU, 17),
+                              std::make_pair(Opcode::I32Shl, 5)}) {
+              b3.Insert(GenerateCompoundAssignment(state, Opcode::I32Xor,
+                                                   MakeBinary(shift.first, MakeLocalGet(state),
+                                                              MakeI32Const(shift.second))));
+            }
+            b3.Insert(MakeLocalSet(j, MakeBinary(Opcode::I32RemU, MakeLocalGet(state),
+                                                 MakeBinary(Opcode::I32Add, MakeLocalGet(i), MakeI32Const(1)))));
+            // Swap the indices i and j
+            auto index_addr = [&](Var var) {
+              return MakeBinary(Opcode::I32Shl, MakeLocalGet(var), MakeI32Const(TypeShiftLeft(Type::I32)));
+            };
+            b3.Insert(MakeLocalSet(tmp, MakeI32Load(index_addr(i), WABT_USE_NATURAL_ALIGNMENT,
+                                                    resident_permutation_->Begin())));
+            b3.Insert(MakeI32Store(index_addr(i), MakeI32Load(index_addr(j), WABT_USE_NATURAL_ALIGNMENT,
+                                                              resident_permutation_->Begin()),
+                                   WABT_USE_NATURAL_ALIGNMENT, resident_permutation_->Begin()));
+            b3.Insert(MakeI32Store(index_addr(j), MakeLocalGet(tmp), WABT_USE_NATURAL_ALIGNMENT,
+                                   resident_permutation_->Begin()));
+            b3.Insert(MakeBrIf(loop_label, MakeLocalTree(i, MakeBinary(Opcode::I32Sub, MakeLocalGet(i),
+                                                                       MakeI32Const(1)))));
+          }));
+        }));
+
+        // Loop on batches
+        b1->Insert(MakeLocalSet(error, MakeF32Const(0)));
+        b1->Insert(MakeLocalSet(hits, MakeF32Const(0)));
+        b1->Insert(MakeLocalSet(pos_addr, MakeI32Const(resident_permutation_->Begin())));
+        b1->Insert(GenerateRangeLoop(f.Label(), batch, 0, batches, 1, {}, [&](BlockBody* b2) {
+
+          // Gather the shuffled samples of the batch
+          b2->Insert(GenerateRangeLoop(f.Label(), col, 0, batch_size, 1, {}, [&](BlockBody* b3) {
+            b3->Insert(MakeLocalSet(tmp, MakeI32Load(MakeLocalGet(pos_addr))));
+            b3->Insert(MakeLocalSet(src, MakeBinary(Opcode::I32Add, MakeI32Const(resident_data_->Begin()),
+                                                    MakeBinary(Opcode::I32Mul, MakeLocalGet(tmp),
+                                                               MakeI32Const(data_entry_bytes)))));
+            gather(b3, data_entry_bytes, training_data_batches_->Begin());
+            b3->Insert(MakeLocalSet(src, MakeBinary(Opcode::I32Add, MakeI32Const(resident_labels_->Begin()),
+                                                    MakeBinary(Opcode::I32Mul, MakeLocalGet(tmp),
+                                                               MakeI32Const(labels_entry_bytes)))));
+            gather(b3, labels_entry_bytes, training_labels_batches_->Begin());
+            b3->Insert(GenerateCompoundAssignment(pos_addr, Opcode::I32Add, MakeI32Const(TypeSize(Type::I32))));
+          }));
+
+          // Train on the batch and accumulate its results
+          b2->Insert(MakeCall(train_batches_func, {MakeI32Const(1)}));
+          if(options_.bytecode_options.gen_training_error) {
+            b2->Insert(GenerateCompoundAssignment(error, Opcode::F32Add,
+                                                  MakeF32Load(MakeI32Const(training_error_->Begin()))));
+          }
+          if(options_.bytecode_options.gen_training_accuracy) {
+            b2->Insert(GenerateCompoundAssignment(hits, Opcode::F32Add,
+                                                  MakeF32Load(MakeI32Const(training_hits_->Begin()))));
+          }
+        }));
+
+        // Store the results of the epoch
+        b1->Insert(MakeF32Store(MakeLocalGet(result_addr), MakeLocalGet(error)));
+        b1->Insert(MakeF32Store(MakeLocalGet(result_addr), MakeLocalGet(hits), WABT_USE_NATURAL_ALIGNMENT,
+                                TypeSize(Type::F32)));
+      }));
+
+      // Continue the sequence in the next call
+      b.Insert(MakeI32Store(MakeI32Const(shuffle_state_->Begin()), MakeLocalGet(state)));
+      b.Insert(UpdatePredictionWeights());
+    }));
+  });
+}
+
 void Model::MakeTestingFunctions() {
 
   // Get the number of input and output
@@ -698,21 +1844,69 @@ void Model::MakePredictionFunctions() {
   }
 
   // Create prediction function
-  module_manager_.MakeFunction("predict_batch", {}, {},
-                               [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
-    assert(locals.empty());
+  if(options_.bytecode_options.live_prediction_batch) {
+    auto forward_columns_func = ForwardColumnsFunction(Mode::Prediction);
+    module_manager_.MakeFunction("predict_batch", {{Type::I32},{}}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+      assert(params.size() == 1);
+      auto entries = params[0];
+
+      // Apply forward algorithm on the first entries
+      auto partial = MakeBinary(Opcode::I32And, MakeBinary(Opcode::I32Ne, MakeLocalGet(entries), MakeI32Const(0)),
+                                MakeBinary(Opcode::I32LtU, MakeLocalGet(entries),
+                                           MakeI32Const(PredictionBatchSize())));
+      f.Insert(MakeIf(f.Label(), partial, {}, [&](BlockBody b, Var label) {
+        b.Insert(MakeCall(forward_columns_func, {
+          MakeI32Const(input_addr),
+          MakeBinary(Opcode::I32Shl, MakeLocalGet(entries), MakeI32Const(TypeShiftLeft(Type::F32)))
+        }));
+      }, [&](BlockBody b) {
+        b.Insert(MakeCall(forward_prediction_func_, {
+          MakeI32Const(input_addr)
+        }));
+      }));
+    });
+  } else {
+    module_manager_.MakeFunction("predict_batch", {}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+      assert(locals.empty());
 
-    // Apply forward algorithm
-    f.Insert(MakeCall(forward_prediction_func_, {
-      MakeI32Const(input_addr)
-    }));
-  });
+      // Apply forward algorithm
+      f.Insert(MakeCall(forward_prediction_func_, {
+        MakeI32Const(input_addr)
+      }));
+    });
+  }
 
   // Create a function to get prediction batch size
   module_manager_.MakeFunction("prediction_batch_size", {{}, {Type::I32}}, {},
                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
     f.Insert(MakeI32Const(PredictionBatchSize()));
   });
+
+  // Create a function to quantize the weights used for
+  // prediction once they are written in the memory
+  if(Int8PredictionWeights()) {
+    module_manager_.MakeFunction("quantize_weights", {}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+      f.Insert(MakeCall(quantize_weights_func_, {}));
+    });
+  }
+
+  // Create a function to prune the weights used for
+  // prediction once they are written in the memory
+  if(SparseLayers()) {
+    module_manager_.MakeFunction("prune_weights", {}, {},
+                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals){
+      f.Insert(MakeCall(prune_weights_func_, {}));
+    });
+  }
+
+  // Create the functions of the helper threads once
+  // the dot products of all the algorithms are generated
+  if(ParallelGemmThreads() > 1) {
+    snippets_.parallel->MakeFunctions();
+  }
 }
 
 bool Model::Validate() {
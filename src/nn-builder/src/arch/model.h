@@ -11,13 +11,31 @@
 #include <src/nn-builder/src/data_structure/ndarray.h>
 #include <src/nn-builder/src/snippet/matrix.h>
 #include <src/nn-builder/src/snippet/analysis.h>
+#include <src/nn-builder/src/snippet/kernel.h>
+#include <src/nn-builder/src/snippet/parallel.h>
 #include <src/nn-builder/src/arch/initializers.h>
+#include <src/nn-builder/src/arch/optimizer.h>
 #include <memory>
 #include <utility>
 
 namespace nn {
 namespace arch {
 
+// Version of the code generator. Increment it whenever
+// a change produces a different bytecode for the same
+// model configuration, so that cached modules are invalidated
+#define NN_CODEGEN_VERSION 11
+
+// Weights blob of a model built with separate weights.
+// All fields are little-endian u32:
+// - magic, version, layout (see Model::WeightsLayout)
+//   and number of regions
+// - offset in the linear memory and byte size of each region
+// The raw f32 of the regions follow the header in order.
+// Blobs are only loaded in models of the same layout
+#define NN_WEIGHTS_BLOB_MAGIC   0x42574e4e // "NNWB"
+#define NN_WEIGHTS_BLOB_VERSION 2
+
 // Specify optional features for the mode
 // Each feature has its corresponding bytecode
 // in model, and it will be injected depending
@@ -32,12 +50,159 @@ struct ModelBytecodeOptions {
   bool gen_forward_profiling            = false;
   bool gen_backward_profiling           = false;
   bool use_simd                         = false;
+
+  // Generate the matrix dot products as functions shared
+  // by all call sites with the same operands shapes, instead
+  // of inlining a specialized copy at each call site
+  bool use_kernel_functions             = false;
+
+  // Generate the forward and backward algorithms of each
+  // layer in a separate function, and call them in sequence
+  // from the algorithm function instead of inlining all layers
+  bool split_layer_functions            = false;
+
+  // Number of threads generating the forward and backward
+  // algorithms functions in parallel. The generated module
+  // is the same for any number of threads, and 0 generates
+  // them in order on the calling thread. Not compatible
+  // with the kernel functions
+  uint32_t codegen_threads              = 0;
+
+  // Number of Wasm instances training the model together on
+  // a shared linear memory imported as Memory.memory. Each
+  // worker runs the forward and backward algorithms on its
+  // own batches with its own arrays, then the gradients of
+  // all workers are averaged into the weights before the
+  // next batches. The training confusion matrix and the
+  // profiling are not supported with more than one worker
+  uint32_t training_workers             = 1;
+
+  // Number of training batches (micro-batches) whose gradients
+  // are accumulated before the weights are updated once, so
+  // that training follows the semantics of a batch K times as
+  // large while the arrays are allocated for a training batch.
+  // The count of accumulated micro-batches is kept across
+  // calls. Not compatible with the training workers
+  uint32_t gradient_accumulation_steps  = 1;
+
+  // Number of threads computing together each dot product
+  // of the forward and backward algorithms in the layers of
+  // at least `parallel_gemm_min_nodes` nodes. The rows of the
+  // product are partitioned between the calling thread and
+  // helper threads running gemm_helper() on a shared linear
+  // memory imported as Memory.memory, so the helpers must run
+  // while training too. With training workers only the
+  // prediction is parallel. Not compatible with the parallel
+  // code generation
+  uint32_t parallel_gemm_threads        = 1;
+  uint32_t parallel_gemm_min_nodes      = 4096;
+
+  // Store the initial weights and biases in passive data
+  // segments instead of active ones. The module memory is
+  // then left empty at instantiation, and the weights are
+  // (re-)initialized by calling init_weights() until the
+  // segments are released by drop_initial_weights().
+  // Always enabled on a shared memory (see Model::PassiveWeights)
+  bool passive_weights                  = false;
+
+  // Number of regions of `training_batches_in_memory` batches
+  // for the training data and labels. With more than one
+  // slot, the slots form a ring buffer: the producer fills
+  // the slot of fill_training_slot() and commits it with
+  // commit_training_slot(batches), while train_training_slot()
+  // trains on the next committed slot and releases it, so the
+  // next data can be prepared while training. The ring state
+  // is accessed atomically when the memory is shared. Not
+  // compatible with the training workers
+  uint32_t training_data_slots          = 1;
+
+  // Generate reserve_training_batches(n), which grows the
+  // memory to hold n training batches (data then labels)
+  // after the static layout and returns their offset, or
+  // -1 if the memory cannot grow. train_reserved_batches()
+  // then trains on them, so a model can keep as many batches
+  // resident as the host affords. Not compatible with a
+  // shared memory, which cannot grow
+  bool growable_training_batches        = false;
+
+  // Number of training samples kept in the memory for
+  // train_epochs(), which trains on several epochs in one
+  // call and shuffles the samples in-module at each epoch.
+  // The results of each epoch are stored for at most
+  // `resident_training_max_epochs` epochs per call.
+  // 0 does not generate train_epochs(). Not compatible
+  // with the training workers
+  uint32_t resident_training_samples    = 0;
+  uint32_t resident_training_max_epochs = 1000;
+
+  // Make predict_batch(n) compute only the first n entries
+  // of the prediction batch when 0 < n < the batch size,
+  // with kernels bounded by n at runtime, so small requests
+  // cost in proportion to their size. Other values of n
+  // predict the whole batch with the regular kernels
+  bool live_prediction_batch            = false;
+
+  // Make train_batches_in_memory(batches, n) train on the
+  // first n entries of each batch when 0 < n < the batch
+  // size: the dot products and sums are bounded by n at
+  // runtime and the gradients are averaged over n. Other
+  // values of n train on the whole batches. Not compatible
+  // with the training workers, gradient accumulation and
+  // the training accuracy, error and confusion matrix
+  bool live_training_batch              = false;
+
+  // Build only the prediction functions and their arrays, for
+  // models deployed to predict with trained weights (imported
+  // or loaded from a weights blob). The training and testing
+  // functions, data, gradients and results are not generated,
+  // so the training and testing options must be disabled
+  bool inference_only                   = false;
+
+  // Do not store the weights and biases in the module. The
+  // initial weights are written in a separate blob instead
+  // (see Model::WeightsBlob) and loaded in the memory before
+  // training or prediction, so the module bytecode and its
+  // compiled code do not change when the weights change.
+  // Not compatible with the passive weights
+  bool separate_weights                 = false;
+
+  // Number of independent v128 accumulators used by
+  // the SIMD reductions (sums over matrices and losses).
+  // Accumulators are always combined in the same order,
+  // so results are reproducible for a given value, and
+  // setting it to 1 reproduces the single accumulator order
+  uint32_t simd_reduction_accumulators  = 4;
+
+  // Store the activations of the hidden layers in the testing
+  // and prediction forward algorithms as bf16 (the upper half
+  // of the f32 values, rounded to nearest even), which halves
+  // their memory and the traffic of the next dot product. The
+  // values are widened to f32 when loaded by the dot product.
+  // The training algorithms and the weights stay in f32. Not
+  // compatible with the live prediction batch and the
+  // parallel dot products
+  bool bf16_activations                 = false;
+
+  // Predict with int8 copies of the weights, quantized per
+  // row with an f32 scale per row (max(abs(row)) / 127).
+  // The rows of the dot product are scaled back before the
+  // bias is added. The f32 weights are kept for training
+  // and are quantized again at the end of each training
+  // function. Weights written directly in the memory must
+  // be quantized by the quantize weights function. Not
+  // compatible with the live prediction batch, the parallel
+  // dot products and the bf16 activations
+  bool int8_prediction_weights          = false;
 };
 
 struct ModelOptions {
   ModelBytecodeOptions bytecode_options;
   builtins::ActivationOptions activation_options;
   WeightDistributionOptions weights_options;
+  // Optimizer updating the weights after each batch.
+  // Optimizers other than SGD keep their states in the
+  // memory and are not compatible with the training workers
+  OptimizerOptions optimizer_options;
 };
 
 struct BuiltinFunctions {
@@ -51,6 +216,8 @@ struct BuiltinFunctions {
 struct SnippetCode {
   snippet::MatrixSnippet* matrix;
   snippet::AnalysisSnippet* analysis;
+  snippet::MatrixKernels* kernels;
+  snippet::ParallelKernels* parallel;
 };
 
 #ifdef WABT_EXPERIMENTAL
@@ -123,29 +290,67 @@ private:
   wasmpp::Memory* training_hits_  = nullptr;
   wasmpp::Memory* testing_hits_   = nullptr;
   wasmpp::Memory* testing_error_  = nullptr;
+  // Powers beta1^t and beta2^t of the Adam optimizer,
+  // then the learning rate corrected for the bias at t
+  wasmpp::Memory* optimizer_state_ = nullptr;
+  // Number of micro-batches accumulated since the last update
+  wasmpp::Memory* accumulated_batches_ = nullptr;
   DenseForwardTimeMembers dense_forward_logging_members_;
   DenseBackwardTimeMembers dense_backward_logging_members_;
 
+  // Training workers members
+  wasmpp::Memory* workers_barrier_  = nullptr;
+  wasmpp::Memory* workers_hits_     = nullptr;
+  wasmpp::Memory* workers_error_    = nullptr;
+
   // Model functions
-  wabt::Var forward_training_func_;
+  // (training functions are indexed by worker)
+  std::vector<wabt::Var> forward_training_funcs_;
   wabt::Var forward_testing_func_;
   wabt::Var forward_prediction_func_;
-  wabt::Var backward_func_;
-  wabt::Var compute_cost_training_func_;
+  std::vector<wabt::Var> backward_funcs_;
+  std::vector<wabt::Var> update_weights_funcs_;
+  wabt::Var update_weights_func_;
+  std::vector<wabt::Var> compute_cost_training_funcs_;
   wabt::Var compute_cost_testing_func_;
   wabt::Var confusion_matrix_training_func_;
   wabt::Var confusion_matrix_testing_func_;
-  wabt::Var count_correct_predictions_training_func_;
+  std::vector<wabt::Var> count_correct_predictions_training_funcs_;
   wabt::Var count_correct_predictions_testing_func_;
+  wabt::Var quantize_weights_func_;
+  wabt::Var prune_weights_func_;
 
   // Training data
   wasmpp::Memory* training_data_batches_;
   wasmpp::Memory* training_labels_batches_;
 
+  // Fill and train slot indices, then the number of
+  // committed batches in each training data slot
+  wasmpp::Memory* training_slots_state_ = nullptr;
+
+  // Begin address of the batches reserved after the
+  // static layout, and the number of reserved batches
+  wasmpp::Memory* reserved_batches_state_ = nullptr;
+
+  // Resident training samples (one row per sample),
+  // their shuffled indices, the state of the shuffling
+  // generator and the results of each epoch
+  wasmpp::Memory* resident_data_        = nullptr;
+  wasmpp::Memory* resident_labels_      = nullptr;
+  wasmpp::Memory* resident_permutation_ = nullptr;
+  wasmpp::Memory* shuffle_state_        = nullptr;
+  wasmpp::Memory* epochs_results_       = nullptr;
+
   // Test data
   wasmpp::Memory* testing_data_batches_;
   wasmpp::Memory* testing_labels_batches_;
 
+  // Linear memory
+  wabt::Var memory_;
+
+  // Initial weights regions of the weights blob
+  std::vector<std::pair<wasmpp::Memory*, std::vector<uint8_t>>> weights_regions_;
+
   // Builtin functions
   BuiltinFunctions builtins_;
 
@@ -173,22 +378,38 @@ private:
   void AllocateMemory();
 
   // Generate neural network algorithms
-  wabt::Var ForwardAlgorithmFunction(uint8_t mode_index);
-  wabt::Var BackwardAlgorithmFunction();
+  wabt::Var ForwardAlgorithmFunction(uint8_t mode_index, uint32_t worker);
+  wabt::Var ForwardColumnsFunction(uint8_t mode_index);
+  wabt::Var BackwardAlgorithmFunction(uint32_t worker);
+  wabt::Var BackwardColumnsFunction();
+  wabt::Var UpdateWeightsFunction(uint32_t worker, uint32_t workers);
   wabt::Var ConfusionMatrixFunction(uint8_t mode_index);
-  wabt::Var CountCorrectPredictionsFunction(uint8_t mode_index);
-  wabt::Var ComputeCostFunction(uint8_t mode_index);
+  wabt::Var CountCorrectPredictionsFunction(uint8_t mode_index, uint32_t worker);
+  wabt::Var ComputeCostFunction(uint8_t mode_index, uint32_t worker);
+  wabt::Var QuantizeWeightsFunction();
+  wabt::Var PruneWeightsFunction();
+  // Update the copies of the weights used for prediction
+  // (called once the training functions change the weights)
+  wabt::ExprList* UpdatePredictionWeights();
 
   // Make functions
   void MakeLayersFunctions();
   void MakeAlgorithmsFunctions();
   void MakeTrainingFunctions();
+  void MakeTrainingWorkersFunctions(uint32_t data_batch_bytes, uint32_t labels_batch_bytes);
+  void MakeTrainingSlotsFunctions(wabt::Var train_batches_at_func, uint32_t data_slot_bytes,
+                                  uint32_t labels_slot_bytes);
+  void MakeReservedBatchesFunctions(wabt::Var train_batches_at_func, uint32_t data_batch_bytes,
+                                    uint32_t labels_batch_bytes);
+  void MakeTrainingEpochsFunctions(wabt::Var train_batches_func, uint32_t data_entry_bytes,
+                                   uint32_t labels_entry_bytes);
   void MakeTestingFunctions();
   void MakePredictionFunctions();
   void MakeData();
 
   // Helper
   void GetInputOutputSize(uint32_t *input_size, uint32_t *output_size);
+  bool SharedMemory() const { return TrainingWorkers() > 1 || ParallelGemmThreads() > 1; }
 public:
   Model(ModelOptions options);
   wasmpp::ModuleManager& ModuleManager() { return module_manager_; }
@@ -201,9 +422,19 @@ public:
              uint32_t prediction_batch_size, builtins::LossFunction loss,
              float l1_regularizer, float l2_regularizer);
 
+  // Separate weights
+  void AddWeightsRegion(wasmpp::Memory* memory, const std::vector<wasmpp::DataEntry>& entries);
+  std::vector<uint8_t> WeightsBlob() const;
+  // 32-bit FNV-1a hash of the offset and byte size of the
+  // weights and bias of each layer (the layout of the
+  // weights blob regions written by any model or loader)
+  uint32_t WeightsLayout() const;
+
   // Members accessors
   wabt::ExprList* SetLearningRate(wabt::ExprList* val);
   wabt::ExprList* GetLearningRate();
+  // Rate applied by the optimizer to the gradients
+  wabt::ExprList* GetOptimizerRate();
   DenseForwardTimeMembers DenseForwardTime() const { return dense_forward_logging_members_; }
   DenseBackwardTimeMembers DenseBackwardTime() const { return dense_backward_logging_members_; }
 
@@ -215,6 +446,30 @@ public:
 #endif
   uint32_t TrainingBatchSize() const { return training_batch_size_; }
   uint32_t TrainingBatchesInMemory() const { return training_batches_in_memory_; }
+  uint32_t TrainingWorkers() const { return options_.bytecode_options.training_workers; }
+  uint32_t ParallelGemmThreads() const { return options_.bytecode_options.parallel_gemm_threads; }
+  bool InferenceOnly() const { return options_.bytecode_options.inference_only; }
+  uint32_t TrainingDataSlots() const { return options_.bytecode_options.training_data_slots; }
+  uint32_t ResidentTrainingSamples() const { return options_.bytecode_options.resident_training_samples; }
+  OptimizerType Optimizer() const { return options_.optimizer_options.type; }
+  uint32_t GradientAccumulationSteps() const { return options_.bytecode_options.gradient_accumulation_steps; }
+  bool Bf16Activations() const { return options_.bytecode_options.bf16_activations; }
+  bool Int8PredictionWeights() const { return options_.bytecode_options.int8_prediction_weights; }
+  // Check if the initial weights are in passive data segments.
+  // A module on a shared memory has no active segments, since
+  // each instance (e.g. of a worker) would apply them again
+  // over the shared weights: its initial weights and state are
+  // written once by init_weights(), unless the weights are separate
+  bool PassiveWeights() const {
+    return options_.bytecode_options.passive_weights || (SharedMemory() && !options_.bytecode_options.separate_weights);
+  }
+  // Check if a layer predicts with block sparse weights
+  bool SparseLayers() const;
+  // Check if the weights are updated by the update weights
+  // function after the backward algorithm instead of in it
+  bool DeferredWeightsUpdate() const {
+    return TrainingWorkers() > 1 || Optimizer() != SGD || GradientAccumulationSteps() > 1;
+  }
   uint32_t TestingBatchSize() const { return testing_batch_size_; }
   uint32_t BatchSzie(uint8_t mode_index) const;
   uint32_t TestingBatchesInMemory() const { return testing_batches_in_memory_; }
@@ -0,0 +1,24 @@
+#include <src/nn-builder/src/arch/optimizer.h>
+#include <cassert>
+
+namespace nn {
+namespace arch {
+
+uint32_t OptimizerStates(OptimizerType type) {
+  switch (type) {
+    case SGD:
+      return 0;
+    case Momentum:
+    case Nesterov:
+    case RMSProp:
+      return 1;
+    case Adam:
+      return 2;
+    default:
+      assert(!"Not implemented!");
+  }
+  return 0;
+}
+
+} // namespace arch
+} // namespace nn
@@ -0,0 +1,45 @@
+#ifndef NN_ARCH_OPTIMIZER_H_
+#define NN_ARCH_OPTIMIZER_H_
+
+#include <cstdint>
+
+namespace nn {
+namespace arch {
+
+enum OptimizerType {
+  // W = W - alpha * dW
+  SGD,
+  // V = beta1 * V + dW
+  // W = W - alpha * V
+  Momentum,
+  // V = beta1 * V + dW
+  // W = W - alpha * (dW + beta1 * V)
+  Nesterov,
+  // S = beta2 * S + (1 - beta2) * dW^2
+  // W = W - alpha * dW / (sqrt(S) + epsilon)
+  RMSProp,
+  // M = beta1 * M + (1 - beta1) * dW
+  // S = beta2 * S + (1 - beta2) * dW^2
+  // W = W - alpha_t * M / (sqrt(S) + epsilon)
+  // where alpha_t = alpha * sqrt(1 - beta2^t) / (1 - beta1^t)
+  Adam,
+  FIRST_OPTIMIZER = SGD,
+  LAST_OPTIMIZER = Adam
+};
+
+struct OptimizerOptions {
+  OptimizerType type = SGD;
+  // Decay of the first moment (the velocity)
+  float beta1 = 0.9;
+  // Decay of the second moment (the squared gradients)
+  float beta2 = 0.999;
+  float epsilon = 1e-7;
+};
+
+// Number of state arrays kept for each parameter array
+uint32_t OptimizerStates(OptimizerType type);
+
+} // namespace arch
+} // namespace nn
+
+#endif
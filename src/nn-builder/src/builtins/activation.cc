@@ -47,6 +47,15 @@ void Activation::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* modu
     auto mul = MakeBinary(Opcode::F32Mul, MakeLocalGet(params[0]), sub);
     f.Insert(mul);
   });
+  if(options_.derivative_from_output) {
+    // - df(x) = y * (1 - y) where y = f(x)
+    sigmoid_.has_output_derivative = true;
+    sigmoid_.output_derivative = module_manager->MakeFunction(nullptr, {{Type::F32}, {Type::F32}}, {}, [&](FuncBody f,
+        std::vector<Var> params, std::vector<Var> locals) {
+      auto sub = MakeBinary(Opcode::F32Sub, MakeF32Const(1), MakeLocalGet(params[0]));
+      f.Insert(MakeBinary(Opcode::F32Mul, MakeLocalGet(params[0]), sub));
+    });
+  }
 
   // ReLU function
   // -  f(x) = x > 0 ? x : 0
@@ -118,6 +127,15 @@ void Activation::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* modu
     f.Insert(GenerateCompoundAssignment(locals[0], Opcode::F32Mul, MakeLocalGet(locals[0])));
     f.Insert(MakeBinary(Opcode::F32Sub, MakeF32Const(1), MakeLocalGet(locals[0])));
   });
+  if(options_.derivative_from_output) {
+    // - df(x) = 1 - y^2 where y = f(x)
+    tanh_.has_output_derivative = true;
+    tanh_.output_derivative = module_manager->MakeFunction(nullptr, {{Type::F32}, {Type::F32}}, {}, [&](FuncBody f,
+        std::vector<Var> params, std::vector<Var> locals) {
+      auto square = MakeBinary(Opcode::F32Mul, MakeLocalGet(params[0]), MakeLocalGet(params[0]));
+      f.Insert(MakeBinary(Opcode::F32Sub, MakeF32Const(1), square));
+    });
+  }
 
   // Linear function
   // -  f(x) = alpha * x
@@ -18,6 +18,10 @@ struct ActivationFunction {
   } type;
   wabt::Var function;
   wabt::Var derivative;
+  // Derivative expressed using the activation output
+  // i.e. df(x) computed from f(x) instead of x
+  bool has_output_derivative = false;
+  wabt::Var output_derivative;
   bool operator==(const ActivationFunction& func) const;
   bool operator!=(const ActivationFunction& func) const;
 };
@@ -25,6 +29,10 @@ struct ActivationOptions {
   float linear_slope = 1;
   float leaky_relu_slope = 0.01;
   float elu_slope = 0.01;
+  // Generate derivatives which can be computed
+  // from the activation output (e.g. sigmoid and tanh)
+  // so that backward propagation does not recompute f(x)
+  bool derivative_from_output = true;
 };
 class Activation : public Builtin {
 private:
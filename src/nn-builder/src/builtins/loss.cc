@@ -22,16 +22,82 @@ void Loss::InitImports(arch::Model* model, wasmpp::ModuleManager* module_manager
   assert(module_manager != nullptr);
 }
 
+// Apply a scalar f32 function on 4 consecutive cells
+// starting at `addr + offset` and pack the results into a v128
+static ExprList* MakeF32X4Call(Var func, Var addr, uint32_t offset) {
+  uint32_t type_size = TypeSize(Type::F32);
+  auto result = MakeUnary(Opcode::F32X4Splat,
+      MakeCall(func, {MakeF32Load(MakeLocalGet(addr), WABT_USE_NATURAL_ALIGNMENT, offset)}));
+  for(uint32_t lane = 1; lane < 4; lane++) {
+    result = MakeF32X4ReplaceLane(result,
+        MakeCall(func, {MakeF32Load(MakeLocalGet(addr), WABT_USE_NATURAL_ALIGNMENT, offset + lane * type_size)}), lane);
+  }
+  return result;
+}
+
+// Compute `begin + (rows * cols * sizeof(f32))`
+static ExprList* MakeEndAddress(Var begin, Var rows, Var cols) {
+  auto rel_addr = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Mul, MakeLocalGet(rows), MakeLocalGet(cols)),
+                             MakeI32Const(TypeShiftLeft(Type::F32)));
+  return MakeBinary(Opcode::I32Add, MakeLocalGet(begin), rel_addr);
+}
+
+// Compute `end - ((end - begin) % stride)`
+static ExprList* MakeSimdEndAddress(Var begin, Var end, uint32_t stride) {
+  auto remainder = MakeBinary(Opcode::I32RemU, MakeBinary(Opcode::I32Sub, MakeLocalGet(end), MakeLocalGet(begin)),
+                              MakeI32Const(stride));
+  return MakeBinary(Opcode::I32Sub, MakeLocalGet(end), remainder);
+}
+
 void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_manager) {
   assert(model != nullptr);
   assert(module_manager != nullptr);
 
+  // The loss is only computed by the training and testing
+  // functions, so the loss functions of an inference only
+  // model are identified by their type only
+  if(model->InferenceOnly()) {
+    mean_squared_error_.type = LossFunction::MSE;
+    sigmoid_cross_entropy_.type = LossFunction::SIGMOID_CE;
+    softmax_cross_entropy_.type = LossFunction::SOFTMAX_CE;
+    return;
+  }
+
+  bool use_simd = model->Options().bytecode_options.use_simd;
+
   // Mean Squared Error function
   // ! Note:  `Y` is matrix of true labels, `Y_Hat` is matrix of predicted values
   // - J(Y, Y_Hat, rows, cols)       : return (1/(|rows|*|cols|)) * SUM((Y_Hat - Y)^2) // TODO Verify 1/|rows| part
   // - dJ(Y, Y_Hat, DST, rows, cols) : DST = Y_Hat - Y
   mean_squared_error_.type = LossFunction::MSE;
-  mean_squared_error_.J = module_manager->MakeFunction(nullptr,
+  mean_squared_error_.J = use_simd ? MeanSquaredErrorJSimd(model, module_manager)
+                                   : MeanSquaredErrorJ(model, module_manager);
+  mean_squared_error_.dJ = use_simd ? MeanSquaredErrorDJSimd(model, module_manager)
+                                    : MeanSquaredErrorDJ(model, module_manager);
+
+  // Sigmoid Cross-Entropy function
+  // ! Note:  `Y` is matrix of true labels, `Y_Hat` is matrix of predicted values
+  // - J(Y, Y_Hat, rows, cols)       : - 1/|cols| * SUM(Y * log(Y_HAT))
+  // - dJ(Y, Y_Hat, DST, rows, cols) : DST =  ((1 - Y) / (1 - Y_Hat)) - (Y / Y_Hat)
+  sigmoid_cross_entropy_.type = LossFunction::SIGMOID_CE;
+  sigmoid_cross_entropy_.J = use_simd ? SigmoidCrossEntropyJSimd(model, module_manager)
+                                      : SigmoidCrossEntropyJ(model, module_manager);
+  sigmoid_cross_entropy_.dJ = use_simd ? SigmoidCrossEntropyDJSimd(model, module_manager)
+                                       : SigmoidCrossEntropyDJ(model, module_manager);
+
+  // Softmax Cross-Entropy function
+  // - J is same as Sigmoid Cross-Entropy function
+  // - dJ is same as Mean Squared Error
+  // Also refer to the backward algorithm to see the full details
+  // of how it's being used.
+  // Reference: deeplearning.ai - Multi-class classification - Training a softmax classifier (C2W3L09)
+  softmax_cross_entropy_.type = LossFunction::SOFTMAX_CE;
+  softmax_cross_entropy_.J = sigmoid_cross_entropy_.J;
+  softmax_cross_entropy_.dJ = mean_squared_error_.dJ;
+}
+
+Var Loss::MeanSquaredErrorJ(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
       {{Type::I32, Type::I32, Type::I32, Type::I32}, {Type::F32}}, {Type::I32, Type::F32, Type::F32},
           [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     auto y_begin = params[0];
@@ -44,9 +110,7 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     auto cost_val = locals[2];
 
     // Compute end of y_hat
-    auto y_hat_end_rel_addr = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Mul, MakeLocalGet(rows), MakeLocalGet(cols)),
-        MakeI32Const(TypeShiftLeft(Type::F32)));
-    f.Insert(MakeLocalSet(y_hat_end, MakeBinary(Opcode::I32Add, MakeLocalGet(y_hat_begin), y_hat_end_rel_addr)));
+    f.Insert(MakeLocalSet(y_hat_end, MakeEndAddress(y_hat_begin, rows, cols)));
     // Element wise iteration
     f.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_end, TypeSize(Type::F32), {}, [&](BlockBody* b){
       auto sub = MakeBinary(Opcode::F32Sub, MakeF32Load(MakeLocalGet(y_hat_begin)), MakeF32Load(MakeLocalGet(y_begin)));
@@ -65,7 +129,10 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     f.Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Mul, scalar));
     f.Insert(MakeLocalGet(cost_val));
   });
-  mean_squared_error_.dJ = module_manager->MakeFunction(nullptr,
+}
+
+Var Loss::MeanSquaredErrorDJ(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
       {{Type::I32, Type::I32, Type::I32, Type::I32, Type::I32}, {}}, {Type::I32},
       [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     auto y_begin = params[0];
@@ -77,9 +144,7 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     auto dst_end = locals[0];
 
     // Compute end of dst
-    auto dst_end_rel_addr = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Mul, MakeLocalGet(rows), MakeLocalGet(cols)),
-        MakeI32Const(TypeShiftLeft(Type::F32)));
-    f.Insert(MakeLocalSet(dst_end, MakeBinary(Opcode::I32Add, MakeLocalGet(dst_begin), dst_end_rel_addr)));
+    f.Insert(MakeLocalSet(dst_end, MakeEndAddress(dst_begin, rows, cols)));
     // Element wise iteration
     f.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_end, TypeSize(Type::F32), {}, [&](BlockBody* b){
       auto sub = MakeBinary(Opcode::F32Sub, MakeF32Load(MakeLocalGet(y_hat_begin)), MakeF32Load(MakeLocalGet(y_begin)));
@@ -89,13 +154,10 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
       b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(TypeSize(Type::F32))));
     }));
   });
+}
 
-  // Sigmoid Cross-Entropy function
-  // ! Note:  `Y` is matrix of true labels, `Y_Hat` is matrix of predicted values
-  // - J(Y, Y_Hat, rows, cols)       : - 1/|cols| * SUM(Y * log(Y_HAT))
-  // - dJ(Y, Y_Hat, DST, rows, cols) : DST =  ((1 - Y) / (1 - Y_Hat)) - (Y / Y_Hat)
-  sigmoid_cross_entropy_.type = LossFunction::SIGMOID_CE;
-  sigmoid_cross_entropy_.J = module_manager->MakeFunction(nullptr,
+Var Loss::SigmoidCrossEntropyJ(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
       {{Type::I32, Type::I32, Type::I32, Type::I32}, {Type::F32}}, {Type::I32, Type::F32, Type::F32},
       [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     auto y_begin = params[0];
@@ -108,9 +170,7 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     auto cost_val = locals[2];
 
     // Compute end of y_hat
-    auto y_hat_end_rel_addr = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Mul, MakeLocalGet(rows), MakeLocalGet(cols)),
-        MakeI32Const(TypeShiftLeft(Type::F32)));
-    f.Insert(MakeLocalSet(y_hat_end, MakeBinary(Opcode::I32Add, MakeLocalGet(y_hat_begin), y_hat_end_rel_addr)));
+    f.Insert(MakeLocalSet(y_hat_end, MakeEndAddress(y_hat_begin, rows, cols)));
     // Element wise iteration
     f.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_end, TypeSize(Type::F32), {}, [&](BlockBody* b){
       auto mul = MakeBinary(Opcode::F32Mul, MakeF32Load(MakeLocalGet(y_begin)),
@@ -124,7 +184,10 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     f.Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Mul, MakeUnary(Opcode::F32Neg, scalar)));
     f.Insert(MakeLocalGet(cost_val));
   });
-  sigmoid_cross_entropy_.dJ = module_manager->MakeFunction(nullptr,
+}
+
+Var Loss::SigmoidCrossEntropyDJ(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
       {{Type::I32, Type::I32, Type::I32, Type::I32, Type::I32}, {}}, {Type::I32},
       [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
     auto y_begin = params[0];
@@ -136,9 +199,7 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
     auto dst_end = locals[0];
 
     // Compute end of dst
-    auto dst_end_rel_addr = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Mul, MakeLocalGet(rows), MakeLocalGet(cols)),
-        MakeI32Const(TypeShiftLeft(Type::F32)));
-    f.Insert(MakeLocalSet(dst_end, MakeBinary(Opcode::I32Add, MakeLocalGet(dst_begin), dst_end_rel_addr)));
+    f.Insert(MakeLocalSet(dst_end, MakeEndAddress(dst_begin, rows, cols)));
     // Element wise iteration
     f.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_end, TypeSize(Type::F32), {}, [&](BlockBody* b){
       auto left_nom = MakeBinary(Opcode::F32Sub, MakeF32Const(1.0f), MakeF32Load(MakeLocalGet(y_begin)));
@@ -152,16 +213,244 @@ void Loss::InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_man
       b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(TypeSize(Type::F32))));
     }));
   });
+}
 
-  // Softmax Cross-Entropy function
-  // - J is same as Sigmoid Cross-Entropy function
-  // - dJ is same as Mean Squared Error
-  // Also refer to the backward algorithm to see the full details
-  // of how it's being used.
-  // Reference: deeplearning.ai - Multi-class classification - Training a softmax classifier (C2W3L09)
-  softmax_cross_entropy_.type = LossFunction::SOFTMAX_CE;
-  softmax_cross_entropy_.J = sigmoid_cross_entropy_.J;
-  softmax_cross_entropy_.dJ = mean_squared_error_.dJ;
+Var Loss::MeanSquaredErrorJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  std::vector<Type> locals_types = {Type::I32, Type::I32, Type::F32, Type::F32, Type::V128};
+  uint32_t accumulators_count = model->Options().bytecode_options.simd_reduction_accumulators;
+  locals_types.insert(locals_types.end(), accumulators_count, Type::V128);
+  return module_manager->MakeFunction(nullptr,
+      {{Type::I32, Type::I32, Type::I32, Type::I32}, {Type::F32}}, locals_types,
+      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    auto y_begin = params[0];
+    auto y_hat_begin = params[1];
+    auto rows = params[2];
+    auto cols = params[3];
+
+    auto y_hat_end = locals[0];
+    auto y_hat_simd_end = locals[1];
+    auto tmp_res = locals[2];
+    auto cost_val = locals[3];
+    auto v128_tmp_res = locals[4];
+    std::vector<Var> accumulators(locals.begin() + 5, locals.end());
+
+    uint32_t type_size = TypeSize(Type::F32);
+    uint32_t simd_type_size = TypeSize(Type::V128);
+    uint32_t simd_stride = simd_type_size * accumulators_count;
+
+    // Compute end of y_hat
+    f.Insert(MakeLocalSet(y_hat_end, MakeEndAddress(y_hat_begin, rows, cols)));
+    f.Insert(MakeLocalSet(y_hat_simd_end, MakeSimdEndAddress(y_hat_begin, y_hat_end, simd_stride)));
+
+    // Use SIMD while possible
+    // Each accumulator has its own dependency chain
+    auto has_simd = MakeBinary(Opcode::I32Ne, MakeLocalGet(y_hat_begin), MakeLocalGet(y_hat_simd_end));
+    f.Insert(MakeIf(f.Label(), has_simd, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_simd_end, simd_stride, {}, [&](BlockBody* b){
+        for(uint32_t i = 0; i < accumulators_count; i++) {
+          auto sub = MakeBinary(Opcode::F32X4Sub,
+              MakeV128Load(MakeLocalGet(y_hat_begin), WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size),
+              MakeV128Load(MakeLocalGet(y_begin), WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size));
+          b->Insert(MakeLocalSet(v128_tmp_res, sub));
+          auto pow = MakeBinary(Opcode::F32X4Mul, MakeLocalGet(v128_tmp_res), MakeLocalGet(v128_tmp_res));
+          b->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, pow));
+        }
+        // Increment address
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(simd_stride)));
+      }));
+    }));
+
+    // Store v128 into f32
+    f.Insert(MakeLocalSet(cost_val, GenerateF32X4AccumulatorsLTRSum(accumulators)));
+
+    // Fallback to regular computation
+    auto has_remainder = MakeBinary(Opcode::I32Ne, MakeLocalGet(y_hat_begin), MakeLocalGet(y_hat_end));
+    f.Insert(MakeIf(f.Label(), has_remainder, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_end, type_size, {}, [&](BlockBody* b){
+        auto sub = MakeBinary(Opcode::F32Sub, MakeF32Load(MakeLocalGet(y_hat_begin)), MakeF32Load(MakeLocalGet(y_begin)));
+        b->Insert(MakeLocalSet(tmp_res, sub));
+        auto pow = MakeBinary(Opcode::F32Mul, MakeLocalGet(tmp_res), MakeLocalGet(tmp_res));
+        b->Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Add, pow));
+        // Increment address
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }));
+
+    // Multiply cost by 1/(rows*cols)
+    auto scalar = MakeBinary(Opcode::F32Div,
+        MakeF32Const(1.0f),
+        MakeBinary(Opcode::F32Mul,
+                   MakeUnary(Opcode::F32ConvertI32U, MakeLocalGet(rows)),
+                   MakeUnary(Opcode::F32ConvertI32U, MakeLocalGet(cols))));
+    f.Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Mul, scalar));
+    f.Insert(MakeLocalGet(cost_val));
+  });
+}
+
+Var Loss::MeanSquaredErrorDJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
+      {{Type::I32, Type::I32, Type::I32, Type::I32, Type::I32}, {}}, {Type::I32, Type::I32},
+      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    auto y_begin = params[0];
+    auto y_hat_begin = params[1];
+    auto dst_begin = params[2];
+    auto rows = params[3];
+    auto cols = params[4];
+
+    auto dst_end = locals[0];
+    auto dst_simd_end = locals[1];
+
+    uint32_t type_size = TypeSize(Type::F32);
+    uint32_t simd_type_size = TypeSize(Type::V128);
+
+    // Compute end of dst
+    f.Insert(MakeLocalSet(dst_end, MakeEndAddress(dst_begin, rows, cols)));
+    f.Insert(MakeLocalSet(dst_simd_end, MakeSimdEndAddress(dst_begin, dst_end, simd_type_size)));
+
+    // Use SIMD while possible
+    auto has_simd = MakeBinary(Opcode::I32Ne, MakeLocalGet(dst_begin), MakeLocalGet(dst_simd_end));
+    f.Insert(MakeIf(f.Label(), has_simd, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_simd_end, simd_type_size, {}, [&](BlockBody* b){
+        auto sub = MakeBinary(Opcode::F32X4Sub, MakeV128Load(MakeLocalGet(y_hat_begin)), MakeV128Load(MakeLocalGet(y_begin)));
+        b->Insert(MakeV128Store(MakeLocalGet(dst_begin), sub));
+        // Increment addresses
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(simd_type_size)));
+        b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(simd_type_size)));
+      }));
+    }));
+
+    // Fallback to regular computation
+    auto has_remainder = MakeBinary(Opcode::I32Ne, MakeLocalGet(dst_begin), MakeLocalGet(dst_end));
+    f.Insert(MakeIf(f.Label(), has_remainder, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_end, type_size, {}, [&](BlockBody* b){
+        auto sub = MakeBinary(Opcode::F32Sub, MakeF32Load(MakeLocalGet(y_hat_begin)), MakeF32Load(MakeLocalGet(y_begin)));
+        b->Insert(MakeF32Store(MakeLocalGet(dst_begin), sub));
+        // Increment addresses
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(type_size)));
+        b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }));
+  });
+}
+
+Var Loss::SigmoidCrossEntropyJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  std::vector<Type> locals_types = {Type::I32, Type::I32, Type::F32};
+  uint32_t accumulators_count = model->Options().bytecode_options.simd_reduction_accumulators;
+  locals_types.insert(locals_types.end(), accumulators_count, Type::V128);
+  return module_manager->MakeFunction(nullptr,
+      {{Type::I32, Type::I32, Type::I32, Type::I32}, {Type::F32}}, locals_types,
+      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    auto y_begin = params[0];
+    auto y_hat_begin = params[1];
+    auto rows = params[2];
+    auto cols = params[3];
+
+    auto y_hat_end = locals[0];
+    auto y_hat_simd_end = locals[1];
+    auto cost_val = locals[2];
+    std::vector<Var> accumulators(locals.begin() + 3, locals.end());
+
+    uint32_t type_size = TypeSize(Type::F32);
+    uint32_t simd_type_size = TypeSize(Type::V128);
+    uint32_t simd_stride = simd_type_size * accumulators_count;
+
+    // Compute end of y_hat
+    f.Insert(MakeLocalSet(y_hat_end, MakeEndAddress(y_hat_begin, rows, cols)));
+    f.Insert(MakeLocalSet(y_hat_simd_end, MakeSimdEndAddress(y_hat_begin, y_hat_end, simd_stride)));
+
+    // Use SIMD while possible
+    // ! Note: log is a scalar import, so it is applied
+    // lane by lane before the vector multiply-accumulate
+    auto has_simd = MakeBinary(Opcode::I32Ne, MakeLocalGet(y_hat_begin), MakeLocalGet(y_hat_simd_end));
+    f.Insert(MakeIf(f.Label(), has_simd, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_simd_end, simd_stride, {}, [&](BlockBody* b){
+        for(uint32_t i = 0; i < accumulators_count; i++) {
+          auto mul = MakeBinary(Opcode::F32X4Mul,
+              MakeV128Load(MakeLocalGet(y_begin), WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size),
+              MakeF32X4Call(model->Builtins().math.Log(), y_hat_begin, i * simd_type_size));
+          b->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, mul));
+        }
+        // Increment address
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(simd_stride)));
+      }));
+    }));
+
+    // Store v128 into f32
+    f.Insert(MakeLocalSet(cost_val, GenerateF32X4AccumulatorsLTRSum(accumulators)));
+
+    // Fallback to regular computation
+    auto has_remainder = MakeBinary(Opcode::I32Ne, MakeLocalGet(y_hat_begin), MakeLocalGet(y_hat_end));
+    f.Insert(MakeIf(f.Label(), has_remainder, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), y_hat_begin, y_hat_end, type_size, {}, [&](BlockBody* b){
+        auto mul = MakeBinary(Opcode::F32Mul, MakeF32Load(MakeLocalGet(y_begin)),
+                              MakeCall(model->Builtins().math.Log(), {MakeF32Load(MakeLocalGet(y_hat_begin))}));
+        b->Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Add, mul));
+        // Increment address
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }));
+
+    // Multiply cost by -1/cols
+    auto scalar = MakeBinary(Opcode::F32Div, MakeF32Const(1.0f),MakeUnary(Opcode::F32ConvertI32U, MakeLocalGet(cols)));
+    f.Insert(GenerateCompoundAssignment(cost_val, Opcode::F32Mul, MakeUnary(Opcode::F32Neg, scalar)));
+    f.Insert(MakeLocalGet(cost_val));
+  });
+}
+
+Var Loss::SigmoidCrossEntropyDJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager) {
+  return module_manager->MakeFunction(nullptr,
+      {{Type::I32, Type::I32, Type::I32, Type::I32, Type::I32}, {}}, {Type::I32, Type::I32},
+      [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    auto y_begin = params[0];
+    auto y_hat_begin = params[1];
+    auto dst_begin = params[2];
+    auto rows = params[3];
+    auto cols = params[4];
+
+    auto dst_end = locals[0];
+    auto dst_simd_end = locals[1];
+
+    uint32_t type_size = TypeSize(Type::F32);
+    uint32_t simd_type_size = TypeSize(Type::V128);
+
+    // Compute end of dst
+    f.Insert(MakeLocalSet(dst_end, MakeEndAddress(dst_begin, rows, cols)));
+    f.Insert(MakeLocalSet(dst_simd_end, MakeSimdEndAddress(dst_begin, dst_end, simd_type_size)));
+
+    // Use SIMD while possible
+    auto has_simd = MakeBinary(Opcode::I32Ne, MakeLocalGet(dst_begin), MakeLocalGet(dst_simd_end));
+    f.Insert(MakeIf(f.Label(), has_simd, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_simd_end, simd_type_size, {}, [&](BlockBody* b){
+        auto one = MakeUnary(Opcode::F32X4Splat, MakeF32Const(1.0f));
+        auto left_nom = MakeBinary(Opcode::F32X4Sub, one, MakeV128Load(MakeLocalGet(y_begin)));
+        one = MakeUnary(Opcode::F32X4Splat, MakeF32Const(1.0f));
+        auto left_den = MakeBinary(Opcode::F32X4Sub, one, MakeV128Load(MakeLocalGet(y_hat_begin)));
+        auto left_div = MakeBinary(Opcode::F32X4Div, left_nom, left_den);
+        auto right_div = MakeBinary(Opcode::F32X4Div, MakeV128Load(MakeLocalGet(y_begin)),
+                                    MakeV128Load(MakeLocalGet(y_hat_begin)));
+        b->Insert(MakeV128Store(MakeLocalGet(dst_begin), MakeBinary(Opcode::F32X4Sub, left_div, right_div)));
+        // Increment addresses
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(simd_type_size)));
+        b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(simd_type_size)));
+      }));
+    }));
+
+    // Fallback to regular computation
+    auto has_remainder = MakeBinary(Opcode::I32Ne, MakeLocalGet(dst_begin), MakeLocalGet(dst_end));
+    f.Insert(MakeIf(f.Label(), has_remainder, {}, [&](BlockBody true_block, Var label) {
+      true_block.Insert(GenerateDoWhileLoop(f.Label(), dst_begin, dst_end, type_size, {}, [&](BlockBody* b){
+        auto left_nom = MakeBinary(Opcode::F32Sub, MakeF32Const(1.0f), MakeF32Load(MakeLocalGet(y_begin)));
+        auto left_den = MakeBinary(Opcode::F32Sub, MakeF32Const(1.0f), MakeF32Load(MakeLocalGet(y_hat_begin)));
+        auto left_div = MakeBinary(Opcode::F32Div, left_nom, left_den);
+        auto right_div = MakeBinary(Opcode::F32Div, MakeF32Load(MakeLocalGet(y_begin)),
+                                    MakeF32Load(MakeLocalGet(y_hat_begin)));
+        b->Insert(MakeF32Store(MakeLocalGet(dst_begin), MakeBinary(Opcode::F32Sub, left_div, right_div)));
+        // Increment addresses
+        b->Insert(GenerateCompoundAssignment(y_begin, Opcode::I32Add, MakeI32Const(type_size)));
+        b->Insert(GenerateCompoundAssignment(y_hat_begin, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }));
+  });
 }
 
 } // namespace builtins
@@ -23,6 +23,18 @@ private:
   LossFunction mean_squared_error_;
   LossFunction sigmoid_cross_entropy_;
   LossFunction softmax_cross_entropy_;
+
+  // Regular definitions
+  wabt::Var MeanSquaredErrorJ(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var MeanSquaredErrorDJ(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var SigmoidCrossEntropyJ(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var SigmoidCrossEntropyDJ(arch::Model* model, wasmpp::ModuleManager* module_manager);
+
+  // SIMD definitions
+  wabt::Var MeanSquaredErrorJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var MeanSquaredErrorDJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var SigmoidCrossEntropyJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager);
+  wabt::Var SigmoidCrossEntropyDJSimd(arch::Model* model, wasmpp::ModuleManager* module_manager);
 public:
   void InitImports(arch::Model* model, wasmpp::ModuleManager* module_manager, std::string module_name) override;
   void InitDefinitions(arch::Model* model, wasmpp::ModuleManager* module_manager) override;
@@ -0,0 +1,31 @@
+#include <src/nn-builder/src/data_structure/sparse.h>
+#include <src/wasmpp/wasm-manager.h>
+#include <algorithm>
+#include <cmath>
+
+namespace nn {
+namespace ds {
+
+BlockSparseNDArray::BlockSparseNDArray(NDArray* values, NDArray* columns, uint32_t cols) {
+  ERROR_UNLESS(values != nullptr, "values cannot be null");
+  ERROR_UNLESS(columns != nullptr, "columns cannot be null");
+  ERROR_UNLESS(values->Shape().size() == 2 && columns->Shape().size() == 2, "values and columns must be 2D matrices");
+  ERROR_UNLESS(cols % SPARSE_BLOCK_WIDTH == 0, "number of columns must be a multiple of the block width");
+  ERROR_UNLESS(values->Shape()[0] == columns->Shape()[0], "values and columns must have the same number of rows");
+  ERROR_UNLESS(values->Shape()[1] == columns->Shape()[1] * SPARSE_BLOCK_WIDTH,
+               "values must hold a block width of values per column");
+  ERROR_UNLESS(values->Shape()[1] <= cols, "cannot keep more blocks than the number of columns");
+  values_ = values;
+  columns_ = columns;
+  cols_ = cols;
+}
+
+uint32_t BlockSparseNDArray::KeptBlocks(uint32_t cols, float sparsity) {
+  ERROR_UNLESS(sparsity >= 0 && sparsity < 1, "sparsity must be between 0 (inclusive) and 1 (exclusive)");
+  uint32_t blocks = cols / SPARSE_BLOCK_WIDTH;
+  uint32_t pruned = (uint32_t) std::floor((double) blocks * sparsity);
+  return std::max<uint32_t>(1, blocks - pruned);
+}
+
+} // namespace ds
+} // namespace nn
@@ -0,0 +1,39 @@
+#ifndef NN_DS_SPARSE_H_
+#define NN_DS_SPARSE_H_
+
+#include <src/nn-builder/src/data_structure/ndarray.h>
+
+namespace nn {
+namespace ds {
+
+// Number of consecutive columns in a block
+const uint32_t SPARSE_BLOCK_WIDTH = 4;
+
+// Matrix pruned by blocks of consecutive columns. Every row
+// keeps the same number of blocks, so the arrays have a fixed
+// size. The blocks of a row are stored in column order as
+// their values (rows x (blocks * block width), f32) and the
+// first column of each block (rows x blocks, i32)
+class BlockSparseNDArray {
+private:
+  NDArray* values_;
+  NDArray* columns_;
+  uint32_t cols_;
+public:
+  BlockSparseNDArray(NDArray* values, NDArray* columns, uint32_t cols);
+  NDArray* Values() const { return values_; }
+  NDArray* Columns() const { return columns_; }
+  uint32_t Rows() const { return columns_->Shape()[0]; }
+  uint32_t Cols() const { return cols_; }
+  // Number of blocks kept per row
+  uint32_t RowBlocks() const { return columns_->Shape()[1]; }
+
+  // Number of blocks kept per row of a matrix with
+  // `cols` columns once a fraction of them is pruned
+  static uint32_t KeptBlocks(uint32_t cols, float sparsity);
+};
+
+} // namespace ds
+} // namespace nn
+
+#endif
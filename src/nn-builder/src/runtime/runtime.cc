@@ -0,0 +1,274 @@
+#include <src/nn-builder/src/runtime/runtime.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace nn {
+namespace runtime {
+
+using namespace wabt;
+using namespace wasmpp;
+
+ModelRuntime::ModelRuntime(arch::Model* model, uint32_t seed) : model_(model), generator_(seed) {
+  assert(model_ != nullptr);
+  ERROR_UNLESS(model_->TrainingWorkers() == 1 && model_->ParallelGemmThreads() == 1,
+               "Models with training workers or parallel GEMM threads import a shared memory "
+               "and cannot run in the in-process runtime");
+  BindSystem("System");
+  BindMath("Math");
+  BindActivation("Activation");
+  BindLoss("Loss");
+  ERROR_UNLESS(runtime_.Instantiate(model_->ModuleManager()), "Failed to instantiate the model");
+  if(model_->PassiveWeights()) {
+    InitWeights();
+  } else if(model_->Options().bytecode_options.separate_weights) {
+    LoadWeightsBlob(model_->WeightsBlob());
+  }
+}
+
+void ModelRuntime::BindSystem(std::string module_name) {
+  for(auto type : {Type::I32, Type::I64, Type::F32, Type::F64}) {
+    runtime_.MakeHostFunction(module_name, "print", {{type}, {}},
+                              [](const interp::TypedValues& args, interp::TypedValues& results) {
+      switch(args[0].type) {
+        case Type::I32: std::cout << args[0].get_i32() << std::endl; break;
+        case Type::I64: std::cout << args[0].get_i64() << std::endl; break;
+        case Type::F32: std::cout << args[0].get_f32() << std::endl; break;
+        case Type::F64: std::cout << args[0].get_f64() << std::endl; break;
+        default: assert(!"Not implemented");
+      }
+    });
+  }
+  runtime_.MakeHostFunction(module_name, "print_table_f32", {{Type::I32, Type::I32, Type::I32}, {}},
+                            [&](const interp::TypedValues& args, interp::TypedValues& results) {
+    float* table = F32Memory(args[0].get_i32());
+    uint32_t rows = args[1].get_i32();
+    uint32_t cols = args[2].get_i32();
+    for(uint32_t row = 0; row < rows; row++) {
+      for(uint32_t col = 0; col < cols; col++) {
+        std::cout << (col == 0 ? "" : "\t") << table[row * cols + col];
+      }
+      std::cout << std::endl;
+    }
+  });
+  runtime_.MakeHostFunction(module_name, "time", {{}, {Type::F64}},
+                            [](const interp::TypedValues& args, interp::TypedValues& results) {
+    // Milliseconds, as returned by Date.getTime() in JS
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    results[0].set_f64(std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(now).count());
+  });
+}
+
+void ModelRuntime::BindMath(std::string module_name) {
+  runtime_.MakeHostFunction(module_name, "exp", {{Type::F32}, {Type::F32}},
+                            [](const interp::TypedValues& args, interp::TypedValues& results) {
+    results[0].set_f32(std::exp(args[0].get_f32()));
+  });
+  runtime_.MakeHostFunction(module_name, "log", {{Type::F32}, {Type::F32}},
+                            [](const interp::TypedValues& args, interp::TypedValues& results) {
+    results[0].set_f32(std::log(args[0].get_f32()));
+  });
+  runtime_.MakeHostFunction(module_name, "random", {{}, {Type::F32}},
+                            [&](const interp::TypedValues& args, interp::TypedValues& results) {
+    std::uniform_real_distribution<float> distribution(0, 1);
+    results[0].set_f32(distribution(generator_));
+  });
+}
+
+void ModelRuntime::BindActivation(std::string module_name) {
+  // Activation functions are all defined in the module
+  // and do not import any function at the moment
+}
+
+void ModelRuntime::BindLoss(std::string module_name) {
+  // Loss functions are all defined in the module
+  // and do not import any function at the moment
+}
+
+uint32_t ModelRuntime::CallI32(std::string name) {
+  auto results = runtime_.Call(name);
+  assert(results.size() == 1 && results[0].type == Type::I32);
+  return results[0].get_i32();
+}
+
+float ModelRuntime::CallF32(std::string name) {
+  auto results = runtime_.Call(name);
+  assert(results.size() == 1 && results[0].type == Type::F32);
+  return results[0].get_f32();
+}
+
+float* ModelRuntime::F32Memory(uint32_t offset) {
+  ERROR_UNLESS(offset < runtime_.MemoryBytes(), "Offset %u out of the linear memory", offset);
+  return reinterpret_cast<float*>(runtime_.Memory() + offset);
+}
+
+void ModelRuntime::UpdatePredictionWeights() {
+  if(model_->Int8PredictionWeights()) {
+    QuantizeWeights();
+  }
+  if(model_->SparseLayers()) {
+    PruneWeights();
+  }
+}
+
+float* ModelRuntime::TrainingData() {
+  return F32Memory(CallI32("training_data_offset"));
+}
+
+float* ModelRuntime::TrainingLabels() {
+  return F32Memory(CallI32("training_labels_offset"));
+}
+
+float* ModelRuntime::TestingData() {
+  return F32Memory(CallI32("testing_data_offset"));
+}
+
+float* ModelRuntime::TestingLabels() {
+  return F32Memory(CallI32("testing_labels_offset"));
+}
+
+float* ModelRuntime::PredictionData() {
+  return F32Memory(CallI32("prediction_data_offset"));
+}
+
+float* ModelRuntime::PredictionResult() {
+  return F32Memory(CallI32("prediction_result_offset"));
+}
+
+void ModelRuntime::SetLearningRate(float learning_rate) {
+  runtime_.Call("set_learning_rate", {Runtime::MakeF32(learning_rate)});
+}
+
+float ModelRuntime::LearningRate() {
+  return CallF32("get_learning_rate");
+}
+
+void ModelRuntime::InitWeights() {
+  ERROR_UNLESS(model_->PassiveWeights(), "The model weights are not passive");
+  runtime_.Call("init_weights");
+}
+
+void ModelRuntime::DropInitialWeights() {
+  ERROR_UNLESS(model_->PassiveWeights(), "The model weights are not passive");
+  runtime_.Call("drop_initial_weights");
+}
+
+void ModelRuntime::QuantizeWeights() {
+  ERROR_UNLESS(model_->Options().bytecode_options.int8_prediction_weights, "The model prediction weights are not int8");
+  runtime_.Call("quantize_weights");
+}
+
+void ModelRuntime::PruneWeights() {
+  ERROR_UNLESS(model_->SparseLayers(), "The model has no sparse layers");
+  runtime_.Call("prune_weights");
+}
+
+std::vector<float> ModelRuntime::ExtractWeights() {
+  std::vector<float> weights;
+  for(uint32_t l = 1; l < model_->Layers().size(); l++) {
+    for(auto array : {"weight", "bias"}) {
+      std::stringstream prefix;
+      prefix << "layer_" << l << "_" << array;
+      float* begin = F32Memory(CallI32(prefix.str() + "_offset"));
+      uint32_t size = CallI32(prefix.str() + "_byte_size") / sizeof(float);
+      weights.insert(weights.end(), begin, begin + size);
+    }
+  }
+  return weights;
+}
+
+void ModelRuntime::ImportWeights(const std::vector<float>& weights) {
+  size_t index = 0;
+  for(uint32_t l = 1; l < model_->Layers().size(); l++) {
+    for(auto array : {"weight", "bias"}) {
+      std::stringstream prefix;
+      prefix << "layer_" << l << "_" << array;
+      float* begin = F32Memory(CallI32(prefix.str() + "_offset"));
+      uint32_t size = CallI32(prefix.str() + "_byte_size") / sizeof(float);
+      ERROR_UNLESS(index + size <= weights.size(), "Not enough weights for layer %u", l);
+      std::copy(weights.begin() + index, weights.begin() + index + size, begin);
+      index += size;
+    }
+  }
+  ERROR_UNLESS(index == weights.size(), "Too many weights for the model");
+  UpdatePredictionWeights();
+}
+
+void ModelRuntime::LoadWeightsBlob(const std::vector<uint8_t>& blob) {
+  auto ReadU32 = [&](size_t offset) {
+    ERROR_UNLESS(offset + 4 <= blob.size(), "Truncated weights blob");
+    uint32_t val = 0;
+    for(int i = 0; i < 4; i++) {
+      val |= (uint32_t) blob[offset + i] << (8 * i);
+    }
+    return val;
+  };
+  ERROR_UNLESS(ReadU32(0) == NN_WEIGHTS_BLOB_MAGIC, "Not a weights blob");
+  ERROR_UNLESS(ReadU32(4) == NN_WEIGHTS_BLOB_VERSION, "Unsupported weights blob version %u", ReadU32(4));
+  ERROR_UNLESS(ReadU32(8) == model_->WeightsLayout(), "Weights blob of a model with a different layout");
+  uint32_t regions = ReadU32(12);
+  size_t data_offset = 16 + 8 * (size_t) regions;
+  for(uint32_t r = 0; r < regions; r++) {
+    uint32_t offset = ReadU32(16 + 8 * r);
+    uint32_t bytes = ReadU32(20 + 8 * r);
+    ERROR_UNLESS(data_offset + bytes <= blob.size(), "Truncated weights blob");
+    ERROR_UNLESS((uint64_t) offset + bytes <= runtime_.MemoryBytes(), "Weights region out of the linear memory");
+    memcpy(runtime_.Memory() + offset, blob.data() + data_offset, bytes);
+    data_offset += bytes;
+  }
+  UpdatePredictionWeights();
+}
+
+void ModelRuntime::TrainBatchesInMemory(uint32_t batches, uint32_t entries) {
+  ERROR_UNLESS(batches <= model_->TrainingBatchesInMemory(), "Only %u training batches fit in memory",
+               model_->TrainingBatchesInMemory());
+  ERROR_UNLESS(entries <= model_->TrainingBatchSize(), "Only %u entries fit in a training batch",
+               model_->TrainingBatchSize());
+  if(model_->Options().bytecode_options.live_training_batch) {
+    runtime_.Call("train_batches_in_memory", {Runtime::MakeI32(batches), Runtime::MakeI32(entries)});
+  } else {
+    ERROR_UNLESS(entries == 0 || entries == model_->TrainingBatchSize(),
+                 "Model was not built with a live training batch");
+    runtime_.Call("train_batches_in_memory", {Runtime::MakeI32(batches)});
+  }
+}
+
+void ModelRuntime::TestBatchesInMemory(uint32_t batches) {
+  ERROR_UNLESS(batches <= model_->TestingBatchesInMemory(), "Only %u testing batches fit in memory",
+               model_->TestingBatchesInMemory());
+  runtime_.Call("test_batches_in_memory", {Runtime::MakeI32(batches)});
+}
+
+void ModelRuntime::PredictBatch(uint32_t entries) {
+  ERROR_UNLESS(entries <= model_->PredictionBatchSize(), "Only %u entries fit in a prediction batch",
+               model_->PredictionBatchSize());
+  if(model_->Options().bytecode_options.live_prediction_batch) {
+    runtime_.Call("predict_batch", {Runtime::MakeI32(entries)});
+  } else {
+    ERROR_UNLESS(entries == 0 || entries == model_->PredictionBatchSize(),
+                 "Model was not built with a live prediction batch");
+    runtime_.Call("predict_batch");
+  }
+}
+
+float ModelRuntime::TrainingBatchesHits() {
+  return CallF32("training_batches_hits");
+}
+
+float ModelRuntime::TrainingBatchesError() {
+  return CallF32("training_batches_error");
+}
+
+float ModelRuntime::TestingBatchesHits() {
+  return CallF32("testing_batches_hits");
+}
+
+float ModelRuntime::TestingBatchesError() {
+  return CallF32("testing_batches_error");
+}
+
+} // namespace runtime
+} // namespace nn
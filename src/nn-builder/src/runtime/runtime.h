@@ -0,0 +1,106 @@
+#ifndef NN_RUNTIME_RUNTIME_H_
+#define NN_RUNTIME_RUNTIME_H_
+
+#include <src/wasmpp/wasm-runtime.h>
+#include <src/nn-builder/src/arch/model.h>
+#include <random>
+
+namespace nn {
+namespace runtime {
+
+// Execute a built model in-process, without a JS engine.
+// The System, Math, Activation and Loss imports are bound
+// to native functions (same behavior as compiled_model.js),
+// and the data, labels and results of the model are accessed
+// in place in the linear memory
+class ModelRuntime {
+private:
+  arch::Model* model_;
+  wasmpp::Runtime runtime_;
+  std::mt19937 generator_;
+
+  // Bind imports of each builtin module
+  void BindSystem(std::string module_name);
+  void BindMath(std::string module_name);
+  void BindActivation(std::string module_name);
+  void BindLoss(std::string module_name);
+
+  // Helpers
+  uint32_t CallI32(std::string name);
+  float CallF32(std::string name);
+  float* F32Memory(uint32_t offset);
+  // Update the copies of the weights used for
+  // prediction once the weights are written
+  void UpdatePredictionWeights();
+public:
+  // The model must be built
+  ModelRuntime(arch::Model* model, uint32_t seed = std::random_device()());
+  wasmpp::Runtime& WasmRuntime() { return runtime_; }
+
+  // Batches in memory. Each batch is stored as a matrix
+  // with one column per entry (e.g. a training batch of
+  // size n of a model with k inputs is a k x n matrix)
+  float* TrainingData();
+  float* TrainingLabels();
+  float* TestingData();
+  float* TestingLabels();
+  float* PredictionData();
+  float* PredictionResult();
+
+  // Learning rate
+  void SetLearningRate(float learning_rate);
+  float LearningRate();
+
+  // Reset the weights to their initial values, or release
+  // their initial values. Only available for models built
+  // with passive weights, which are initialized on creation
+  void InitWeights();
+  void DropInitialWeights();
+
+  // Quantize the weights of a model built with int8
+  // prediction weights. Done by the training functions
+  // and the weights loaders, so only required after the
+  // weights are written directly in the memory
+  void QuantizeWeights();
+
+  // Prune the weights of the sparse layers. Done by the
+  // training functions and the weights loaders, so only
+  // required after the weights are written directly in
+  // the memory
+  void PruneWeights();
+
+  // Copy the weights then the bias of each layer in order
+  // (same layout as ExtractWeights() of compiled_model.js).
+  // The weights used for prediction are updated after import
+  std::vector<float> ExtractWeights();
+  void ImportWeights(const std::vector<float>& weights);
+
+  // Copy the regions of a weights blob in the memory (see
+  // Model::WeightsBlob). Models built with separate weights
+  // are loaded with their initial weights on creation.
+  // The weights used for prediction are updated after
+  // loading the blob
+  void LoadWeightsBlob(const std::vector<uint8_t>& blob);
+
+  // Train and test on the first batches in memory. Models
+  // built with a live training batch can train only on the
+  // first `entries` of each batch
+  void TrainBatchesInMemory(uint32_t batches, uint32_t entries = 0);
+  void TestBatchesInMemory(uint32_t batches);
+
+  // Predict the batch in memory. Models built with a live
+  // prediction batch can predict only its first `entries`
+  void PredictBatch(uint32_t entries = 0);
+
+  // Results of the last batches in memory. Only
+  // available if generated by the bytecode options
+  float TrainingBatchesHits();
+  float TrainingBatchesError();
+  float TestingBatchesHits();
+  float TestingBatchesError();
+};
+
+} // namespace runtime
+} // namespace nn
+
+#endif
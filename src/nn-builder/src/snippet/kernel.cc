@@ -0,0 +1,71 @@
+#include <src/nn-builder/src/snippet/kernel.h>
+#include <sstream>
+
+namespace nn {
+namespace snippet {
+
+using namespace wasmpp;
+using namespace wabt;
+using namespace ds;
+
+wabt::ExprList* MatrixKernels::CallKernel(std::string name, std::vector<RelocMat> operands, wabt::TypeVector locals,
+                                          std::function<wabt::ExprList*(std::vector<RelocMat>,
+                                                                        std::vector<wabt::Var>)> snippet) {
+  // Functions are identified by the snippet
+  // name and the shapes of its operands
+  std::stringstream key;
+  key << name;
+  for(auto operand : operands) {
+    MATRIX_CHECK(operand.Array());
+    key << "_" << operand.Array()->Shape()[0] << "x" << operand.Array()->Shape()[1];
+  }
+
+  auto function = functions_.find(key.str());
+  if(function == functions_.end()) {
+    std::vector<Type> params(operands.size(), Type::I32);
+    auto var = module_manager_->MakeFunction(nullptr, {params, {}}, locals,
+                                             [&](FuncBody f, std::vector<Var> func_params, std::vector<Var> func_locals) {
+      // Operands keep their shapes but
+      // their addresses are read from the params
+      std::vector<RelocMat> params_operands;
+      for(uint32_t i = 0; i < operands.size(); i++) {
+        params_operands.emplace_back(operands[i].Array(), func_params[i]);
+      }
+      f.Insert(snippet(params_operands, func_locals));
+    });
+    function = functions_.emplace(key.str(), var).first;
+  }
+
+  std::vector<wabt::ExprList*> args;
+  for(auto operand : operands) {
+    args.push_back(operand.MakeBegin());
+  }
+  calls_++;
+  return MakeCall(function->second, args);
+}
+
+#define DOT_LOCALS {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, \
+                    use_simd_ ? Type::V128 : Type::I32}
+
+wabt::ExprList* MatrixKernels::MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst) {
+  return CallKernel("dot", {lhs, rhs, dst}, DOT_LOCALS, [&](std::vector<RelocMat> operands, std::vector<Var> locals) {
+    return matrix_->MatrixDot(operands[0], operands[1], operands[2], locals);
+  });
+}
+
+wabt::ExprList* MatrixKernels::MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst) {
+  return CallKernel("dot_lt", {lhs, rhs, dst}, DOT_LOCALS, [&](std::vector<RelocMat> operands, std::vector<Var> locals) {
+    return matrix_->MatrixDotLT(operands[0], operands[1], operands[2], locals);
+  });
+}
+
+wabt::ExprList* MatrixKernels::MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst) {
+  return CallKernel("dot_rt", {lhs, rhs, dst}, DOT_LOCALS, [&](std::vector<RelocMat> operands, std::vector<Var> locals) {
+    return matrix_->MatrixDotRT(operands[0], operands[1], operands[2], locals);
+  });
+}
+
+#undef DOT_LOCALS
+
+} // namespace snippet
+} // namespace nn
@@ -0,0 +1,51 @@
+#ifndef NN_SNIPPET_KERNEL_H_
+#define NN_SNIPPET_KERNEL_H_
+
+#include <src/nn-builder/src/snippet/matrix.h>
+#include <unordered_map>
+
+namespace nn {
+namespace snippet {
+
+// Generate matrix snippets as functions instead of inlining
+// them at each call site. A single function is generated per
+// snippet and operands shapes, and it receives the operands
+// begin addresses as parameters. Call sites with identical
+// shapes (e.g. the same layer in different modes, or layers with
+// the same number of nodes) therefore share the same code
+class MatrixKernels {
+private:
+  wasmpp::ModuleManager* module_manager_;
+  MatrixSnippet* matrix_;
+  bool use_simd_;
+  std::unordered_map<std::string, wabt::Var> functions_;
+  uint32_t calls_ = 0;
+
+  // Call the kernel function of a snippet and create
+  // it if no function exists yet for the operands shapes
+  wabt::ExprList* CallKernel(std::string name, std::vector<RelocMat> operands, wabt::TypeVector locals,
+                             std::function<wabt::ExprList*(std::vector<RelocMat>, std::vector<wabt::Var>)> snippet);
+public:
+  MatrixKernels(wasmpp::ModuleManager* module_manager, MatrixSnippet* matrix, bool use_simd) :
+      module_manager_(module_manager), matrix_(matrix), use_simd_(use_simd) {}
+
+  // Dot product of two matrices
+  wabt::ExprList* MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst);
+
+  // Dot product of two matrices where the left one is treated as transposed
+  wabt::ExprList* MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst);
+
+  // Dot product of two matrices where the right one is treated as transposed
+  wabt::ExprList* MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst);
+
+  // Number of generated kernel functions
+  uint32_t Functions() const { return (uint32_t) functions_.size(); }
+
+  // Number of call sites using a kernel function
+  uint32_t Calls() const { return calls_; }
+};
+
+} // namespace snippet
+} // namespace nn
+
+#endif
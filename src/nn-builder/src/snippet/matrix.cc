@@ -9,13 +9,27 @@ using namespace wasmpp;
 using namespace wabt;
 using namespace ds;
 
-wabt::ExprList* MatrixSnippet::MatrixDot(NDArray* lhs, RelocMat rhs, NDArray* dst, std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
+wabt::ExprList* RelocMat::MakeBegin() const {
+  if(has_begin_var) {
+    return MakeLocalGet(var_);
+  }
+  return MakeI32Const(array_->Memory()->Begin());
+}
+
+wabt::ExprList* RelocMat::MakeEnd() const {
+  if(has_begin_var) {
+    return MakeBinary(Opcode::I32Add, MakeLocalGet(var_), MakeI32Const(array_->Memory()->Bytes()));
+  }
+  return MakeI32Const(array_->Memory()->End());
+}
+
+wabt::ExprList* MatrixSnippet::MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
   MATRIX_CHECK(rhs.Array());
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[0], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
   assert(locals.size() == 7);
 
   auto rhs_col = locals[0];
@@ -27,20 +41,16 @@ wabt::ExprList* MatrixSnippet::MatrixDot(NDArray* lhs, RelocMat rhs, NDArray* ds
   auto used_by_simd = locals[6];
 
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
   uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
   uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
     b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
       b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
-      if(rhs.HasBeginVar()) {
-        b2->Insert(MakeLocalSet(rhs_row_offset, MakeLocalGet(rhs.Var())));
-      } else {
-        b2->Insert(MakeLocalSet(rhs_row_offset, MakeI32Const(rhs.Array()->Memory()->Begin())));
-      }
+      b2->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
       b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b3) {
         auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
         auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
@@ -55,13 +65,22 @@ wabt::ExprList* MatrixSnippet::MatrixDot(NDArray* lhs, RelocMat rhs, NDArray* ds
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixDotLT(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[0] == rhs->Shape()[0], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[1], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs->Shape()[1], "dst and rhs matrices are not compatible");
+wabt::ExprList* MatrixSnippet::MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[1], "dst and lhs matrices are not compatible");
+  return MatrixDotLTRange(lhs, rhs, dst, 0, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixDotLTRange(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t lhs_col_begin,
+                                                std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[0] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(lhs_col_begin + dst.Array()->Shape()[0] <= lhs.Array()->Shape()[1],
+               "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
   assert(locals.size() == 7);
 
   auto lhs_col = locals[0];
@@ -73,16 +92,16 @@ wabt::ExprList* MatrixSnippet::MatrixDotLT(NDArray* lhs, NDArray* rhs, NDArray*
   auto used_by_simd = locals[6];
 
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
-  uint32_t rhs_width_bytes = rhs->Shape()[1] * type_size;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(lhs_col, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+  Merge(e, MakeLocalSet(lhs_col, MakeI32Const(lhs_col_begin * type_size)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
     b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
       b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
-      b2->Insert(MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-      b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs->Memory()->Begin(), rhs->Memory()->End(), rhs_width_bytes, {}, [&](BlockBody* b3) {
+      b2->Insert(MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+      b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs.MakeBegin(), rhs.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b3) {
         auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col)));
         auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
         b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
@@ -96,13 +115,13 @@ wabt::ExprList* MatrixSnippet::MatrixDotLT(NDArray* lhs, NDArray* rhs, NDArray*
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixDotRT(NDArray* lhs, RelocMat rhs, NDArray* dst, std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
+wabt::ExprList* MatrixSnippet::MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
   MATRIX_CHECK(rhs.Array());
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[1] == rhs.Array()->Shape()[1], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[0], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs.Array()->Shape()[0], "dst and rhs matrices are not compatible");
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[1], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[0], "dst and rhs matrices are not compatible");
   assert(locals.size() == 7);
 
   auto rhs_rows = locals[0];
@@ -114,18 +133,14 @@ wabt::ExprList* MatrixSnippet::MatrixDotRT(NDArray* lhs, RelocMat rhs, NDArray*
   auto used_by_simd = locals[6];
 
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
   uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
   uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), rhs_height_bytes, {}, [&](BlockBody* b1) {
-    if(rhs.HasBeginVar()) {
-      b1->Insert(MakeLocalSet(rhs_row_offset, MakeLocalGet(rhs.Var())));
-    } else {
-      b1->Insert(MakeLocalSet(rhs_row_offset, MakeI32Const(rhs.Array()->Memory()->Begin())));
-    }
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_height_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
     b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
       b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
       b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs_width_bytes, type_size, {}, [&](BlockBody* b3) {
@@ -142,85 +157,99 @@ wabt::ExprList* MatrixSnippet::MatrixDotRT(NDArray* lhs, RelocMat rhs, NDArray*
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::ElementWiseBinaryOperation(Opcode op, NDArray* lhs, NDArray* rhs, NDArray* dst,
-                                                          std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
-  MATRIX_CHECK(dst);
-  MATRIX_SAME_SHAPE(lhs, rhs);
-  MATRIX_SAME_SHAPE(rhs, dst);
-  assert(locals.size() == 2);
+namespace {
 
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
+// View of the rows [row_begin, row_end) of a matrix
+NDArray* MatrixRows(NDArray* matrix, uint32_t row_begin, uint32_t row_end) {
+  uint32_t row_bytes = matrix->Shape()[1] * TypeSize(Type::F32);
+  return new NDArray(new wasmpp::Memory(matrix->Begin() + row_begin * row_bytes, matrix->Begin() + row_end * row_bytes),
+                     {row_end - row_begin, matrix->Shape()[1]}, TypeSize(Type::F32));
+}
 
-  uint32_t type_size = TypeSize(Type::F32);
+} // namespace
+
+#define MATRIX_ROWS_CHECK(lhs, dst, row_begin, row_end)                                                          \
+  MATRIX_CHECK(lhs.Array());                                                                                     \
+  MATRIX_CHECK(dst.Array());                                                                                     \
+  ERROR_UNLESS(!lhs.HasBeginVar() && !dst.HasBeginVar(), "lhs and dst matrices cannot have a begin variable"); \
+  ERROR_UNLESS(row_begin < row_end && row_end <= dst.Array()->Shape()[0], "rows range is out of bound");
+
+wabt::ExprList* MatrixSnippet::MatrixDotRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin,
+                                             uint32_t row_end, std::vector<Var> locals) {
+  MATRIX_ROWS_CHECK(lhs, dst, row_begin, row_end)
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  // Rows of dst are computed from the same rows of lhs
+  return MatrixDot(MatrixRows(lhs.Array(), row_begin, row_end), rhs, MatrixRows(dst.Array(), row_begin, row_end),
+                   locals);
+}
 
-  wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
-    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(op, MakeF32Load(lhs_addr), MakeF32Load(rhs_addr))));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
-  }));
-  return e;
+wabt::ExprList* MatrixSnippet::MatrixDotLTRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin,
+                                               uint32_t row_end, std::vector<Var> locals) {
+  MATRIX_ROWS_CHECK(lhs, dst, row_begin, row_end)
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[1], "dst and lhs matrices are not compatible");
+  // Rows of dst are computed from the same columns of lhs
+  return MatrixDotLTRange(lhs, rhs, MatrixRows(dst.Array(), row_begin, row_end), row_begin, locals);
 }
 
-ExprList* MatrixSnippet::ElementWiseBinaryScalarOperation(Opcode op, ds::NDArray *lhs, ds::NDArray *rhs,
-                                                          ds::NDArray *dst, ExprList *scalar, std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
-  MATRIX_CHECK(dst);
-  MATRIX_SAME_SHAPE(lhs, rhs);
-  MATRIX_SAME_SHAPE(rhs, dst);
+wabt::ExprList* MatrixSnippet::MatrixDotRTRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin,
+                                               uint32_t row_end, std::vector<Var> locals) {
+  MATRIX_ROWS_CHECK(lhs, dst, row_begin, row_end)
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  // Rows of dst are computed from the same rows of lhs
+  return MatrixDotRT(MatrixRows(lhs.Array(), row_begin, row_end), rhs, MatrixRows(dst.Array(), row_begin, row_end),
+                     locals);
+}
 
-  assert(locals.size() == 3);
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
-  auto vscalar = locals[2];
+#undef MATRIX_ROWS_CHECK
+
+wabt::ExprList* MatrixSnippet::MatrixDotColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, Var cols_bytes,
+                                                std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 7);
+
+  auto rhs_col = locals[0];
+  auto lhs_col_rhs_rows = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
 
   uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, MakeLocalSet(vscalar, scalar));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
-    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(op, MakeF32Load(lhs_addr),
-                                                              MakeBinary(Opcode::F32Mul,
-                                                                         MakeF32Load(rhs_addr), MakeLocalGet(vscalar)))));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, cols_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+      }));
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
-
-}
-
-wabt::ExprList* MatrixSnippet::MatrixAddition(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
-  return ElementWiseBinaryOperation(Opcode::F32Add, lhs, rhs, dst, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixSubtraction(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
-  return ElementWiseBinaryOperation(Opcode::F32Sub, lhs, rhs, dst, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixMultiplication(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
-  return ElementWiseBinaryOperation(Opcode::F32Mul, lhs, rhs, dst, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixVectorAddition(NDArray* matrix, NDArray* vector, NDArray* dst_matrix,
-                                                    std::vector<Var> locals) {
-  return MatrixVectorBinaryOperation(Opcode::F32Add, matrix, vector, dst_matrix, locals);
 }
 
-wabt::ExprList* MatrixSnippet::MatrixVectorBinaryOperation(Opcode op, NDArray *matrix, NDArray *vector,
-                                                           NDArray *dst_matrix, std::vector<Var> locals) {
+wabt::ExprList* MatrixSnippet::MatrixVectorAdditionColumns(NDArray* matrix, NDArray* vector, NDArray* dst_matrix,
+                                                           Var cols_bytes, std::vector<Var> locals) {
   MATRIX_CHECK(matrix);
   VECTOR_CHECK(vector);
   MATRIX_CHECK(dst_matrix);
   MATRIX_SAME_SHAPE(matrix, dst_matrix);
-
   assert(locals.size() == 4);
 
   auto row = locals[0];
@@ -233,144 +262,140 @@ wabt::ExprList* MatrixSnippet::MatrixVectorBinaryOperation(Opcode op, NDArray *m
 
   wabt::ExprList* e = new wabt::ExprList();
   Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
   Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
-    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, cols_bytes, type_size, {}, [&](BlockBody* b2){
+      b2->Insert(MakeLocalSet(addr, MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col))));
       auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
       auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
-      auto vec_addr = MakeLocalGet(vec_row_offset);
-      auto result = MakeBinary(op, MakeF32Load(mat_addr), MakeF32Load(vec_addr));
+      auto result = MakeBinary(Opcode::F32Add, MakeF32Load(mat_addr), MakeF32Load(MakeLocalGet(vec_row_offset)));
       b2->Insert(MakeF32Store(dst_addr, result));
-      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
     }));
     b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixScalar(NDArray* src, ExprList* scalar, NDArray* dst, std::vector<Var> locals) {
+wabt::ExprList* MatrixSnippet::MatrixActivationColumns(NDArray* src, builtins::ActivationFunction func, NDArray* dst,
+                                                       Var cols_bytes, std::vector<Var> locals) {
   MATRIX_CHECK(src);
   MATRIX_CHECK(dst);
   MATRIX_SAME_SHAPE(src, dst);
-  assert(locals.size() == 3);
+  assert(locals.size() == 2);
 
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
-  auto used_by_simd = locals[2];
+  auto row = locals[0];
+  auto col = locals[1];
 
   uint32_t type_size = TypeSize(Type::F32);
+  uint32_t width_bytes = dst->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-    auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Mul, MakeF32Load(src_addr), scalar)));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst->Memory()->Bytes(), width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, cols_bytes, type_size, {}, [&](BlockBody* b2){
+      auto offset = [&]() {
+        return MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col));
+      };
+      auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), offset());
+      auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst->Memory()->Begin()), offset());
+      b2->Insert(MakeF32Store(dst_addr, MakeCall(func.function, {MakeF32Load(src_addr)})));
+    }));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::ElementWiseFunction(std::vector<RelocMat> args, Var func, NDArray* dst,
-                                                   std::vector<Var> locals) {
-  MATRIX_CHECK(dst);
-  for(auto arg : args) {
-    MATRIX_CHECK(arg.Array());
-    MATRIX_SAME_SHAPE(arg.Array(), dst);
-  }
-  assert(locals.size() == 2);
+wabt::ExprList* MatrixSnippet::MatrixDotLTColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, Var cols_bytes,
+                                                  std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[0] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[1], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 7);
 
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
+  auto lhs_col = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
 
-  std::vector<wabt::ExprList*> args_expr;
   uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {},
-                             [&](BlockBody* b) {
-    for(auto arg : args) {
-      ExprList* arg_addr = nullptr;
-      if(arg.HasBeginVar()) {
-        arg_addr = MakeLocalGet(arg.Var());
-      } else {
-        arg_addr = MakeI32Const(arg.Array()->Memory()->Begin());
-      }
-      args_expr.push_back(MakeF32Load(MakeBinary(Opcode::I32Add, arg_addr, MakeLocalGet(addr))));
-    }
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeCall(func, args_expr)));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  Merge(e, MakeLocalSet(lhs_col, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, cols_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+      b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs.MakeBegin(), rhs.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col)));
+        auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+      }));
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(lhs_col, Opcode::I32Add, MakeI32Const(type_size)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixActivation(RelocMat src, builtins::ActivationFunction func, NDArray* dst,
-                                                std::vector<Var> locals, bool prime) {
-  return ElementWiseFunction({src}, prime ? func.derivative : func.function, dst, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixColumnHardmax(NDArray* src, NDArray* dst, std::vector<Var> locals) {
-  MATRIX_CHECK(src);
-  MATRIX_CHECK(dst);
-  MATRIX_SAME_SHAPE(src, dst);
-  assert(locals.size() == 5);
+wabt::ExprList* MatrixSnippet::MatrixDotRTColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, Var cols_bytes,
+                                                  std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[1], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[0], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 7);
 
-  auto row = locals[0];
-  auto col = locals[1];
-  auto src_max_addr = locals[2];
-  auto dst_max_addr = locals[3];
-  auto curr_addr = locals[4];
+  auto rhs_rows = locals[0];
+  auto lhs_col_rhs_rows = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
 
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t width_bytes = src->Shape()[1] * type_size;
-  uint32_t height_bytes = src->Shape()[0] * width_bytes;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, GenerateRangeLoop(label_manager_, col, 0, width_bytes, type_size, {}, [&](BlockBody* b1) {
-    b1->Insert(MakeLocalSet(src_max_addr, MakeBinary(Opcode::I32Add, MakeI32Const(src->Begin()), MakeLocalGet(col))));
-    b1->Insert(MakeLocalSet(dst_max_addr, MakeBinary(Opcode::I32Add, MakeI32Const(dst->Begin()), MakeLocalGet(col))));
-    // Find max
-    b1->Insert(GenerateRangeLoop(label_manager_, row, 0, height_bytes, width_bytes, {}, [&](BlockBody* b2) {
-      b2->Insert(MakeLocalSet(curr_addr,
-                              MakeBinary(Opcode::I32Add, MakeLocalGet(row),
-                                         MakeBinary(Opcode::I32Add, MakeLocalGet(col), MakeI32Const(src->Begin())))));
-      auto cond = MakeBinary(Opcode::F32Ge, MakeF32Load(MakeLocalGet(curr_addr)), MakeF32Load(MakeLocalGet(src_max_addr)));
-      b2->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
-        t.Insert(MakeLocalSet(src_max_addr, MakeLocalGet(curr_addr)));
-        t.Insert(MakeLocalSet(dst_max_addr,
-                                MakeBinary(Opcode::I32Add, MakeLocalGet(row),
-                                           MakeBinary(Opcode::I32Add, MakeLocalGet(col), MakeI32Const(dst->Begin())))));
-      }));
-    }));
-
-    // Place 1 in max and 0 in rest
-    b1->Insert(GenerateRangeLoop(label_manager_, row, 0, height_bytes, width_bytes, {}, [&](BlockBody* b2) {
-      b2->Insert(MakeLocalSet(curr_addr,
-                              MakeBinary(Opcode::I32Add, MakeLocalGet(row),
-                                         MakeBinary(Opcode::I32Add, MakeLocalGet(col), MakeI32Const(dst->Begin())))));
-      auto cond = MakeBinary(Opcode::I32Eq, MakeLocalGet(curr_addr), MakeLocalGet(dst_max_addr));
-      b2->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
-        t.Insert(MakeF32Store(MakeLocalGet(curr_addr), MakeF32Const(1)));
-      }, [&](BlockBody f) {
-        f.Insert(MakeF32Store(MakeLocalGet(curr_addr), MakeF32Const(0)));
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_height_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, cols_bytes, type_size, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
       }));
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
+      b2->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
     }));
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::ds::NDArray *dst_vector,
-                                                   std::vector<wabt::Var> locals) {
-
+wabt::ExprList* MatrixSnippet::MatrixHorizontalSumColumns(NDArray* matrix, NDArray* dst_vector, Var cols_bytes,
+                                                          std::vector<Var> locals) {
   MATRIX_CHECK(matrix);
   VECTOR_CHECK(dst_vector);
+  ERROR_UNLESS(dst_vector->Shape()[0] == matrix->Shape()[0], "matrix and vector are not compatible");
   assert(locals.size() == 5);
 
   auto mat_row_offset = locals[0];
   auto col = locals[1];
   auto vec_row_offset = locals[2];
   auto res = locals[3];
-  auto used_by_simd = locals[4];
 
   uint32_t type_size = TypeSize(Type::F32);
   uint32_t matrix_width_bytes = matrix->Shape()[1] * type_size;
@@ -379,7 +404,7 @@ wabt::ExprList* MatrixSnippet::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::
   Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(dst_vector->Memory()->Begin())));
   Merge(e, GenerateRangeLoop(label_manager_, mat_row_offset, matrix->Memory()->Begin(), matrix->Memory()->End(), matrix_width_bytes, {}, [&](BlockBody* b1) {
     b1->Insert(MakeLocalSet(res, MakeF32Const(0)));
-    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, matrix_width_bytes, type_size, {}, [&](BlockBody* b2){
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, cols_bytes, type_size, {}, [&](BlockBody* b2){
       auto mat_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(mat_row_offset), MakeLocalGet(col));
       b2->Insert(GenerateCompoundAssignment(res, Opcode::F32Add, MakeF32Load(mat_addr)));
     }));
@@ -389,303 +414,1069 @@ wabt::ExprList* MatrixSnippet::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixAbsSum(nn::ds::NDArray *matrix, wabt::Var result, std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(matrix);
-
+wabt::ExprList* MatrixSnippet::ElementWiseBinaryOperation(Opcode op, NDArray* lhs, NDArray* rhs, NDArray* dst,
+                                                          std::vector<Var> locals) {
+  MATRIX_CHECK(lhs);
+  MATRIX_CHECK(rhs);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(lhs, rhs);
+  MATRIX_SAME_SHAPE(rhs, dst);
   assert(locals.size() == 2);
+
   auto dst_addr = locals[0];
-  auto used_by_simd = locals[1];
+  auto addr = locals[1];
 
   uint32_t type_size = TypeSize(Type::F32);
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(result, MakeF32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->End(), type_size, {}, [&](BlockBody* b){
-    b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeUnary(Opcode::F32Abs, MakeF32Load(MakeLocalGet(dst_addr)))));
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
+    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(op, MakeF32Load(lhs_addr), MakeF32Load(rhs_addr))));
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippet::MatrixSquareSum(nn::ds::NDArray *matrix, wabt::Var result, std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(matrix);
-
-  assert(locals.size() == 3);
-  auto dst_addr = locals[0];
-  auto cache = locals[1];
-  auto used_by_simd = locals[2];
-
-  uint32_t type_size = TypeSize(Type::F32);
-
-  wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(result, MakeF32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->End(), type_size, {}, [&](BlockBody* b){
-    b->Insert(MakeLocalSet(cache, MakeF32Load(MakeLocalGet(dst_addr))));
-    b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeBinary(Opcode::F32Mul,
-                                                                            MakeLocalGet(cache), MakeLocalGet(cache))));
-  }));
-  return e;
-}
-
-wabt::ExprList* MatrixSnippet::MatrixAddRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
-                                                   wabt::ExprList *scalar, std::vector<wabt::Var> locals) {
-  return ElementWiseBinaryScalarOperation(Opcode::F32Add, lhs, rhs, dst, scalar, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixSubRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
-                                                   wabt::ExprList *scalar, std::vector<wabt::Var> locals) {
-  return ElementWiseBinaryScalarOperation(Opcode::F32Sub, lhs, rhs, dst, scalar, locals);
-}
-
-wabt::ExprList* MatrixSnippet::MatrixAddRightSignScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
-                                                       float scale, std::vector<wabt::Var> locals) {
+ExprList* MatrixSnippet::ElementWiseBinaryScalarOperation(Opcode op, ds::NDArray *lhs, ds::NDArray *rhs,
+                                                          ds::NDArray *dst, ExprList *scalar, std::vector<Var> locals) {
   MATRIX_CHECK(lhs);
   MATRIX_CHECK(rhs);
   MATRIX_CHECK(dst);
   MATRIX_SAME_SHAPE(lhs, rhs);
   MATRIX_SAME_SHAPE(rhs, dst);
-  assert(locals.size() == 2);
 
+  assert(locals.size() == 3);
   auto dst_addr = locals[0];
   auto addr = locals[1];
+  auto vscalar = locals[2];
 
   uint32_t type_size = TypeSize(Type::F32);
 
   wabt::ExprList* e = new wabt::ExprList();
   Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, MakeLocalSet(vscalar, scalar));
   Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
     auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
     auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-    // Compute right scale sign addition
-    auto rhs_sign = MakeBinary(Opcode::F32Copysign, MakeF32Const(1), MakeF32Load(rhs_addr));
-    auto rhs_val = MakeBinary(Opcode::F32Mul, rhs_sign, MakeF32Const(scale));
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Add, MakeF32Load(lhs_addr), rhs_val)));
-    // Move to next element
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(op, MakeF32Load(lhs_addr),
+                                                              MakeBinary(Opcode::F32Mul,
+                                                                         MakeF32Load(rhs_addr), MakeLocalGet(vscalar)))));
     b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
   }));
   return e;
+
 }
 
-wabt::ExprList* MatrixSnippet::MatrixAddRightSignScaleAddRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs,
-                                                                    nn::ds::NDArray *dst, float scale1, float scale2,
-                                                                    std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
-  MATRIX_CHECK(dst);
-  MATRIX_SAME_SHAPE(lhs, rhs);
-  MATRIX_SAME_SHAPE(rhs, dst);
-  assert(locals.size() == 4);
+wabt::ExprList* MatrixSnippet::MatrixAddition(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
+  return ElementWiseBinaryOperation(Opcode::F32Add, lhs, rhs, dst, locals);
+}
 
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
-  auto rhs_cache = locals[2];
-  auto used_by_simd = locals[3];
+wabt::ExprList* MatrixSnippet::MatrixSubtraction(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
+  return ElementWiseBinaryOperation(Opcode::F32Sub, lhs, rhs, dst, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixMultiplication(NDArray* lhs, NDArray* rhs, NDArray* dst, std::vector<Var> locals) {
+  return ElementWiseBinaryOperation(Opcode::F32Mul, lhs, rhs, dst, locals);
+}
+
+namespace {
+
+// Widen the bf16 value at an address to f32
+wabt::ExprList* MakeBf16Load(wabt::ExprList* addr) {
+  return MakeUnary(Opcode::F32ReinterpretI32, MakeBinary(Opcode::I32Shl, MakeI32Load16U(addr), MakeI32Const(16)));
+}
+
+} // namespace
+
+wabt::ExprList* MatrixSnippet::MatrixDotBf16(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 8);
+
+  auto lhs_col_rhs_rows = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto used_by_simd_1 = locals[6];
+  auto used_by_simd_2 = locals[7];
 
   uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * BF16_SIZE;
+  uint32_t dst_width_bytes = dst.Array()->Shape()[1] * type_size;
 
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
-    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-    // Cache lhs val
-    b->Insert(MakeLocalSet(rhs_cache, MakeF32Load(rhs_addr)));
-    // Compute right scale sign addition
-    auto rhs_sign = MakeBinary(Opcode::F32Copysign, MakeF32Const(1), MakeLocalGet(rhs_cache));
-    auto rhs_scale1 = MakeBinary(Opcode::F32Mul, rhs_sign, MakeF32Const(scale1));
-    auto rhs_scale2 = MakeBinary(Opcode::F32Mul, MakeLocalGet(rhs_cache), MakeF32Const(scale2));
-    auto rhs_val = MakeBinary(Opcode::F32Add, rhs_scale1, rhs_scale2);
-    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Add, MakeF32Load(lhs_addr), rhs_val)));
-    // Move to next element
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), dst_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, rhs_width_bytes, BF16_SIZE, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, lhs_width_bytes, type_size, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        auto rhs_cell = MakeBf16Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+      }));
+      // A dst column is twice as wide as a rhs column
+      auto dst_col = MakeBinary(Opcode::I32Shl, MakeLocalGet(rhs_col), MakeI32Const(1));
+      b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), dst_col), MakeLocalGet(res_cell)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::ElementWiseBinaryOperation(Opcode op, NDArray *lhs, NDArray *rhs, NDArray *dst,
-                                                              std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
+wabt::ExprList* MatrixSnippet::MatrixNarrowBf16(NDArray* src, NDArray* dst, std::vector<Var> locals) {
+  MATRIX_CHECK(src);
   MATRIX_CHECK(dst);
-  MATRIX_SAME_SHAPE(lhs, rhs);
-  MATRIX_SAME_SHAPE(rhs, dst);
+  MATRIX_SAME_SHAPE(src, dst);
   assert(locals.size() == 2);
 
-  // Cannot optimize
-  if(lhs->Memory()->Bytes() < WASMPP_V128_SIZE) {
-    return MatrixSnippet::ElementWiseBinaryOperation(op, lhs, rhs, dst, locals);
-  }
-
   auto dst_addr = locals[0];
-  auto addr = locals[1];
-
-  uint32_t simd_type_size = TypeSize(Type::V128);
-  auto remainder = dst->Memory()->Bytes() % WASMPP_V128_SIZE;
-  auto dst_simd_end = dst->Memory()->End() - remainder;
+  auto bits = locals[1];
 
-  // Use SIMD while possible
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
-    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
-    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-    b->Insert(MakeV128Store(MakeLocalGet(dst_addr),
-                            MakeBinary(OpcodeToSimdOpcode(op), MakeV128Load(lhs_addr), MakeV128Load(rhs_addr))));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), BF16_SIZE, {},
+                             [&](BlockBody* b) {
+    // An f32 is twice as wide as a bf16
+    auto offset = MakeBinary(Opcode::I32Shl, MakeBinary(Opcode::I32Sub, MakeLocalGet(dst_addr),
+                                                         MakeI32Const(dst->Memory()->Begin())), MakeI32Const(1));
+    auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), offset);
+    b->Insert(MakeLocalSet(bits, MakeUnary(Opcode::I32ReinterpretF32, MakeF32Load(src_addr))));
+
+    // The rounding would carry a NaN payload into the exponent
+    // and give an infinity, so NaN becomes the quiet NaN 0x7FC0
+    auto is_nan = MakeBinary(Opcode::F32Ne, MakeUnary(Opcode::F32ReinterpretI32, MakeLocalGet(bits)),
+                             MakeUnary(Opcode::F32ReinterpretI32, MakeLocalGet(bits)));
+    b->Insert(MakeIf(label_manager_, is_nan, {}, [&](BlockBody t, Var label) {
+      t.Insert(MakeLocalSet(bits, MakeI32Const(0x7FC00000)));
+    }));
+
+    // Round to nearest even then keep the upper half
+    // bits = bits + 0x7FFF + ((bits >> 16) & 1)
+    auto lsb = MakeBinary(Opcode::I32And, MakeBinary(Opcode::I32ShrU, MakeLocalGet(bits), MakeI32Const(16)),
+                          MakeI32Const(1));
+    b->Insert(GenerateCompoundAssignment(bits, Opcode::I32Add, MakeBinary(Opcode::I32Add, MakeI32Const(0x7FFF), lsb)));
+    b->Insert(MakeI32Store16(MakeLocalGet(dst_addr), MakeBinary(Opcode::I32ShrU, MakeLocalGet(bits), MakeI32Const(16))));
   }));
+  return e;
+}
 
-  // Fallback to regular computation
-  if(remainder > 0) {
-    auto type_size = TypeSize(Type::F32);
-    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-      auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
-      auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
-      b->Insert(MakeF32Store(MakeLocalGet(dst_addr),
-                              MakeBinary(op, MakeF32Load(lhs_addr), MakeF32Load(rhs_addr))));
-      b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+namespace {
+
+// Convert the int8 value at an address to f32
+wabt::ExprList* MakeInt8Load(wabt::ExprList* addr) {
+  return MakeUnary(Opcode::F32ConvertI32S, MakeI32Load8S(addr));
+}
+
+} // namespace
+
+wabt::ExprList* MatrixSnippet::MatrixDotInt8(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 8);
+
+  auto lhs_col_rhs_rows = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto used_by_simd_1 = locals[6];
+  auto used_by_simd_2 = locals[7];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * INT8_SIZE;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, lhs_width_bytes, INT8_SIZE, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeInt8Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+      }));
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
     }));
-  }
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+  }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixScalar(nn::ds::NDArray *src, wabt::ExprList *scalar, nn::ds::NDArray *dst,
-                                                std::vector<wabt::Var> locals) {
+wabt::ExprList* MatrixSnippet::MatrixQuantizeRows(NDArray* src, NDArray* dst, NDArray* scales,
+                                                  std::vector<Var> locals) {
   MATRIX_CHECK(src);
   MATRIX_CHECK(dst);
+  VECTOR_CHECK(scales);
   MATRIX_SAME_SHAPE(src, dst);
-  assert(locals.size() == 3);
-
-  // Cannot optimize
-  if(src->Memory()->Bytes() < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixScalar(src, scalar, dst, locals);
-  }
+  ERROR_UNLESS(scales->Shape()[0] == src->Shape()[0], "src and scales matrices are not compatible");
+  assert(locals.size() == 5);
 
-  auto dst_addr = locals[0];
-  auto addr = locals[1];
-  auto scalar_val = locals[2];
+  auto row = locals[0];
+  auto col = locals[1];
+  auto scale_addr = locals[2];
+  auto max = locals[3];
+  auto inv_scale = locals[4];
 
-  uint32_t simd_type_size = TypeSize(Type::V128);
-  auto remainder = dst->Memory()->Bytes() % WASMPP_V128_SIZE;
-  auto dst_simd_end = dst->Memory()->End() - remainder;
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t width_bytes = src->Shape()[1] * type_size;
+  const float int8_max = 127;
+
+  auto src_addr = [&]() {
+    return MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()),
+                      MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col)));
+  };
+  auto dst_addr = [&]() {
+    // An f32 is 4 times as wide as an int8
+    auto offset = MakeBinary(Opcode::I32ShrU, MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col)),
+                             MakeI32Const(2));
+    return MakeBinary(Opcode::I32Add, MakeI32Const(dst->Memory()->Begin()), offset);
+  };
 
-  // Use SIMD while possible
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(scalar_val, scalar));
-  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
-    auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
-    b->Insert(MakeV128Store(MakeLocalGet(dst_addr),
-                            MakeBinary(Opcode::F32X4Mul, MakeV128Load(src_addr),
-                                       MakeUnary(Opcode::F32X4Splat, MakeLocalGet(scalar_val)))));
-    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
-  }));
-
-  // Fallback to regular computation
-  if(remainder > 0) {
-    auto type_size = TypeSize(Type::F32);
-    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
-      auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
-      b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Mul, MakeF32Load(src_addr),
-                                                                MakeLocalGet(scalar_val))));
-      b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  Merge(e, MakeLocalSet(scale_addr, MakeI32Const(scales->Memory()->Begin())));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, src->Memory()->Bytes(), width_bytes, {}, [&](BlockBody* b1) {
+    // Find the max absolute value of the row
+    b1->Insert(MakeLocalSet(max, MakeF32Const(0)));
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, width_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(max, MakeBinary(Opcode::F32Max, MakeLocalGet(max),
+                                              MakeUnary(Opcode::F32Abs, MakeF32Load(src_addr())))));
     }));
-  }
+    b1->Insert(MakeF32Store(MakeLocalGet(scale_addr), MakeBinary(Opcode::F32Div, MakeLocalGet(max),
+                                                                  MakeF32Const(int8_max))));
+
+    // A row of zeros is quantized to zeros
+    b1->Insert(MakeLocalSet(inv_scale, MakeF32Const(0)));
+    auto cond = MakeBinary(Opcode::F32Gt, MakeLocalGet(max), MakeF32Const(0));
+    b1->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
+      t.Insert(MakeLocalSet(inv_scale, MakeBinary(Opcode::F32Div, MakeF32Const(int8_max), MakeLocalGet(max))));
+    }));
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, width_bytes, type_size, {}, [&](BlockBody* b2) {
+      auto quantized = MakeUnary(Opcode::F32Nearest, MakeBinary(Opcode::F32Mul, MakeF32Load(src_addr()),
+                                                                MakeLocalGet(inv_scale)));
+      // A NaN or infinite max leaves the inverse scale to zero
+      // and NaN products, which the saturating conversion
+      // turns into zeros instead of trapping
+      b2->Insert(MakeI32Store8(dst_addr(), MakeUnary(Opcode::I32TruncSatF32S, quantized)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(scale_addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixVectorBinaryOperation(Opcode op, NDArray *matrix, NDArray *vector,
-                                                               NDArray *dst_matrix, std::vector<Var> locals) {
+wabt::ExprList* MatrixSnippet::MatrixVectorScaleAddition(NDArray* matrix, NDArray* scales, NDArray* vector,
+                                                         NDArray* dst_matrix, std::vector<Var> locals) {
   MATRIX_CHECK(matrix);
+  VECTOR_CHECK(scales);
   VECTOR_CHECK(vector);
   MATRIX_CHECK(dst_matrix);
   MATRIX_SAME_SHAPE(matrix, dst_matrix);
-  assert(locals.size() == 4);
+  MATRIX_SAME_SHAPE(scales, vector);
+  ERROR_UNLESS(vector->Shape()[0] == matrix->Shape()[0], "matrix and vector are not compatible");
 
-  uint32_t simd_type_size = TypeSize(Type::V128);
-  uint32_t type_size = TypeSize(Type::F32);
-  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
-  auto width_remainder = dst_width_bytes % WASMPP_V128_SIZE;
-  auto dst_simd_width_bytes = dst_width_bytes - width_remainder;
-
-  // Cannot optimize if matrix width bytes is too small
-  if(dst_width_bytes < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixVectorBinaryOperation(op, matrix, vector, dst_matrix, locals);
-  }
+  assert(locals.size() == 4);
 
   auto row = locals[0];
   auto col = locals[1];
   auto vec_row_offset = locals[2];
   auto addr = locals[3];
 
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
+  // The scales are at the same offset as the vector values
+  uint32_t scales_delta = scales->Memory()->Begin() - vector->Memory()->Begin();
+
   wabt::ExprList* e = new wabt::ExprList();
   Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
   Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
   Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
-
-    // Use SIMD while possible
-    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2){
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
       auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
       auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto scale_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(vec_row_offset), MakeI32Const(scales_delta));
       auto vec_addr = MakeLocalGet(vec_row_offset);
-      auto result = MakeBinary(OpcodeToSimdOpcode(op), MakeV128Load(mat_addr), MakeUnary(Opcode::F32X4Splat, MakeF32Load(vec_addr)));
-      b2->Insert(MakeV128Store(dst_addr, result));
-      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+      auto result = MakeBinary(Opcode::F32Add, MakeBinary(Opcode::F32Mul, MakeF32Load(mat_addr), MakeF32Load(scale_addr)),
+                               MakeF32Load(vec_addr));
+      b2->Insert(MakeF32Store(dst_addr, result));
+      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
     }));
-
-    // Fallback to regular compuation
-    if(width_remainder > 0) {
-      b1->Insert(GenerateDoWhileLoop(label_manager_, col, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
-        auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
-        auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
-        auto vec_addr = MakeLocalGet(vec_row_offset);
-        auto result = MakeBinary(op, MakeF32Load(mat_addr), MakeF32Load(vec_addr));
-        b2->Insert(MakeF32Store(dst_addr, result));
-        b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
-      }));
-    }
-
     b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::ds::NDArray *dst_vector,
-                                                std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(matrix);
-  VECTOR_CHECK(dst_vector);
-  assert(locals.size() == 5);
+namespace {
 
-  uint32_t simd_type_size = TypeSize(Type::V128);
-  uint32_t type_size = TypeSize(Type::F32);
-  uint32_t matrix_width_bytes = matrix->Shape()[1] * type_size;
-  auto width_remainder = matrix_width_bytes % WASMPP_V128_SIZE;
-  auto matrix_simd_width_bytes = matrix_width_bytes - width_remainder;
+// Address of the values of a block, given the offset of the row in the
+// columns array and of the block in the row. The values of a block are
+// SPARSE_BLOCK_WIDTH times as wide as its column
+wabt::ExprList* SparseBlockValues(BlockSparseNDArray* lhs, Var lhs_row_offset, Var block) {
+  auto offset = MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(block));
+  return MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Values()->Memory()->Begin()),
+                    MakeBinary(Opcode::I32Mul, offset, MakeI32Const(SPARSE_BLOCK_WIDTH)));
+}
 
-  // Cannot optimize if matrix width bytes is too small
+// Address of the rhs cell in column `rhs_col` (in bytes) of the
+// row matching the first column of a block
+wabt::ExprList* SparseBlockRhsRow(BlockSparseNDArray* lhs, const RelocMat& rhs, Var lhs_row_offset, Var block,
+                                  Var rhs_col) {
+  auto column_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Columns()->Memory()->Begin()),
+                                MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(block)));
+  auto rhs_width_bytes = rhs.Array()->Shape()[1] * TypeSize(Type::F32);
+  auto row = MakeBinary(Opcode::I32Mul, MakeI32Load(column_addr), MakeI32Const(rhs_width_bytes));
+  return MakeBinary(Opcode::I32Add, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), row), MakeLocalGet(rhs_col));
+}
+
+} // namespace
+
+wabt::ExprList* MatrixSnippet::MatrixPruneBlocks(NDArray* src, BlockSparseNDArray* dst, NDArray* norms,
+                                                 std::vector<Var> locals) {
+  MATRIX_CHECK(src);
+  VECTOR_CHECK(norms);
+  ERROR_UNLESS(dst != nullptr, "dst cannot be null");
+  ERROR_UNLESS(dst->Rows() == src->Shape()[0] && dst->Cols() == src->Shape()[1],
+               "src and dst matrices are not compatible");
+  ERROR_UNLESS(norms->Shape()[0] == src->Shape()[1] / SPARSE_BLOCK_WIDTH, "norms must hold the blocks of a row");
+  assert(locals.size() == 7);
+
+  auto row = locals[0];
+  auto block = locals[1];
+  auto best = locals[2];
+  auto kept = locals[3];
+  auto values_addr = locals[4];
+  auto columns_addr = locals[5];
+  auto best_norm = locals[6];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t width_bytes = src->Shape()[1] * type_size;
+  uint32_t norms_bytes = norms->Memory()->Bytes();
+
+  auto norm_addr = [&]() {
+    return MakeBinary(Opcode::I32Add, MakeI32Const(norms->Memory()->Begin()), MakeLocalGet(block));
+  };
+  // A block is SPARSE_BLOCK_WIDTH times as wide as its norm
+  auto block_addr = [&]() {
+    auto offset = MakeBinary(Opcode::I32Mul, MakeLocalGet(block), MakeI32Const(SPARSE_BLOCK_WIDTH));
+    return MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()),
+                      MakeBinary(Opcode::I32Add, MakeLocalGet(row), offset));
+  };
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(values_addr, MakeI32Const(dst->Values()->Memory()->Begin())));
+  Merge(e, MakeLocalSet(columns_addr, MakeI32Const(dst->Columns()->Memory()->Begin())));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, src->Memory()->Bytes(), width_bytes, {}, [&](BlockBody* b1) {
+    // Sum the absolute values of each block
+    b1->Insert(GenerateRangeLoop(label_manager_, block, 0, norms_bytes, type_size, {}, [&](BlockBody* b2) {
+      wabt::ExprList* norm = nullptr;
+      for(uint32_t lane = 0; lane < SPARSE_BLOCK_WIDTH; lane++) {
+        auto value = MakeUnary(Opcode::F32Abs, MakeF32Load(block_addr(), WABT_USE_NATURAL_ALIGNMENT, lane * type_size));
+        norm = norm == nullptr ? value : MakeBinary(Opcode::F32Add, norm, value);
+      }
+      // A NaN norm is the lowest one
+      b2->Insert(MakeLocalSet(best_norm, norm));
+      auto is_nan = MakeBinary(Opcode::F32Ne, MakeLocalGet(best_norm), MakeLocalGet(best_norm));
+      b2->Insert(MakeIf(label_manager_, is_nan, {}, [&](BlockBody t, Var label) {
+        t.Insert(MakeLocalSet(best_norm, MakeF32Const(-1)));
+      }));
+      b2->Insert(MakeF32Store(norm_addr(), MakeLocalGet(best_norm)));
+    }));
+
+    // Mark the kept blocks with a norm of -2, below the NaN
+    // ones. Each pass picks an unmarked block, so a row keeps
+    // exactly RowBlocks() blocks
+    b1->Insert(GenerateRangeLoop(label_manager_, kept, 0, dst->RowBlocks(), 1, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(best, MakeI32Const(-1)));
+      b2->Insert(GenerateRangeLoop(label_manager_, block, 0, norms_bytes, type_size, {}, [&](BlockBody* b3) {
+        auto unmarked = MakeBinary(Opcode::F32Ne, MakeF32Load(norm_addr()), MakeF32Const(-2));
+        auto better = MakeBinary(Opcode::I32Or, MakeBinary(Opcode::I32LtS, MakeLocalGet(best), MakeI32Const(0)),
+                                 MakeBinary(Opcode::F32Gt, MakeF32Load(norm_addr()), MakeLocalGet(best_norm)));
+        auto cond = MakeBinary(Opcode::I32And, unmarked, better);
+        b3->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
+          t.Insert(MakeLocalSet(best_norm, MakeF32Load(norm_addr())));
+          t.Insert(MakeLocalSet(best, MakeLocalGet(block)));
+        }));
+      }));
+      auto best_addr = MakeBinary(Opcode::I32Add, MakeI32Const(norms->Memory()->Begin()), MakeLocalGet(best));
+      b2->Insert(MakeF32Store(best_addr, MakeF32Const(-2)));
+    }));
+
+    // Copy the kept blocks in column order
+    b1->Insert(GenerateRangeLoop(label_manager_, block, 0, norms_bytes, type_size, {}, [&](BlockBody* b2) {
+      auto cond = MakeBinary(Opcode::F32Eq, MakeF32Load(norm_addr()), MakeF32Const(-2));
+      b2->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
+        for(uint32_t lane = 0; lane < SPARSE_BLOCK_WIDTH; lane++) {
+          t.Insert(MakeF32Store(MakeLocalGet(values_addr),
+                                MakeF32Load(block_addr(), WABT_USE_NATURAL_ALIGNMENT, lane * type_size),
+                                WABT_USE_NATURAL_ALIGNMENT, lane * type_size));
+        }
+        auto column = MakeBinary(Opcode::I32Mul, MakeBinary(Opcode::I32ShrU, MakeLocalGet(block),
+                                                            MakeI32Const(TypeShiftLeft(Type::F32))),
+                                 MakeI32Const(SPARSE_BLOCK_WIDTH));
+        t.Insert(MakeI32Store(MakeLocalGet(columns_addr), column));
+        t.Insert(GenerateCompoundAssignment(values_addr, Opcode::I32Add, MakeI32Const(SPARSE_BLOCK_WIDTH * type_size)));
+        t.Insert(GenerateCompoundAssignment(columns_addr, Opcode::I32Add, MakeI32Const(TypeSize(Type::I32))));
+      }));
+    }));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixDotSparse(BlockSparseNDArray* lhs, RelocMat rhs, RelocMat dst,
+                                               std::vector<Var> locals) {
+  ERROR_UNLESS(lhs != nullptr, "lhs cannot be null");
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs->Cols() == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs->Rows(), "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 7);
+
+  auto block = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto used_by_simd = locals[6];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+  uint32_t row_blocks_bytes = lhs->RowBlocks() * TypeSize(Type::I32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+      b2->Insert(GenerateRangeLoop(label_manager_, block, 0, row_blocks_bytes, TypeSize(Type::I32), {}, [&](BlockBody* b3) {
+        // Set rhs pointer to the row of the first column of the block
+        b3->Insert(MakeLocalSet(rhs_row_offset, SparseBlockRhsRow(lhs, rhs, lhs_row_offset, block, rhs_col)));
+        for(uint32_t lane = 0; lane < SPARSE_BLOCK_WIDTH; lane++) {
+          auto lhs_cell = MakeF32Load(SparseBlockValues(lhs, lhs_row_offset, block), WABT_USE_NATURAL_ALIGNMENT,
+                                      lane * type_size);
+          auto rhs_cell = MakeF32Load(MakeLocalGet(rhs_row_offset), WABT_USE_NATURAL_ALIGNMENT, lane * rhs_width_bytes);
+          b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        }
+      }));
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(row_blocks_bytes)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixVectorAddition(NDArray* matrix, NDArray* vector, NDArray* dst_matrix,
+                                                    std::vector<Var> locals) {
+  return MatrixVectorBinaryOperation(Opcode::F32Add, matrix, vector, dst_matrix, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixVectorBinaryOperation(Opcode op, NDArray *matrix, NDArray *vector,
+                                                           NDArray *dst_matrix, std::vector<Var> locals) {
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(vector);
+  MATRIX_CHECK(dst_matrix);
+  MATRIX_SAME_SHAPE(matrix, dst_matrix);
+
+  assert(locals.size() == 4);
+
+  auto row = locals[0];
+  auto col = locals[1];
+  auto vec_row_offset = locals[2];
+  auto addr = locals[3];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
+      auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto vec_addr = MakeLocalGet(vec_row_offset);
+      auto result = MakeBinary(op, MakeF32Load(mat_addr), MakeF32Load(vec_addr));
+      b2->Insert(MakeF32Store(dst_addr, result));
+      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixScalar(NDArray* src, ExprList* scalar, NDArray* dst, std::vector<Var> locals) {
+  MATRIX_CHECK(src);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(src, dst);
+  assert(locals.size() == 3);
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+  auto used_by_simd = locals[2];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+    auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Mul, MakeF32Load(src_addr), scalar)));
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::ElementWiseFunction(std::vector<RelocMat> args, Var func, NDArray* dst,
+                                                   std::vector<Var> locals) {
+  MATRIX_CHECK(dst);
+  for(auto arg : args) {
+    MATRIX_CHECK(arg.Array());
+    MATRIX_SAME_SHAPE(arg.Array(), dst);
+  }
+  assert(locals.size() == 2);
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+
+  std::vector<wabt::ExprList*> args_expr;
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {},
+                             [&](BlockBody* b) {
+    for(auto arg : args) {
+      args_expr.push_back(MakeF32Load(MakeBinary(Opcode::I32Add, arg.MakeBegin(), MakeLocalGet(addr))));
+    }
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeCall(func, args_expr)));
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixActivation(RelocMat src, builtins::ActivationFunction func, NDArray* dst,
+                                                std::vector<Var> locals, bool prime, bool from_output) {
+  if(from_output) {
+    ERROR_UNLESS(prime, "only the derivative can be computed from the activation output");
+    ERROR_UNLESS(func.has_output_derivative, "activation function derivative cannot be computed from its output");
+    return ElementWiseFunction({src}, func.output_derivative, dst, locals);
+  }
+  return ElementWiseFunction({src}, prime ? func.derivative : func.function, dst, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixColumnHardmax(NDArray* src, NDArray* dst, std::vector<Var> locals) {
+  MATRIX_CHECK(src);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(src, dst);
+  ERROR_UNLESS(src->Begin() != dst->Begin(), "src and dst matrices cannot be the same");
+  assert(locals.size() == 5);
+
+  auto row = locals[0];
+  auto col = locals[1];
+  auto src_max_addr = locals[2];
+  auto dst_max_addr = locals[3];
+  auto curr_addr = locals[4];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t width_bytes = src->Shape()[1] * type_size;
+  uint32_t height_bytes = src->Shape()[0] * width_bytes;
+
+  wabt::ExprList* e = new wabt::ExprList();
+  // Place 0 everywhere, then 1 in the max of each column
+  Merge(e, MakeMemoryFill(MakeI32Const(dst->Begin()), MakeI32Const(0), MakeI32Const(dst->Memory()->Bytes())));
+  Merge(e, GenerateRangeLoop(label_manager_, col, 0, width_bytes, type_size, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(src_max_addr, MakeBinary(Opcode::I32Add, MakeI32Const(src->Begin()), MakeLocalGet(col))));
+    b1->Insert(MakeLocalSet(dst_max_addr, MakeBinary(Opcode::I32Add, MakeI32Const(dst->Begin()), MakeLocalGet(col))));
+    // Find max
+    b1->Insert(GenerateRangeLoop(label_manager_, row, 0, height_bytes, width_bytes, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(curr_addr,
+                              MakeBinary(Opcode::I32Add, MakeLocalGet(row),
+                                         MakeBinary(Opcode::I32Add, MakeLocalGet(col), MakeI32Const(src->Begin())))));
+      auto cond = MakeBinary(Opcode::F32Ge, MakeF32Load(MakeLocalGet(curr_addr)), MakeF32Load(MakeLocalGet(src_max_addr)));
+      b2->Insert(MakeIf(label_manager_, cond, {}, [&](BlockBody t, Var label) {
+        t.Insert(MakeLocalSet(src_max_addr, MakeLocalGet(curr_addr)));
+        t.Insert(MakeLocalSet(dst_max_addr,
+                                MakeBinary(Opcode::I32Add, MakeLocalGet(row),
+                                           MakeBinary(Opcode::I32Add, MakeLocalGet(col), MakeI32Const(dst->Begin())))));
+      }));
+    }));
+
+    b1->Insert(MakeF32Store(MakeLocalGet(dst_max_addr), MakeF32Const(1)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::ds::NDArray *dst_vector,
+                                                   std::vector<wabt::Var> locals) {
+
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(dst_vector);
+  assert(locals.size() == 5);
+
+  auto mat_row_offset = locals[0];
+  auto col = locals[1];
+  auto vec_row_offset = locals[2];
+  auto res = locals[3];
+  auto used_by_simd = locals[4];
+
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t matrix_width_bytes = matrix->Shape()[1] * type_size;
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(dst_vector->Memory()->Begin())));
+  Merge(e, GenerateRangeLoop(label_manager_, mat_row_offset, matrix->Memory()->Begin(), matrix->Memory()->End(), matrix_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(res, MakeF32Const(0)));
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, matrix_width_bytes, type_size, {}, [&](BlockBody* b2){
+      auto mat_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(mat_row_offset), MakeLocalGet(col));
+      b2->Insert(GenerateCompoundAssignment(res, Opcode::F32Add, MakeF32Load(mat_addr)));
+    }));
+    b1->Insert(MakeF32Store(MakeLocalGet(vec_row_offset), MakeLocalGet(res)));
+    b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixAbsSum(nn::ds::NDArray *matrix, wabt::Var result, std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(matrix);
+
+  assert(locals.size() == 2);
+  auto dst_addr = locals[0];
+  auto used_by_simd = locals[1];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(result, MakeF32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->End(), type_size, {}, [&](BlockBody* b){
+    b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeUnary(Opcode::F32Abs, MakeF32Load(MakeLocalGet(dst_addr)))));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixSquareSum(nn::ds::NDArray *matrix, wabt::Var result, std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(matrix);
+
+  assert(locals.size() == 3);
+  auto dst_addr = locals[0];
+  auto cache = locals[1];
+  auto used_by_simd = locals[2];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(result, MakeF32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->End(), type_size, {}, [&](BlockBody* b){
+    b->Insert(MakeLocalSet(cache, MakeF32Load(MakeLocalGet(dst_addr))));
+    b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeBinary(Opcode::F32Mul,
+                                                                            MakeLocalGet(cache), MakeLocalGet(cache))));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixAddRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
+                                                   wabt::ExprList *scalar, std::vector<wabt::Var> locals) {
+  return ElementWiseBinaryScalarOperation(Opcode::F32Add, lhs, rhs, dst, scalar, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixSubRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
+                                                   wabt::ExprList *scalar, std::vector<wabt::Var> locals) {
+  return ElementWiseBinaryScalarOperation(Opcode::F32Sub, lhs, rhs, dst, scalar, locals);
+}
+
+wabt::ExprList* MatrixSnippet::MatrixAddRightSignScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs, nn::ds::NDArray *dst,
+                                                       float scale, std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs);
+  MATRIX_CHECK(rhs);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(lhs, rhs);
+  MATRIX_SAME_SHAPE(rhs, dst);
+  assert(locals.size() == 2);
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
+    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
+    // Compute right scale sign addition
+    auto rhs_sign = MakeBinary(Opcode::F32Copysign, MakeF32Const(1), MakeF32Load(rhs_addr));
+    auto rhs_val = MakeBinary(Opcode::F32Mul, rhs_sign, MakeF32Const(scale));
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Add, MakeF32Load(lhs_addr), rhs_val)));
+    // Move to next element
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippet::MatrixAddRightSignScaleAddRightScale(nn::ds::NDArray *lhs, nn::ds::NDArray *rhs,
+                                                                    nn::ds::NDArray *dst, float scale1, float scale2,
+                                                                    std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs);
+  MATRIX_CHECK(rhs);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(lhs, rhs);
+  MATRIX_SAME_SHAPE(rhs, dst);
+  assert(locals.size() == 4);
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+  auto rhs_cache = locals[2];
+  auto used_by_simd = locals[3];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
+    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
+    // Cache lhs val
+    b->Insert(MakeLocalSet(rhs_cache, MakeF32Load(rhs_addr)));
+    // Compute right scale sign addition
+    auto rhs_sign = MakeBinary(Opcode::F32Copysign, MakeF32Const(1), MakeLocalGet(rhs_cache));
+    auto rhs_scale1 = MakeBinary(Opcode::F32Mul, rhs_sign, MakeF32Const(scale1));
+    auto rhs_scale2 = MakeBinary(Opcode::F32Mul, MakeLocalGet(rhs_cache), MakeF32Const(scale2));
+    auto rhs_val = MakeBinary(Opcode::F32Add, rhs_scale1, rhs_scale2);
+    b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Add, MakeF32Load(lhs_addr), rhs_val)));
+    // Move to next element
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+namespace {
+
+// Update the parameter elements at `addr` bytes from the
+// beginning of the arrays, one f32 or one v128 at a time.
+// The gradient and the new moment are kept in `g` and `m`
+ExprList* OptimizerUpdateElements(const arch::OptimizerOptions& options, NDArray* param, NDArray* grad,
+                                  std::vector<NDArray*> states, Var addr, Var rate, Var g, Var m, bool simd) {
+  auto binary = [&](Opcode op, ExprList* lhs, ExprList* rhs) {
+    return MakeBinary(simd ? OpcodeToSimdOpcode(op) : op, lhs, rhs);
+  };
+  auto value = [&](ExprList* val) {
+    return simd ? MakeUnary(Opcode::F32X4Splat, val) : val;
+  };
+  auto address = [&](NDArray* array) {
+    return MakeBinary(Opcode::I32Add, MakeI32Const(array->Memory()->Begin()), MakeLocalGet(addr));
+  };
+  auto load = [&](NDArray* array) {
+    return simd ? MakeV128Load(address(array)) : MakeF32Load(address(array));
+  };
+  auto store = [&](NDArray* array, ExprList* val) {
+    return simd ? MakeV128Store(address(array), val) : MakeF32Store(address(array), val);
+  };
+  // decay * state + scale * val
+  auto moment = [&](NDArray* state, float decay, float scale, ExprList* val) {
+    auto decayed = binary(Opcode::F32Mul, value(MakeF32Const(decay)), load(state));
+    if(scale != 1) {
+      val = binary(Opcode::F32Mul, value(MakeF32Const(scale)), val);
+    }
+    return binary(Opcode::F32Add, decayed, val);
+  };
+  // val / (sqrt(square) + epsilon)
+  auto normalize = [&](ExprList* val, ExprList* square) {
+    auto root = MakeUnary(simd ? Opcode::F32X4Sqrt : Opcode::F32Sqrt, square);
+    return binary(Opcode::F32Div, val, binary(Opcode::F32Add, root, value(MakeF32Const(options.epsilon))));
+  };
+  auto square = [&](Var var) {
+    return binary(Opcode::F32Mul, MakeLocalGet(var), MakeLocalGet(var));
+  };
+
+  ExprList* e = new ExprList();
+  Merge(e, MakeLocalSet(g, load(grad)));
+  ExprList* step = nullptr;
+  switch (options.type) {
+    case arch::Momentum:
+      Merge(e, MakeLocalSet(m, moment(states[0], options.beta1, 1, MakeLocalGet(g))));
+      Merge(e, store(states[0], MakeLocalGet(m)));
+      step = MakeLocalGet(m);
+      break;
+    case arch::Nesterov:
+      Merge(e, MakeLocalSet(m, moment(states[0], options.beta1, 1, MakeLocalGet(g))));
+      Merge(e, store(states[0], MakeLocalGet(m)));
+      step = binary(Opcode::F32Add, MakeLocalGet(g),
+                    binary(Opcode::F32Mul, value(MakeF32Const(options.beta1)), MakeLocalGet(m)));
+      break;
+    case arch::RMSProp:
+      Merge(e, MakeLocalSet(m, moment(states[0], options.beta2, 1 - options.beta2, square(g))));
+      Merge(e, store(states[0], MakeLocalGet(m)));
+      step = normalize(MakeLocalGet(g), MakeLocalGet(m));
+      break;
+    case arch::Adam:
+      Merge(e, MakeLocalSet(m, moment(states[0], options.beta1, 1 - options.beta1, MakeLocalGet(g))));
+      Merge(e, store(states[0], MakeLocalGet(m)));
+      // The gradient is not used after the second moment
+      Merge(e, MakeLocalSet(g, moment(states[1], options.beta2, 1 - options.beta2, square(g))));
+      Merge(e, store(states[1], MakeLocalGet(g)));
+      step = normalize(MakeLocalGet(m), MakeLocalGet(g));
+      break;
+    default:
+      assert(!"Not implemented!");
+  }
+  // W = W - rate * step
+  Merge(e, store(param, binary(Opcode::F32Sub, load(param),
+                               binary(Opcode::F32Mul, value(MakeLocalGet(rate)), step))));
+  return e;
+}
+
+} // namespace
+
+wabt::ExprList* MatrixSnippet::MatrixOptimizerUpdate(const arch::OptimizerOptions& options, NDArray* param,
+                                                     NDArray* grad, std::vector<NDArray*> states,
+                                                     wabt::ExprList* rate, std::vector<Var> locals) {
+  MATRIX_CHECK(param);
+  MATRIX_CHECK(grad);
+  MATRIX_SAME_SHAPE(param, grad);
+  ERROR_UNLESS(states.size() == arch::OptimizerStates(options.type), "wrong number of optimizer states");
+  for(auto state : states) {
+    MATRIX_CHECK(state);
+    MATRIX_SAME_SHAPE(param, state);
+  }
+  assert(locals.size() == 7);
+  auto param_addr = locals[0];
+  auto addr = locals[1];
+  auto vrate = locals[2];
+  auto g = locals[3];
+  auto m = locals[4];
+
+  uint32_t type_size = TypeSize(Type::F32);
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, MakeLocalSet(vrate, rate));
+  Merge(e, GenerateRangeLoop(label_manager_, param_addr, param->Memory()->Begin(), param->Memory()->End(), type_size,
+                             {}, [&](BlockBody* b) {
+    b->Insert(OptimizerUpdateElements(options, param, grad, states, addr, vrate, g, m, false));
+    // Move to next element
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::ElementWiseBinaryOperation(Opcode op, NDArray *lhs, NDArray *rhs, NDArray *dst,
+                                                              std::vector<Var> locals) {
+  MATRIX_CHECK(lhs);
+  MATRIX_CHECK(rhs);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(lhs, rhs);
+  MATRIX_SAME_SHAPE(rhs, dst);
+  assert(locals.size() == 2);
+
+  // Cannot optimize
+  if(lhs->Memory()->Bytes() < WASMPP_V128_SIZE) {
+    return MatrixSnippet::ElementWiseBinaryOperation(op, lhs, rhs, dst, locals);
+  }
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  auto remainder = dst->Memory()->Bytes() % WASMPP_V128_SIZE;
+  auto dst_simd_end = dst->Memory()->End() - remainder;
+
+  // Use SIMD while possible
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
+    auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
+    auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
+    b->Insert(MakeV128Store(MakeLocalGet(dst_addr),
+                            MakeBinary(OpcodeToSimdOpcode(op), MakeV128Load(lhs_addr), MakeV128Load(rhs_addr))));
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+  }));
+
+  // Fallback to regular computation
+  if(remainder > 0) {
+    auto type_size = TypeSize(Type::F32);
+    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+      auto lhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Memory()->Begin()), MakeLocalGet(addr));
+      auto rhs_addr = MakeBinary(Opcode::I32Add, MakeI32Const(rhs->Memory()->Begin()), MakeLocalGet(addr));
+      b->Insert(MakeF32Store(MakeLocalGet(dst_addr),
+                              MakeBinary(op, MakeF32Load(lhs_addr), MakeF32Load(rhs_addr))));
+      b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+    }));
+  }
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixScalar(nn::ds::NDArray *src, wabt::ExprList *scalar, nn::ds::NDArray *dst,
+                                                std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(src);
+  MATRIX_CHECK(dst);
+  MATRIX_SAME_SHAPE(src, dst);
+  assert(locals.size() == 3);
+
+  // Cannot optimize
+  if(src->Memory()->Bytes() < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixScalar(src, scalar, dst, locals);
+  }
+
+  auto dst_addr = locals[0];
+  auto addr = locals[1];
+  auto scalar_val = locals[2];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  auto remainder = dst->Memory()->Bytes() % WASMPP_V128_SIZE;
+  auto dst_simd_end = dst->Memory()->End() - remainder;
+
+  // Use SIMD while possible
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(scalar_val, scalar));
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, dst->Memory()->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
+    auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
+    b->Insert(MakeV128Store(MakeLocalGet(dst_addr),
+                            MakeBinary(Opcode::F32X4Mul, MakeV128Load(src_addr),
+                                       MakeUnary(Opcode::F32X4Splat, MakeLocalGet(scalar_val)))));
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+  }));
+
+  // Fallback to regular computation
+  if(remainder > 0) {
+    auto type_size = TypeSize(Type::F32);
+    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, dst->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+      auto src_addr = MakeBinary(Opcode::I32Add, MakeI32Const(src->Memory()->Begin()), MakeLocalGet(addr));
+      b->Insert(MakeF32Store(MakeLocalGet(dst_addr), MakeBinary(Opcode::F32Mul, MakeF32Load(src_addr),
+                                                                MakeLocalGet(scalar_val))));
+      b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+    }));
+  }
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixVectorBinaryOperation(Opcode op, NDArray *matrix, NDArray *vector,
+                                                               NDArray *dst_matrix, std::vector<Var> locals) {
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(vector);
+  MATRIX_CHECK(dst_matrix);
+  MATRIX_SAME_SHAPE(matrix, dst_matrix);
+  assert(locals.size() == 4);
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
+  auto width_remainder = dst_width_bytes % WASMPP_V128_SIZE;
+  auto dst_simd_width_bytes = dst_width_bytes - width_remainder;
+
+  // Cannot optimize if matrix width bytes is too small
+  if(dst_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixVectorBinaryOperation(op, matrix, vector, dst_matrix, locals);
+  }
+
+  auto row = locals[0];
+  auto col = locals[1];
+  auto vec_row_offset = locals[2];
+  auto addr = locals[3];
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
+
+    // Use SIMD while possible
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2){
+      auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto vec_addr = MakeLocalGet(vec_row_offset);
+      auto result = MakeBinary(OpcodeToSimdOpcode(op), MakeV128Load(mat_addr), MakeUnary(Opcode::F32X4Splat, MakeF32Load(vec_addr)));
+      b2->Insert(MakeV128Store(dst_addr, result));
+      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+    }));
+
+    // Fallback to regular compuation
+    if(width_remainder > 0) {
+      b1->Insert(GenerateDoWhileLoop(label_manager_, col, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
+        auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto vec_addr = MakeLocalGet(vec_row_offset);
+        auto result = MakeBinary(op, MakeF32Load(mat_addr), MakeF32Load(vec_addr));
+        b2->Insert(MakeF32Store(dst_addr, result));
+        b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }
+
+    b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixHorizontalSum(nn::ds::NDArray *matrix, nn::ds::NDArray *dst_vector,
+                                                std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(dst_vector);
+  assert(locals.size() >= 5);
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t matrix_width_bytes = matrix->Shape()[1] * type_size;
+  auto width_remainder = matrix_width_bytes % WASMPP_V128_SIZE;
+  auto matrix_simd_width_bytes = matrix_width_bytes - width_remainder;
+
+  // Cannot optimize if matrix width bytes is too small
   if(matrix_width_bytes < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixHorizontalSum(matrix, dst_vector, locals);
+    return MatrixSnippet::MatrixHorizontalSum(matrix, dst_vector, {locals[0], locals[1], locals[2], locals[3], locals[4]});
   }
 
   auto mat_row_offset = locals[0];
   auto col = locals[1];
   auto vec_row_offset = locals[2];
   auto res = locals[3];
-  auto res_128 = locals[4];
+  std::vector<Var> accumulators = ReductionAccumulators({locals.begin() + 4, locals.end()}, matrix_width_bytes);
+
+  uint32_t simd_stride = simd_type_size * (uint32_t) accumulators.size();
+  auto matrix_unrolled_width_bytes = matrix_width_bytes - (matrix_width_bytes % simd_stride);
 
   wabt::ExprList* e = new wabt::ExprList();
   Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(dst_vector->Memory()->Begin())));
   Merge(e, GenerateRangeLoop(label_manager_, mat_row_offset, matrix->Memory()->Begin(), matrix->Memory()->End(), matrix_width_bytes, {}, [&](BlockBody* b1) {
-    b1->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+    for(auto &acc : accumulators) {
+      b1->Insert(MakeLocalSet(acc, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+    }
 
     // Use SIMD while possible
-    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, matrix_simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2){
-      auto mat_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(mat_row_offset), MakeLocalGet(col));
-      b2->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeV128Load(mat_addr)));
+    // Interleave independent accumulators
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, matrix_unrolled_width_bytes, simd_stride, {}, [&](BlockBody* b2){
+      for(uint32_t i = 0; i < accumulators.size(); i++) {
+        auto mat_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(mat_row_offset), MakeLocalGet(col));
+        b2->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add,
+                                              MakeV128Load(mat_addr, WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size)));
+      }
     }));
-    b1->Insert(MakeLocalSet(res, GenerateF32X4HorizontalLTRSum(res_128)));
+
+    // Remaining vectors which do not fill all accumulators
+    for(uint32_t offset = matrix_unrolled_width_bytes, i = 0; offset < matrix_simd_width_bytes; offset += simd_type_size, i++) {
+      b1->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add,
+                                            MakeV128Load(MakeLocalGet(mat_row_offset), WABT_USE_NATURAL_ALIGNMENT, offset)));
+    }
+    b1->Insert(MakeLocalSet(res, GenerateF32X4AccumulatorsLTRSum(accumulators)));
 
     // Fallback to regular computation
     if(width_remainder > 0) {
-      b1->Insert(GenerateDoWhileLoop(label_manager_, col, matrix_width_bytes, type_size, {}, [&](BlockBody* b2){
+      b1->Insert(GenerateRangeLoop(label_manager_, col, matrix_simd_width_bytes, matrix_width_bytes, type_size, {}, [&](BlockBody* b2){
         auto mat_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(mat_row_offset), MakeLocalGet(col));
         b2->Insert(GenerateCompoundAssignment(res, Opcode::F32Add, MakeF32Load(mat_addr)));
       }));
@@ -696,18 +1487,220 @@ wabt::ExprList* MatrixSnippetSimd::MatrixHorizontalSum(nn::ds::NDArray *matrix,
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixDotLT(ds::NDArray *lhs, ds::NDArray *rhs, ds::NDArray *dst,
-                                               std::vector<Var> locals) {
-  MATRIX_CHECK(lhs);
-  MATRIX_CHECK(rhs);
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[0] == rhs->Shape()[0], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[1], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs->Shape()[1], "dst and rhs matrices are not compatible");
+std::vector<wabt::Var> MatrixSnippetSimd::ReductionAccumulators(std::vector<wabt::Var> v128_locals, uint32_t bytes) const {
+  ERROR_UNLESS(!v128_locals.empty(), "at least one v128 accumulator is required");
+  // Do not use more accumulators than available vectors
+  uint32_t vectors = bytes / WASMPP_V128_SIZE;
+  if(v128_locals.size() > vectors) {
+    v128_locals.resize(vectors);
+  }
+  return v128_locals;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixDotLTRange(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t lhs_col_begin,
+                                                    std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[0] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(lhs_col_begin + dst.Array()->Shape()[0] <= lhs.Array()->Shape()[1],
+               "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+
+  assert(locals.size() == 7);
+  auto lhs_col = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto res_128 = locals[6];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+  uint32_t width_remainder = rhs_width_bytes % WASMPP_V128_SIZE;
+  uint32_t simd_width_bytes = rhs_width_bytes - width_remainder;
+
+  // Cannot optimize if rhs width bytes is too small
+  if(rhs_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixDotLTRange(lhs, rhs, dst, lhs_col_begin, locals);
+  }
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(lhs_col, MakeI32Const(lhs_col_begin * type_size)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+
+    // Use SIMD while possible
+    // Loop on rhs columns in group of 4
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2) {
+      // Reset lhs pointer to first row and compute the correct column;
+      b2->Insert(MakeLocalSet(lhs_row_offset, MakeBinary(Opcode::I32Add, lhs.MakeBegin(), MakeLocalGet(lhs_col))));
+
+      // Reset result counter
+      b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+      // Loop vertically on a column group
+      b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs.MakeBegin(), rhs.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b3){
+        auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
+        auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+
+        // Compute 4 cells at a time
+        b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
+
+        // Move lhs pointer to next row
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+      }));
+
+      // Store result in destination matrix
+      b2->Insert(MakeV128Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_128)));
+    }));
+
+     if(width_remainder > 0) {
+       // Fallback to regular computation
+       b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_col, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
+         // Reset lhs pointer to first row and compute the correct column;
+         b2->Insert(MakeLocalSet(lhs_row_offset, MakeBinary(Opcode::I32Add, lhs.MakeBegin(), MakeLocalGet(lhs_col))));
+
+         // Reset result counter
+         b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+
+         // Loop vertically on a column
+         b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs.MakeBegin(), rhs.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b3){
+           auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+           auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+
+           // Compute cell
+           b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+
+           // Move lhs pointer to next row
+           b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+         }));
+
+         // Store result in destination matrix
+         b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_cell)));
+       }));
+     }
+
+    // Increment the lhs column counter
+    b1->Insert(GenerateCompoundAssignment(lhs_col, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst,
+                                               std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[1], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[0], "dst and rhs matrices are not compatible");
+  assert(locals.size() == 7);
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+  uint32_t width_remainder = lhs_width_bytes % WASMPP_V128_SIZE;
+  uint32_t simd_width_bytes = lhs_width_bytes - width_remainder;
+
+  auto rhs_rows = locals[0];
+  auto lhs_col_rhs_rows = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto res_128 = locals[6];
+
+  // Handle special case where the number of columns is 1
+  // and rhs has more than 4 elements
+  wabt::ExprList* e = new wabt::ExprList();
+  if(lhs.Array()->Shape()[1] == 1 && rhs_height_bytes >= WASMPP_V128_SIZE) {
+
+    uint32_t height_remainder = rhs_height_bytes % WASMPP_V128_SIZE;
+    uint32_t simd_height_bytes = rhs_height_bytes - height_remainder;
+
+    Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_height_bytes, {}, [&](BlockBody* b1) {
+      // Reset rhs pointer to top row
+      b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+
+      // Apply SIMD while possible
+      b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, simd_height_bytes, simd_type_size, {}, [&](BlockBody* b2) {
+        auto lhs_op = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
+        auto rhs_op = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_rows), MakeLocalGet(rhs_row_offset)));
+        auto dest_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
+        b2->Insert(MakeV128Store(dest_addr, MakeBinary(Opcode::F32X4Mul, lhs_op, rhs_op)));
+      }));
+
+      // Fallback to regular computation
+      if(height_remainder > 0) {
+        b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_rows, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
+          auto lhs_op = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto rhs_op = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_rows), MakeLocalGet(rhs_row_offset)));
+          auto dest_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
+          b2->Insert(MakeF32Store(dest_addr, MakeBinary(Opcode::F32Mul, lhs_op, rhs_op)));
+        }));
+      }
+
+      // Move lhs pointer to next row
+      b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+    }));
+    return e;
+  }
+
+  // Cannot optimize if matrix width bytes is too small
+  if(lhs_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixDotRT(lhs, rhs, dst, locals);
+  }
+
+  // Optimize for large matrices
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_height_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
+      b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+      // Use SIMD while possible
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b3) {
+        auto lhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
+      }));
+      b2->Insert(MakeLocalSet(res_cell, GenerateF32X4HorizontalLTRSum(res_128)));
+
+      // Fallback to regular computation
+      if(width_remainder > 0) {
+        b2->Insert(GenerateDoWhileLoop(label_manager_, lhs_col_rhs_rows, rhs_width_bytes, type_size, {}, [&](BlockBody* b3) {
+          auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+          auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+          b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        }));
+      }
+      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
+      b2->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
+    }));
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst,
+                                             std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
 
   assert(locals.size() == 7);
-  auto lhs_col = locals[0];
-  auto rhs_col = locals[1];
+  auto rhs_col = locals[0];
+  auto lhs_col_rhs_rows = locals[1];
   auto lhs_row_offset = locals[2];
   auto rhs_row_offset = locals[3];
   auto dst_row_offset = locals[4];
@@ -716,208 +1709,440 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDotLT(ds::NDArray *lhs, ds::NDArray *rh
 
   uint32_t simd_type_size = TypeSize(Type::V128);
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
-  uint32_t rhs_width_bytes = rhs->Shape()[1] * type_size;
+  uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
   uint32_t width_remainder = rhs_width_bytes % WASMPP_V128_SIZE;
   uint32_t simd_width_bytes = rhs_width_bytes - width_remainder;
 
-  // Cannot optimize if rhs width bytes is too small
+  // Handle special case where rhs is a vector
+  // and has more than 4 rows
+  if(rhs.Array()->Shape()[1] == 1 && rhs_height_bytes >= WASMPP_V128_SIZE) {
+    uint32_t height_remainder = rhs_height_bytes % WASMPP_V128_SIZE;
+    uint32_t simd_height_bytes = rhs_height_bytes - height_remainder;
+
+    wabt::ExprList* e = new wabt::ExprList();
+    Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), type_size, {}, [&](BlockBody* b1) {
+      // Reset result local
+      b1->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+      // Reset rhs pointer
+      b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
+
+      // Use SIMD while possible
+      b1->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, simd_height_bytes, simd_type_size, {}, [&](BlockBody* b2) {
+        auto lhs_cell = MakeV128Load(MakeLocalGet(lhs_row_offset));
+        auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        b2->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
+        b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(simd_type_size)));
+      }));
+
+      // Compute result
+      b1->Insert(MakeLocalSet(res_cell, GenerateF32X4HorizontalLTRSum(res_128)));
+
+      // Fallback to regular computation
+      if(height_remainder > 0) {
+        b1->Insert(GenerateDoWhileLoop(label_manager_, lhs_col_rhs_rows, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
+          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+          b2->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+          b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+        }));
+      }
+
+      // Store result in destination cell
+      b1->Insert(MakeF32Store(MakeLocalGet(dst_row_offset), MakeLocalGet(res_cell)));
+    }));
+    return e;
+  }
+
+  // Cannot optimize if rhs width is too small
   if(rhs_width_bytes < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixDotLT(lhs, rhs, dst, locals);
+    return MatrixSnippet::MatrixDot(lhs, rhs, dst, locals);
   }
 
+  // Optimize for large matrices
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(lhs_col, MakeI32Const(0)));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Begin(), dst->End(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
 
     // Use SIMD while possible
     // Loop on rhs columns in group of 4
     b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2) {
-      // Reset lhs pointer to first row and compute the correct column;
-      b2->Insert(MakeLocalSet(lhs_row_offset, MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Begin()), MakeLocalGet(lhs_col))));
 
       // Reset result counter
       b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
 
+      // Set rhs pointer to next 4 columns
+      b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
+
       // Loop vertically on a column group
-      b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs->Begin(), rhs->End(), rhs_width_bytes, {}, [&](BlockBody* b3){
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
         auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
-        auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        auto rhs_cell = MakeV128Load(MakeLocalGet(rhs_row_offset));
 
         // Compute 4 cells at a time
         b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
 
-        // Move lhs pointer to next row
-        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+        // Move lhs pointer to next column
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+
+        // Move rhs pointer to next row
+        b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
       }));
 
+      // Reset lhs pointer to beginning of row
+      b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
+
       // Store result in destination matrix
       b2->Insert(MakeV128Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_128)));
     }));
 
-     if(width_remainder > 0) {
-       // Fallback to regular computation
-       b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_col, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
-         // Reset lhs pointer to first row and compute the correct column;
-         b2->Insert(MakeLocalSet(lhs_row_offset, MakeBinary(Opcode::I32Add, MakeI32Const(lhs->Begin()), MakeLocalGet(lhs_col))));
+    if(width_remainder > 0) {
+      // Fallback to regular computation
+      // Loop on remaining rhs columns
+      b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_col, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
 
-         // Reset result counter
-         b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+        // Reset result counter
+        b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
 
-         // Loop vertically on a column
-         b2->Insert(GenerateRangeLoop(label_manager_, rhs_row_offset, rhs->Begin(), rhs->End(), rhs_width_bytes, {}, [&](BlockBody* b3){
-           auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
-           auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(rhs_col)));
+        // Set rhs pointer to next columns
+        b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
 
-           // Compute cell
-           b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+        // Loop vertically on a column
+        b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
+          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto rhs_cell = MakeF32Load(MakeLocalGet(rhs_row_offset));
 
-           // Move lhs pointer to next row
-           b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
-         }));
+          // Compute cell
+          b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
 
-         // Store result in destination matrix
-         b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_cell)));
-       }));
-     }
+          // Move lhs pointer to next column
+          b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
 
-    // Increment the lhs column counter
-    b1->Insert(GenerateCompoundAssignment(lhs_col, Opcode::I32Add, MakeI32Const(type_size)));
+          // Move rhs pointer to next row
+          b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+        }));
+
+        // Reset lhs pointer to beginning of row
+        b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
+
+        // Store result in destination matrix
+        b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_cell)));
+      }));
+    }
+
+    // Move lhs offset to next row
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
+
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixDotRT(nn::ds::NDArray *lhs, nn::snippet::RelocMat rhs, nn::ds::NDArray *dst,
-                                               std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(lhs);
+wabt::ExprList* MatrixSnippetSimd::MatrixDotColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, Var cols_bytes,
+                                                    std::vector<Var> locals) {
+  MATRIX_CHECK(lhs.Array());
   MATRIX_CHECK(rhs.Array());
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[1] == rhs.Array()->Shape()[1], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[0], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs.Array()->Shape()[0], "dst and rhs matrices are not compatible");
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+
   assert(locals.size() == 7);
+  auto rhs_col = locals[0];
+  auto lhs_col_rhs_rows = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto res_128 = locals[6];
 
   uint32_t simd_type_size = TypeSize(Type::V128);
   uint32_t type_size = TypeSize(Type::F32);
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
-  uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
   uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
-  uint32_t width_remainder = lhs_width_bytes % WASMPP_V128_SIZE;
-  uint32_t simd_width_bytes = lhs_width_bytes - width_remainder;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
 
-  auto rhs_rows = locals[0];
-  auto lhs_col_rhs_rows = locals[1];
+  // Cannot optimize if rhs width is too small
+  if(rhs_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixDotColumns(lhs, rhs, dst, cols_bytes, locals);
+  }
+
+  // Bytes of the columns computed in groups of 4
+  auto simd_cols_bytes = [&]() {
+    return MakeBinary(Opcode::I32And, MakeLocalGet(cols_bytes), MakeI32Const(~(WASMPP_V128_SIZE - 1)));
+  };
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(rhs_col, MakeI32Const(0)));
+
+    // Use SIMD while possible
+    // Loop on rhs columns in group of 4
+    b1->Insert(MakeIf(label_manager_, simd_cols_bytes(), {}, [&](BlockBody b2, Var label2) {
+      b2.Insert(GenerateRangeLoop(label_manager_, rhs_col, MakeI32Const(0), simd_cols_bytes(), simd_type_size, {}, [&](BlockBody* b3) {
+
+        // Reset result counter
+        b3->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+        // Set rhs pointer to next 4 columns
+        b3->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
+
+        // Loop vertically on a column group
+        b3->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b4){
+          auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
+          auto rhs_cell = MakeV128Load(MakeLocalGet(rhs_row_offset));
+          b4->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
+          b4->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+          b4->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+        }));
+
+        // Reset lhs pointer to beginning of row
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
+
+        // Store result in destination matrix
+        b3->Insert(MakeV128Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_128)));
+      }));
+    }));
+
+    // Fallback to regular computation
+    // Loop on remaining columns
+    auto remaining = MakeBinary(Opcode::I32Ne, MakeLocalGet(rhs_col), MakeLocalGet(cols_bytes));
+    b1->Insert(MakeIf(label_manager_, remaining, {}, [&](BlockBody b2, Var label2) {
+      b2.Insert(GenerateDoWhileLoop(label_manager_, rhs_col, cols_bytes, type_size, {}, [&](BlockBody* b3) {
+        b3->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+        b3->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
+        b3->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b4){
+          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto rhs_cell = MakeF32Load(MakeLocalGet(rhs_row_offset));
+          b4->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+          b4->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+          b4->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
+        }));
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
+        b3->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_cell)));
+      }));
+    }));
+
+    // Move lhs offset to next row
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixVectorAdditionColumns(NDArray* matrix, NDArray* vector, NDArray* dst_matrix,
+                                                               Var cols_bytes, std::vector<Var> locals) {
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(vector);
+  MATRIX_CHECK(dst_matrix);
+  MATRIX_SAME_SHAPE(matrix, dst_matrix);
+  assert(locals.size() == 4);
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
+
+  // Cannot optimize if matrix width bytes is too small
+  if(dst_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixVectorAdditionColumns(matrix, vector, dst_matrix, cols_bytes, locals);
+  }
+
+  auto row = locals[0];
+  auto col = locals[1];
+  auto vec_row_offset = locals[2];
+  auto addr = locals[3];
+
+  // Bytes of the columns computed in groups of 4
+  auto simd_cols_bytes = [&]() {
+    return MakeBinary(Opcode::I32And, MakeLocalGet(cols_bytes), MakeI32Const(~(WASMPP_V128_SIZE - 1)));
+  };
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
+    b1->Insert(MakeLocalSet(col, MakeI32Const(0)));
+
+    // Use SIMD while possible
+    b1->Insert(MakeIf(label_manager_, simd_cols_bytes(), {}, [&](BlockBody b2, Var label2) {
+      b2.Insert(GenerateRangeLoop(label_manager_, col, MakeI32Const(0), simd_cols_bytes(), simd_type_size, {}, [&](BlockBody* b3){
+        b3->Insert(MakeLocalSet(addr, MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col))));
+        auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto vec_value = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(vec_row_offset)));
+        b3->Insert(MakeV128Store(dst_addr, MakeBinary(Opcode::F32X4Add, MakeV128Load(mat_addr), vec_value)));
+      }));
+    }));
+
+    // Fallback to regular computation
+    auto remaining = MakeBinary(Opcode::I32Ne, MakeLocalGet(col), MakeLocalGet(cols_bytes));
+    b1->Insert(MakeIf(label_manager_, remaining, {}, [&](BlockBody b2, Var label2) {
+      b2.Insert(GenerateDoWhileLoop(label_manager_, col, cols_bytes, type_size, {}, [&](BlockBody* b3){
+        b3->Insert(MakeLocalSet(addr, MakeBinary(Opcode::I32Add, MakeLocalGet(row), MakeLocalGet(col))));
+        auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto result = MakeBinary(Opcode::F32Add, MakeF32Load(mat_addr), MakeF32Load(MakeLocalGet(vec_row_offset)));
+        b3->Insert(MakeF32Store(dst_addr, result));
+      }));
+    }));
+
+    b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixDotBf16(RelocMat lhs, RelocMat rhs, RelocMat dst,
+                                                 std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs.Array());
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+
+  assert(locals.size() == 8);
+  auto lhs_col_rhs_rows = locals[0];
+  auto rhs_col = locals[1];
   auto lhs_row_offset = locals[2];
   auto rhs_row_offset = locals[3];
   auto dst_row_offset = locals[4];
   auto res_cell = locals[5];
-  auto res_128 = locals[6];
+  auto res_even_128 = locals[6];
+  auto res_odd_128 = locals[7];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * type_size;
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * BF16_SIZE;
+  uint32_t dst_width_bytes = dst.Array()->Shape()[1] * type_size;
+  uint32_t width_remainder = rhs_width_bytes % WASMPP_V128_SIZE;
+  uint32_t simd_width_bytes = rhs_width_bytes - width_remainder;
+
+  // Cannot optimize if rhs width is too small
+  if(rhs_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixDotBf16(lhs, rhs, dst, locals);
+  }
 
-  // Handle special case where the number of columns is 1
-  // and rhs has more than 4 elements
   wabt::ExprList* e = new wabt::ExprList();
-  if(lhs->Shape()[1] == 1 && rhs_height_bytes >= WASMPP_V128_SIZE) {
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), dst_width_bytes, {}, [&](BlockBody* b1) {
 
-    uint32_t height_remainder = rhs_height_bytes % WASMPP_V128_SIZE;
-    uint32_t simd_height_bytes = rhs_height_bytes - height_remainder;
+    // Use SIMD while possible
+    // Loop on rhs columns in group of 8
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2) {
 
-    Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), rhs_height_bytes, {}, [&](BlockBody* b1) {
-      // Reset rhs pointer to top row
-      if(rhs.HasBeginVar()) {
-        b1->Insert(MakeLocalSet(rhs_row_offset, MakeLocalGet(rhs.Var())));
-      } else {
-        b1->Insert(MakeLocalSet(rhs_row_offset, MakeI32Const(rhs.Array()->Memory()->Begin())));
-      }
+      // Reset result counters
+      b2->Insert(MakeLocalSet(res_even_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+      b2->Insert(MakeLocalSet(res_odd_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
 
-      // Apply SIMD while possible
-      b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, simd_height_bytes, simd_type_size, {}, [&](BlockBody* b2) {
-        auto lhs_op = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
-        auto rhs_op = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_rows), MakeLocalGet(rhs_row_offset)));
-        auto dest_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
-        b2->Insert(MakeV128Store(dest_addr, MakeBinary(Opcode::F32X4Mul, lhs_op, rhs_op)));
+      // Set rhs pointer to next 8 columns
+      b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
+
+      // Loop vertically on a column group
+      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
+        auto lhs_cell = [&]() {
+          return MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
+        };
+
+        // Each 32-bit lane holds an even column in its lower
+        // half and an odd column in its upper half, so the
+        // even columns are shifted up and the odd ones masked
+        auto rhs_even_cells = MakeBinary(Opcode::I32X4Shl, MakeV128Load(MakeLocalGet(rhs_row_offset)), MakeI32Const(16));
+        auto rhs_odd_cells = MakeBinary(Opcode::V128And, MakeV128Load(MakeLocalGet(rhs_row_offset)),
+                                        MakeUnary(Opcode::I32X4Splat, MakeI32Const(0xFFFF0000)));
+
+        // Compute 8 cells at a time
+        b3->Insert(GenerateCompoundAssignment(res_even_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell(), rhs_even_cells)));
+        b3->Insert(GenerateCompoundAssignment(res_odd_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell(), rhs_odd_cells)));
+
+        // Move lhs pointer to next column
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+
+        // Move rhs pointer to next row
+        b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
       }));
 
-      // Fallback to regular computation
-      if(height_remainder > 0) {
-        b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_rows, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
-          auto lhs_op = MakeF32Load(MakeLocalGet(lhs_row_offset));
-          auto rhs_op = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_rows), MakeLocalGet(rhs_row_offset)));
-          auto dest_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
-          b2->Insert(MakeF32Store(dest_addr, MakeBinary(Opcode::F32Mul, lhs_op, rhs_op)));
-        }));
-      }
+      // Reset lhs pointer to beginning of row
+      b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
 
-      // Move lhs pointer to next row
-      b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
+      // Store results interleaved in destination matrix
+      for(uint32_t lane = 0; lane < WASMPP_V128_SIZE / type_size; lane++) {
+        auto dst_cell_addr = [&]() {
+          return MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset),
+                            MakeBinary(Opcode::I32Shl, MakeLocalGet(rhs_col), MakeI32Const(1)));
+        };
+        b2->Insert(MakeF32Store(dst_cell_addr(), MakeF32X4ExtractLane(MakeLocalGet(res_even_128), lane),
+                                WABT_USE_NATURAL_ALIGNMENT, 2 * lane * type_size));
+        b2->Insert(MakeF32Store(dst_cell_addr(), MakeF32X4ExtractLane(MakeLocalGet(res_odd_128), lane),
+                                WABT_USE_NATURAL_ALIGNMENT, (2 * lane + 1) * type_size));
+      }
     }));
-    return e;
-  }
 
-  // Cannot optimize if matrix width bytes is too small
-  if(lhs_width_bytes < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixDotRT(lhs, rhs, dst, locals);
-  }
+    if(width_remainder > 0) {
+      // Fallback to regular computation
+      // Loop on remaining rhs columns
+      b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_col, rhs_width_bytes, BF16_SIZE, {}, [&](BlockBody* b2) {
 
-  // Optimize for large matrices
-  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), rhs_height_bytes, {}, [&](BlockBody* b1) {
-    if(rhs.HasBeginVar()) {
-      b1->Insert(MakeLocalSet(rhs_row_offset, MakeLocalGet(rhs.Var())));
-    } else {
-      b1->Insert(MakeLocalSet(rhs_row_offset, MakeI32Const(rhs.Array()->Memory()->Begin())));
-    }
-    b1->Insert(GenerateRangeLoop(label_manager_, rhs_rows, 0, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
-      b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+        // Reset result counter
+        b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
 
-      // Use SIMD while possible
-      b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b3) {
-        auto lhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
-        auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
-        b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
-      }));
-      b2->Insert(MakeLocalSet(res_cell, GenerateF32X4HorizontalLTRSum(res_128)));
+        // Set rhs pointer to next column
+        b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
 
-      // Fallback to regular computation
-      if(width_remainder > 0) {
-        b2->Insert(GenerateDoWhileLoop(label_manager_, lhs_col_rhs_rows, rhs_width_bytes, type_size, {}, [&](BlockBody* b3) {
-          auto lhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(lhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
-          auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
+        // Loop vertically on a column
+        b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
+          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto rhs_cell = MakeBf16Load(MakeLocalGet(rhs_row_offset));
+
+          // Compute cell
           b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+
+          // Move lhs pointer to next column
+          b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+
+          // Move rhs pointer to next row
+          b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
         }));
-      }
-      auto dst_cell_addr = MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_rows));
-      b2->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
-      b2->Insert(MakeF32Store(dst_cell_addr, MakeLocalGet(res_cell)));
-    }));
+
+        // Reset lhs pointer to beginning of row
+        b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Sub, MakeI32Const(lhs_width_bytes)));
+
+        // Store result in destination matrix
+        auto dst_col = MakeBinary(Opcode::I32Shl, MakeLocalGet(rhs_col), MakeI32Const(1));
+        b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), dst_col), MakeLocalGet(res_cell)));
+      }));
+    }
+
+    // Move lhs offset to next row
     b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
 }
 
-wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::RelocMat rhs, nn::ds::NDArray *dst,
-                                             std::vector<wabt::Var> locals) {
-  MATRIX_CHECK(lhs);
+wabt::ExprList* MatrixSnippetSimd::MatrixDotInt8(RelocMat lhs, RelocMat rhs, RelocMat dst,
+                                                 std::vector<wabt::Var> locals) {
+  MATRIX_CHECK(lhs.Array());
   MATRIX_CHECK(rhs.Array());
-  MATRIX_CHECK(dst);
-  ERROR_UNLESS(lhs->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[0] == lhs->Shape()[0], "dst and lhs matrices are not compatible");
-  ERROR_UNLESS(dst->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs.Array()->Shape()[1] == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs.Array()->Shape()[0], "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
 
-  assert(locals.size() == 7);
-  auto rhs_col = locals[0];
-  auto lhs_col_rhs_rows = locals[1];
+  assert(locals.size() == 8);
+  auto lhs_col_rhs_rows = locals[0];
+  auto rhs_col = locals[1];
   auto lhs_row_offset = locals[2];
   auto rhs_row_offset = locals[3];
   auto dst_row_offset = locals[4];
   auto res_cell = locals[5];
   auto res_128 = locals[6];
+  auto multipliers_128 = locals[7];
 
   uint32_t simd_type_size = TypeSize(Type::V128);
   uint32_t type_size = TypeSize(Type::F32);
   uint32_t rhs_height_bytes = rhs.Array()->Shape()[0] * type_size;
   uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
-  uint32_t lhs_width_bytes = lhs->Shape()[1] * type_size;
+  uint32_t lhs_width_bytes = lhs.Array()->Shape()[1] * INT8_SIZE;
   uint32_t width_remainder = rhs_width_bytes % WASMPP_V128_SIZE;
   uint32_t simd_width_bytes = rhs_width_bytes - width_remainder;
 
@@ -926,26 +2151,36 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
   if(rhs.Array()->Shape()[1] == 1 && rhs_height_bytes >= WASMPP_V128_SIZE) {
     uint32_t height_remainder = rhs_height_bytes % WASMPP_V128_SIZE;
     uint32_t simd_height_bytes = rhs_height_bytes - height_remainder;
+    uint32_t lanes = WASMPP_V128_SIZE / type_size;
 
     wabt::ExprList* e = new wabt::ExprList();
-    Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Memory()->Begin())));
-    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Memory()->Begin(), dst->Memory()->End(), type_size, {}, [&](BlockBody* b1) {
+
+    // Lane i of a loaded i32 holds byte i in its least significant
+    // bits, so it is multiplied by 2^(24 - 8i) to move the byte to
+    // the most significant bits before an arithmetic shift
+    auto multipliers = MakeUnary(Opcode::I32X4Splat, MakeI32Const(1 << 24));
+    for(uint32_t lane = 1; lane < lanes; lane++) {
+      multipliers = MakeI32X4ReplaceLane(multipliers, MakeI32Const(1 << (24 - 8 * lane)), lane);
+    }
+    Merge(e, MakeLocalSet(multipliers_128, multipliers));
+    Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), type_size, {}, [&](BlockBody* b1) {
       // Reset result local
       b1->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
 
       // Reset rhs pointer
-      if(rhs.HasBeginVar()) {
-        b1->Insert(MakeLocalSet(rhs_row_offset, MakeLocalGet(rhs.Var())));
-      } else {
-        b1->Insert(MakeLocalSet(rhs_row_offset, MakeI32Const(rhs.Array()->Begin())));
-      }
+      b1->Insert(MakeLocalSet(rhs_row_offset, rhs.MakeBegin()));
 
       // Use SIMD while possible
       b1->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, simd_height_bytes, simd_type_size, {}, [&](BlockBody* b2) {
-        auto lhs_cell = MakeV128Load(MakeLocalGet(lhs_row_offset));
+        // Widen 4 int8 cells to f32
+        auto lhs_bytes = MakeUnary(Opcode::I32X4Splat, MakeI32Load(MakeLocalGet(lhs_row_offset)));
+        auto lhs_ints = MakeBinary(Opcode::I32X4ShrS, MakeBinary(Opcode::I32X4Mul, lhs_bytes, MakeLocalGet(multipliers_128)),
+                                   MakeI32Const(24));
+        auto lhs_cell = MakeUnary(Opcode::F32X4ConvertI32X4S, lhs_ints);
         auto rhs_cell = MakeV128Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
         b2->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
-        b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(simd_type_size)));
+        b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lanes * INT8_SIZE)));
       }));
 
       // Compute result
@@ -954,10 +2189,10 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
       // Fallback to regular computation
       if(height_remainder > 0) {
         b1->Insert(GenerateDoWhileLoop(label_manager_, lhs_col_rhs_rows, rhs_height_bytes, type_size, {}, [&](BlockBody* b2) {
-          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto lhs_cell = MakeInt8Load(MakeLocalGet(lhs_row_offset));
           auto rhs_cell = MakeF32Load(MakeBinary(Opcode::I32Add, MakeLocalGet(rhs_row_offset), MakeLocalGet(lhs_col_rhs_rows)));
           b2->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
-          b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+          b2->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(INT8_SIZE)));
         }));
       }
 
@@ -969,13 +2204,13 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
 
   // Cannot optimize if rhs width is too small
   if(rhs_width_bytes < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixDot(lhs, rhs, dst, locals);
+    return MatrixSnippet::MatrixDotInt8(lhs, rhs, dst, locals);
   }
 
   // Optimize for large matrices
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(lhs->Begin())));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst->Begin(), dst->End(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+  Merge(e, MakeLocalSet(lhs_row_offset, lhs.MakeBegin()));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
 
     // Use SIMD while possible
     // Loop on rhs columns in group of 4
@@ -985,22 +2220,18 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
       b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
 
       // Set rhs pointer to next 4 columns
-      if(rhs.HasBeginVar()) {
-        b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, MakeLocalGet(rhs.Var()), MakeLocalGet(rhs_col))));
-      } else {
-        b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, MakeI32Const(rhs.Array()->Begin()), MakeLocalGet(rhs_col))));
-      }
+      b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
 
       // Loop vertically on a column group
       b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
-        auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(lhs_row_offset)));
+        auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeInt8Load(MakeLocalGet(lhs_row_offset)));
         auto rhs_cell = MakeV128Load(MakeLocalGet(rhs_row_offset));
 
         // Compute 4 cells at a time
         b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cell)));
 
         // Move lhs pointer to next column
-        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+        b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(INT8_SIZE)));
 
         // Move rhs pointer to next row
         b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
@@ -1022,22 +2253,18 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
         b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
 
         // Set rhs pointer to next columns
-        if(rhs.HasBeginVar()) {
-          b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, MakeLocalGet(rhs.Var()), MakeLocalGet(rhs_col))));
-        } else {
-          b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, MakeI32Const(rhs.Array()->Begin()), MakeLocalGet(rhs_col))));
-        }
+        b2->Insert(MakeLocalSet(rhs_row_offset, MakeBinary(Opcode::I32Add, rhs.MakeBegin(), MakeLocalGet(rhs_col))));
 
         // Loop vertically on a column
         b2->Insert(GenerateRangeLoop(label_manager_, lhs_col_rhs_rows, 0, rhs.Array()->Memory()->Bytes(), rhs_width_bytes, {}, [&](BlockBody* b3){
-          auto lhs_cell = MakeF32Load(MakeLocalGet(lhs_row_offset));
+          auto lhs_cell = MakeInt8Load(MakeLocalGet(lhs_row_offset));
           auto rhs_cell = MakeF32Load(MakeLocalGet(rhs_row_offset));
 
           // Compute cell
           b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
 
           // Move lhs pointer to next column
-          b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+          b3->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(INT8_SIZE)));
 
           // Move rhs pointer to next row
           b3->Insert(GenerateCompoundAssignment(rhs_row_offset, Opcode::I32Add, MakeI32Const(rhs_width_bytes)));
@@ -1055,40 +2282,238 @@ wabt::ExprList* MatrixSnippetSimd::MatrixDot(nn::ds::NDArray *lhs, nn::snippet::
     b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(lhs_width_bytes)));
   }));
   return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixVectorScaleAddition(NDArray* matrix, NDArray* scales, NDArray* vector,
+                                                             NDArray* dst_matrix, std::vector<Var> locals) {
+  MATRIX_CHECK(matrix);
+  VECTOR_CHECK(scales);
+  VECTOR_CHECK(vector);
+  MATRIX_CHECK(dst_matrix);
+  MATRIX_SAME_SHAPE(matrix, dst_matrix);
+  MATRIX_SAME_SHAPE(scales, vector);
+  ERROR_UNLESS(vector->Shape()[0] == matrix->Shape()[0], "matrix and vector are not compatible");
+  assert(locals.size() == 4);
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t dst_width_bytes = dst_matrix->Shape()[1] * type_size;
+  auto width_remainder = dst_width_bytes % WASMPP_V128_SIZE;
+  auto dst_simd_width_bytes = dst_width_bytes - width_remainder;
+
+  // Cannot optimize if matrix width bytes is too small
+  if(dst_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixVectorScaleAddition(matrix, scales, vector, dst_matrix, locals);
+  }
+
+  auto row = locals[0];
+  auto col = locals[1];
+  auto vec_row_offset = locals[2];
+  auto addr = locals[3];
+
+  // The scales are at the same offset as the vector values
+  uint32_t scales_delta = scales->Memory()->Begin() - vector->Memory()->Begin();
+  auto scale_addr = [&]() {
+    return MakeBinary(Opcode::I32Add, MakeLocalGet(vec_row_offset), MakeI32Const(scales_delta));
+  };
+
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(vec_row_offset, MakeI32Const(vector->Memory()->Begin())));
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, row, 0, dst_matrix->Memory()->Bytes(), dst_width_bytes, {}, [&](BlockBody* b1) {
+
+    // Use SIMD while possible
+    b1->Insert(GenerateRangeLoop(label_manager_, col, 0, dst_simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2){
+      auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+      auto scale = MakeUnary(Opcode::F32X4Splat, MakeF32Load(scale_addr()));
+      auto vec = MakeUnary(Opcode::F32X4Splat, MakeF32Load(MakeLocalGet(vec_row_offset)));
+      auto result = MakeBinary(Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, MakeV128Load(mat_addr), scale), vec);
+      b2->Insert(MakeV128Store(dst_addr, result));
+      b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+    }));
+
+    // Fallback to regular computation
+    if(width_remainder > 0) {
+      b1->Insert(GenerateDoWhileLoop(label_manager_, col, dst_width_bytes, type_size, {}, [&](BlockBody* b2){
+        auto mat_addr = MakeBinary(Opcode::I32Add, MakeI32Const(matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto dst_addr = MakeBinary(Opcode::I32Add, MakeI32Const(dst_matrix->Memory()->Begin()), MakeLocalGet(addr));
+        auto result = MakeBinary(Opcode::F32Add, MakeBinary(Opcode::F32Mul, MakeF32Load(mat_addr), MakeF32Load(scale_addr())),
+                                 MakeF32Load(MakeLocalGet(vec_row_offset)));
+        b2->Insert(MakeF32Store(dst_addr, result));
+        b2->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+      }));
+    }
+
+    b1->Insert(GenerateCompoundAssignment(vec_row_offset, Opcode::I32Add, MakeI32Const(type_size)));
+  }));
+  return e;
+}
+
+wabt::ExprList* MatrixSnippetSimd::MatrixDotSparse(BlockSparseNDArray* lhs, RelocMat rhs, RelocMat dst,
+                                                   std::vector<wabt::Var> locals) {
+  ERROR_UNLESS(lhs != nullptr, "lhs cannot be null");
+  MATRIX_CHECK(rhs.Array());
+  MATRIX_CHECK(dst.Array());
+  ERROR_UNLESS(lhs->Cols() == rhs.Array()->Shape()[0], "lhs and rhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[0] == lhs->Rows(), "dst and lhs matrices are not compatible");
+  ERROR_UNLESS(dst.Array()->Shape()[1] == rhs.Array()->Shape()[1], "dst and rhs matrices are not compatible");
+
+  assert(locals.size() == 7);
+  auto block = locals[0];
+  auto rhs_col = locals[1];
+  auto lhs_row_offset = locals[2];
+  auto rhs_row_offset = locals[3];
+  auto dst_row_offset = locals[4];
+  auto res_cell = locals[5];
+  auto res_128 = locals[6];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  uint32_t type_size = TypeSize(Type::F32);
+  uint32_t rhs_width_bytes = rhs.Array()->Shape()[1] * type_size;
+  uint32_t row_blocks_bytes = lhs->RowBlocks() * TypeSize(Type::I32);
+  uint32_t width_remainder = rhs_width_bytes % WASMPP_V128_SIZE;
+  uint32_t simd_width_bytes = rhs_width_bytes - width_remainder;
+  assert(SPARSE_BLOCK_WIDTH * type_size == WASMPP_V128_SIZE);
+
+  // Handle special case where rhs is a vector.
+  // The rhs cells of a block are consecutive
+  if(rhs.Array()->Shape()[1] == 1) {
+    wabt::ExprList* e = new wabt::ExprList();
+    Merge(e, MakeLocalSet(rhs_col, MakeI32Const(0)));
+    Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(0)));
+    Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), type_size, {}, [&](BlockBody* b1) {
+      // Reset result local
+      b1->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+      // Compute a block at a time
+      b1->Insert(GenerateRangeLoop(label_manager_, block, 0, row_blocks_bytes, TypeSize(Type::I32), {}, [&](BlockBody* b2) {
+        auto lhs_cells = MakeV128Load(SparseBlockValues(lhs, lhs_row_offset, block));
+        auto rhs_cells = MakeV128Load(SparseBlockRhsRow(lhs, rhs, lhs_row_offset, block, rhs_col));
+        b2->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cells, rhs_cells)));
+      }));
+
+      // Store result in destination cell
+      b1->Insert(MakeF32Store(MakeLocalGet(dst_row_offset), GenerateF32X4HorizontalLTRSum(res_128)));
+
+      // Move lhs offset to next row
+      b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(row_blocks_bytes)));
+    }));
+    return e;
+  }
+
+  // Cannot optimize if rhs width is too small
+  if(rhs_width_bytes < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixDotSparse(lhs, rhs, dst, locals);
+  }
+
+  // Optimize for large matrices
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(lhs_row_offset, MakeI32Const(0)));
+  Merge(e, GenerateRangeLoop(label_manager_, dst_row_offset, dst.MakeBegin(), dst.MakeEnd(), rhs_width_bytes, {}, [&](BlockBody* b1) {
+
+    // Use SIMD while possible
+    // Loop on rhs columns in group of 4
+    b1->Insert(GenerateRangeLoop(label_manager_, rhs_col, 0, simd_width_bytes, simd_type_size, {}, [&](BlockBody* b2) {
+
+      // Reset result counter
+      b2->Insert(MakeLocalSet(res_128, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+
+      // Loop on the blocks of the lhs row
+      b2->Insert(GenerateRangeLoop(label_manager_, block, 0, row_blocks_bytes, TypeSize(Type::I32), {}, [&](BlockBody* b3) {
+        // Set rhs pointer to the row of the first column of the block
+        b3->Insert(MakeLocalSet(rhs_row_offset, SparseBlockRhsRow(lhs, rhs, lhs_row_offset, block, rhs_col)));
+
+        // Compute 4 cells at a time for each column of the block
+        for(uint32_t lane = 0; lane < SPARSE_BLOCK_WIDTH; lane++) {
+          auto lhs_cell = MakeUnary(Opcode::F32X4Splat, MakeF32Load(SparseBlockValues(lhs, lhs_row_offset, block),
+                                                                    WABT_USE_NATURAL_ALIGNMENT, lane * type_size));
+          auto rhs_cells = MakeV128Load(MakeLocalGet(rhs_row_offset), WABT_USE_NATURAL_ALIGNMENT, lane * rhs_width_bytes);
+          b3->Insert(GenerateCompoundAssignment(res_128, Opcode::F32X4Add, MakeBinary(Opcode::F32X4Mul, lhs_cell, rhs_cells)));
+        }
+      }));
+
+      // Store result in destination matrix
+      b2->Insert(MakeV128Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_128)));
+    }));
+
+    if(width_remainder > 0) {
+      // Fallback to regular computation
+      // Loop on remaining rhs columns
+      b1->Insert(GenerateDoWhileLoop(label_manager_, rhs_col, rhs_width_bytes, type_size, {}, [&](BlockBody* b2) {
+
+        // Reset result counter
+        b2->Insert(MakeLocalSet(res_cell, MakeF32Const(0)));
+
+        // Loop on the blocks of the lhs row
+        b2->Insert(GenerateRangeLoop(label_manager_, block, 0, row_blocks_bytes, TypeSize(Type::I32), {}, [&](BlockBody* b3) {
+          b3->Insert(MakeLocalSet(rhs_row_offset, SparseBlockRhsRow(lhs, rhs, lhs_row_offset, block, rhs_col)));
+          for(uint32_t lane = 0; lane < SPARSE_BLOCK_WIDTH; lane++) {
+            auto lhs_cell = MakeF32Load(SparseBlockValues(lhs, lhs_row_offset, block), WABT_USE_NATURAL_ALIGNMENT,
+                                        lane * type_size);
+            auto rhs_cell = MakeF32Load(MakeLocalGet(rhs_row_offset), WABT_USE_NATURAL_ALIGNMENT, lane * rhs_width_bytes);
+            b3->Insert(GenerateCompoundAssignment(res_cell, Opcode::F32Add, MakeBinary(Opcode::F32Mul, lhs_cell, rhs_cell)));
+          }
+        }));
+
+        // Store result in destination matrix
+        b2->Insert(MakeF32Store(MakeBinary(Opcode::I32Add, MakeLocalGet(dst_row_offset), MakeLocalGet(rhs_col)), MakeLocalGet(res_cell)));
+      }));
+    }
 
+    // Move lhs offset to next row
+    b1->Insert(GenerateCompoundAssignment(lhs_row_offset, Opcode::I32Add, MakeI32Const(row_blocks_bytes)));
+  }));
+  return e;
 }
 
 wabt::ExprList* MatrixSnippetSimd::MatrixAbsSum(nn::ds::NDArray *matrix, wabt::Var result, std::vector<wabt::Var> locals) {
   MATRIX_CHECK(matrix);
+  assert(locals.size() >= 2);
 
   // Cannot optimize
   if(matrix->Memory()->Bytes() < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixAbsSum(matrix, result, locals);
+    return MatrixSnippet::MatrixAbsSum(matrix, result, {locals[0], locals[1]});
   }
 
-  assert(locals.size() == 2);
   auto dst_addr = locals[0];
-  auto v128_result = locals[1];
+  std::vector<Var> accumulators = ReductionAccumulators({locals.begin() + 1, locals.end()}, matrix->Memory()->Bytes());
 
   uint32_t simd_type_size = TypeSize(Type::V128);
-  auto remainder = matrix->Memory()->Bytes() % WASMPP_V128_SIZE;
-  auto dst_simd_end = matrix->Memory()->End() - remainder;
+  uint32_t simd_stride = simd_type_size * (uint32_t) accumulators.size();
+  auto simd_bytes = matrix->Memory()->Bytes() - (matrix->Memory()->Bytes() % WASMPP_V128_SIZE);
+  auto unrolled_bytes = matrix->Memory()->Bytes() - (matrix->Memory()->Bytes() % simd_stride);
 
-  // Use SIMD while possible
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(v128_result, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
-    auto abs = MakeUnary(Opcode::F32X4Abs, MakeV128Load(MakeLocalGet(dst_addr)));
-    b->Insert(GenerateCompoundAssignment(v128_result, Opcode::F32X4Add, abs));
+  for(auto &acc : accumulators) {
+    Merge(e, MakeLocalSet(acc, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+  }
+
+  // Use SIMD while possible
+  // Interleave independent accumulators
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->Begin() + unrolled_bytes, simd_stride, {},
+                             [&](BlockBody* b) {
+    for(uint32_t i = 0; i < accumulators.size(); i++) {
+      auto abs = MakeUnary(Opcode::F32X4Abs, MakeV128Load(MakeLocalGet(dst_addr), WABT_USE_NATURAL_ALIGNMENT,
+                                                           i * simd_type_size));
+      b->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, abs));
+    }
   }));
 
+  // Remaining vectors which do not fill all accumulators
+  for(uint32_t addr = unrolled_bytes, i = 0; addr < simd_bytes; addr += simd_type_size, i++) {
+    auto abs = MakeUnary(Opcode::F32X4Abs, MakeV128Load(MakeI32Const(matrix->Begin() + addr)));
+    Merge(e, GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, abs));
+  }
+
   // Store v128 into f32
-  Merge(e, MakeLocalSet(result, GenerateF32X4HorizontalLTRSum(v128_result)));
+  Merge(e, MakeLocalSet(result, GenerateF32X4AccumulatorsLTRSum(accumulators)));
 
   // Fallback to regular computation
-  if(remainder > 0) {
+  if(simd_bytes < matrix->Memory()->Bytes()) {
     auto type_size = TypeSize(Type::F32);
-    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, matrix->End(), type_size, {}, [&](BlockBody* b) {
+    Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin() + simd_bytes, matrix->End(), type_size, {},
+                               [&](BlockBody* b) {
       b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeUnary(Opcode::F32Abs, MakeF32Load(MakeLocalGet(dst_addr)))));
     }));
   }
@@ -1098,36 +2523,54 @@ wabt::ExprList* MatrixSnippetSimd::MatrixAbsSum(nn::ds::NDArray *matrix, wabt::V
 wabt::ExprList* MatrixSnippetSimd::MatrixSquareSum(nn::ds::NDArray *matrix, wabt::Var result,
                                                    std::vector<wabt::Var> locals) {
   MATRIX_CHECK(matrix);
+  assert(locals.size() >= 3);
 
   // Cannot optimize
   if(matrix->Memory()->Bytes() < WASMPP_V128_SIZE) {
-    return MatrixSnippet::MatrixSquareSum(matrix, result, locals);
+    return MatrixSnippet::MatrixSquareSum(matrix, result, {locals[0], locals[1], locals[2]});
   }
 
-  assert(locals.size() == 3);
   auto dst_addr = locals[0];
   auto cache = locals[1];
-  auto v128_result = locals[2];
+  std::vector<Var> accumulators = ReductionAccumulators({locals.begin() + 2, locals.end()}, matrix->Memory()->Bytes());
 
   uint32_t simd_type_size = TypeSize(Type::V128);
-  auto remainder = matrix->Memory()->Bytes() % WASMPP_V128_SIZE;
-  auto dst_simd_end = matrix->Memory()->End() - remainder;
+  uint32_t simd_stride = simd_type_size * (uint32_t) accumulators.size();
+  auto simd_bytes = matrix->Memory()->Bytes() - (matrix->Memory()->Bytes() % WASMPP_V128_SIZE);
+  auto unrolled_bytes = matrix->Memory()->Bytes() - (matrix->Memory()->Bytes() % simd_stride);
 
-  // Use SIMD while possible
   wabt::ExprList* e = new wabt::ExprList();
-  Merge(e, MakeLocalSet(v128_result, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
-  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), dst_simd_end, simd_type_size, {}, [&](BlockBody* b) {
-    auto square = MakeBinary(Opcode::F32X4Mul, MakeV128Load(MakeLocalGet(dst_addr)), MakeV128Load(MakeLocalGet(dst_addr)));
-    b->Insert(GenerateCompoundAssignment(v128_result, Opcode::F32X4Add, square));
+  for(auto &acc : accumulators) {
+    Merge(e, MakeLocalSet(acc, MakeUnary(Opcode::F32X4Splat, MakeF32Const(0))));
+  }
+
+  // Use SIMD while possible
+  // Interleave independent accumulators
+  Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin(), matrix->Begin() + unrolled_bytes, simd_stride, {},
+                             [&](BlockBody* b) {
+    for(uint32_t i = 0; i < accumulators.size(); i++) {
+      auto square = MakeBinary(Opcode::F32X4Mul,
+                               MakeV128Load(MakeLocalGet(dst_addr), WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size),
+                               MakeV128Load(MakeLocalGet(dst_addr), WABT_USE_NATURAL_ALIGNMENT, i * simd_type_size));
+      b->Insert(GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, square));
+    }
   }));
 
+  // Remaining vectors which do not fill all accumulators
+  for(uint32_t addr = unrolled_bytes, i = 0; addr < simd_bytes; addr += simd_type_size, i++) {
+    auto square = MakeBinary(Opcode::F32X4Mul, MakeV128Load(MakeI32Const(matrix->Begin() + addr)),
+                             MakeV128Load(MakeI32Const(matrix->Begin() + addr)));
+    Merge(e, GenerateCompoundAssignment(accumulators[i], Opcode::F32X4Add, square));
+  }
+
   // Store v128 into f32
-  Merge(e, MakeLocalSet(result, GenerateF32X4HorizontalLTRSum(v128_result)));
+  Merge(e, MakeLocalSet(result, GenerateF32X4AccumulatorsLTRSum(accumulators)));
 
   // Fallback to regular computation
-  if(remainder > 0) {
+  if(simd_bytes < matrix->Memory()->Bytes()) {
     auto type_size = TypeSize(Type::F32);
-    Merge(e, GenerateDoWhileLoop(label_manager_, dst_addr, matrix->End(), type_size, {}, [&](BlockBody* b) {
+    Merge(e, GenerateRangeLoop(label_manager_, dst_addr, matrix->Begin() + simd_bytes, matrix->End(), type_size, {},
+                               [&](BlockBody* b) {
       b->Insert(MakeLocalSet(cache, MakeF32Load(MakeLocalGet(dst_addr))));
       b->Insert(GenerateCompoundAssignment(result, Opcode::F32Add, MakeBinary(Opcode::F32Mul, MakeLocalGet(cache),
                                                                               MakeLocalGet(cache))));
@@ -1316,5 +2759,58 @@ ExprList* MatrixSnippetSimd::MatrixAddRightSignScaleAddRightScale(nn::ds::NDArra
   return e;
 }
 
+ExprList* MatrixSnippetSimd::MatrixOptimizerUpdate(const arch::OptimizerOptions& options, NDArray* param,
+                                                   NDArray* grad, std::vector<NDArray*> states,
+                                                   wabt::ExprList* rate, std::vector<Var> locals) {
+  MATRIX_CHECK(param);
+  MATRIX_CHECK(grad);
+  MATRIX_SAME_SHAPE(param, grad);
+  ERROR_UNLESS(states.size() == arch::OptimizerStates(options.type), "wrong number of optimizer states");
+  for(auto state : states) {
+    MATRIX_CHECK(state);
+    MATRIX_SAME_SHAPE(param, state);
+  }
+  assert(locals.size() == 7);
+
+  // Cannot optimize
+  if(param->Memory()->Bytes() < WASMPP_V128_SIZE) {
+    return MatrixSnippet::MatrixOptimizerUpdate(options, param, grad, states, rate, locals);
+  }
+
+  auto param_addr = locals[0];
+  auto addr = locals[1];
+  auto vrate = locals[2];
+  auto g = locals[3];
+  auto m = locals[4];
+  auto vg = locals[5];
+  auto vm = locals[6];
+
+  uint32_t simd_type_size = TypeSize(Type::V128);
+  auto remainder = param->Memory()->Bytes() % WASMPP_V128_SIZE;
+  auto param_simd_end = param->Memory()->End() - remainder;
+
+  // Use SIMD while possible
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(addr, MakeI32Const(0)));
+  Merge(e, MakeLocalSet(vrate, rate));
+  Merge(e, GenerateRangeLoop(label_manager_, param_addr, param->Memory()->Begin(), param_simd_end, simd_type_size,
+                             {}, [&](BlockBody* b) {
+    b->Insert(OptimizerUpdateElements(options, param, grad, states, addr, vrate, vg, vm, true));
+    // Move to next elements
+    b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(simd_type_size)));
+  }));
+
+  // Fallback to regular computation
+  if(remainder > 0) {
+    auto type_size = TypeSize(Type::F32);
+    Merge(e, GenerateDoWhileLoop(label_manager_, param_addr, param->Memory()->End(), type_size, {}, [&](BlockBody* b) {
+      b->Insert(OptimizerUpdateElements(options, param, grad, states, addr, vrate, g, m, false));
+      // Move to next element
+      b->Insert(GenerateCompoundAssignment(addr, Opcode::I32Add, MakeI32Const(type_size)));
+    }));
+  }
+  return e;
+}
+
 } // namespace snippet
 } // namespace nn
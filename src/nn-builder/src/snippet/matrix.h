@@ -2,14 +2,21 @@
 #define NN_SNIPPET_MATRIX_H_
 
 #include <src/nn-builder/src/data_structure/ndarray.h>
+#include <src/nn-builder/src/data_structure/sparse.h>
 #include <src/nn-builder/src/builtins/activation.h>
 #include <src/nn-builder/src/builtins/loss.h>
+#include <src/nn-builder/src/arch/optimizer.h>
 #include <src/nn-builder/src/snippet/snippets.h>
 #include <src/wasmpp/wasm-manager.h>
 
 namespace nn {
 namespace snippet {
 
+// Size in bytes of a bf16 value
+const uint32_t BF16_SIZE = 2;
+// Size in bytes of an int8 value
+const uint32_t INT8_SIZE = 1;
+
 // RelocMat is useful for a matrix which can have a hybrid starting address.
 // A matrix wrapped in this class should be used carefully because
 // a begin address should point to a matrix with the exact shape
@@ -22,6 +29,9 @@ public:
   ds::NDArray* Array() const { return array_; }
   wabt::Var Var() const { assert(has_begin_var); return var_; }
   bool HasBeginVar() const { return has_begin_var; }
+  // Expressions computing the begin and end addresses
+  wabt::ExprList* MakeBegin() const;
+  wabt::ExprList* MakeEnd() const;
 private:
   ds::NDArray* array_;
   wabt::Var var_;
@@ -56,19 +66,98 @@ protected:
   virtual wabt::ExprList* MatrixVectorBinaryOperation(wabt::Opcode op, ds::NDArray* matrix, ds::NDArray* vector,
                                                       ds::NDArray* dst_matrix, std::vector<wabt::Var> locals);
 
+  // Dot product where the left one is treated as transposed,
+  // and where the destination rows start at the left column
+  // `lhs_col_begin` (the destination can be a range of rows)
+  virtual wabt::ExprList* MatrixDotLTRange(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t lhs_col_begin,
+                                           std::vector<wabt::Var> locals);
+
 public:
   MatrixSnippet(wasmpp::LabelManager* label_manager, arch::BuiltinFunctions* builtins) : Snippet(label_manager, builtins) {}
 
   // Dot product of two matrices
-  virtual wabt::ExprList* MatrixDot(ds::NDArray* lhs, RelocMat rhs, ds::NDArray* dst, std::vector<wabt::Var> locals);
+  virtual wabt::ExprList* MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
 
   // Dot product of two matrices where the left one is treated as transposed
-  virtual wabt::ExprList* MatrixDotLT(ds::NDArray* lhs, ds::NDArray* rhs, ds::NDArray* dst,
-                                      std::vector<wabt::Var> locals);
+  virtual wabt::ExprList* MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
 
   // Dot product of two matrices where the right one is treated as transposed
-  virtual wabt::ExprList* MatrixDotRT(ds::NDArray* lhs, RelocMat rhs, ds::NDArray* dst,
-                                      std::vector<wabt::Var> locals);
+  virtual wabt::ExprList* MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+
+  // Compute only the destination rows [row_begin, row_end)
+  // of the dot products above, so that the rows can be
+  // partitioned between threads. The left and destination
+  // matrices cannot have a begin variable
+  wabt::ExprList* MatrixDotRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin, uint32_t row_end,
+                                std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixDotLTRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin, uint32_t row_end,
+                                  std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixDotRTRows(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t row_begin, uint32_t row_end,
+                                  std::vector<wabt::Var> locals);
+
+  // Compute only the first columns of the destination, up to
+  // the byte offset `cols_bytes` (at least one column), so
+  // that the cost follows a batch size known at runtime.
+  // The locals are the ones of the dot product
+  virtual wabt::ExprList* MatrixDotColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, wabt::Var cols_bytes,
+                                           std::vector<wabt::Var> locals);
+  virtual wabt::ExprList* MatrixVectorAdditionColumns(ds::NDArray* matrix, ds::NDArray* vector,
+                                                      ds::NDArray* dst_matrix, wabt::Var cols_bytes,
+                                                      std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixActivationColumns(ds::NDArray* src, builtins::ActivationFunction func, ds::NDArray* dst,
+                                          wabt::Var cols_bytes, std::vector<wabt::Var> locals);
+  // Backward steps on the first columns of a batch: the
+  // dot products bound the batch dimension (the columns of
+  // rhs and dst, or the columns of lhs and rhs reduced by
+  // the transposed rhs) and the row sums stop at `cols_bytes`.
+  // The locals are the ones of the scalar snippets
+  wabt::ExprList* MatrixDotLTColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, wabt::Var cols_bytes,
+                                     std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixDotRTColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, wabt::Var cols_bytes,
+                                     std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixHorizontalSumColumns(ds::NDArray* matrix, ds::NDArray* dst_vector, wabt::Var cols_bytes,
+                                             std::vector<wabt::Var> locals);
+
+  // Dot product where the right matrix holds bf16 values,
+  // which are widened to f32 on load. The locals are the
+  // ones of the dot product followed by a second v128 used
+  // only by the SIMD version
+  virtual wabt::ExprList* MatrixDotBf16(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+
+  // Round a matrix to bf16 (to nearest even) in a bf16 matrix.
+  // Any NaN is written as the quiet NaN 0x7FC0
+  wabt::ExprList* MatrixNarrowBf16(ds::NDArray* src, ds::NDArray* dst, std::vector<wabt::Var> locals);
+
+  // Dot product where the left matrix holds int8 values,
+  // which are converted to f32 on load. The rows of the
+  // result are not scaled (see MatrixVectorScaleAddition).
+  // The locals are the ones of the dot product followed
+  // by a second v128 used only by the SIMD version
+  virtual wabt::ExprList* MatrixDotInt8(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+
+  // Quantize each row of a matrix to int8 with a scale per row
+  // scale[i] = max(abs(src[i])) / 127 and dst[i] = round(src[i] / scale[i])
+  // The locals are (i32, i32, i32, f32, f32)
+  wabt::ExprList* MatrixQuantizeRows(ds::NDArray* src, ds::NDArray* dst, ds::NDArray* scales,
+                                     std::vector<wabt::Var> locals);
+
+  // Scale the rows of a matrix then add a vector (vertically)
+  // e.g. dst[i][j] = mat[i][j] * scales[i] + vec[i]
+  virtual wabt::ExprList* MatrixVectorScaleAddition(ds::NDArray* matrix, ds::NDArray* scales, ds::NDArray* vector,
+                                                    ds::NDArray* dst_matrix, std::vector<wabt::Var> locals);
+
+  // Prune each row of a matrix to the blocks with the largest
+  // sum of absolute values (the first ones on ties, a NaN sum
+  // being the lowest). The norms vector (blocks of a row x 1)
+  // is used as scratch memory.
+  // The locals are (i32, i32, i32, i32, i32, i32, f32)
+  wabt::ExprList* MatrixPruneBlocks(ds::NDArray* src, ds::BlockSparseNDArray* dst, ds::NDArray* norms,
+                                    std::vector<wabt::Var> locals);
+
+  // Dot product where the left matrix is block sparse.
+  // Only the kept blocks are multiplied
+  virtual wabt::ExprList* MatrixDotSparse(ds::BlockSparseNDArray* lhs, RelocMat rhs, RelocMat dst,
+                                          std::vector<wabt::Var> locals);
 
   // Add matrices and vector (vertically)
   virtual wabt::ExprList* MatrixVectorAddition(ds::NDArray* matrix, ds::NDArray* vector, ds::NDArray* dst_matrix,
@@ -91,8 +180,10 @@ public:
                                std::vector<wabt::Var> locals);
 
   // Apply activation function to matrix
+  // If `from_output` is set, `src` is expected to hold the activation
+  // output and the derivative is computed from it
   virtual wabt::ExprList* MatrixActivation(RelocMat src, builtins::ActivationFunction func, ds::NDArray* dst,
-                                           std::vector<wabt::Var> locals, bool prime);
+                                           std::vector<wabt::Var> locals, bool prime, bool from_output = false);
 
   // Apply hard-max on each matrix column
   virtual wabt::ExprList* MatrixColumnHardmax(ds::NDArray* src, ds::NDArray* dst, std::vector<wabt::Var> locals);
@@ -121,6 +212,15 @@ public:
   // Combine both add right sign scale and right scale
   virtual wabt::ExprList* MatrixAddRightSignScaleAddRightScale(ds::NDArray* lhs, ds::NDArray* rhs, ds::NDArray* dst,
                                                                float scale1, float scale2, std::vector<wabt::Var> locals);
+
+  // Update a parameter from its gradient with the optimizer,
+  // and update the optimizer states of the parameter (see
+  // arch::OptimizerStates) in the same pass. The rate is
+  // evaluated once. The locals are (i32, i32, f32, f32, f32)
+  // followed by two v128 used only by the SIMD version
+  virtual wabt::ExprList* MatrixOptimizerUpdate(const arch::OptimizerOptions& options, ds::NDArray* param,
+                                                ds::NDArray* grad, std::vector<ds::NDArray*> states,
+                                                wabt::ExprList* rate, std::vector<wabt::Var> locals);
 };
 
 class MatrixSnippetSimd : public MatrixSnippet {
@@ -134,6 +234,13 @@ private:
 
   wabt::ExprList* MatrixVectorBinaryOperation(wabt::Opcode op, ds::NDArray* matrix, ds::NDArray* vector,
                                               ds::NDArray* dst_matrix, std::vector<wabt::Var> locals) override;
+
+  // Select the v128 locals used as independent accumulators
+  // by a reduction over `bytes` bytes. The accumulators are
+  // combined in a fixed order, so passing a single one
+  // reproduces the summation order of a one-accumulator
+  // reduction
+  std::vector<wabt::Var> ReductionAccumulators(std::vector<wabt::Var> v128_locals, uint32_t bytes) const;
 public:
   explicit MatrixSnippetSimd(wasmpp::LabelManager* label_manager, arch::BuiltinFunctions* builtins) :
       MatrixSnippet(label_manager, builtins) {}
@@ -142,26 +249,54 @@ public:
                                std::vector<wabt::Var> locals) override ;
 
   // The SIMD version of this function generates a result slightly different
-  // than the non-SIMD one because of the order of float addition
+  // than the non-SIMD one because of the order of float addition.
+  // Trailing v128 locals are reduction accumulators
   wabt::ExprList* MatrixHorizontalSum(ds::NDArray* matrix, ds::NDArray* dst_vector, std::vector<wabt::Var> locals) override;
 
   // The SIMD version of this function generates a result slightly different
   // than the non-SIMD one because of the order of float addition
-  wabt::ExprList* MatrixDotRT(ds::NDArray* lhs, RelocMat rhs, ds::NDArray* dst, std::vector<wabt::Var> locals) override;
+  wabt::ExprList* MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) override;
 
   // The SIMD version of this function generates exact results as the non-SIMD
-  wabt::ExprList* MatrixDotLT(ds::NDArray* lhs, ds::NDArray* rhs, ds::NDArray* dst, std::vector<wabt::Var> locals) override ;
+  wabt::ExprList* MatrixDotLTRange(RelocMat lhs, RelocMat rhs, RelocMat dst, uint32_t lhs_col_begin,
+                                   std::vector<wabt::Var> locals) override ;
 
   // The SIMD version of this function generates a result slightly different
   // than the non-SIMD one because of the order of float addition
-  wabt::ExprList* MatrixDot(ds::NDArray* lhs, RelocMat rhs, ds::NDArray* dst, std::vector<wabt::Var> locals) override ;
+  wabt::ExprList* MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates exact results as the non-SIMD
+  wabt::ExprList* MatrixDotColumns(RelocMat lhs, RelocMat rhs, RelocMat dst, wabt::Var cols_bytes,
+                                   std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates exact results as the non-SIMD
+  wabt::ExprList* MatrixVectorAdditionColumns(ds::NDArray* matrix, ds::NDArray* vector, ds::NDArray* dst_matrix,
+                                              wabt::Var cols_bytes, std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates exact results as the non-SIMD
+  wabt::ExprList* MatrixDotBf16(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) override ;
 
   // The SIMD version of this function generates a result slightly different
   // than the non-SIMD one because of the order of float addition
-  wabt::ExprList* MatrixAbsSum(ds::NDArray* matrix, wabt::Var result, std::vector<wabt::Var> locals) override ;
+  wabt::ExprList* MatrixDotInt8(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates exact results as the non-SIMD
+  wabt::ExprList* MatrixVectorScaleAddition(ds::NDArray* matrix, ds::NDArray* scales, ds::NDArray* vector,
+                                            ds::NDArray* dst_matrix, std::vector<wabt::Var> locals) override ;
 
   // The SIMD version of this function generates a result slightly different
   // than the non-SIMD one because of the order of float addition
+  wabt::ExprList* MatrixDotSparse(ds::BlockSparseNDArray* lhs, RelocMat rhs, RelocMat dst,
+                                  std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates a result slightly different
+  // than the non-SIMD one because of the order of float addition.
+  // Trailing v128 locals are reduction accumulators
+  wabt::ExprList* MatrixAbsSum(ds::NDArray* matrix, wabt::Var result, std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates a result slightly different
+  // than the non-SIMD one because of the order of float addition.
+  // Trailing v128 locals are reduction accumulators
   wabt::ExprList* MatrixSquareSum(ds::NDArray* matrix, wabt::Var result, std::vector<wabt::Var> locals) override ;
 
   // The SIMD version of this function generates a result slightly different
@@ -173,6 +308,11 @@ public:
   // than the non-SIMD one because of the order of float addition
   wabt::ExprList* MatrixAddRightSignScaleAddRightScale(ds::NDArray* lhs, ds::NDArray* rhs, ds::NDArray* dst,
                                                        float scale1, float scale2, std::vector<wabt::Var> locals) override ;
+
+  // The SIMD version of this function generates exact results as the non-SIMD
+  wabt::ExprList* MatrixOptimizerUpdate(const arch::OptimizerOptions& options, ds::NDArray* param,
+                                        ds::NDArray* grad, std::vector<ds::NDArray*> states,
+                                        wabt::ExprList* rate, std::vector<wabt::Var> locals) override ;
 };
 
 #define MATRIX_CHECK(x) \
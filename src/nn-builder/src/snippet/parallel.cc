@@ -0,0 +1,171 @@
+#include <src/nn-builder/src/snippet/parallel.h>
+#include <src/wasmpp/wasm-instructions-gen.h>
+#include <algorithm>
+
+namespace nn {
+namespace snippet {
+
+using namespace wasmpp;
+using namespace wabt;
+using namespace ds;
+
+// Offsets in the control block
+#define CONTROL_BARRIER_OFFSET  0
+#define CONTROL_TASK_OFFSET     (2 * WASMPP_I32_SIZE)
+#define CONTROL_RHS_OFFSET      (3 * WASMPP_I32_SIZE)
+
+ParallelKernels::ParallelKernels(wasmpp::ModuleManager* module_manager, MatrixSnippet* matrix, bool use_simd,
+                                 uint32_t threads) :
+    module_manager_(module_manager), matrix_(matrix), use_simd_(use_simd), threads_(threads) {
+  ERROR_UNLESS(threads_ >= 1, "threads must be at least 1");
+  if(threads_ > 1) {
+    control_ = module_manager_->Memory().Allocate(4 * TypeSize(Type::I32));
+  }
+}
+
+wabt::ExprList* ParallelKernels::Barrier(wabt::Var barrier, wabt::Var generation) {
+  ExprList* e = new ExprList();
+  Merge(e, MakeLocalSet(barrier, MakeI32Const(control_->Begin() + CONTROL_BARRIER_OFFSET)));
+  Merge(e, GenerateBarrier(&module_manager_->Label(), barrier, MakeI32Const(threads_), generation));
+  return e;
+}
+
+#define DOT_LOCALS {Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, \
+                    use_simd_ ? Type::V128 : Type::I32}
+
+wabt::ExprList* ParallelKernels::ForkJoin(RelocMat lhs, RelocMat rhs, RelocMat dst, RowsSnippet snippet,
+                                          std::vector<wabt::Var> locals) {
+  ERROR_UNLESS(threads_ > 1, "dot products are computed by a single thread");
+  MATRIX_CHECK(dst.Array());
+  assert(locals.size() == 2);
+  auto barrier = locals[0];
+  auto generation = locals[1];
+
+  // Thread t computes the rows [t * p, (t + 1) * p)
+  uint32_t rows = dst.Array()->Shape()[0];
+  uint32_t part_rows = (rows + threads_ - 1) / threads_;
+  uint32_t task = Tasks();
+  std::vector<Var> functions;
+  for(uint32_t t = 0; t < threads_; t++) {
+    uint32_t row_begin = std::min(rows, t * part_rows);
+    uint32_t row_end = std::min(rows, row_begin + part_rows);
+    wabt::TypeVector locals_types = DOT_LOCALS;
+    locals_types.push_back(Type::I32);
+    functions.push_back(module_manager_->MakeFunction(nullptr, {}, locals_types,
+                                                      [&](FuncBody f, std::vector<Var> params,
+                                                          std::vector<Var> func_locals) {
+      if(row_begin == row_end) {
+        f.Insert(MakeNop());
+        return;
+      }
+      // The rhs address of a call site is
+      // read from the control block
+      RelocMat task_rhs = rhs;
+      if(rhs.HasBeginVar()) {
+        auto rhs_begin = func_locals.back();
+        f.Insert(MakeLocalSet(rhs_begin, MakeI32Load(MakeI32Const(control_->Begin() + CONTROL_RHS_OFFSET))));
+        task_rhs = RelocMat(rhs.Array(), rhs_begin);
+      }
+      func_locals.pop_back();
+      f.Insert(snippet(lhs, task_rhs, dst, row_begin, row_end, func_locals));
+    }));
+  }
+  tasks_.push_back(functions);
+
+  ExprList* e = new ExprList();
+  // Fork
+  if(rhs.HasBeginVar()) {
+    Merge(e, MakeI32Store(MakeI32Const(control_->Begin() + CONTROL_RHS_OFFSET), rhs.MakeBegin()));
+  }
+  // Tasks are stored from 1 since 0 stops the helpers
+  Merge(e, MakeI32AtomicStore(MakeI32Const(control_->Begin() + CONTROL_TASK_OFFSET), MakeI32Const(task + 1)));
+  Merge(e, Barrier(barrier, generation));
+  Merge(e, MakeCall(functions[0], {}));
+  // Join
+  Merge(e, Barrier(barrier, generation));
+  return e;
+}
+
+wabt::ExprList* ParallelKernels::MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) {
+  return ForkJoin(lhs, rhs, dst, [&](RelocMat l, RelocMat r, RelocMat d, uint32_t row_begin, uint32_t row_end,
+                                     std::vector<Var> dot_locals) {
+    return matrix_->MatrixDotRows(l, r, d, row_begin, row_end, dot_locals);
+  }, locals);
+}
+
+wabt::ExprList* ParallelKernels::MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) {
+  return ForkJoin(lhs, rhs, dst, [&](RelocMat l, RelocMat r, RelocMat d, uint32_t row_begin, uint32_t row_end,
+                                     std::vector<Var> dot_locals) {
+    return matrix_->MatrixDotLTRows(l, r, d, row_begin, row_end, dot_locals);
+  }, locals);
+}
+
+wabt::ExprList* ParallelKernels::MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals) {
+  return ForkJoin(lhs, rhs, dst, [&](RelocMat l, RelocMat r, RelocMat d, uint32_t row_begin, uint32_t row_end,
+                                     std::vector<Var> dot_locals) {
+    return matrix_->MatrixDotRTRows(l, r, d, row_begin, row_end, dot_locals);
+  }, locals);
+}
+
+void ParallelKernels::MakeFunctions() {
+  ERROR_UNLESS(threads_ > 1, "dot products are computed by a single thread");
+
+  auto task_func = module_manager_->MakeFunction("gemm_task", {{Type::I32, Type::I32}, {}}, {},
+                                                 [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 2);
+    auto task = params[0];
+    auto thread = params[1];
+    f.Insert(MakeNop());
+    for(uint32_t k = 0; k < Tasks(); k++) {
+      auto is_task = MakeBinary(Opcode::I32Eq, MakeLocalGet(task), MakeI32Const(k));
+      f.Insert(MakeIf(f.Label(), is_task, {}, [&](BlockBody b, Var label) {
+        for(uint32_t t = 0; t < threads_; t++) {
+          auto is_thread = MakeBinary(Opcode::I32Eq, MakeLocalGet(thread), MakeI32Const(t));
+          b.Insert(MakeIf(f.Label(), is_thread, {}, [&](BlockBody b1, Var label1) {
+            b1.Insert(MakeCall(tasks_[k][t], {}));
+          }));
+        }
+      }));
+    }
+  });
+
+  module_manager_->MakeFunction("gemm_helper", {{Type::I32}, {}}, {Type::I32, Type::I32, Type::I32},
+                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(params.size() == 1);
+    auto thread = params[0];
+    assert(locals.size() == 3);
+    auto barrier = locals[0];
+    auto generation = locals[1];
+    auto task = locals[2];
+
+    // Wait for a fork, run the task of the thread,
+    // then join, until the task 0 is forked
+    f.Insert(MakeLoop(f.Label(), {}, [&](BlockBody b, Var label) {
+      b.Insert(Barrier(barrier, generation));
+      b.Insert(MakeLocalSet(task, MakeI32AtomicLoad(MakeI32Const(control_->Begin() + CONTROL_TASK_OFFSET))));
+      b.Insert(MakeIf(f.Label(), MakeLocalGet(task), {}, [&](BlockBody b1, Var label1) {
+        b1.Insert(MakeCall(task_func, {
+          MakeBinary(Opcode::I32Sub, MakeLocalGet(task), MakeI32Const(1)),
+          MakeLocalGet(thread)
+        }));
+        b1.Insert(Barrier(barrier, generation));
+        b1.Insert(MakeBr(label));
+      }));
+    }));
+  });
+
+  module_manager_->MakeFunction("stop_gemm_helpers", {}, {Type::I32, Type::I32},
+                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    assert(locals.size() == 2);
+    f.Insert(MakeI32AtomicStore(MakeI32Const(control_->Begin() + CONTROL_TASK_OFFSET), MakeI32Const(0)));
+    f.Insert(Barrier(locals[0], locals[1]));
+  });
+
+  module_manager_->MakeFunction("gemm_threads", {{}, {Type::I32}}, {},
+                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    f.Insert(MakeI32Const(threads_));
+  });
+}
+
+} // namespace snippet
+} // namespace nn
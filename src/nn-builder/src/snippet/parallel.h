@@ -0,0 +1,68 @@
+#ifndef NN_SNIPPET_PARALLEL_H_
+#define NN_SNIPPET_PARALLEL_H_
+
+#include <src/nn-builder/src/snippet/matrix.h>
+
+namespace nn {
+namespace snippet {
+
+// Compute matrix dot products on several threads sharing
+// the linear memory. Each dot product is a task whose
+// destination rows are partitioned between the threads,
+// and a function is generated per task and thread.
+// The calling thread (thread 0) forks a task by storing its
+// index and meeting the helper threads at a barrier, computes
+// its own rows, then joins the helpers at a second barrier.
+// Helper threads run the exported helper loop until stopped
+class ParallelKernels {
+private:
+  wasmpp::ModuleManager* module_manager_;
+  MatrixSnippet* matrix_;
+  bool use_simd_;
+  uint32_t threads_;
+  // Barrier (count and generation), index of the
+  // forked task, and begin address of its rhs
+  wasmpp::Memory* control_ = nullptr;
+  // Task functions indexed by task then thread
+  std::vector<std::vector<wabt::Var>> tasks_;
+
+  typedef std::function<wabt::ExprList*(RelocMat, RelocMat, RelocMat, uint32_t, uint32_t,
+                                        std::vector<wabt::Var>)> RowsSnippet;
+
+  // Generate the functions of a task and
+  // fork/join it from the calling thread
+  wabt::ExprList* ForkJoin(RelocMat lhs, RelocMat rhs, RelocMat dst, RowsSnippet snippet,
+                           std::vector<wabt::Var> locals);
+
+  // Wait for all threads at the barrier
+  wabt::ExprList* Barrier(wabt::Var barrier, wabt::Var generation);
+public:
+  // The control block is allocated
+  // when there is more than one thread
+  ParallelKernels(wasmpp::ModuleManager* module_manager, MatrixSnippet* matrix, bool use_simd, uint32_t threads);
+
+  // Dot products computed by all threads.
+  // The locals are two i32 used by the barriers
+  wabt::ExprList* MatrixDot(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixDotLT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+  wabt::ExprList* MatrixDotRT(RelocMat lhs, RelocMat rhs, RelocMat dst, std::vector<wabt::Var> locals);
+
+  // Make the exported functions once all tasks are generated:
+  // - gemm_task(task, thread): compute the rows of a thread
+  // - gemm_helper(thread): loop of a helper thread running
+  //   the forked tasks until the helpers are stopped
+  // - stop_gemm_helpers(): let the helper loops return
+  // - gemm_threads(): number of threads including thread 0
+  void MakeFunctions();
+
+  // Number of threads including the calling thread
+  uint32_t Threads() const { return threads_; }
+
+  // Number of dot products computed by all threads
+  uint32_t Tasks() const { return (uint32_t) tasks_.size(); }
+};
+
+} // namespace snippet
+} // namespace nn
+
+#endif
@@ -0,0 +1,110 @@
+#include <src/nn-builder/tests/atomic_test.h>
+#include <src/wasmpp/wasm-instructions-gen.h>
+
+namespace nn {
+namespace test {
+
+using namespace wabt;
+using namespace wasmpp;
+
+#define ASSERT_I32_EQ(val, expected)                            \
+    MakeCall(test_builtins_->assert_f32_eq, {                   \
+        MakeUnary(Opcode::F32ConvertI32U, val),                 \
+        MakeF32Const(expected)                                  \
+    })
+
+void AtomicTest::AtomicRmw_test_1() {
+  NN_TEST() {
+    auto ptr = locals[0];
+    auto addr = module_manager_->Memory().Allocate(TypeSize(Type::I32))->Begin();
+
+    f.Insert(MakeLocalSet(ptr, MakeI32Const(addr)));
+
+    f.Insert(MakeI32AtomicStore(MakeLocalGet(ptr), MakeI32Const(5)));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicRmwAdd(MakeLocalGet(ptr), MakeI32Const(3)), 5));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(ptr)), 8));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicRmwSub(MakeLocalGet(ptr), MakeI32Const(2)), 8));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicRmwXchg(MakeLocalGet(ptr), MakeI32Const(1)), 6));
+
+    // Exchange only if the expected value matches
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicRmwCmpxchg(MakeLocalGet(ptr), MakeI32Const(0), MakeI32Const(9)), 1));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(ptr)), 1));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicRmwCmpxchg(MakeLocalGet(ptr), MakeI32Const(1), MakeI32Const(9)), 1));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(ptr)), 9));
+    f.Insert(MakeAtomicFence());
+  };
+  ADD_NN_TEST(module_manager_, "AtomicRmw_1", Type::I32);
+}
+
+void AtomicTest::SpinLock_test_1() {
+  NN_TEST() {
+    auto lock = locals[0];
+    auto addr = module_manager_->Memory().Allocate(TypeSize(Type::I32))->Begin();
+
+    f.Insert(MakeLocalSet(lock, MakeI32Const(addr)));
+    f.Insert(MakeI32AtomicStore(MakeLocalGet(lock), MakeI32Const(0)));
+    f.Insert(GenerateSpinLockAcquire(f.Label(), lock));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(lock)), 1));
+    f.Insert(GenerateSpinLockRelease(lock));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(lock)), 0));
+  };
+  ADD_NN_TEST(module_manager_, "SpinLock_1", Type::I32);
+}
+
+void AtomicTest::Barrier_test_1() {
+  NN_TEST() {
+    auto barrier = locals[0];
+    auto generation = locals[1];
+    auto addr = module_manager_->Memory().Allocate(2 * TypeSize(Type::I32))->Begin();
+
+    f.Insert(MakeLocalSet(barrier, MakeI32Const(addr)));
+    f.Insert(MakeI32AtomicStore(MakeLocalGet(barrier), MakeI32Const(0)));
+    f.Insert(MakeI32AtomicStore(MakeLocalGet(barrier), MakeI32Const(0), WABT_USE_NATURAL_ALIGNMENT,
+                                TypeSize(Type::I32)));
+
+    // A single thread is always the last one to arrive
+    f.Insert(GenerateBarrier(f.Label(), barrier, MakeI32Const(1), generation));
+    f.Insert(GenerateBarrier(f.Label(), barrier, MakeI32Const(1), generation));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(barrier)), 0));
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(barrier), WABT_USE_NATURAL_ALIGNMENT,
+                                             TypeSize(Type::I32)), 2));
+  };
+  ADD_NN_TEST(module_manager_, "Barrier_1", Type::I32, Type::I32);
+}
+
+void AtomicTest::Barrier_thread_test_1() {
+  NN_TEST() {
+    auto threads = params[1];
+    auto barrier = locals[0];
+    auto generation = locals[1];
+    auto counter = locals[2];
+    auto addr = module_manager_->Memory().Allocate(3 * TypeSize(Type::I32))->Begin();
+
+    // The barrier and the counter are zero in the new memory
+    f.Insert(MakeLocalSet(barrier, MakeI32Const(addr)));
+    f.Insert(MakeLocalSet(counter, MakeI32Const(addr + 2 * TypeSize(Type::I32))));
+
+    // No thread may pass the barrier before all threads increment
+    // the counter, or increment it again before all threads read it
+    const uint32_t rounds = 8;
+    for(uint32_t round = 0; round < rounds; round++) {
+      f.Insert(MakeI32AtomicRmwAdd(MakeLocalGet(counter), MakeI32Const(1)));
+      f.Insert(MakeDrop());
+      f.Insert(GenerateBarrier(f.Label(), barrier, MakeLocalGet(threads), generation));
+      f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+          MakeUnary(Opcode::F32ConvertI32U, MakeBinary(Opcode::I32Mul, MakeLocalGet(threads),
+                                                       MakeI32Const(round + 1))),
+          MakeUnary(Opcode::F32ConvertI32U, MakeI32AtomicLoad(MakeLocalGet(counter)))
+      }));
+      f.Insert(GenerateBarrier(f.Label(), barrier, MakeLocalGet(threads), generation));
+    }
+    f.Insert(ASSERT_I32_EQ(MakeI32AtomicLoad(MakeLocalGet(barrier), WABT_USE_NATURAL_ALIGNMENT,
+                                             TypeSize(Type::I32)), 2 * rounds));
+  };
+  ADD_NN_THREAD_TEST(module_manager_, "Barrier_1", Type::I32, Type::I32, Type::I32);
+}
+
+#undef ASSERT_I32_EQ
+
+} // namespace test
+} // namespace nn
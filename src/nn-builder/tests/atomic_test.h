@@ -0,0 +1,26 @@
+#ifndef NN_TESTS_ATOMIC_TEST_H_
+#define NN_TESTS_ATOMIC_TEST_H_
+
+#include <src/wasmpp/wasm-manager.h>
+#include <src/nn-builder/tests/test-common.h>
+
+namespace nn {
+namespace test {
+
+class AtomicTest {
+private:
+  wasmpp::ModuleManager* module_manager_;
+  TestBuiltins* test_builtins_;
+public:
+  AtomicTest(wasmpp::ModuleManager* module_manager, TestBuiltins* test_builtins) :
+      module_manager_(module_manager), test_builtins_(test_builtins) {}
+  void AtomicRmw_test_1();
+  void SpinLock_test_1();
+  void Barrier_test_1();
+  void Barrier_thread_test_1();
+};
+
+} // namespace test
+} // namespace nn
+
+#endif
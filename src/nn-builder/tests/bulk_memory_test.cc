@@ -0,0 +1,117 @@
+#include <src/nn-builder/tests/bulk_memory_test.h>
+#include <src/wasmpp/wasm-instructions-gen.h>
+
+namespace nn {
+namespace test {
+
+using namespace wabt;
+using namespace wasmpp;
+
+void BulkMemoryTest::MemoryFill_test_1() {
+  NN_TEST() {
+    auto ptr = locals[0];
+    uint32_t rows = 3;
+    uint32_t cols = 5;
+    uint32_t bytes = rows * cols * TypeSize(Type::F32);
+    auto dst = module_manager_->Memory().Allocate(bytes);
+    auto expected = module_manager_->Memory().Allocate(bytes);
+
+    for(uint32_t i = 0; i < rows * cols; i++) {
+      f.Insert(MakeF32Store(MakeI32Const(dst->Begin() + i * TypeSize(Type::F32)), MakeF32Const(i + 1.5f)));
+      f.Insert(MakeF32Store(MakeI32Const(expected->Begin() + i * TypeSize(Type::F32)), MakeF32Const(0)));
+    }
+
+    f.Insert(MakeLocalSet(ptr, MakeI32Const(dst->Begin())));
+    f.Insert(MakeMemoryFill(MakeLocalGet(ptr), MakeI32Const(0), MakeI32Const(bytes)));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Begin()),
+        MakeI32Const(expected->Begin()),
+        MakeI32Const(rows),
+        MakeI32Const(cols)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MemoryFill_1", Type::I32);
+}
+
+void BulkMemoryTest::MemoryCopy_test_1() {
+  NN_TEST() {
+    auto ptr = locals[0];
+    uint32_t rows = 3;
+    uint32_t cols = 5;
+    uint32_t bytes = rows * cols * TypeSize(Type::F32);
+    auto src = module_manager_->Memory().Allocate(bytes);
+    auto dst = module_manager_->Memory().Allocate(bytes);
+
+    for(uint32_t i = 0; i < rows * cols; i++) {
+      f.Insert(MakeF32Store(MakeI32Const(src->Begin() + i * TypeSize(Type::F32)), MakeF32Const(i + 1.5f)));
+    }
+
+    f.Insert(MakeLocalSet(ptr, MakeI32Const(dst->Begin())));
+    f.Insert(MakeMemoryCopy(MakeLocalGet(ptr), MakeI32Const(src->Begin()), MakeI32Const(bytes)));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Begin()),
+        MakeI32Const(src->Begin()),
+        MakeI32Const(rows),
+        MakeI32Const(cols)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MemoryCopy_1", Type::I32);
+}
+
+void BulkMemoryTest::MemoryInit_test_1() {
+  NN_TEST() {
+    auto ptr = locals[0];
+    uint32_t rows = 3;
+    uint32_t cols = 5;
+    uint32_t bytes = rows * cols * TypeSize(Type::F32);
+    auto dst = module_manager_->Memory().Allocate(bytes);
+    auto expected = module_manager_->Memory().Allocate(bytes);
+
+    std::vector<DataEntry> entries;
+    for(uint32_t i = 0; i < rows * cols; i++) {
+      entries.push_back(DataEntry::MakeF32(i + 1.5f));
+      f.Insert(MakeF32Store(MakeI32Const(expected->Begin() + i * TypeSize(Type::F32)), MakeF32Const(i + 1.5f)));
+    }
+    auto segment = module_manager_->MakePassiveData(entries);
+
+    f.Insert(MakeLocalSet(ptr, MakeI32Const(dst->Begin())));
+    f.Insert(MakeMemoryInit(segment, MakeLocalGet(ptr), MakeI32Const(0), MakeI32Const(bytes)));
+    f.Insert(MakeDataDrop(segment));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Begin()),
+        MakeI32Const(expected->Begin()),
+        MakeI32Const(rows),
+        MakeI32Const(cols)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MemoryInit_1", Type::I32);
+}
+
+void BulkMemoryTest::MemoryGrow_test_1() {
+  NN_TEST() {
+    auto pages = locals[0];
+    auto to_f32 = [&](ExprList* e) {
+      return MakeUnary(Opcode::F32ConvertI32S, e);
+    };
+
+    // The test memory has as many pages as its maximum, so
+    // growing by 0 pages succeeds and growing by 1 page fails
+    f.Insert(MakeLocalSet(pages, MakeMemorySize()));
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        to_f32(MakeMemoryGrow(MakeI32Const(0))),
+        to_f32(MakeLocalGet(pages))
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        to_f32(MakeMemoryGrow(MakeI32Const(1))),
+        MakeF32Const(-1)
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        to_f32(MakeMemorySize()),
+        to_f32(MakeLocalGet(pages))
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MemoryGrow_1", Type::I32);
+}
+
+} // namespace test
+} // namespace nn
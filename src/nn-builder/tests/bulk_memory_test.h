@@ -0,0 +1,26 @@
+#ifndef NN_TESTS_BULK_MEMORY_TEST_H_
+#define NN_TESTS_BULK_MEMORY_TEST_H_
+
+#include <src/wasmpp/wasm-manager.h>
+#include <src/nn-builder/tests/test-common.h>
+
+namespace nn {
+namespace test {
+
+class BulkMemoryTest {
+private:
+  wasmpp::ModuleManager* module_manager_;
+  TestBuiltins* test_builtins_;
+public:
+  BulkMemoryTest(wasmpp::ModuleManager* module_manager, TestBuiltins* test_builtins) :
+      module_manager_(module_manager), test_builtins_(test_builtins) {}
+  void MemoryFill_test_1();
+  void MemoryCopy_test_1();
+  void MemoryInit_test_1();
+  void MemoryGrow_test_1();
+};
+
+} // namespace test
+} // namespace nn
+
+#endif
@@ -1,6 +1,9 @@
 #include <src/nn-builder/tests/matrix_test.h>
 #include <src/nn-builder/src/data_structure/ndarray.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace nn {
 namespace test {
@@ -189,14 +192,491 @@ void MatrixSnippetTest::MatrixDot_test_1() {
   ADD_NN_TEST(module_manager_, "MatrixDot_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
 }
 
+void MatrixSnippetTest::MatrixDotRows_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 5;
+    uint32_t lhs_cols = 10;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 7;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < rhs_cols; ++j) {
+        for (auto k = 0; k <lhs_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[k][j];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    // Compute the rows in two ranges
+    f.Insert(matrix_snippet_.MatrixDotRows(lhs, snippet::RelocMat(rhs), dst, 0, 2, locals));
+    f.Insert(matrix_snippet_.MatrixDotRows(lhs, snippet::RelocMat(rhs), dst, 2, lhs_rows, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotRows_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixDotColumns_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 5;
+    uint32_t lhs_cols = 10;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 7;
+    uint32_t dst_cols = 3;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < dst_cols; ++j) {
+        for (auto k = 0; k <lhs_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[k][j];
+        }
+      }
+    }
+    // The columns past `dst_cols` are left unchanged
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixDotColumns(lhs, snippet::RelocMat(rhs), dst, cols_bytes,
+                                              std::vector<Var>(locals.begin() + 1, locals.end())));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotColumns_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::F32, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixVectorAdditionColumns_test_1() {
+  NN_TEST() {
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+    uint32_t dst_cols = 3;
+
+    NEW_MATRIX(matrix, rows, cols);
+    NEW_MATRIX(vector, rows, 1);
+    NEW_MATRIX(dst, rows, cols);
+    NEW_MATRIX(expected, rows, cols);
+
+    // The columns past `dst_cols` are left unchanged
+    float mat_val = 1.2;
+    float vec_val = 1.3;
+    for (uint32_t row = 0; row < rows; row++) {
+      f.Insert(MakeF32Store(MakeI32Const(vector->GetLinearIndex({row, 0})), MakeF32Const(vec_val)));
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})),
+                              MakeF32Const(col < dst_cols ? mat_val + vec_val : 0)));
+        mat_val++;
+      }
+      vec_val++;
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixVectorAdditionColumns(matrix, vector, dst, cols_bytes,
+                                                         std::vector<Var>(locals.begin() + 1, locals.end())));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixVectorAdditionColumns_1", Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32);
+}
+
+void MatrixSnippetTest::MatrixActivationColumns_test_1() {
+  // Activation f(x) = 2x + 1
+  builtins::ActivationFunction func;
+  func.function = module_manager_->MakeFunction(nullptr, {{Type::F32}, {Type::F32}}, {},
+                                                [&](FuncBody f, std::vector<Var> params, std::vector<Var> locals) {
+    f.Insert(MakeBinary(Opcode::F32Add, MakeBinary(Opcode::F32Mul, MakeLocalGet(params[0]), MakeF32Const(2)),
+                        MakeF32Const(1)));
+  });
+
+  NN_TEST() {
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+    uint32_t dst_cols = 3;
+
+    NEW_MATRIX(src, rows, cols);
+    NEW_MATRIX(dst, rows, cols);
+    NEW_MATRIX(expected, rows, cols);
+
+    // The columns past `dst_cols` are left unchanged
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(src->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})),
+                              MakeF32Const(col < dst_cols ? 2 * val + 1 : 0)));
+        val++;
+      }
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixActivationColumns(src, func, dst, cols_bytes, {locals[1], locals[2]}));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixActivationColumns_1", Type::I32, Type::I32, Type::I32);
+}
+
+void MatrixSnippetTest::MatrixDotLTColumns_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 10;
+    uint32_t lhs_cols = 5;
+    uint32_t rhs_rows = lhs_rows;
+    uint32_t rhs_cols = 7;
+    uint32_t dst_cols = 3;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_cols, rhs_cols);
+    NEW_MATRIX(expected, lhs_cols, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_cols, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_cols; ++i) {
+      for (auto j = 0; j < dst_cols; ++j) {
+        for (auto k = 0; k < lhs_rows; ++k) {
+          res[i][j] += mat1[k][i] * mat2[k][j];
+        }
+      }
+    }
+    // The columns past `dst_cols` are left unchanged
+    for (uint32_t row = 0; row < lhs_cols; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixDotLTColumns(lhs, rhs, dst, cols_bytes,
+                                                std::vector<Var>(locals.begin() + 1, locals.end())));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotLTColumns_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::F32, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixDotRTColumns_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 5;
+    uint32_t lhs_cols = 7;
+    uint32_t rhs_rows = 4;
+    uint32_t rhs_cols = lhs_cols;
+    uint32_t used_cols = 3;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_rows);
+    NEW_MATRIX(expected, lhs_rows, rhs_rows);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_rows, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    // Only the first `used_cols` columns of lhs and rhs are reduced
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < rhs_rows; ++j) {
+        for (auto k = 0; k < used_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[j][k];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_rows; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(used_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixDotRTColumns(lhs, rhs, dst, cols_bytes,
+                                                std::vector<Var>(locals.begin() + 1, locals.end())));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotRTColumns_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::F32, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixHorizontalSumColumns_test_1() {
+  NN_TEST() {
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+    uint32_t used_cols = 3;
+
+    NEW_MATRIX(matrix, rows, cols);
+    NEW_MATRIX(dst, rows, 1);
+    NEW_MATRIX(expected, rows, 1);
+
+    // Only the first `used_cols` columns are summed
+    float mat_val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      float result = 0;
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        if(col < used_cols) {
+          result += mat_val;
+        }
+        mat_val++;
+      }
+      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, 0})), MakeF32Const(result)));
+    }
+
+    auto cols_bytes = locals[0];
+    f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(used_cols * TypeSize(Type::F32))));
+    f.Insert(matrix_snippet_.MatrixHorizontalSumColumns(matrix, dst, cols_bytes,
+                                                        std::vector<Var>(locals.begin() + 1, locals.end())));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixHorizontalSumColumns_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128);
+}
+
 void MatrixSnippetTest::MatrixDotLT_test_1() {
   NN_TEST() {
-    uint32_t lhs_rows = 10;
-    uint32_t lhs_cols = 5;
-    uint32_t rhs_rows = lhs_rows;
-    uint32_t rhs_cols = 7;
-    uint32_t dst_rows = lhs_cols;
-    uint32_t dst_cols = rhs_cols;
+    uint32_t lhs_rows = 10;
+    uint32_t lhs_cols = 5;
+    uint32_t rhs_rows = lhs_rows;
+    uint32_t rhs_cols = 7;
+    uint32_t dst_rows = lhs_cols;
+    uint32_t dst_cols = rhs_cols;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, dst_rows, dst_cols);
+    NEW_MATRIX(expected, dst_rows, dst_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(dst_rows, std::vector<float>(dst_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_cols; ++i) {
+      for (auto j = 0; j < rhs_cols; ++j) {
+        for (auto k = 0; k <lhs_rows; ++k) {
+          res[i][j] += mat1[k][i] * mat2[k][j];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < dst_rows; row++) {
+      for (uint32_t col = 0; col < dst_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixDotLT(lhs, rhs, dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotLT_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128);
+}
+
+void MatrixSnippetTest::MatrixDotLTRows_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 10;
+    uint32_t lhs_cols = 5;
+    uint32_t rhs_rows = lhs_rows;
+    uint32_t rhs_cols = 7;
+    uint32_t dst_rows = lhs_cols;
+    uint32_t dst_cols = rhs_cols;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, dst_rows, dst_cols);
+    NEW_MATRIX(expected, dst_rows, dst_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(dst_rows, std::vector<float>(dst_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_cols; ++i) {
+      for (auto j = 0; j < rhs_cols; ++j) {
+        for (auto k = 0; k <lhs_rows; ++k) {
+          res[i][j] += mat1[k][i] * mat2[k][j];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < dst_rows; row++) {
+      for (uint32_t col = 0; col < dst_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    // Compute the rows in two ranges
+    f.Insert(matrix_snippet_.MatrixDotLTRows(lhs, rhs, dst, 0, 2, locals));
+    f.Insert(matrix_snippet_.MatrixDotLTRows(lhs, rhs, dst, 2, dst_rows, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotLTRows_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128);
+}
+
+void MatrixSnippetTest::MatrixDotRT_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 5;
+    uint32_t lhs_cols = 10;
+    uint32_t rhs_rows = 7;
+    uint32_t rhs_cols = lhs_cols;
+    uint32_t dst_rows = lhs_rows;
+    uint32_t dst_cols = rhs_rows;
 
     NEW_MATRIX(lhs, lhs_rows, lhs_cols);
     NEW_MATRIX(rhs, rhs_rows, rhs_cols);
@@ -221,10 +701,10 @@ void MatrixSnippetTest::MatrixDotLT_test_1() {
         val++;
       }
     }
-    for (auto i = 0; i < lhs_cols; ++i) {
-      for (auto j = 0; j < rhs_cols; ++j) {
-        for (auto k = 0; k <lhs_rows; ++k) {
-          res[i][j] += mat1[k][i] * mat2[k][j];
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < rhs_rows; ++j) {
+        for (auto k = 0; k <lhs_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[j][k];
         }
       }
     }
@@ -234,7 +714,7 @@ void MatrixSnippetTest::MatrixDotLT_test_1() {
       }
     }
 
-    f.Insert(matrix_snippet_.MatrixDotLT(lhs, rhs, dst, locals));
+    f.Insert(matrix_snippet_.MatrixDotRT(lhs, rhs, dst, locals));
     f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
         MakeI32Const(dst->Memory()->Begin()),
         MakeI32Const(expected->Memory()->Begin()),
@@ -242,11 +722,11 @@ void MatrixSnippetTest::MatrixDotLT_test_1() {
         MakeI32Const(dst->Shape()[1])
     }));
   };
-  ADD_NN_TEST(module_manager_, "MatrixDotLT_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
-              Type::V128);
+  ADD_NN_TEST(module_manager_, "MatrixDotRT_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::F32, Type::V128);
 }
 
-void MatrixSnippetTest::MatrixDotRT_test_1() {
+void MatrixSnippetTest::MatrixDotRTRows_test_1() {
   NN_TEST() {
     uint32_t lhs_rows = 5;
     uint32_t lhs_cols = 10;
@@ -291,7 +771,9 @@ void MatrixSnippetTest::MatrixDotRT_test_1() {
       }
     }
 
-    f.Insert(matrix_snippet_.MatrixDotRT(lhs, rhs, dst, locals));
+    // Compute the rows in two ranges
+    f.Insert(matrix_snippet_.MatrixDotRTRows(lhs, rhs, dst, 0, 2, locals));
+    f.Insert(matrix_snippet_.MatrixDotRTRows(lhs, rhs, dst, 2, dst_rows, locals));
     f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
         MakeI32Const(dst->Memory()->Begin()),
         MakeI32Const(expected->Memory()->Begin()),
@@ -299,7 +781,7 @@ void MatrixSnippetTest::MatrixDotRT_test_1() {
         MakeI32Const(dst->Shape()[1])
     }));
   };
-  ADD_NN_TEST(module_manager_, "MatrixDotRT_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+  ADD_NN_TEST(module_manager_, "MatrixDotRTRows_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
               Type::F32, Type::V128);
 }
 
@@ -510,50 +992,608 @@ void MatrixSnippetTest::MatrixAddRightSignScale_test_1() {
     NEW_MATRIX(dst, rows, cols);
     NEW_MATRIX(expected, rows, cols);
 
-    float val = 1.2;
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float s_val = val * (col %2 == 0 ? 1 : -1);
+        float s_scale = copysignf(1.0, s_val);
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(s_val)));
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(s_val)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(s_val + (s_scale * scale))));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixAddRightSignScale(lhs, rhs, dst, scale, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixAddRightSignScale_1", Type::I32, Type::I32);
+}
+
+void MatrixSnippetTest::MatrixHorizontalSum_test_1() {
+  NN_TEST() {
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+
+    NEW_MATRIX(matrix, rows, cols);
+    NEW_MATRIX(dst, rows, 1);
+    NEW_MATRIX(expected, rows, 1);
+
+    float mat_val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      float result = 0;
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        result += mat_val;
+        mat_val++;
+      }
+      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, 0})), MakeF32Const(result)));
+    }
+
+    f.Insert(matrix_snippet_.MatrixHorizontalSum(matrix, dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixHorizontalSum_1", Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixOptimizerUpdate_test_1() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::Momentum;
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(velocity, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+    NEW_MATRIX(expected_velocity, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float v = options.beta1 * (val / 2) + val;
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(velocity->GetLinearIndex({row, col})), MakeF32Const(val / 2)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})), MakeF32Const(val - rate * v)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_velocity->GetLinearIndex({row, col})), MakeF32Const(v)));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixOptimizerUpdate(options, param, grad, {velocity}, MakeF32Const(rate), locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(velocity->Memory()->Begin()),
+        MakeI32Const(expected_velocity->Memory()->Begin()),
+        MakeI32Const(velocity->Shape()[0]),
+        MakeI32Const(velocity->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdate_1", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::I32, Type::I32);
+}
+
+void MatrixSnippetTest::MatrixOptimizerUpdate_test_2() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::Nesterov;
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(state, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+    NEW_MATRIX(expected_state, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float v = options.beta1 * (val / 2) + val;
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(state->GetLinearIndex({row, col})), MakeF32Const(val / 2)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})),
+                              MakeF32Const(val - rate * (val + options.beta1 * v))));
+        f.Insert(MakeF32Store(MakeI32Const(expected_state->GetLinearIndex({row, col})), MakeF32Const(v)));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixOptimizerUpdate(options, param, grad, {state}, MakeF32Const(rate), locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(state->Memory()->Begin()),
+        MakeI32Const(expected_state->Memory()->Begin()),
+        MakeI32Const(state->Shape()[0]),
+        MakeI32Const(state->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdate_2", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::I32, Type::I32);
+}
+
+void MatrixSnippetTest::MatrixOptimizerUpdate_test_3() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::RMSProp;
+    uint32_t rows = 5;
+    uint32_t cols = 10;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(state, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+    NEW_MATRIX(expected_state, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float v = options.beta2 * (val / 4) + (1 - options.beta2) * (val * val);
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(state->GetLinearIndex({row, col})), MakeF32Const(val / 4)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})),
+                              MakeF32Const(val - rate * (val / (sqrtf(v) + options.epsilon)))));
+        f.Insert(MakeF32Store(MakeI32Const(expected_state->GetLinearIndex({row, col})), MakeF32Const(v)));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixOptimizerUpdate(options, param, grad, {state}, MakeF32Const(rate), locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(state->Memory()->Begin()),
+        MakeI32Const(expected_state->Memory()->Begin()),
+        MakeI32Const(state->Shape()[0]),
+        MakeI32Const(state->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdate_3", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::I32, Type::I32);
+}
+
+void MatrixSnippetTest::MatrixDotBf16_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 5;
+    uint32_t lhs_cols = 9;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 7;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+    ds::NDArray* rhs_bf16 = new ds::NDArray(module_manager_->Memory().Allocate(rhs_rows * rhs_cols * snippet::BF16_SIZE),
+                                            {rhs_rows, rhs_cols}, snippet::BF16_SIZE);
+
+    // Round to bf16 (to nearest even) as the narrowing does
+    auto bf16 = [](float val) {
+      uint32_t bits;
+      memcpy(&bits, &val, sizeof(bits));
+      bits += 0x7FFF + ((bits >> 16) & 1);
+      bits &= 0xFFFF0000;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    };
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.21;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val / 7)));
+        mat2[row][col] = bf16(val / 7);
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        float res = 0;
+        for (uint32_t k = 0; k < lhs_cols; k++) {
+          res += mat1[row][k] * mat2[k][col];
+        }
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res)));
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixNarrowBf16(rhs, rhs_bf16, {locals[0], locals[1]}));
+    f.Insert(matrix_snippet_.MatrixDotBf16(lhs, snippet::RelocMat(rhs_bf16), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotBf16_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixNarrowBf16_test_1() {
+  NN_TEST() {
+    uint32_t rows = 3;
+    uint32_t cols = 5;
+
+    NEW_MATRIX(identity, rows, rows);
+    NEW_MATRIX(src, rows, cols);
+    NEW_MATRIX(dst, rows, cols);
+    NEW_MATRIX(expected, rows, cols);
+    ds::NDArray* src_bf16 = new ds::NDArray(module_manager_->Memory().Allocate(rows * cols * snippet::BF16_SIZE),
+                                            {rows, cols}, snippet::BF16_SIZE);
+
+    auto from_bits = [](uint32_t bits) {
+      float val;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    };
+
+    // f32 bits and their bf16 rounded to nearest even:
+    // ties to an even and an odd upper half, values just
+    // above and below a tie, a negative tie and zero
+    std::vector<std::pair<uint32_t, uint32_t>> values = {
+        {0x3F808000, 0x3F80}, {0x3F818000, 0x3F82}, {0x3F808001, 0x3F81}, {0x3F807FFF, 0x3F80},
+        {0xBF818000, 0xBF82}, {0x40490FDB, 0x4049}, {0x00000000, 0x0000}
+    };
+    for (uint32_t row = 0; row < rows; row++) {
+      f.Insert(MakeF32Store(MakeI32Const(identity->GetLinearIndex({row, row})), MakeF32Const(1)));
+      for (uint32_t col = 0; col < cols; col++) {
+        auto value = values[(row * cols + col) % values.size()];
+        f.Insert(MakeF32Store(MakeI32Const(src->GetLinearIndex({row, col})), MakeF32Const(from_bits(value.first))));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})),
+                              MakeF32Const(from_bits(value.second << 16))));
+      }
+    }
+
+    // The identity dot product widens the bf16 values back to f32
+    f.Insert(matrix_snippet_.MatrixNarrowBf16(src, src_bf16, {locals[0], locals[1]}));
+    f.Insert(matrix_snippet_.MatrixDotBf16(identity, snippet::RelocMat(src_bf16), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+
+    // A signaling NaN, a negative NaN with a payload and an
+    // infinity, whose bf16 bits are compared directly since
+    // NaN is not equal to itself
+    std::vector<std::pair<uint32_t, uint32_t>> special_values = {
+        {0x7F800001, 0x7FC0}, {0xFFC00001, 0x7FC0}, {0x7F800000, 0x7F80}
+    };
+    uint32_t special_cols = (uint32_t) special_values.size();
+    NEW_MATRIX(special, 1, special_cols);
+    ds::NDArray* special_bf16 = new ds::NDArray(module_manager_->Memory().Allocate(special_cols * snippet::BF16_SIZE),
+                                                {1, special_cols}, snippet::BF16_SIZE);
+    for (uint32_t col = 0; col < special_cols; col++) {
+      f.Insert(MakeI32Store(MakeI32Const(special->GetLinearIndex({0, col})), MakeI32Const(special_values[col].first)));
+    }
+    f.Insert(matrix_snippet_.MatrixNarrowBf16(special, special_bf16, {locals[0], locals[1]}));
+    for (uint32_t col = 0; col < special_cols; col++) {
+      auto bf16_bits = MakeI32Load16U(MakeI32Const(special_bf16->GetLinearIndex({0, col})));
+      f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+          MakeUnary(Opcode::F32ConvertI32U, bf16_bits),
+          MakeF32Const(special_values[col].second)
+      }));
+    }
+  };
+  ADD_NN_TEST(module_manager_, "MatrixNarrowBf16_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetTest::MatrixQuantizeRows_test_1() {
+  NN_TEST() {
+    uint32_t rows = 3;
+    uint32_t cols = 4;
+
+    NEW_MATRIX(src, rows, cols);
+    NEW_MATRIX(scales, rows, 1);
+    ds::NDArray* src_int8 = new ds::NDArray(module_manager_->Memory().Allocate(rows * cols * snippet::INT8_SIZE),
+                                            {rows, cols}, snippet::INT8_SIZE);
+
+    // A row rounded to nearest even, and rows holding a NaN
+    // and an infinity, which are quantized to zeros instead
+    // of trapping in the float to int conversion
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<std::vector<float>> values = {
+        {-2, 1, 0.5f, 2}, {1, nan, -1, 0.5f}, {1, -inf, -1, 0.5f}
+    };
+    std::vector<std::vector<int32_t>> expected = {
+        {-127, 64, 32, 127}, {0, 0, 0, 0}, {0, 0, 0, 0}
+    };
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(src->GetLinearIndex({row, col})), MakeF32Const(values[row][col])));
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixQuantizeRows(src, src_int8, scales, {locals[0], locals[1], locals[2], locals[5],
+                                                                        locals[6]}));
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        auto quantized = MakeI32Load8S(MakeI32Const(src_int8->GetLinearIndex({row, col})));
+        f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+            MakeUnary(Opcode::F32ConvertI32S, quantized),
+            MakeF32Const((float) expected[row][col])
+        }));
+      }
+    }
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        MakeF32Load(MakeI32Const(scales->GetLinearIndex({0, 0}))),
+        MakeF32Const(2.0f / 127)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixQuantizeRows_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::F32);
+}
+
+namespace {
+
+// Matrix of quarters, so a dot product with it is exact in
+// any order of addition. Row 3 is all zeros and keeps its
+// first blocks
+std::vector<std::vector<float>> SparseTestMatrix(uint32_t rows, uint32_t cols) {
+  std::vector<std::vector<float>> mat(rows, std::vector<float>(cols, 0));
+  for (uint32_t row = 0; row < rows; row++) {
+    for (uint32_t col = 0; col < cols; col++) {
+      mat[row][col] = row == 3 ? 0 : (float) ((int32_t) ((row * 7 + col * 5) % 11) - 5) * 0.25f;
+    }
+  }
+  return mat;
+}
+
+// Blocks of a row kept by MatrixPruneBlocks: the blocks
+// with the largest sums of absolute values, the first
+// one winning a tie and a NaN sum being the lowest
+std::vector<bool> KeptRowBlocks(const std::vector<float>& row, uint32_t kept_blocks) {
+  uint32_t blocks = row.size() / ds::SPARSE_BLOCK_WIDTH;
+  std::vector<float> norms(blocks, 0);
+  for (uint32_t block = 0; block < blocks; block++) {
+    for (uint32_t lane = 0; lane < ds::SPARSE_BLOCK_WIDTH; lane++) {
+      norms[block] += std::fabs(row[block * ds::SPARSE_BLOCK_WIDTH + lane]);
+    }
+    norms[block] = std::isnan(norms[block]) ? -1 : norms[block];
+  }
+  std::vector<bool> keep(blocks, false);
+  for (uint32_t k = 0; k < kept_blocks; k++) {
+    int32_t best = -1;
+    for (uint32_t block = 0; block < blocks; block++) {
+      if (!keep[block] && (best < 0 || norms[block] > norms[best])) {
+        best = block;
+      }
+    }
+    keep[best] = true;
+  }
+  return keep;
+}
+
+// Zero the blocks of each row dropped by MatrixPruneBlocks
+void ZeroPrunedBlocks(std::vector<std::vector<float>>& mat, uint32_t kept_blocks) {
+  for (auto& row : mat) {
+    std::vector<bool> keep = KeptRowBlocks(row, kept_blocks);
+    for (uint32_t col = 0; col < row.size(); col++) {
+      if (!keep[col / ds::SPARSE_BLOCK_WIDTH]) {
+        row[col] = 0;
+      }
+    }
+  }
+}
+
+} // namespace
+
+void MatrixSnippetTest::MatrixPruneBlocks_test_1() {
+  NN_TEST() {
+    uint32_t rows = 5;
+    uint32_t cols = 16;
+    uint32_t kept_blocks = ds::BlockSparseNDArray::KeptBlocks(cols, 0.5f);
+    uint32_t kept_cols = kept_blocks * ds::SPARSE_BLOCK_WIDTH;
+
+    NEW_MATRIX(src, rows, cols);
+    NEW_MATRIX(values, rows, kept_cols);
+    NEW_MATRIX(norms, cols / ds::SPARSE_BLOCK_WIDTH, 1);
+    NEW_MATRIX(expected_values, rows, kept_cols);
+    // Columns are compared as f32
+    NEW_MATRIX(columns_f32, rows, kept_blocks);
+    NEW_MATRIX(expected_columns, rows, kept_blocks);
+    ds::NDArray* columns = new ds::NDArray(module_manager_->Memory().Allocate(rows * kept_blocks * TypeSize(Type::I32)),
+                                           {rows, kept_blocks}, TypeSize(Type::I32));
+    ds::BlockSparseNDArray* sparse = new ds::BlockSparseNDArray(values, columns, cols);
+
+    // Each row keeps its blocks in column order
+    std::vector<std::vector<float>> mat = SparseTestMatrix(rows, cols);
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(src->GetLinearIndex({row, col})), MakeF32Const(mat[row][col])));
+      }
+      std::vector<bool> keep = KeptRowBlocks(mat[row], kept_blocks);
+      uint32_t kept = 0;
+      for (uint32_t block = 0; block < keep.size(); block++) {
+        if (!keep[block]) {
+          continue;
+        }
+        for (uint32_t lane = 0; lane < ds::SPARSE_BLOCK_WIDTH; lane++) {
+          float val = mat[row][block * ds::SPARSE_BLOCK_WIDTH + lane];
+          uint32_t col = kept * ds::SPARSE_BLOCK_WIDTH + lane;
+          f.Insert(MakeF32Store(MakeI32Const(expected_values->GetLinearIndex({row, col})), MakeF32Const(val)));
+        }
+        f.Insert(MakeF32Store(MakeI32Const(expected_columns->GetLinearIndex({row, kept})),
+                              MakeF32Const(block * ds::SPARSE_BLOCK_WIDTH)));
+        kept++;
+      }
+    }
+
+    f.Insert(matrix_snippet_.MatrixPruneBlocks(src, sparse, norms, locals));
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t k = 0; k < kept_blocks; k++) {
+        auto column = MakeI32Load(MakeI32Const(columns->GetLinearIndex({row, k})));
+        f.Insert(MakeF32Store(MakeI32Const(columns_f32->GetLinearIndex({row, k})),
+                              MakeUnary(Opcode::F32ConvertI32U, column)));
+      }
+    }
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(values->Memory()->Begin()),
+        MakeI32Const(expected_values->Memory()->Begin()),
+        MakeI32Const(values->Shape()[0]),
+        MakeI32Const(values->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(columns_f32->Memory()->Begin()),
+        MakeI32Const(expected_columns->Memory()->Begin()),
+        MakeI32Const(columns_f32->Shape()[0]),
+        MakeI32Const(columns_f32->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixPruneBlocks_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32);
+}
+
+void MatrixSnippetTest::MatrixPruneBlocks_test_2() {
+  NN_TEST() {
+    uint32_t rows = 2;
+    uint32_t cols = 16;
+    uint32_t kept_blocks = ds::BlockSparseNDArray::KeptBlocks(cols, 0.5f);
+    uint32_t kept_cols = kept_blocks * ds::SPARSE_BLOCK_WIDTH;
+
+    NEW_MATRIX(src, rows, cols);
+    NEW_MATRIX(values, rows, kept_cols);
+    NEW_MATRIX(norms, cols / ds::SPARSE_BLOCK_WIDTH, 1);
+    ds::NDArray* columns = new ds::NDArray(module_manager_->Memory().Allocate(rows * kept_blocks * TypeSize(Type::I32)),
+                                           {rows, kept_blocks}, TypeSize(Type::I32));
+    ds::BlockSparseNDArray* sparse = new ds::BlockSparseNDArray(values, columns, cols);
+
+    // Row 0 holds a NaN in all its blocks but the third, so it
+    // keeps the third block and the first NaN one, and still
+    // writes all its blocks before row 1
+    std::vector<std::vector<float>> mat = SparseTestMatrix(rows + 1, cols);
+    mat.erase(mat.begin());
+    for (uint32_t block : {0, 1, 3}) {
+      mat[0][block * ds::SPARSE_BLOCK_WIDTH + 1] = std::numeric_limits<float>::quiet_NaN();
+    }
+    std::vector<std::vector<uint32_t>> expected_blocks(rows);
     for (uint32_t row = 0; row < rows; row++) {
       for (uint32_t col = 0; col < cols; col++) {
-        float s_val = val * (col %2 == 0 ? 1 : -1);
-        float s_scale = copysignf(1.0, s_val);
-        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(s_val)));
-        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(s_val)));
-        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(s_val + (s_scale * scale))));
-        val++;
+        f.Insert(MakeF32Store(MakeI32Const(src->GetLinearIndex({row, col})), MakeF32Const(mat[row][col])));
+      }
+      std::vector<bool> keep = KeptRowBlocks(mat[row], kept_blocks);
+      for (uint32_t block = 0; block < keep.size(); block++) {
+        if (keep[block]) {
+          expected_blocks[row].push_back(block);
+        }
       }
     }
+    assert(expected_blocks[0] == std::vector<uint32_t>({0, 2}));
 
-    f.Insert(matrix_snippet_.MatrixAddRightSignScale(lhs, rhs, dst, scale, locals));
-    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
-        MakeI32Const(dst->Memory()->Begin()),
-        MakeI32Const(expected->Memory()->Begin()),
-        MakeI32Const(dst->Shape()[0]),
-        MakeI32Const(dst->Shape()[1])
-    }));
+    f.Insert(matrix_snippet_.MatrixPruneBlocks(src, sparse, norms, locals));
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t k = 0; k < kept_blocks; k++) {
+        uint32_t block = expected_blocks[row][k];
+        auto column = MakeI32Load(MakeI32Const(columns->GetLinearIndex({row, k})));
+        f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+            MakeUnary(Opcode::F32ConvertI32U, column),
+            MakeF32Const(block * ds::SPARSE_BLOCK_WIDTH)
+        }));
+        // NaN is not equal to itself
+        if (row == 0) {
+          continue;
+        }
+        for (uint32_t lane = 0; lane < ds::SPARSE_BLOCK_WIDTH; lane++) {
+          f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+              MakeF32Load(MakeI32Const(values->GetLinearIndex({row, k * ds::SPARSE_BLOCK_WIDTH + lane}))),
+              MakeF32Const(mat[row][block * ds::SPARSE_BLOCK_WIDTH + lane])
+          }));
+        }
+      }
+    }
   };
-  ADD_NN_TEST(module_manager_, "MatrixAddRightSignScale_1", Type::I32, Type::I32);
+  ADD_NN_TEST(module_manager_, "MatrixPruneBlocks_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32);
 }
 
-void MatrixSnippetTest::MatrixHorizontalSum_test_1() {
+void MatrixSnippetTest::MatrixDotSparse_test_1() {
   NN_TEST() {
-    uint32_t rows = 5;
-    uint32_t cols = 10;
+    uint32_t lhs_rows = 6;
+    uint32_t lhs_cols = 12;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 7;
+    uint32_t kept_blocks = ds::BlockSparseNDArray::KeptBlocks(lhs_cols, 0.34f);
 
-    NEW_MATRIX(matrix, rows, cols);
-    NEW_MATRIX(dst, rows, 1);
-    NEW_MATRIX(expected, rows, 1);
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(values, lhs_rows, kept_blocks * ds::SPARSE_BLOCK_WIDTH);
+    NEW_MATRIX(norms, lhs_cols / ds::SPARSE_BLOCK_WIDTH, 1);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+    ds::NDArray* columns = new ds::NDArray(module_manager_->Memory().Allocate(lhs_rows * kept_blocks * TypeSize(Type::I32)),
+                                           {lhs_rows, kept_blocks}, TypeSize(Type::I32));
+    ds::BlockSparseNDArray* sparse = new ds::BlockSparseNDArray(values, columns, lhs_cols);
 
-    float mat_val = 1.2;
-    for (uint32_t row = 0; row < rows; row++) {
-      float result = 0;
-      for (uint32_t col = 0; col < cols; col++) {
-        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
-        result += mat_val;
-        mat_val++;
+    std::vector<std::vector<float>> mat1 = SparseTestMatrix(lhs_rows, lhs_cols);
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(mat1[row][col])));
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        float val = (float) ((int32_t) ((row * 5 + col * 3) % 9) - 4) * 0.25f;
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+      }
+    }
+    ZeroPrunedBlocks(mat1, kept_blocks);
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        float res = 0;
+        for (uint32_t k = 0; k < lhs_cols; k++) {
+          res += mat1[row][k] * mat2[k][col];
+        }
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res)));
       }
-      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, 0})), MakeF32Const(result)));
     }
 
-    f.Insert(matrix_snippet_.MatrixHorizontalSum(matrix, dst, locals));
+    f.Insert(matrix_snippet_.MatrixPruneBlocks(lhs, sparse, norms, {locals[0], locals[1], locals[2], locals[3],
+                                                                    locals[4], locals[5], locals[6]}));
+    f.Insert(matrix_snippet_.MatrixDotSparse(sparse, rhs, dst, {locals[0], locals[1], locals[2], locals[3],
+                                                                locals[4], locals[6], locals[7]}));
     f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
         MakeI32Const(dst->Memory()->Begin()),
         MakeI32Const(expected->Memory()->Begin()),
@@ -561,7 +1601,8 @@ void MatrixSnippetTest::MatrixHorizontalSum_test_1() {
         MakeI32Const(dst->Shape()[1])
     }));
   };
-  ADD_NN_TEST(module_manager_, "MatrixHorizontalSum_1", Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+  ADD_NN_TEST(module_manager_, "MatrixDotSparse_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32, Type::V128);
 }
 
 void MatrixSnippetSimdTest::MatrixAdditionSimd_test_1() {
@@ -772,6 +1813,58 @@ void MatrixSnippetSimdTest::MatrixHorizontalSumSimd_test_1() {
   ADD_NN_TEST(module_manager_, "MatrixHorizontalSumSimd_1", Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
 }
 
+void MatrixSnippetSimdTest::MatrixHorizontalSumSimd_test_2() {
+  NN_TEST() {
+    uint32_t rows = 7;
+    uint32_t cols = 45;
+
+    NEW_MATRIX(matrix, rows, cols);
+    NEW_MATRIX(dst, rows, 1);
+    NEW_MATRIX(expected, rows, 1);
+
+    // Simulate the same order of addition for the
+    // float numbers as the SIMD version of this function
+    // using 4 accumulators, where the i-th vector of a row
+    // is added to the accumulator (i % 4), then accumulators
+    // are combined as ((acc[0] + acc[1]) + (acc[2] + acc[3]))
+    float mat_val = 1.2;
+    uint32_t simd_remainder = cols % 4;
+    uint32_t simd_cols = cols - simd_remainder;
+    for (uint32_t row = 0; row < rows; row++) {
+      float acc[4][4] = {{0}};
+      uint32_t col = 0;
+      // Simulate SIMD computation
+      for (; col < simd_cols; col++) {
+        acc[(col / 4) % 4][col % 4] += mat_val;
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        mat_val++;
+      }
+      float vec[4];
+      for(uint32_t lane = 0; lane < 4; lane++) {
+        vec[lane] = (acc[0][lane] + acc[1][lane]) + (acc[2][lane] + acc[3][lane]);
+      }
+      float result = (((vec[0] + vec[1]) + vec[2]) + vec[3]);
+      // Simulate regular computation for the remaining values
+      for(; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        result += mat_val;
+        mat_val++;
+      }
+      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, 0})), MakeF32Const(result)));
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixHorizontalSum(matrix, dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixHorizontalSumSimd_2", Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128, Type::V128, Type::V128);
+}
+
 void MatrixSnippetSimdTest::MatrixDotRTSimd_test_1() {
   NN_TEST("Matrix . Matrix^T") {
     uint32_t lhs_rows = 57;
@@ -964,32 +2057,270 @@ void MatrixSnippetSimdTest::MatrixDotSimd_test_1() {
       }
     }
 
-    f.Insert(matrix_snippet_simd_.MatrixDot(lhs, snippet::RelocMat(rhs), dst, locals));
-    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
-        MakeI32Const(dst->Memory()->Begin()),
-        MakeI32Const(expected->Memory()->Begin()),
-        MakeI32Const(dst->Shape()[0]),
-        MakeI32Const(dst->Shape()[1])
-    }));
+    f.Insert(matrix_snippet_simd_.MatrixDot(lhs, snippet::RelocMat(rhs), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotSimd_test_2() {
+  NN_TEST("Matrix . Matrix") {
+    uint32_t lhs_rows = 101;
+    uint32_t lhs_cols = 103;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 107;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < rhs_cols; ++j) {
+        for (auto k = 0; k <lhs_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[k][j];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixDot(lhs, snippet::RelocMat(rhs), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotSimd_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotSimd_test_3() {
+  NN_TEST("Matrix . Matrix with relocated operands") {
+    uint32_t lhs_rows = 13;
+    uint32_t lhs_cols = 17;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 19;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+    for (auto i = 0; i < lhs_rows; ++i) {
+      for (auto j = 0; j < rhs_cols; ++j) {
+        for (auto k = 0; k <lhs_cols; ++k) {
+          res[i][j] += mat1[i][k] * mat2[k][j];
+        }
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+      }
+    }
+
+    // Read all operands addresses from locals
+    auto lhs_begin = locals[7];
+    auto rhs_begin = locals[8];
+    auto dst_begin = locals[9];
+    f.Insert(MakeLocalSet(lhs_begin, MakeI32Const(lhs->Memory()->Begin())));
+    f.Insert(MakeLocalSet(rhs_begin, MakeI32Const(rhs->Memory()->Begin())));
+    f.Insert(MakeLocalSet(dst_begin, MakeI32Const(dst->Memory()->Begin())));
+    f.Insert(matrix_snippet_simd_.MatrixDot(snippet::RelocMat(lhs, lhs_begin), snippet::RelocMat(rhs, rhs_begin),
+                                            snippet::RelocMat(dst, dst_begin),
+                                            {locals[0], locals[1], locals[2], locals[3], locals[4], locals[5], locals[6]}));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotSimd_3", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128,
+              Type::I32, Type::I32, Type::I32);
+}
+
+void MatrixSnippetSimdTest::MatrixDotColumnsSimd_test_1() {
+  NN_TEST("Matrix . Matrix on the first columns") {
+    uint32_t lhs_rows = 7;
+    uint32_t lhs_cols = 10;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 11;
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.2;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat2[row][col] = val;
+        val++;
+      }
+    }
+
+    // Fewer columns than a SIMD group, groups with
+    // remaining columns, and groups only
+    auto cols_bytes = locals[0];
+    for (uint32_t dst_cols : {3, 6, 8}) {
+      NEW_MATRIX(dst, lhs_rows, rhs_cols);
+      NEW_MATRIX(expected, lhs_rows, rhs_cols);
+      std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+      for (auto i = 0; i < lhs_rows; ++i) {
+        for (auto j = 0; j < dst_cols; ++j) {
+          for (auto k = 0; k < lhs_cols; ++k) {
+            res[i][j] += mat1[i][k] * mat2[k][j];
+          }
+        }
+      }
+      // The columns past `dst_cols` are left unchanged
+      for (uint32_t row = 0; row < lhs_rows; row++) {
+        for (uint32_t col = 0; col < rhs_cols; col++) {
+          f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+          f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
+        }
+      }
+
+      f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+      f.Insert(matrix_snippet_simd_.MatrixDotColumns(lhs, snippet::RelocMat(rhs), dst, cols_bytes,
+                                                     std::vector<Var>(locals.begin() + 1, locals.end())));
+      f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+          MakeI32Const(dst->Memory()->Begin()),
+          MakeI32Const(expected->Memory()->Begin()),
+          MakeI32Const(dst->Shape()[0]),
+          MakeI32Const(dst->Shape()[1])
+      }));
+    }
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotColumnsSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixVectorAdditionColumnsSimd_test_1() {
+  NN_TEST() {
+    uint32_t rows = 7;
+    uint32_t cols = 11;
+
+    NEW_MATRIX(matrix, rows, cols);
+    NEW_MATRIX(vector, rows, 1);
+
+    std::vector<std::vector<float>> mat(rows, std::vector<float>(cols, 0));
+    std::vector<float> vec(rows, 0);
+    float mat_val = 1.2;
+    float vec_val = 1.3;
+    for (uint32_t row = 0; row < rows; row++) {
+      f.Insert(MakeF32Store(MakeI32Const(vector->GetLinearIndex({row, 0})), MakeF32Const(vec_val)));
+      vec[row] = vec_val;
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(mat_val)));
+        mat[row][col] = mat_val;
+        mat_val++;
+      }
+      vec_val++;
+    }
+
+    // Fewer columns than a SIMD group, groups with
+    // remaining columns, and groups only
+    auto cols_bytes = locals[0];
+    for (uint32_t dst_cols : {3, 6, 8}) {
+      NEW_MATRIX(dst, rows, cols);
+      NEW_MATRIX(expected, rows, cols);
+      // The columns past `dst_cols` are left unchanged
+      for (uint32_t row = 0; row < rows; row++) {
+        for (uint32_t col = 0; col < cols; col++) {
+          f.Insert(MakeF32Store(MakeI32Const(dst->GetLinearIndex({row, col})), MakeF32Const(0)));
+          f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})),
+                                MakeF32Const(col < dst_cols ? mat[row][col] + vec[row] : 0)));
+        }
+      }
+
+      f.Insert(MakeLocalSet(cols_bytes, MakeI32Const(dst_cols * TypeSize(Type::F32))));
+      f.Insert(matrix_snippet_simd_.MatrixVectorAdditionColumns(matrix, vector, dst, cols_bytes,
+                                                                std::vector<Var>(locals.begin() + 1, locals.end())));
+      f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+          MakeI32Const(dst->Memory()->Begin()),
+          MakeI32Const(expected->Memory()->Begin()),
+          MakeI32Const(dst->Shape()[0]),
+          MakeI32Const(dst->Shape()[1])
+      }));
+    }
   };
-  ADD_NN_TEST(module_manager_, "MatrixDotSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+  ADD_NN_TEST(module_manager_, "MatrixVectorAdditionColumnsSimd_1", Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32);
 }
 
-void MatrixSnippetSimdTest::MatrixDotSimd_test_2() {
-  NN_TEST("Matrix . Matrix") {
-    uint32_t lhs_rows = 101;
-    uint32_t lhs_cols = 103;
-    uint32_t rhs_rows = lhs_cols;
+void MatrixSnippetSimdTest::MatrixDotLTSimd_test_1() {
+  NN_TEST("Matrix^T . Matrix") {
+    uint32_t lhs_rows = 103;
+    uint32_t lhs_cols = 101;
+    uint32_t rhs_rows = lhs_rows;
     uint32_t rhs_cols = 107;
+    uint32_t dst_rows = lhs_cols;
+    uint32_t dst_cols = rhs_cols;
 
     NEW_MATRIX(lhs, lhs_rows, lhs_cols);
     NEW_MATRIX(rhs, rhs_rows, rhs_cols);
-    NEW_MATRIX(dst, lhs_rows, rhs_cols);
-    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+    NEW_MATRIX(dst, dst_rows, dst_cols);
+    NEW_MATRIX(expected, dst_rows, dst_cols);
 
     std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
     std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
-    std::vector<std::vector<float>> res(lhs_rows, std::vector<float>(rhs_cols, 0));
+    std::vector<std::vector<float>> res(dst_rows, std::vector<float>(dst_cols, 0));
     float val = 1.2;
     for (uint32_t row = 0; row < lhs_rows; row++) {
       for (uint32_t col = 0; col < lhs_cols; col++) {
@@ -1005,20 +2336,20 @@ void MatrixSnippetSimdTest::MatrixDotSimd_test_2() {
         val++;
       }
     }
-    for (auto i = 0; i < lhs_rows; ++i) {
+    for (auto i = 0; i < lhs_cols; ++i) {
       for (auto j = 0; j < rhs_cols; ++j) {
-        for (auto k = 0; k <lhs_cols; ++k) {
-          res[i][j] += mat1[i][k] * mat2[k][j];
+        for (auto k = 0; k <lhs_rows; ++k) {
+          res[i][j] += mat1[k][i] * mat2[k][j];
         }
       }
     }
-    for (uint32_t row = 0; row < lhs_rows; row++) {
-      for (uint32_t col = 0; col < rhs_cols; col++) {
+    for (uint32_t row = 0; row < dst_rows; row++) {
+      for (uint32_t col = 0; col < dst_cols; col++) {
         f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res[row][col])));
       }
     }
 
-    f.Insert(matrix_snippet_simd_.MatrixDot(lhs, snippet::RelocMat(rhs), dst, locals));
+    f.Insert(matrix_snippet_simd_.MatrixDotLT(lhs, rhs, dst, locals));
     f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
         MakeI32Const(dst->Memory()->Begin()),
         MakeI32Const(expected->Memory()->Begin()),
@@ -1026,10 +2357,10 @@ void MatrixSnippetSimdTest::MatrixDotSimd_test_2() {
         MakeI32Const(dst->Shape()[1])
     }));
   };
-  ADD_NN_TEST(module_manager_, "MatrixDotSimd_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+  ADD_NN_TEST(module_manager_, "MatrixDotLTSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
 }
 
-void MatrixSnippetSimdTest::MatrixDotLTSimd_test_1() {
+void MatrixSnippetSimdTest::MatrixDotLTRowsSimd_test_1() {
   NN_TEST("Matrix^T . Matrix") {
     uint32_t lhs_rows = 103;
     uint32_t lhs_cols = 101;
@@ -1074,7 +2405,10 @@ void MatrixSnippetSimdTest::MatrixDotLTSimd_test_1() {
       }
     }
 
-    f.Insert(matrix_snippet_simd_.MatrixDotLT(lhs, rhs, dst, locals));
+    // Compute the rows in three ranges
+    f.Insert(matrix_snippet_simd_.MatrixDotLTRows(lhs, rhs, dst, 0, 33, locals));
+    f.Insert(matrix_snippet_simd_.MatrixDotLTRows(lhs, rhs, dst, 33, 34, locals));
+    f.Insert(matrix_snippet_simd_.MatrixDotLTRows(lhs, rhs, dst, 34, dst_rows, locals));
     f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
         MakeI32Const(dst->Memory()->Begin()),
         MakeI32Const(expected->Memory()->Begin()),
@@ -1082,7 +2416,7 @@ void MatrixSnippetSimdTest::MatrixDotLTSimd_test_1() {
         MakeI32Const(dst->Shape()[1])
     }));
   };
-  ADD_NN_TEST(module_manager_, "MatrixDotLTSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
+  ADD_NN_TEST(module_manager_, "MatrixDotLTRowsSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32, Type::V128);
 }
 
 void MatrixSnippetSimdTest::MatrixAbsSumSimd_test_1() {
@@ -1138,6 +2472,61 @@ void MatrixSnippetSimdTest::MatrixAbsSumSimd_test_1() {
   ADD_NN_TEST(module_manager_, "MatrixAbsSumSimd_1", Type::I32, Type::V128, Type::F32);
 }
 
+void MatrixSnippetSimdTest::MatrixAbsSumSimd_test_2() {
+  NN_TEST() {
+    auto vi32_1 = locals[0];
+    auto result = locals[1];
+    std::vector<Var> accumulators = {locals[2], locals[3], locals[4], locals[5]};
+
+    uint32_t rows = 21;
+    uint32_t cols = 15;
+
+    NEW_MATRIX(matrix, rows, cols);
+
+    float add = 0;
+    float mat_val = 1.2;
+    auto end = rows * cols;
+    auto simd_end = end - end % 4;
+
+    uint32_t index = 0;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        auto val = mat_val * (index % 2 == 0 ? 1 : -1);
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})), MakeF32Const(val)));
+        index++;
+      }
+    }
+
+    // The i-th vector is added to the accumulator (i % 4)
+    uint32_t i = 0;
+    index = 0;
+    float acc[4][4] = {{0}};
+    for(; i < simd_end; i++) {
+      auto val = mat_val * (index++ % 2 == 0 ? 1 : -1);
+      acc[(i / 4) % 4][i % 4] += abs(val);
+    }
+    float v128[4];
+    for(uint32_t lane = 0; lane < 4; lane++) {
+      v128[lane] = (acc[0][lane] + acc[1][lane]) + (acc[2][lane] + acc[3][lane]);
+    }
+    add = v128[0] + v128[1] + v128[2] + v128[3];
+    for(; i < end; i++) {
+      auto val = mat_val * (index++ % 2 == 0 ? 1 : -1);
+      add += abs(val);
+    }
+
+    std::vector<Var> abs_sum_locals = {vi32_1};
+    abs_sum_locals.insert(abs_sum_locals.end(), accumulators.begin(), accumulators.end());
+    f.Insert(matrix_snippet_simd_.MatrixAbsSum(matrix, result, abs_sum_locals));
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        MakeF32Const(add),
+        MakeLocalGet(result)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixAbsSumSimd_2", Type::I32, Type::F32, Type::V128, Type::V128, Type::V128,
+              Type::V128);
+}
+
 void MatrixSnippetSimdTest::MatrixSquareSumSimd_test_1() {
   NN_TEST() {
     auto vi32_1 = locals[0];
@@ -1183,6 +2572,63 @@ void MatrixSnippetSimdTest::MatrixSquareSumSimd_test_1() {
   ADD_NN_TEST(module_manager_, "MatrixSquareSumSimd_1", Type::I32, Type::F32, Type::V128, Type::F32);
 }
 
+void MatrixSnippetSimdTest::MatrixSquareSumSimd_test_2() {
+  NN_TEST() {
+    auto vi32_1 = locals[0];
+    auto vf32_1 = locals[1];
+    auto result = locals[2];
+    std::vector<Var> accumulators = {locals[3], locals[4], locals[5]};
+
+    uint32_t rows = 7;
+    uint32_t cols = 11;
+
+    NEW_MATRIX(matrix, rows, cols);
+
+    auto end = rows * cols;
+    auto simd_end = end - end % 4;
+    auto unrolled_end = end - end % (4 * accumulators.size());
+    auto ValueAt = [](uint32_t index) {
+      return 0.1f * (index % 7 + 1);
+    };
+
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(matrix->GetLinearIndex({row, col})),
+                              MakeF32Const(ValueAt(row * cols + col))));
+      }
+    }
+
+    // The i-th vector of the unrolled loop is added to the accumulator (i % 3),
+    // the remaining vectors to the first accumulators
+    uint32_t i = 0;
+    float acc[3][4] = {{0}};
+    for(; i < unrolled_end; i++) {
+      acc[(i / 4) % 3][i % 4] += ValueAt(i) * ValueAt(i);
+    }
+    for(; i < simd_end; i++) {
+      acc[(i - unrolled_end) / 4][i % 4] += ValueAt(i) * ValueAt(i);
+    }
+    float v128[4];
+    for(uint32_t lane = 0; lane < 4; lane++) {
+      v128[lane] = (acc[0][lane] + acc[1][lane]) + acc[2][lane];
+    }
+    float add = v128[0] + v128[1] + v128[2] + v128[3];
+    for(; i < end; i++) {
+      add += ValueAt(i) * ValueAt(i);
+    }
+
+    std::vector<Var> square_sum_locals = {vi32_1, vf32_1};
+    square_sum_locals.insert(square_sum_locals.end(), accumulators.begin(), accumulators.end());
+    f.Insert(matrix_snippet_simd_.MatrixSquareSum(matrix, result, square_sum_locals));
+    f.Insert(MakeCall(test_builtins_->assert_f32_eq, {
+        MakeF32Const(add),
+        MakeLocalGet(result)
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixSquareSumSimd_2", Type::I32, Type::F32, Type::F32, Type::V128, Type::V128,
+              Type::V128);
+}
+
 void MatrixSnippetSimdTest::MatrixAddRightScaleSimd_test_1() {
   NN_TEST() {
     float scale = 0.01234;
@@ -1367,6 +2813,407 @@ void MatrixSnippetSimdTest::MatrixAddRightSignScaleAddRightScale_test_1() {
   ADD_NN_TEST(module_manager_, "MatrixAddRightSignScaleAddRightScaleSimd_1", Type::I32, Type::I32, Type::F32, Type::V128);
 }
 
+void MatrixSnippetSimdTest::MatrixOptimizerUpdateSimd_test_1() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::Adam;
+    uint32_t rows = 13;
+    uint32_t cols = 21;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(moment1, rows, cols);
+    NEW_MATRIX(moment2, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float m = options.beta1 * (val / 2) + (1 - options.beta1) * val;
+        float v = options.beta2 * (val / 4) + (1 - options.beta2) * (val * val);
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(moment1->GetLinearIndex({row, col})), MakeF32Const(val / 2)));
+        f.Insert(MakeF32Store(MakeI32Const(moment2->GetLinearIndex({row, col})), MakeF32Const(val / 4)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})),
+                              MakeF32Const(val - rate * (m / (sqrtf(v) + options.epsilon)))));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixOptimizerUpdate(options, param, grad, {moment1, moment2}, MakeF32Const(rate),
+                                                        locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdateSimd_1", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixOptimizerUpdateSimd_test_2() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::Nesterov;
+    uint32_t rows = 13;
+    uint32_t cols = 21;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(state, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+    NEW_MATRIX(expected_state, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float v = options.beta1 * (val / 2) + val;
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(state->GetLinearIndex({row, col})), MakeF32Const(val / 2)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})),
+                              MakeF32Const(val - rate * (val + options.beta1 * v))));
+        f.Insert(MakeF32Store(MakeI32Const(expected_state->GetLinearIndex({row, col})), MakeF32Const(v)));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixOptimizerUpdate(options, param, grad, {state}, MakeF32Const(rate), locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(state->Memory()->Begin()),
+        MakeI32Const(expected_state->Memory()->Begin()),
+        MakeI32Const(state->Shape()[0]),
+        MakeI32Const(state->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdateSimd_2", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixOptimizerUpdateSimd_test_3() {
+  NN_TEST() {
+    float rate = 0.01;
+    arch::OptimizerOptions options;
+    options.type = arch::RMSProp;
+    uint32_t rows = 13;
+    uint32_t cols = 21;
+
+    NEW_MATRIX(param, rows, cols);
+    NEW_MATRIX(grad, rows, cols);
+    NEW_MATRIX(state, rows, cols);
+    NEW_MATRIX(expected_param, rows, cols);
+    NEW_MATRIX(expected_state, rows, cols);
+
+    float val = 1.2;
+    for (uint32_t row = 0; row < rows; row++) {
+      for (uint32_t col = 0; col < cols; col++) {
+        float v = options.beta2 * (val / 4) + (1 - options.beta2) * (val * val);
+        f.Insert(MakeF32Store(MakeI32Const(param->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(grad->GetLinearIndex({row, col})), MakeF32Const(val)));
+        f.Insert(MakeF32Store(MakeI32Const(state->GetLinearIndex({row, col})), MakeF32Const(val / 4)));
+        f.Insert(MakeF32Store(MakeI32Const(expected_param->GetLinearIndex({row, col})),
+                              MakeF32Const(val - rate * (val / (sqrtf(v) + options.epsilon)))));
+        f.Insert(MakeF32Store(MakeI32Const(expected_state->GetLinearIndex({row, col})), MakeF32Const(v)));
+        val++;
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixOptimizerUpdate(options, param, grad, {state}, MakeF32Const(rate), locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(param->Memory()->Begin()),
+        MakeI32Const(expected_param->Memory()->Begin()),
+        MakeI32Const(param->Shape()[0]),
+        MakeI32Const(param->Shape()[1])
+    }));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(state->Memory()->Begin()),
+        MakeI32Const(expected_state->Memory()->Begin()),
+        MakeI32Const(state->Shape()[0]),
+        MakeI32Const(state->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixOptimizerUpdateSimd_3", Type::I32, Type::I32, Type::F32, Type::F32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotBf16Simd_test_1() {
+  NN_TEST() {
+    uint32_t lhs_rows = 11;
+    uint32_t lhs_cols = 9;
+    uint32_t rhs_rows = lhs_cols;
+    uint32_t rhs_cols = 13; // A group of 8 columns and a remainder
+
+    NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+    NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+    NEW_MATRIX(dst, lhs_rows, rhs_cols);
+    NEW_MATRIX(expected, lhs_rows, rhs_cols);
+    ds::NDArray* rhs_bf16 = new ds::NDArray(module_manager_->Memory().Allocate(rhs_rows * rhs_cols * snippet::BF16_SIZE),
+                                            {rhs_rows, rhs_cols}, snippet::BF16_SIZE);
+
+    // Round to bf16 (to nearest even) as the narrowing does
+    auto bf16 = [](float val) {
+      uint32_t bits;
+      memcpy(&bits, &val, sizeof(bits));
+      bits += 0x7FFF + ((bits >> 16) & 1);
+      bits &= 0xFFFF0000;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    };
+
+    std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+    std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+    float val = 1.21;
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < lhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+        mat1[row][col] = val;
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < rhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val / 7)));
+        mat2[row][col] = bf16(val / 7);
+        val++;
+      }
+    }
+    for (uint32_t row = 0; row < lhs_rows; row++) {
+      for (uint32_t col = 0; col < rhs_cols; col++) {
+        float res = 0;
+        for (uint32_t k = 0; k < lhs_cols; k++) {
+          res += mat1[row][k] * mat2[k][col];
+        }
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res)));
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixNarrowBf16(rhs, rhs_bf16, {locals[0], locals[1]}));
+    f.Insert(matrix_snippet_simd_.MatrixDotBf16(lhs, snippet::RelocMat(rhs_bf16), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotBf16Simd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotBf16Simd_test_2() {
+  NN_TEST("Identity . bf16 matrix") {
+    uint32_t rows = 3;
+    uint32_t cols = 13; // A group of 8 columns and a remainder
+
+    NEW_MATRIX(identity, rows, rows);
+    NEW_MATRIX(dst, rows, cols);
+    NEW_MATRIX(expected, rows, cols);
+    ds::NDArray* rhs_bf16 = new ds::NDArray(module_manager_->Memory().Allocate(rows * cols * snippet::BF16_SIZE),
+                                            {rows, cols}, snippet::BF16_SIZE);
+
+    // The bf16 values are stored directly, and each is
+    // widened exactly to the f32 of its upper half, in
+    // the even and odd columns of the groups of 8 columns
+    // and in the remaining columns
+    std::vector<uint32_t> halves = {0x3F80, 0xBF82, 0x4049, 0x0000, 0x7F7F, 0x0080, 0xC2C8};
+    for (uint32_t row = 0; row < rows; row++) {
+      f.Insert(MakeF32Store(MakeI32Const(identity->GetLinearIndex({row, row})), MakeF32Const(1)));
+      for (uint32_t col = 0; col < cols; col++) {
+        uint32_t half = halves[(row * cols + col) % halves.size()];
+        uint32_t bits = half << 16;
+        float val;
+        memcpy(&val, &bits, sizeof(val));
+        f.Insert(MakeI32Store16(MakeI32Const(rhs_bf16->GetLinearIndex({row, col})), MakeI32Const(half)));
+        f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(val)));
+      }
+    }
+
+    f.Insert(matrix_snippet_simd_.MatrixDotBf16(identity, snippet::RelocMat(rhs_bf16), dst, locals));
+    f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+        MakeI32Const(dst->Memory()->Begin()),
+        MakeI32Const(expected->Memory()->Begin()),
+        MakeI32Const(dst->Shape()[0]),
+        MakeI32Const(dst->Shape()[1])
+    }));
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotBf16Simd_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotInt8Simd(FuncBody f, std::vector<Var> locals, uint32_t lhs_rows,
+                                              uint32_t lhs_cols, uint32_t rhs_cols) {
+  uint32_t rhs_rows = lhs_cols;
+
+  NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+  NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+  NEW_MATRIX(scales, lhs_rows, 1);
+  NEW_MATRIX(bias, lhs_rows, 1);
+  NEW_MATRIX(dst, lhs_rows, rhs_cols);
+  NEW_MATRIX(expected, lhs_rows, rhs_cols);
+  ds::NDArray* lhs_int8 = new ds::NDArray(module_manager_->Memory().Allocate(lhs_rows * lhs_cols * snippet::INT8_SIZE),
+                                          {lhs_rows, lhs_cols}, snippet::INT8_SIZE);
+
+  // Scales are powers of two and the rhs holds quarters,
+  // so the result is exact in any order of addition.
+  // Row 3 is all zeros and the third column is rounded
+  std::vector<std::vector<float>> mat1(lhs_rows, std::vector<float>(lhs_cols, 0));
+  std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+  std::vector<float> row_scales(lhs_rows, 0);
+  for (uint32_t row = 0; row < lhs_rows; row++) {
+    float scale = row % 2 == 0 ? 0.5f : 0.25f;
+    float max = 0;
+    for (uint32_t col = 0; col < lhs_cols; col++) {
+      float val = scale * (float) ((int32_t) ((row * 31 + col * 17) % 255) - 127);
+      if(row == 3) {
+        val = 0;
+      } else if(col == 0) {
+        val = -127 * scale;
+      } else if(col == 2) {
+        val += 0.1f * scale;
+      }
+      f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+      mat1[row][col] = val;
+      max = std::max(max, std::fabs(val));
+    }
+    // Quantize as MatrixQuantizeRows does
+    row_scales[row] = max / 127;
+    float inv_scale = max > 0 ? 127 / max : 0;
+    for (uint32_t col = 0; col < lhs_cols; col++) {
+      mat1[row][col] = std::nearbyint(mat1[row][col] * inv_scale);
+    }
+    f.Insert(MakeF32Store(MakeI32Const(bias->GetLinearIndex({row, 0})), MakeF32Const(row * 0.5f)));
+  }
+  for (uint32_t row = 0; row < rhs_rows; row++) {
+    for (uint32_t col = 0; col < rhs_cols; col++) {
+      float val = (float) ((int32_t) ((row * 5 + col * 3) % 9) - 4) * 0.25f;
+      f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+      mat2[row][col] = val;
+    }
+  }
+  for (uint32_t row = 0; row < lhs_rows; row++) {
+    for (uint32_t col = 0; col < rhs_cols; col++) {
+      float res = 0;
+      for (uint32_t k = 0; k < lhs_cols; k++) {
+        res += mat1[row][k] * mat2[k][col];
+      }
+      res = res * row_scales[row] + row * 0.5f;
+      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res)));
+    }
+  }
+
+  std::vector<Var> dot_locals(locals.begin(), locals.begin() + 8);
+  f.Insert(matrix_snippet_simd_.MatrixQuantizeRows(lhs, lhs_int8, scales, {locals[0], locals[1], locals[2], locals[5],
+                                                                          locals[8]}));
+  f.Insert(matrix_snippet_simd_.MatrixDotInt8(snippet::RelocMat(lhs_int8), rhs, dst, dot_locals));
+  f.Insert(matrix_snippet_simd_.MatrixVectorScaleAddition(dst, scales, bias, dst, {locals[0], locals[1], locals[2],
+                                                                                  locals[3]}));
+  f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+      MakeI32Const(dst->Memory()->Begin()),
+      MakeI32Const(expected->Memory()->Begin()),
+      MakeI32Const(dst->Shape()[0]),
+      MakeI32Const(dst->Shape()[1])
+  }));
+}
+
+void MatrixSnippetSimdTest::MatrixDotInt8Simd_test_1() {
+  NN_TEST() {
+    // A group of 4 columns and a remainder
+    MatrixDotInt8Simd(f, locals, 6, 9, 7);
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotInt8Simd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128, Type::F32);
+}
+
+void MatrixSnippetSimdTest::MatrixDotInt8Simd_test_2() {
+  NN_TEST() {
+    // rhs is a vector
+    MatrixDotInt8Simd(f, locals, 5, 9, 1);
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotInt8Simd_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32, Type::F32,
+              Type::V128, Type::V128, Type::F32);
+}
+
+void MatrixSnippetSimdTest::MatrixDotSparseSimd(FuncBody f, std::vector<Var> locals, uint32_t lhs_rows,
+                                                uint32_t lhs_cols, uint32_t rhs_cols, float sparsity) {
+  uint32_t rhs_rows = lhs_cols;
+  uint32_t kept_blocks = ds::BlockSparseNDArray::KeptBlocks(lhs_cols, sparsity);
+
+  NEW_MATRIX(lhs, lhs_rows, lhs_cols);
+  NEW_MATRIX(rhs, rhs_rows, rhs_cols);
+  NEW_MATRIX(values, lhs_rows, kept_blocks * ds::SPARSE_BLOCK_WIDTH);
+  NEW_MATRIX(norms, lhs_cols / ds::SPARSE_BLOCK_WIDTH, 1);
+  NEW_MATRIX(dst, lhs_rows, rhs_cols);
+  NEW_MATRIX(expected, lhs_rows, rhs_cols);
+  ds::NDArray* columns = new ds::NDArray(module_manager_->Memory().Allocate(lhs_rows * kept_blocks * TypeSize(Type::I32)),
+                                         {lhs_rows, kept_blocks}, TypeSize(Type::I32));
+  ds::BlockSparseNDArray* sparse = new ds::BlockSparseNDArray(values, columns, lhs_cols);
+
+  std::vector<std::vector<float>> mat1 = SparseTestMatrix(lhs_rows, lhs_cols);
+  std::vector<std::vector<float>> mat2(rhs_rows, std::vector<float>(rhs_cols, 0));
+  for (uint32_t row = 0; row < lhs_rows; row++) {
+    for (uint32_t col = 0; col < lhs_cols; col++) {
+      f.Insert(MakeF32Store(MakeI32Const(lhs->GetLinearIndex({row, col})), MakeF32Const(mat1[row][col])));
+    }
+  }
+  for (uint32_t row = 0; row < rhs_rows; row++) {
+    for (uint32_t col = 0; col < rhs_cols; col++) {
+      float val = (float) ((int32_t) ((row * 5 + col * 3) % 9) - 4) * 0.25f;
+      f.Insert(MakeF32Store(MakeI32Const(rhs->GetLinearIndex({row, col})), MakeF32Const(val)));
+      mat2[row][col] = val;
+    }
+  }
+  ZeroPrunedBlocks(mat1, kept_blocks);
+  for (uint32_t row = 0; row < lhs_rows; row++) {
+    for (uint32_t col = 0; col < rhs_cols; col++) {
+      float res = 0;
+      for (uint32_t k = 0; k < lhs_cols; k++) {
+        res += mat1[row][k] * mat2[k][col];
+      }
+      f.Insert(MakeF32Store(MakeI32Const(expected->GetLinearIndex({row, col})), MakeF32Const(res)));
+    }
+  }
+
+  f.Insert(matrix_snippet_simd_.MatrixPruneBlocks(lhs, sparse, norms, {locals[0], locals[1], locals[2], locals[3],
+                                                                       locals[4], locals[5], locals[6]}));
+  f.Insert(matrix_snippet_simd_.MatrixDotSparse(sparse, rhs, dst, {locals[0], locals[1], locals[2], locals[3],
+                                                                   locals[4], locals[6], locals[7]}));
+  f.Insert(MakeCall(test_builtins_->assert_matrix_eq, {
+      MakeI32Const(dst->Memory()->Begin()),
+      MakeI32Const(expected->Memory()->Begin()),
+      MakeI32Const(dst->Shape()[0]),
+      MakeI32Const(dst->Shape()[1])
+  }));
+}
+
+void MatrixSnippetSimdTest::MatrixDotSparseSimd_test_1() {
+  NN_TEST() {
+    // A group of 4 columns and a remainder
+    MatrixDotSparseSimd(f, locals, 6, 12, 7, 0.34f);
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotSparseSimd_1", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32, Type::V128);
+}
+
+void MatrixSnippetSimdTest::MatrixDotSparseSimd_test_2() {
+  NN_TEST() {
+    // rhs is a vector
+    MatrixDotSparseSimd(f, locals, 5, 16, 1, 0.5f);
+  };
+  ADD_NN_TEST(module_manager_, "MatrixDotSparseSimd_2", Type::I32, Type::I32, Type::I32, Type::I32, Type::I32,
+              Type::I32, Type::F32, Type::V128);
+}
+
 } // namespace test
 } // namespace nn
 
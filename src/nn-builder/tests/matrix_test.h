@@ -23,6 +23,15 @@ public:
   void MatrixDot_test_1();
   void MatrixDotLT_test_1();
   void MatrixDotRT_test_1();
+  void MatrixDotRows_test_1();
+  void MatrixDotColumns_test_1();
+  void MatrixVectorAdditionColumns_test_1();
+  void MatrixActivationColumns_test_1();
+  void MatrixDotLTColumns_test_1();
+  void MatrixDotRTColumns_test_1();
+  void MatrixHorizontalSumColumns_test_1();
+  void MatrixDotLTRows_test_1();
+  void MatrixDotRTRows_test_1();
   void MatrixVectorAddition_test_1();
   void MatrixHorizontalSum_test_1();
   void MatrixAbsSum_test_1();
@@ -31,6 +40,15 @@ public:
   void MatrixSubRightScale_test_1();
   void MatrixAddRightSignScale_test_1();
   void MatrixAddRightSignScaleAddRightScale_test_1();
+  void MatrixOptimizerUpdate_test_1();
+  void MatrixOptimizerUpdate_test_2();
+  void MatrixOptimizerUpdate_test_3();
+  void MatrixDotBf16_test_1();
+  void MatrixNarrowBf16_test_1();
+  void MatrixQuantizeRows_test_1();
+  void MatrixPruneBlocks_test_1();
+  void MatrixPruneBlocks_test_2();
+  void MatrixDotSparse_test_1();
 };
 
 class MatrixSnippetSimdTest {
@@ -38,6 +56,15 @@ private:
   snippet::MatrixSnippetSimd matrix_snippet_simd_;
   wasmpp::ModuleManager* module_manager_;
   TestBuiltins* test_builtins_;
+
+  // Quantize a lhs_rows x lhs_cols matrix, multiply it by a
+  // lhs_cols x rhs_cols matrix and check the scaled result
+  void MatrixDotInt8Simd(wasmpp::FuncBody f, std::vector<wabt::Var> locals, uint32_t lhs_rows, uint32_t lhs_cols,
+                         uint32_t rhs_cols);
+  // Prune a lhs_rows x lhs_cols matrix, multiply it by a
+  // lhs_cols x rhs_cols matrix and check the result
+  void MatrixDotSparseSimd(wasmpp::FuncBody f, std::vector<wabt::Var> locals, uint32_t lhs_rows, uint32_t lhs_cols,
+                           uint32_t rhs_cols, float sparsity);
 public:
   MatrixSnippetSimdTest(wasmpp::ModuleManager* module_manager, TestBuiltins* test_builtins) :
       module_manager_(module_manager), test_builtins_(test_builtins),
@@ -48,17 +75,33 @@ public:
   void MatrixScalarSimd_test_1();
   void MatrixDotSimd_test_1();
   void MatrixDotSimd_test_2();
+  void MatrixDotSimd_test_3();
+  void MatrixDotColumnsSimd_test_1();
+  void MatrixVectorAdditionColumnsSimd_test_1();
   void MatrixDotLTSimd_test_1();
+  void MatrixDotLTRowsSimd_test_1();
   void MatrixDotRTSimd_test_1();
   void MatrixDotRTSimd_test_2();
   void MatrixVectorAdditionSimd_test_1();
   void MatrixHorizontalSumSimd_test_1();
+  void MatrixHorizontalSumSimd_test_2();
   void MatrixAbsSumSimd_test_1();
+  void MatrixAbsSumSimd_test_2();
   void MatrixSquareSumSimd_test_1();
+  void MatrixSquareSumSimd_test_2();
   void MatrixAddRightScaleSimd_test_1();
   void MatrixSubRightScaleSimd_test_1();
   void MatrixAddRightSignScaleSimd_test_1();
   void MatrixAddRightSignScaleAddRightScale_test_1();
+  void MatrixOptimizerUpdateSimd_test_1();
+  void MatrixOptimizerUpdateSimd_test_2();
+  void MatrixOptimizerUpdateSimd_test_3();
+  void MatrixDotBf16Simd_test_1();
+  void MatrixDotBf16Simd_test_2();
+  void MatrixDotInt8Simd_test_1();
+  void MatrixDotInt8Simd_test_2();
+  void MatrixDotSparseSimd_test_1();
+  void MatrixDotSparseSimd_test_2();
 };
 
 } // namespace test
@@ -0,0 +1,425 @@
+#include <src/nn-builder/tests/model_test.h>
+#include <src/nn-builder/src/arch/layers/dense.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+namespace nn {
+namespace test {
+
+using namespace nn::arch;
+using namespace nn::arch::layer;
+using namespace nn::runtime;
+
+const uint32_t inputs = 8;
+const uint32_t outputs = 4;
+
+Model* ModelTest::MakeModel(ModelOptions options, ModelConfig config) {
+  Model* model = new Model(options);
+  model->SetLayers({
+     NewLayer<DenseInputLayer>(inputs)->WeightType(XavierUniform)->KeepProb(1),
+     NewLayer<DenseHiddenLayer>(config.hidden_nodes, model->Builtins().activation.Sigmoid())
+         ->WeightType(XavierUniform)->KeepProb(1)->Sparsity(config.sparsity),
+     NewLayer<DenseHiddenLayer>(config.hidden_nodes, model->Builtins().activation.Tanh())
+         ->WeightType(XavierUniform)->KeepProb(1)->Sparsity(config.sparsity),
+     NewLayer<DenseOutputLayer>(outputs, model->Builtins().activation.Softmax())->WeightType(LeCunUniform)
+         ->Sparsity(config.sparsity)
+  });
+  model->Build(config.training_batch_size, config.training_batches_in_memory, 4, 2, 4,
+               model->Builtins().loss.SoftmaxCrossEntropy(), config.regularizer, config.regularizer);
+  return model;
+}
+
+void ModelTest::FillBatches(float* data, float* labels, uint32_t batch_size, uint32_t batches, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> input(-1, 1);
+  std::uniform_int_distribution<uint32_t> label(0, outputs - 1);
+  for(uint32_t i = 0; i < inputs * batch_size * batches; i++) {
+    data[i] = input(generator);
+  }
+  std::fill(labels, labels + outputs * batch_size * batches, 0.0f);
+  for(uint32_t b = 0; b < batches; b++) {
+    for(uint32_t col = 0; col < batch_size; col++) {
+      labels[b * outputs * batch_size + label(generator) * batch_size + col] = 1;
+    }
+  }
+}
+
+void ModelTest::Begin(std::string name) {
+  std::cout << ">>  Testing model: " << name << std::endl;
+}
+
+void ModelTest::ExpectTrue(bool condition, std::string what) {
+  if(!condition) {
+    std::cerr << "Expectation failed: " << what << std::endl;
+    failures_++;
+  }
+}
+
+void ModelTest::ExpectEq(const std::vector<float>& expected, const std::vector<float>& actual, std::string what) {
+  if(expected.size() != actual.size()) {
+    std::cerr << "Equality failed: " << what << " has " << actual.size() << " values instead of "
+              << expected.size() << std::endl;
+    failures_++;
+    return;
+  }
+  for(size_t i = 0; i < expected.size(); i++) {
+    if(expected[i] != actual[i]) {
+      std::cerr << "Equality failed: " << what << "[" << i << "] " << expected[i] << " != " << actual[i]
+                << std::endl;
+      failures_++;
+      return;
+    }
+  }
+}
+
+void ModelTest::ExpectNear(const std::vector<float>& expected, const std::vector<float>& actual, float tolerance,
+                           std::string what) {
+  if(expected.size() != actual.size()) {
+    std::cerr << "Equality failed: " << what << " has " << actual.size() << " values instead of "
+              << expected.size() << std::endl;
+    failures_++;
+    return;
+  }
+  for(size_t i = 0; i < expected.size(); i++) {
+    if(std::fabs(expected[i] - actual[i]) > tolerance * std::max(1.0f, std::fabs(expected[i]))) {
+      std::cerr << "Equality failed: " << what << "[" << i << "] " << expected[i] << " != " << actual[i]
+                << std::endl;
+      failures_++;
+      return;
+    }
+  }
+}
+
+void ModelTest::DerivativeFromOutput_test_1() {
+  Begin("DerivativeFromOutput_1");
+  // The sigmoid and tanh derivatives computed from A[l]
+  // must train exactly as the ones recomputing g(Z[l])
+  std::vector<std::vector<float>> weights;
+  for(bool from_output : {false, true}) {
+    ModelOptions options;
+    options.bytecode_options.use_simd = true;
+    options.activation_options.derivative_from_output = from_output;
+    ModelConfig config;
+    config.training_batches_in_memory = 3;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    ModelRuntime runtime(model.get(), 0);
+    runtime.SetLearningRate(0.1);
+    FillBatches(runtime.TrainingData(), runtime.TrainingLabels(), 4, 3, 1);
+    for(int epoch = 0; epoch < 3; epoch++) {
+      runtime.TrainBatchesInMemory(3);
+    }
+    weights.push_back(runtime.ExtractWeights());
+  }
+  ExpectEq(weights[0], weights[1], "weights trained with the output derivatives");
+}
+
+void ModelTest::DeterministicBuild_test_1() {
+  Begin("DeterministicBuild_1");
+  // The same model must give the same bytecode when built
+  // again, and for any number of code generation threads
+  std::vector<std::vector<uint8_t>> wasm;
+  for(uint32_t threads : {0, 4, 4}) {
+    ModelOptions options;
+    options.bytecode_options.use_simd = true;
+    options.bytecode_options.split_layer_functions = true;
+    options.bytecode_options.codegen_threads = threads;
+    ModelConfig config;
+    config.training_batches_in_memory = 3;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    wasm.push_back(model->ModuleManager().ToWasm().data);
+  }
+  ExpectTrue(wasm[0] == wasm[1], "bytecode generated on 4 threads differs from the sequential one");
+  ExpectTrue(wasm[1] == wasm[2], "bytecode generated on 4 threads differs between two builds");
+}
+
+void ModelTest::SharedMemoryData_test_1() {
+  Begin("SharedMemoryData_1");
+  // Each instance on a shared memory would apply active
+  // segments again over the weights and the state being
+  // trained, so only init_weights() may initialize them
+  for(bool training_workers : {true, false}) {
+    ModelOptions options;
+    options.bytecode_options.use_simd = true;
+    if(training_workers) {
+      options.bytecode_options.training_workers = 2;
+    } else {
+      options.bytecode_options.parallel_gemm_threads = 2;
+      options.bytecode_options.parallel_gemm_min_nodes = 1;
+      options.bytecode_options.resident_training_samples = 8;
+      options.optimizer_options.type = Adam;
+    }
+    ModelConfig config;
+    config.training_batches_in_memory = 4;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    auto& module = model->ModuleManager().GetModule();
+    for(auto segment : module.data_segments) {
+      ExpectTrue(segment->kind == wabt::SegmentKind::Passive, "active data segment on a shared memory");
+    }
+    ExpectTrue(module.GetExport("init_weights") != nullptr, "init_weights() is not exported");
+  }
+}
+
+void ModelTest::LoadBatchClamp_test_1() {
+  Begin("LoadBatchClamp_1");
+  // Loading more resident batches than batches in memory
+  // loads the first ones, with their labels found after
+  // the data of all the resident batches
+  ModelOptions options;
+  options.bytecode_options.growable_training_batches = true;
+  std::unique_ptr<Model> model(MakeModel(options, ModelConfig()));
+  ModelRuntime runtime(model.get(), 0);
+  const uint32_t resident = 3;
+  auto data_size = inputs * model->TrainingBatchSize();
+  auto labels_size = outputs * model->TrainingBatchSize();
+  auto offset = runtime.WasmRuntime().Call("reserve_training_batches", {wasmpp::Runtime::MakeI32(resident)});
+  uint32_t src_offset = offset[0].get_i32();
+  float* src = reinterpret_cast<float*>(runtime.WasmRuntime().Memory() + src_offset);
+  FillBatches(src, src + resident * data_size, model->TrainingBatchSize(), resident, 1);
+  std::vector<float> data(src, src + 2 * data_size);
+  std::vector<float> labels(src + resident * data_size, src + resident * data_size + 2 * labels_size);
+  // The labels of the batches in memory are followed by other arrays
+  float* next_array = runtime.TrainingLabels() + 2 * labels_size;
+  std::vector<float> next_values(next_array, next_array + labels_size);
+
+  runtime.WasmRuntime().Call("load_batch", {wasmpp::Runtime::MakeI32(src_offset),
+                                            wasmpp::Runtime::MakeI32(resident)});
+  ExpectEq(data, std::vector<float>(runtime.TrainingData(), runtime.TrainingData() + 2 * data_size),
+           "loaded training data");
+  ExpectEq(labels, std::vector<float>(runtime.TrainingLabels(), runtime.TrainingLabels() + 2 * labels_size),
+           "loaded training labels");
+  ExpectEq(next_values, std::vector<float>(next_array, next_array + labels_size), "array after the training labels");
+}
+
+void ModelTest::ReservedBatches_test_1() {
+  Begin("ReservedBatches_1");
+  // Training on reserved batches, in chunks clamped to the
+  // reserved ones, must train as the same batches in memory
+  ModelOptions options;
+  options.bytecode_options.growable_training_batches = true;
+  const uint32_t resident = 3;
+  ModelConfig in_memory_config;
+  in_memory_config.training_batches_in_memory = resident;
+  std::unique_ptr<Model> model(MakeModel(options, ModelConfig()));
+  std::unique_ptr<Model> in_memory_model(MakeModel(options, in_memory_config));
+  ModelRuntime runtime(model.get(), 0);
+  ModelRuntime in_memory_runtime(in_memory_model.get(), 0);
+  auto data_size = inputs * model->TrainingBatchSize();
+
+  auto too_many = runtime.WasmRuntime().Call("reserve_training_batches", {wasmpp::Runtime::MakeI32((uint32_t) -1)});
+  ExpectTrue(too_many[0].get_i32() == (uint32_t) -1, "reserved batches past the 32-bit memory");
+  auto offset = runtime.WasmRuntime().Call("reserve_training_batches", {wasmpp::Runtime::MakeI32(resident)});
+  uint32_t data_offset = offset[0].get_i32();
+  ExpectTrue(data_offset != (uint32_t) -1, "memory cannot grow to reserve the batches");
+  auto reserved = runtime.WasmRuntime().Call("reserved_training_batches");
+  ExpectTrue((uint32_t) reserved[0].get_i32() == resident, "number of reserved batches");
+  auto labels_offset = runtime.WasmRuntime().Call("reserved_training_labels_offset");
+  ExpectTrue((uint32_t) labels_offset[0].get_i32() == data_offset + resident * data_size * sizeof(float),
+             "reserved labels follow the data of all the reserved batches");
+
+  float* data = reinterpret_cast<float*>(runtime.WasmRuntime().Memory() + data_offset);
+  FillBatches(data, data + resident * data_size, model->TrainingBatchSize(), resident, 1);
+  FillBatches(in_memory_runtime.TrainingData(), in_memory_runtime.TrainingLabels(),
+              in_memory_model->TrainingBatchSize(), resident, 1);
+  runtime.SetLearningRate(0.1);
+  in_memory_runtime.SetLearningRate(0.1);
+  auto train_reserved = [&](uint32_t first, uint32_t count) {
+    runtime.WasmRuntime().Call("train_reserved_batches", {wasmpp::Runtime::MakeI32(first),
+                                                          wasmpp::Runtime::MakeI32(count)});
+  };
+  for(int epoch = 0; epoch < 2; epoch++) {
+    train_reserved(0, 1);
+    train_reserved(1, 10);
+    train_reserved(resident, 1);
+    in_memory_runtime.TrainBatchesInMemory(resident);
+  }
+  ExpectEq(in_memory_runtime.ExtractWeights(), runtime.ExtractWeights(), "weights trained on reserved batches");
+}
+
+void ModelTest::GradientAccumulation_test_1() {
+  Begin("GradientAccumulation_1");
+  // Accumulating K micro-batches of 4 entries must train as
+  // one batch of K * 4 entries, with the 1/m scaling and the
+  // regularization of the large batch. The sums are split,
+  // so the weights only match up to rounding
+  const uint32_t steps = 2;
+  const uint32_t micro_batch = 4;
+  const uint32_t batch = steps * micro_batch;
+  for(OptimizerType optimizer : {SGD, Adam}) {
+    ModelOptions options;
+    options.bytecode_options.use_simd = true;
+    options.optimizer_options.type = optimizer;
+    ModelConfig config;
+    config.training_batch_size = batch;
+    config.training_batches_in_memory = 1;
+    config.regularizer = 0.001;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    options.bytecode_options.gradient_accumulation_steps = steps;
+    ModelConfig accumulation_config = config;
+    accumulation_config.training_batch_size = micro_batch;
+    accumulation_config.training_batches_in_memory = steps;
+    std::unique_ptr<Model> accumulation_model(MakeModel(options, accumulation_config));
+    ModelRuntime runtime(model.get(), 0);
+    ModelRuntime accumulation_runtime(accumulation_model.get(), 0);
+    runtime.SetLearningRate(0.1);
+    accumulation_runtime.SetLearningRate(0.1);
+    for(uint32_t round = 0; round < 3; round++) {
+      // The large batch holds the columns of the micro-batches in order
+      float* data = accumulation_runtime.TrainingData();
+      float* labels = accumulation_runtime.TrainingLabels();
+      FillBatches(data, labels, micro_batch, steps, round + 1);
+      for(uint32_t s = 0; s < steps; s++) {
+        for(uint32_t col = 0; col < micro_batch; col++) {
+          for(uint32_t row = 0; row < inputs; row++) {
+            runtime.TrainingData()[row * batch + s * micro_batch + col] =
+                data[s * inputs * micro_batch + row * micro_batch + col];
+          }
+          for(uint32_t row = 0; row < outputs; row++) {
+            runtime.TrainingLabels()[row * batch + s * micro_batch + col] =
+                labels[s * outputs * micro_batch + row * micro_batch + col];
+          }
+        }
+      }
+      runtime.TrainBatchesInMemory(1);
+      accumulation_runtime.TrainBatchesInMemory(steps);
+      ExpectNear(runtime.ExtractWeights(), accumulation_runtime.ExtractWeights(), 1e-5,
+                 "weights trained on accumulated micro-batches");
+    }
+  }
+}
+
+void ModelTest::LiveTrainingBatch_test_1() {
+  Begin("LiveTrainingBatch_1");
+  const uint32_t batch = 4;
+  const uint32_t entries = 2;
+  const uint32_t batches = 2;
+  for(OptimizerType optimizer : {SGD, Adam}) {
+    ModelOptions options;
+    options.optimizer_options.type = optimizer;
+    ModelConfig config;
+    config.training_batch_size = entries;
+    config.training_batches_in_memory = batches;
+    config.regularizer = 0.001;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    options.bytecode_options.live_training_batch = true;
+    ModelConfig live_config = config;
+    live_config.training_batch_size = batch;
+    std::unique_ptr<Model> live_model(MakeModel(options, live_config));
+    ModelRuntime runtime(model.get(), 0);
+    ModelRuntime live_runtime(live_model.get(), 0);
+    runtime.SetLearningRate(0.1);
+    live_runtime.SetLearningRate(0.1);
+    for(uint32_t round = 0; round < 3; round++) {
+      // The live batches start with the columns of the small
+      // batches and end with other entries which are ignored
+      float* data = runtime.TrainingData();
+      float* labels = runtime.TrainingLabels();
+      FillBatches(data, labels, entries, batches, round + 1);
+      FillBatches(live_runtime.TrainingData(), live_runtime.TrainingLabels(), batch, batches, round + 100);
+      for(uint32_t b = 0; b < batches; b++) {
+        for(uint32_t col = 0; col < entries; col++) {
+          for(uint32_t row = 0; row < inputs; row++) {
+            live_runtime.TrainingData()[b * inputs * batch + row * batch + col] =
+                data[b * inputs * entries + row * entries + col];
+          }
+          for(uint32_t row = 0; row < outputs; row++) {
+            live_runtime.TrainingLabels()[b * outputs * batch + row * batch + col] =
+                labels[b * outputs * entries + row * entries + col];
+          }
+        }
+      }
+      runtime.TrainBatchesInMemory(batches);
+      live_runtime.TrainBatchesInMemory(batches, entries);
+      ExpectNear(runtime.ExtractWeights(), live_runtime.ExtractWeights(), 1e-5,
+                 "weights trained on the first entries of the batches");
+    }
+  }
+}
+
+void ModelTest::WeightsBlobLayout_test_1() {
+  Begin("WeightsBlobLayout_1");
+  ModelOptions options;
+  options.bytecode_options.separate_weights = true;
+  ModelConfig other_config;
+  other_config.hidden_nodes = 12;
+  std::unique_ptr<Model> model(MakeModel(options, ModelConfig()));
+  std::unique_ptr<Model> same_model(MakeModel(options, ModelConfig()));
+  std::unique_ptr<Model> other_model(MakeModel(options, other_config));
+  ExpectTrue(model->WeightsLayout() == same_model->WeightsLayout(), "same models have different layouts");
+  ExpectTrue(model->WeightsLayout() != other_model->WeightsLayout(), "different models have the same layout");
+
+  // The layout is stored after the magic and version
+  auto blob = model->WeightsBlob();
+  uint32_t layout = 0;
+  for(int i = 0; i < 4; i++) {
+    layout |= (uint32_t) blob[8 + i] << (8 * i);
+  }
+  ExpectTrue(layout == model->WeightsLayout(), "weights blob layout");
+
+  // A blob loads in a model with the same layout
+  ModelRuntime runtime(same_model.get(), 0);
+  auto initial_weights = runtime.ExtractWeights();
+  runtime.SetLearningRate(0.1);
+  FillBatches(runtime.TrainingData(), runtime.TrainingLabels(), 4, 2, 1);
+  runtime.TrainBatchesInMemory(2);
+  runtime.LoadWeightsBlob(blob);
+  ExpectEq(initial_weights, runtime.ExtractWeights(), "weights loaded from the blob");
+}
+
+void ModelTest::PredictionWeights_test_1() {
+  Begin("PredictionWeights_1");
+  // The int8 and the pruned weights are updated by the
+  // training functions and after importing weights, so
+  // updating them again must not change the prediction
+  for(bool int8 : {true, false}) {
+    ModelOptions options;
+    options.bytecode_options.use_simd = true;
+    options.bytecode_options.int8_prediction_weights = int8;
+    ModelConfig config;
+    config.sparsity = int8 ? 0 : 0.5;
+    std::unique_ptr<Model> model(MakeModel(options, config));
+    ModelRuntime runtime(model.get(), 0);
+    ModelRuntime imported_runtime(model.get(), 0);
+    const uint32_t batch_size = model->PredictionBatchSize();
+    auto predict = [&](ModelRuntime& runtime) {
+      std::mt19937 generator(1);
+      std::uniform_real_distribution<float> input(-1, 1);
+      std::generate_n(runtime.PredictionData(), inputs * batch_size, [&]() { return input(generator); });
+      runtime.PredictBatch();
+      return std::vector<float>(runtime.PredictionResult(), runtime.PredictionResult() + outputs * batch_size);
+    };
+    auto update = [&]() {
+      if(int8) {
+        runtime.QuantizeWeights();
+      } else {
+        runtime.PruneWeights();
+      }
+    };
+    runtime.SetLearningRate(0.5);
+    FillBatches(runtime.TrainingData(), runtime.TrainingLabels(), 4, 2, 1);
+    runtime.TrainBatchesInMemory(2);
+    auto trained_prediction = predict(runtime);
+    update();
+    ExpectEq(trained_prediction, predict(runtime), "prediction after training");
+    imported_runtime.ImportWeights(runtime.ExtractWeights());
+    ExpectEq(trained_prediction, predict(imported_runtime), "prediction after importing the weights");
+  }
+}
+
+std::vector<uint8_t> ModelTest::TrainingWorkersModel(uint32_t workers) {
+  // The workers together train on batches of 8 entries
+  ERROR_UNLESS(8 % workers == 0, "8 entries cannot be split between %u workers", workers);
+  ModelOptions options;
+  options.bytecode_options.use_simd = true;
+  options.bytecode_options.training_workers = workers;
+  ModelConfig config;
+  config.training_batch_size = 8 / workers;
+  config.training_batches_in_memory = 2 * workers;
+  std::unique_ptr<Model> model(MakeModel(options, config));
+  return model->ModuleManager().ToWasm().data;
+}
+
+} // namespace test
+} // namespace nn
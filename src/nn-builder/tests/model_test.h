@@ -0,0 +1,65 @@
+#ifndef NN_TESTS_MODEL_TEST_H_
+#define NN_TESTS_MODEL_TEST_H_
+
+#include <src/nn-builder/src/arch/model.h>
+#include <src/nn-builder/src/runtime/runtime.h>
+#include <string>
+#include <vector>
+
+namespace nn {
+namespace test {
+
+// Model test cases build small models and run them in-process
+// with the model runtime, then compare their results in C++
+class ModelTest {
+private:
+  uint32_t failures_ = 0;
+
+  // Shape of a test model. Each test only sets
+  // the fields it depends on
+  struct ModelConfig {
+    uint32_t training_batch_size = 4;
+    uint32_t training_batches_in_memory = 2;
+    uint32_t hidden_nodes = 8;
+    // Sparsity of the hidden and output layers
+    float sparsity = 0;
+    // Same L1 and L2 regularizer
+    float regularizer = 0;
+  };
+
+  // Build a model with 8 inputs, a sigmoid and a tanh hidden
+  // layers and a softmax output layer of 4 nodes
+  arch::Model* MakeModel(arch::ModelOptions options, ModelConfig config);
+
+  // Fill batches with random inputs and one-hot labels
+  void FillBatches(float* data, float* labels, uint32_t batch_size, uint32_t batches, uint32_t seed);
+
+  // Report the name of a test case and its failures
+  void Begin(std::string name);
+  void ExpectTrue(bool condition, std::string what);
+  void ExpectEq(const std::vector<float>& expected, const std::vector<float>& actual, std::string what);
+  // Values equal up to a relative `tolerance`
+  void ExpectNear(const std::vector<float>& expected, const std::vector<float>& actual, float tolerance,
+                  std::string what);
+public:
+  // Number of failed expectations
+  uint32_t Failures() const { return failures_; }
+  void DerivativeFromOutput_test_1();
+  void DeterministicBuild_test_1();
+  void SharedMemoryData_test_1();
+  void LoadBatchClamp_test_1();
+  void ReservedBatches_test_1();
+  void GradientAccumulation_test_1();
+  void LiveTrainingBatch_test_1();
+  void WeightsBlobLayout_test_1();
+  void PredictionWeights_test_1();
+
+  // Model trained on the same batches of 8 entries by a
+  // number of training workers (see run_worker_tests.js)
+  std::vector<uint8_t> TrainingWorkersModel(uint32_t workers);
+};
+
+} // namespace test
+} // namespace nn
+
+#endif
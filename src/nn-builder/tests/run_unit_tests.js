@@ -1,17 +1,45 @@
 const fs = require('fs');
+const path = require('path');
+const {Worker} = require('worker_threads');
 const {CompiledModel} = require('../js/compiled_model');
 
+// Number of threads running each thread test
+const THREADS = 4;
+
 process.on('unhandledRejection', error => {
-  console.error(">> Make sure SIMD is enabled (e.g. nodejs --experimental-wasm-simd)");
+  console.error(">> Make sure SIMD, threads and bulk memory are enabled (e.g. nodejs --experimental-wasm-simd "
+                + "--experimental-wasm-threads --experimental-wasm-bulk-memory)");
   console.error(">> Error message:", error);
 });
 
+// Call a thread test on several worker threads
+// instantiating the module on the shared memory
+async function ThreadTest(bytes, func) {
+  console.log(">>  Testing function:", func, "on", THREADS, "threads");
+  console.time("    exectuion time");
+  let done = [];
+  for(let t = 0; t < THREADS; t++) {
+    let worker = new Worker(path.join(__dirname, 'unit_test_worker.js'), {
+      workerData: {bytes: bytes, memory: CompiledModel.Memory(), func: func, thread: t, threads: THREADS}
+    });
+    done.push(new Promise((resolve, reject) => {
+      worker.on('error', reject);
+      worker.on('exit', resolve);
+    }));
+  }
+  await Promise.all(done);
+  console.timeEnd("    exectuion time");
+}
+
 if(process.argv.length > 2) {
-  const buf = fs.readFileSync(process.argv[2]);
-  const lib = WebAssembly.instantiate(new Uint8Array(buf), CompiledModel.Imports());
-  lib.then( wasm => {
-    const compiled_model = new CompiledModel(wasm);
+  const bytes = new Uint8Array(fs.readFileSync(process.argv[2]));
+  CompiledModel.Instantiate(bytes).then(async compiled_model => {
     compiled_model.UnitTest();
+    for(let func of Object.keys(compiled_model.Exports())) {
+      if(func.startsWith("thread_test_")) {
+        await ThreadTest(bytes, func);
+      }
+    }
   })
 } else {
     console.log("Missing argument: file.wasm");
@@ -0,0 +1,79 @@
+const fs = require('fs');
+const path = require('path');
+const {CompiledModel} = require('../js/compiled_model');
+
+// Compare the weights trained by the same model on one
+// thread and on two training workers (see nn-test -r DIR)
+const INPUTS = 8;
+const OUTPUTS = 4;
+const ENTRIES = 32;
+const EPOCHS = 2;
+// The workers add their gradients in a different order
+const TOLERANCE = 1e-5;
+
+process.on('unhandledRejection', error => {
+  console.error(">> Make sure SIMD, threads and bulk memory are enabled (e.g. nodejs --experimental-wasm-simd "
+                + "--experimental-wasm-threads --experimental-wasm-bulk-memory)");
+  console.error(">> Error message:", error);
+  process.exit(1);
+});
+
+// Deterministic inputs and one-hot labels
+function MakeEntries() {
+  let seed = 1;
+  let Random = () => {
+    seed = (seed * 1103515245 + 12345) % 2147483648;
+    return seed / 2147483648;
+  };
+  let data = [];
+  let labels = [];
+  for(let e = 0; e < ENTRIES; e++) {
+    data.push(Array.from({length: INPUTS}, () => 2 * Random() - 1));
+    let label = new Array(OUTPUTS).fill(0);
+    label[Math.floor(Random() * OUTPUTS)] = 1;
+    labels.push(label);
+  }
+  return {data: data, labels: labels};
+}
+
+// Train for each epoch in a separate call. The workers are
+// restarted at each call, and their new instances must not
+// reset the weights trained by the previous call
+async function TrainedWeights(file, entries) {
+  let compiled_model = await CompiledModel.Instantiate(new Uint8Array(fs.readFileSync(file)));
+  let training = compiled_model.EncodeTrainingData(entries.data, entries.labels);
+  let config = {epochs: 1, learning_rate: 0.1};
+  for(let e = 0; e < EPOCHS; e++) {
+    if(compiled_model._TrainingWorkers() > 1) {
+      await compiled_model.TrainWorkers(training, config);
+      await compiled_model.StopWorkers();
+    } else {
+      compiled_model.Train(training, config);
+    }
+  }
+  return compiled_model.ExtractWeights();
+}
+
+if(process.argv.length > 2) {
+  (async () => {
+    let entries = MakeEntries();
+    let expected = await TrainedWeights(path.join(process.argv[2], "workers_1.wasm"), entries);
+    let actual = await TrainedWeights(path.join(process.argv[2], "workers_2.wasm"), entries);
+    let failures = 0;
+    expected.forEach((layer, l) => {
+      for(let key of ["weights", "bias"]) {
+        layer[key].forEach((value, i) => {
+          if(Math.abs(value - actual[l][key][i]) > TOLERANCE) {
+            console.error("Layer", layer.layer, key, i, "trained by the workers differs:", value, "!=",
+                          actual[l][key][i]);
+            failures++;
+          }
+        });
+      }
+    });
+    console.log(failures === 0 ? ">>  Training workers: OK" : ">>  Training workers: failed");
+    process.exit(failures === 0 ? 0 : 1);
+  })();
+} else {
+    console.log("Missing argument: directory of workers_1.wasm and workers_2.wasm (nn-test -r)");
+}
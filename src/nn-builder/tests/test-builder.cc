@@ -1,11 +1,16 @@
 #include <src/nn-builder/tests/matrix_test.h>
+#include <src/nn-builder/tests/atomic_test.h>
+#include <src/nn-builder/tests/bulk_memory_test.h>
+#include <src/nn-builder/tests/model_test.h>
 #include <iostream>
 #include <getopt.h>
 #include <fstream>
 
 bool FLAG_to_wasm = false;
 bool FLAG_to_wat = false;
+bool FLAG_models = false;
 std::string output_file;
+std::string worker_models_directory;
 
 void PrintUsage() {
   std::cout
@@ -14,6 +19,8 @@ void PrintUsage() {
       << "    -w, --to-wasm    Print wasm" << std::endl
       << "    -W, --to-wat     Print wat" << std::endl
       << "    -o, --output     Output file" << std::endl
+      << "    -m, --models     Run the model test cases in-process" << std::endl
+      << "    -r, --workers    Directory of the models of run_worker_tests.js" << std::endl
       << "    -h, --help       Display this help message" << std::endl;
 }
 
@@ -24,13 +31,15 @@ void InitParams(int argc, char *argv[]) {
       {"to-wasm", no_argument, 0, 'w'},
       {"to-wat", no_argument, 0, 'W'},
       {"output", required_argument, 0, 'o'},
+      {"models", no_argument, 0, 'm'},
+      {"workers", required_argument, 0, 'r'},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}
   };
 
   int optionIndex = 0;
   int c;
-  while ((c = getopt_long(argc, argv, "hwWo:", longOptions, &optionIndex)) != -1) {
+  while ((c = getopt_long(argc, argv, "hwWo:mr:", longOptions, &optionIndex)) != -1) {
     switch (c) {
       case 'w':
         FLAG_to_wasm = true;
@@ -41,6 +50,12 @@ void InitParams(int argc, char *argv[]) {
       case 'o':
         output_file = optarg;
         break;
+      case 'm':
+        FLAG_models = true;
+        break;
+      case 'r':
+        worker_models_directory = optarg;
+        break;
       case 'h':
       default:
         break;
@@ -49,9 +64,49 @@ void InitParams(int argc, char *argv[]) {
 }
 
 
+int RunModelTests() {
+  nn::test::ModelTest model_test;
+  model_test.DerivativeFromOutput_test_1();
+  model_test.DeterministicBuild_test_1();
+  model_test.SharedMemoryData_test_1();
+  model_test.LoadBatchClamp_test_1();
+  model_test.ReservedBatches_test_1();
+  model_test.GradientAccumulation_test_1();
+  model_test.LiveTrainingBatch_test_1();
+  model_test.WeightsBlobLayout_test_1();
+  model_test.PredictionWeights_test_1();
+
+  if(model_test.Failures() > 0) {
+    std::cerr << model_test.Failures() << " model test expectations failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// Write the same model built for 1 and 2 training
+// workers, to be compared by run_worker_tests.js
+void WriteWorkerModels() {
+  nn::test::ModelTest model_test;
+  for(uint32_t workers : {1, 2}) {
+    auto data = model_test.TrainingWorkersModel(workers);
+    std::ofstream file(worker_models_directory + "/workers_" + std::to_string(workers) + ".wasm",
+                       std::ios::binary);
+    file << std::string(data.begin(), data.end());
+  }
+}
+
 int main(int argc, char *argv[]) {
   InitParams(argc, argv);
 
+  if(FLAG_models) {
+    return RunModelTests();
+  }
+
+  if(!worker_models_directory.empty()) {
+    WriteWorkerModels();
+    return 0;
+  }
+
   if(!FLAG_to_wat && !FLAG_to_wasm && output_file.empty()) {
     PrintUsage();
     exit(0);
@@ -67,7 +122,10 @@ int main(int argc, char *argv[]) {
       {{wabt::Type ::F32, wabt::Type::F32},{}});
 
   // Allocate enough memory
-  auto memory = module_manager.MakeMemory(500);
+  // Memory is shared so that it can be used by atomic instructions,
+  // and imported so that the thread tests can instantiate the
+  // module on the same memory from several threads
+  auto memory = module_manager.MakeMemoryImport("Memory", "memory", 500, 500, true);
   module_manager.MakeMemoryExport("memory", memory);
 
   // Create matrix tests
@@ -79,6 +137,15 @@ int main(int argc, char *argv[]) {
   matrix_snippet_test.MatrixDot_test_1();
   matrix_snippet_test.MatrixDotLT_test_1();
   matrix_snippet_test.MatrixDotRT_test_1();
+  matrix_snippet_test.MatrixDotRows_test_1();
+  matrix_snippet_test.MatrixDotColumns_test_1();
+  matrix_snippet_test.MatrixVectorAdditionColumns_test_1();
+  matrix_snippet_test.MatrixActivationColumns_test_1();
+  matrix_snippet_test.MatrixDotLTColumns_test_1();
+  matrix_snippet_test.MatrixDotRTColumns_test_1();
+  matrix_snippet_test.MatrixHorizontalSumColumns_test_1();
+  matrix_snippet_test.MatrixDotLTRows_test_1();
+  matrix_snippet_test.MatrixDotRTRows_test_1();
   matrix_snippet_test.MatrixVectorAddition_test_1();
   matrix_snippet_test.MatrixHorizontalSum_test_1();
   matrix_snippet_test.MatrixAbsSum_test_1();
@@ -87,6 +154,15 @@ int main(int argc, char *argv[]) {
   matrix_snippet_test.MatrixSubRightScale_test_1();
   matrix_snippet_test.MatrixAddRightSignScale_test_1();
   matrix_snippet_test.MatrixAddRightSignScaleAddRightScale_test_1();
+  matrix_snippet_test.MatrixOptimizerUpdate_test_1();
+  matrix_snippet_test.MatrixOptimizerUpdate_test_2();
+  matrix_snippet_test.MatrixOptimizerUpdate_test_3();
+  matrix_snippet_test.MatrixDotBf16_test_1();
+  matrix_snippet_test.MatrixNarrowBf16_test_1();
+  matrix_snippet_test.MatrixQuantizeRows_test_1();
+  matrix_snippet_test.MatrixPruneBlocks_test_1();
+  matrix_snippet_test.MatrixPruneBlocks_test_2();
+  matrix_snippet_test.MatrixDotSparse_test_1();
 
   // Create matrix simd tests
   nn::test::MatrixSnippetSimdTest matrix_snippet_simd_test(&module_manager, &test_builtins);
@@ -96,17 +172,47 @@ int main(int argc, char *argv[]) {
   matrix_snippet_simd_test.MatrixScalarSimd_test_1();
   matrix_snippet_simd_test.MatrixDotSimd_test_1();
   matrix_snippet_simd_test.MatrixDotSimd_test_2();
+  matrix_snippet_simd_test.MatrixDotSimd_test_3();
+  matrix_snippet_simd_test.MatrixDotColumnsSimd_test_1();
+  matrix_snippet_simd_test.MatrixVectorAdditionColumnsSimd_test_1();
   matrix_snippet_simd_test.MatrixDotLTSimd_test_1();
+  matrix_snippet_simd_test.MatrixDotLTRowsSimd_test_1();
   matrix_snippet_simd_test.MatrixDotRTSimd_test_1();
   matrix_snippet_simd_test.MatrixDotRTSimd_test_2();
   matrix_snippet_simd_test.MatrixVectorAdditionSimd_test_1();
   matrix_snippet_simd_test.MatrixHorizontalSumSimd_test_1();
+  matrix_snippet_simd_test.MatrixHorizontalSumSimd_test_2();
   matrix_snippet_simd_test.MatrixAbsSumSimd_test_1();
+  matrix_snippet_simd_test.MatrixAbsSumSimd_test_2();
   matrix_snippet_simd_test.MatrixSquareSumSimd_test_1();
+  matrix_snippet_simd_test.MatrixSquareSumSimd_test_2();
   matrix_snippet_simd_test.MatrixAddRightScaleSimd_test_1();
   matrix_snippet_simd_test.MatrixSubRightScaleSimd_test_1();
   matrix_snippet_simd_test.MatrixAddRightSignScaleSimd_test_1();
   matrix_snippet_simd_test.MatrixAddRightSignScaleAddRightScale_test_1();
+  matrix_snippet_simd_test.MatrixOptimizerUpdateSimd_test_1();
+  matrix_snippet_simd_test.MatrixOptimizerUpdateSimd_test_2();
+  matrix_snippet_simd_test.MatrixOptimizerUpdateSimd_test_3();
+  matrix_snippet_simd_test.MatrixDotBf16Simd_test_1();
+  matrix_snippet_simd_test.MatrixDotBf16Simd_test_2();
+  matrix_snippet_simd_test.MatrixDotInt8Simd_test_1();
+  matrix_snippet_simd_test.MatrixDotInt8Simd_test_2();
+  matrix_snippet_simd_test.MatrixDotSparseSimd_test_1();
+  matrix_snippet_simd_test.MatrixDotSparseSimd_test_2();
+
+  // Create atomic tests
+  nn::test::AtomicTest atomic_test(&module_manager, &test_builtins);
+  atomic_test.AtomicRmw_test_1();
+  atomic_test.SpinLock_test_1();
+  atomic_test.Barrier_test_1();
+  atomic_test.Barrier_thread_test_1();
+
+  // Create bulk memory tests
+  nn::test::BulkMemoryTest bulk_memory_test(&module_manager, &test_builtins);
+  bulk_memory_test.MemoryFill_test_1();
+  bulk_memory_test.MemoryCopy_test_1();
+  bulk_memory_test.MemoryInit_test_1();
+  bulk_memory_test.MemoryGrow_test_1();
 
   assert(module_manager.Validate());
   if(!output_file.empty()) {
@@ -17,6 +17,12 @@ struct TestBuiltins {
 #define ADD_NN_TEST(module_manager, name, ...) \
     module_manager->MakeFunction("test_" name, {}, {__VA_ARGS__}, _test_function)
 
+// Thread test cases are called on several threads
+// sharing the memory, with (thread, threads) params
+#define ADD_NN_THREAD_TEST(module_manager, name, ...) \
+    module_manager->MakeFunction("thread_test_" name, {{wabt::Type::I32, wabt::Type::I32}, {}}, {__VA_ARGS__}, \
+                                 _test_function)
+
 } // namespace test
 } // namespace nn
 
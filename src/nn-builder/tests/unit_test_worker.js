@@ -0,0 +1,10 @@
+// Worker thread of a thread test (see run_unit_tests.js).
+// The thread instantiates the unit tests on the shared
+// memory and calls the test with its thread index
+const {workerData} = require('worker_threads');
+const {CompiledModel} = require('../js/compiled_model');
+
+CompiledModel._memory = workerData.memory;
+WebAssembly.instantiate(workerData.bytes, CompiledModel.Imports(workerData.memory)).then(wasm => {
+  wasm.instance.exports[workerData.func](workerData.thread, workerData.threads);
+});
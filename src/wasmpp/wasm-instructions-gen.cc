@@ -1,5 +1,6 @@
 #include <src/wasmpp/wasm-instructions-gen.h>
 #include <src/wasmpp/wasm-manager.h>
+#include <cstdint>
 
 namespace wasmpp {
 
@@ -43,6 +44,14 @@ wabt::ExprList* GenerateRangeLoop(LabelManager* label_manager, wabt::Var var, ui
   return e;
 }
 
+wabt::ExprList* GenerateRangeLoop(LabelManager* label_manager, wabt::Var var, wabt::ExprList* start, wabt::ExprList* end,
+                                  uint32_t inc, wabt::FuncSignature sig, std::function<void(BlockBody*)> content) {
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(var, start));
+  Merge(e, GenerateGenericDoWhileLoop(label_manager, var, end, MakeI32Const(inc), sig, content));
+  return e;
+}
+
 wabt::ExprList* GenerateDoWhileLoop(LabelManager* label_manager, wabt::Var begin, wabt::Var end, uint32_t inc,
                                   wabt::FuncSignature sig, std::function<void(BlockBody*)> content) {
   wabt::ExprList* e = new wabt::ExprList();
@@ -72,4 +81,68 @@ wabt::ExprList* GenerateF32X4HorizontalLTRSum(wabt::Var var) {
   Merge(e, add_3);
   return e;
 }
+
+wabt::ExprList* GenerateF32X4AccumulatorsLTRSum(std::vector<wabt::Var> vars) {
+  ERROR_UNLESS(!vars.empty(), "at least one accumulator is required");
+  wabt::ExprList* e = new wabt::ExprList();
+  for(uint32_t step = 1; step < vars.size(); step *= 2) {
+    for(uint32_t i = 0; i + step < vars.size(); i += 2 * step) {
+      Merge(e, GenerateCompoundAssignment(vars[i], wabt::Opcode::F32X4Add, MakeLocalGet(vars[i + step])));
+    }
+  }
+  Merge(e, GenerateF32X4HorizontalLTRSum(vars[0]));
+  return e;
+}
+wabt::ExprList* GenerateSpinLockAcquire(LabelManager* label_manager, wabt::Var lock) {
+  ERROR_UNLESS(label_manager != nullptr, "label manager cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLoop(label_manager, {}, [&](BlockBody b, wabt::Var label) {
+    b.Insert(MakeBrIf(label, MakeI32AtomicRmwCmpxchg(MakeLocalGet(lock), MakeI32Const(0), MakeI32Const(1))));
+  }));
+  return e;
+}
+
+wabt::ExprList* GenerateSpinLockRelease(wabt::Var lock) {
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeI32AtomicStore(MakeLocalGet(lock), MakeI32Const(0)));
+  return e;
+}
+
+wabt::ExprList* GenerateBarrier(LabelManager* label_manager, wabt::Var barrier, wabt::ExprList* threads,
+                                wabt::Var generation) {
+  ERROR_UNLESS(label_manager != nullptr, "label manager cannot be null");
+  ERROR_UNLESS(threads != nullptr, "threads cannot be null");
+  const uint32_t generation_offset = WASMPP_I32_SIZE;
+  const uint32_t all_waiters = UINT32_MAX;
+  const uint64_t no_timeout = UINT64_MAX;
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, MakeLocalSet(generation, MakeI32AtomicLoad(MakeLocalGet(barrier), wabt::WABT_USE_NATURAL_ALIGNMENT,
+                                                      generation_offset)));
+  auto arrived = MakeI32AtomicRmwAdd(MakeLocalGet(barrier), MakeI32Const(1));
+  auto last = MakeBinary(wabt::Opcode::I32Eq, arrived, MakeBinary(wabt::Opcode::I32Sub, threads, MakeI32Const(1)));
+  Merge(e, MakeIf(label_manager, last, {}, [&](BlockBody true_block, wabt::Var true_label) {
+    // Reset the barrier and start the next generation
+    true_block.Insert(MakeI32AtomicStore(MakeLocalGet(barrier), MakeI32Const(0)));
+    true_block.Insert(MakeI32AtomicRmwAdd(MakeLocalGet(barrier), MakeI32Const(1), wabt::WABT_USE_NATURAL_ALIGNMENT,
+                                          generation_offset));
+    true_block.Insert(MakeDrop());
+    true_block.Insert(MakeAtomicNotify(MakeLocalGet(barrier), MakeI32Const(all_waiters),
+                                       wabt::WABT_USE_NATURAL_ALIGNMENT, generation_offset));
+    true_block.Insert(MakeDrop());
+  }, [&](BlockBody false_block) {
+    // Wait until the generation changes
+    false_block.Insert(MakeLoop(label_manager, {}, [&](BlockBody b, wabt::Var label) {
+      auto current = MakeI32AtomicLoad(MakeLocalGet(barrier), wabt::WABT_USE_NATURAL_ALIGNMENT, generation_offset);
+      b.Insert(MakeIf(label_manager, MakeBinary(wabt::Opcode::I32Eq, current, MakeLocalGet(generation)), {},
+                      [&](BlockBody wait_block, wabt::Var wait_label) {
+        wait_block.Insert(MakeI32AtomicWait(MakeLocalGet(barrier), MakeLocalGet(generation), MakeI64Const(no_timeout),
+                                            wabt::WABT_USE_NATURAL_ALIGNMENT, generation_offset));
+        wait_block.Insert(MakeDrop());
+        wait_block.Insert(MakeBr(label));
+      }));
+    }));
+  }));
+  return e;
+}
+
 } // namespace wasmpp
\ No newline at end of file
@@ -95,6 +95,35 @@ wabt::ExprList* GenerateRangeLoop(LabelManager* label_manager, wabt::Var var, ui
   wabt::ExprList* GenerateRangeLoop(LabelManager* label_manager, wabt::Var var, uint32_t start, wabt::Var end, uint32_t inc,
                                     wabt::FuncSignature sig, std::function<void(BlockBody*)> content);
 
+/*!
+ * General a Wasm loop
+ * <pre>
+ * {start}
+ * set_local {var}
+ * loop {label}
+ *   {content}
+ *   get_local {var}
+ *   i32.const {inc}
+ *   i32.add
+ *   tee_local {var}
+ *   {end}
+ *   i32.ne
+ *   br_if {label}
+ * end
+ * </pre>
+ * @note The end expression is evaluated at each iteration
+ * @param label_manager Label manager
+ * @param var Loop reference variable
+ * @param start From
+ * @param end To
+ * @param inc Increment value
+ * @param sig Loop signature
+ * @param content Loop content
+ * @return Expression list
+ */
+wabt::ExprList* GenerateRangeLoop(LabelManager* label_manager, wabt::Var var, wabt::ExprList* start, wabt::ExprList* end,
+                                  uint32_t inc, wabt::FuncSignature sig, std::function<void(BlockBody*)> content);
+
 /*!
  * General a Wasm loop
  * <pre>
@@ -178,6 +207,89 @@ wabt::ExprList* GenerateCompoundAssignment(wabt::Var var, wabt::Opcode op, wabt:
  */
   wabt::ExprList* GenerateF32X4HorizontalLTRSum(wabt::Var var);
 
+/*!
+ * Generate a fixed order sum of multiple f32x4 accumulators
+ * followed by their horizontal sum. Accumulators are combined
+ * pairwise into the first one, therefore the summation order only
+ * depends on the number of accumulators
+ * <pre>
+ * ;; e.g. for 4 accumulators
+ * {vars[0]} = {vars[0]} + {vars[1]}
+ * {vars[2]} = {vars[2]} + {vars[3]}
+ * {vars[0]} = {vars[0]} + {vars[2]}
+ * f32.extract_lane {vars[0]} 0
+ * f32.extract_lane {vars[0]} 1
+ * f32.add
+ * f32.extract_lane {vars[0]} 2
+ * f32.add
+ * f32.extract_lane {vars[0]} 3
+ * f32.add
+ * </pre>
+ * @note Accumulators will be modified
+ * @param vars Accumulators reference variables
+ * @return Expression list
+ */
+  wabt::ExprList* GenerateF32X4AccumulatorsLTRSum(std::vector<wabt::Var> vars);
+
+/*!
+ * Generate a spin lock acquisition. The lock is
+ * an i32 in a shared memory which is 0 when released
+ * <pre>
+ * loop {label}
+ *   get_local {lock}
+ *   i32.const 0
+ *   i32.const 1
+ *   i32.atomic.rmw.cmpxchg
+ *   br_if {label}
+ * end
+ * </pre>
+ * @param label_manager Label manager
+ * @param lock Reference variable of the lock address
+ * @return Expression list
+ */
+wabt::ExprList* GenerateSpinLockAcquire(LabelManager* label_manager, wabt::Var lock);
+
+/*!
+ * Generate a spin lock release
+ * <pre>
+ * get_local {lock}
+ * i32.const 0
+ * i32.atomic.store
+ * </pre>
+ * @param lock Reference variable of the lock address
+ * @return Expression list
+ */
+wabt::ExprList* GenerateSpinLockRelease(wabt::Var lock);
+
+/*!
+ * Generate a barrier blocking until all threads reach it.
+ * The barrier is two i32 in a shared memory initialized to 0:
+ * the number of arrived threads followed by the generation.
+ * The last thread to arrive starts a new generation and
+ * wakes up the threads waiting on the current one
+ * <pre>
+ * {generation} = i32.atomic.load offset=4 {barrier}
+ * if (i32.atomic.rmw.add {barrier} 1) == {threads} - 1
+ *   i32.atomic.store {barrier} 0
+ *   i32.atomic.rmw.add offset=4 {barrier} 1
+ *   memory.atomic.notify offset=4 {barrier} -1
+ * else
+ *   loop {label}
+ *     if (i32.atomic.load offset=4 {barrier}) == {generation}
+ *       i32.atomic.wait offset=4 {barrier} {generation} -1
+ *       br {label}
+ * </pre>
+ * @note The waiting threads must be allowed to block
+ * (e.g. not the main thread of a browser)
+ * @param label_manager Label manager
+ * @param barrier Reference variable of the barrier address
+ * @param threads Number of threads
+ * @param generation Reference variable of an i32 local
+ * @return Expression list
+ */
+wabt::ExprList* GenerateBarrier(LabelManager* label_manager, wabt::Var barrier, wabt::ExprList* threads,
+                                wabt::Var generation);
+
 } // namespace wasmpp
 
 #endif
\ No newline at end of file
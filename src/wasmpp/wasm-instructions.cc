@@ -204,6 +204,146 @@ wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::ExprList* val, wabt::A
 STORE_INSTRUCTIONS_LIST(DEFINE_STORE)
 #undef DEFINE_STORE
 
+#define DEFINE_ATOMIC_LOAD(opcode) \
+wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::Address align, uint32_t offset) {  \
+  ERROR_UNLESS(index != nullptr, "index cannot be null");                                    \
+  wabt::ExprList* e = new wabt::ExprList();                                                  \
+  Merge(e, index);                                                                           \
+  e->push_back(wabt::MakeUnique<wabt::AtomicLoadExpr>(wabt::Opcode::opcode, align, offset)); \
+  return e;                                                                                  \
+}
+ATOMIC_LOAD_INSTRUCTIONS_LIST(DEFINE_ATOMIC_LOAD)
+#undef DEFINE_ATOMIC_LOAD
+
+#define DEFINE_ATOMIC_STORE(opcode) \
+wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::ExprList* val, wabt::Address align, \
+    uint32_t offset) {                                                                        \
+  ERROR_UNLESS(index != nullptr, "index cannot be null");                                     \
+  ERROR_UNLESS(val != nullptr, "val cannot be null");                                         \
+  wabt::ExprList* e = new wabt::ExprList();                                                   \
+  Merge(e, index);                                                                            \
+  Merge(e, val);                                                                              \
+  e->push_back(wabt::MakeUnique<wabt::AtomicStoreExpr>(wabt::Opcode::opcode, align, offset)); \
+  return e;                                                                                   \
+}
+ATOMIC_STORE_INSTRUCTIONS_LIST(DEFINE_ATOMIC_STORE)
+#undef DEFINE_ATOMIC_STORE
+
+#define DEFINE_ATOMIC_RMW(opcode) \
+wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::ExprList* val, wabt::Address align, \
+    uint32_t offset) {                                                                        \
+  ERROR_UNLESS(index != nullptr, "index cannot be null");                                     \
+  ERROR_UNLESS(val != nullptr, "val cannot be null");                                         \
+  wabt::ExprList* e = new wabt::ExprList();                                                   \
+  Merge(e, index);                                                                            \
+  Merge(e, val);                                                                              \
+  e->push_back(wabt::MakeUnique<wabt::AtomicRmwExpr>(wabt::Opcode::opcode, align, offset));   \
+  return e;                                                                                   \
+}
+ATOMIC_RMW_INSTRUCTIONS_LIST(DEFINE_ATOMIC_RMW)
+#undef DEFINE_ATOMIC_RMW
+
+#define DEFINE_ATOMIC_CMPXCHG(opcode) \
+wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::ExprList* expected, wabt::ExprList* replacement,   \
+    wabt::Address align, uint32_t offset) {                                                                 \
+  ERROR_UNLESS(index != nullptr, "index cannot be null");                                                   \
+  ERROR_UNLESS(expected != nullptr, "expected cannot be null");                                             \
+  ERROR_UNLESS(replacement != nullptr, "replacement cannot be null");                                       \
+  wabt::ExprList* e = new wabt::ExprList();                                                                 \
+  Merge(e, index);                                                                                          \
+  Merge(e, expected);                                                                                       \
+  Merge(e, replacement);                                                                                    \
+  e->push_back(wabt::MakeUnique<wabt::AtomicRmwCmpxchgExpr>(wabt::Opcode::opcode, align, offset));          \
+  return e;                                                                                                 \
+}
+ATOMIC_CMPXCHG_INSTRUCTIONS_LIST(DEFINE_ATOMIC_CMPXCHG)
+#undef DEFINE_ATOMIC_CMPXCHG
+
+#define DEFINE_ATOMIC_WAIT(opcode) \
+wabt::ExprList* Make##opcode(wabt::ExprList* index, wabt::ExprList* expected, wabt::ExprList* timeout,       \
+    wabt::Address align, uint32_t offset) {                                                                 \
+  ERROR_UNLESS(index != nullptr, "index cannot be null");                                                   \
+  ERROR_UNLESS(expected != nullptr, "expected cannot be null");                                             \
+  ERROR_UNLESS(timeout != nullptr, "timeout cannot be null");                                               \
+  wabt::ExprList* e = new wabt::ExprList();                                                                 \
+  Merge(e, index);                                                                                          \
+  Merge(e, expected);                                                                                       \
+  Merge(e, timeout);                                                                                        \
+  e->push_back(wabt::MakeUnique<wabt::AtomicWaitExpr>(wabt::Opcode::opcode, align, offset));                \
+  return e;                                                                                                 \
+}
+ATOMIC_WAIT_INSTRUCTIONS_LIST(DEFINE_ATOMIC_WAIT)
+#undef DEFINE_ATOMIC_WAIT
+
+wabt::ExprList* MakeAtomicNotify(wabt::ExprList* index, wabt::ExprList* count, wabt::Address align, uint32_t offset) {
+  ERROR_UNLESS(index != nullptr, "index cannot be null");
+  ERROR_UNLESS(count != nullptr, "count cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, index);
+  Merge(e, count);
+  e->push_back(wabt::MakeUnique<wabt::AtomicNotifyExpr>(wabt::Opcode::AtomicNotify, align, offset));
+  return e;
+}
+
+wabt::ExprList* MakeAtomicFence() {
+  // Sequentially consistent is the only
+  // consistency model defined at the moment
+  const uint32_t kSequentiallyConsistent = 0;
+  return ExprToExprList(wabt::MakeUnique<wabt::AtomicFenceExpr>(kSequentiallyConsistent));
+}
+
+wabt::ExprList* MakeMemoryCopy(wabt::ExprList* dst, wabt::ExprList* src, wabt::ExprList* size) {
+  ERROR_UNLESS(dst != nullptr, "dst cannot be null");
+  ERROR_UNLESS(src != nullptr, "src cannot be null");
+  ERROR_UNLESS(size != nullptr, "size cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, dst);
+  Merge(e, src);
+  Merge(e, size);
+  e->push_back(wabt::MakeUnique<wabt::MemoryCopyExpr>());
+  return e;
+}
+
+wabt::ExprList* MakeMemoryFill(wabt::ExprList* dst, wabt::ExprList* val, wabt::ExprList* size) {
+  ERROR_UNLESS(dst != nullptr, "dst cannot be null");
+  ERROR_UNLESS(val != nullptr, "val cannot be null");
+  ERROR_UNLESS(size != nullptr, "size cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, dst);
+  Merge(e, val);
+  Merge(e, size);
+  e->push_back(wabt::MakeUnique<wabt::MemoryFillExpr>());
+  return e;
+}
+
+wabt::ExprList* MakeMemoryInit(wabt::Var segment, wabt::ExprList* dst, wabt::ExprList* src, wabt::ExprList* size) {
+  ERROR_UNLESS(dst != nullptr, "dst cannot be null");
+  ERROR_UNLESS(src != nullptr, "src cannot be null");
+  ERROR_UNLESS(size != nullptr, "size cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, dst);
+  Merge(e, src);
+  Merge(e, size);
+  e->push_back(wabt::MakeUnique<wabt::MemoryInitExpr>(segment));
+  return e;
+}
+
+wabt::ExprList* MakeDataDrop(wabt::Var segment) {
+  return ExprToExprList(wabt::MakeUnique<wabt::DataDropExpr>(segment));
+}
+
+wabt::ExprList* MakeMemorySize() {
+  return ExprToExprList(wabt::MakeUnique<wabt::MemorySizeExpr>());
+}
+
+wabt::ExprList* MakeMemoryGrow(wabt::ExprList* pages) {
+  ERROR_UNLESS(pages != nullptr, "pages cannot be null");
+  wabt::ExprList* e = new wabt::ExprList();
+  Merge(e, pages);
+  e->push_back(wabt::MakeUnique<wabt::MemoryGrowExpr>());
+  return e;
+}
+
 #ifdef WABT_EXPERIMENTAL
 wabt::ExprList* MakeNativeCall(wabt::Var var, std::vector<wabt::ExprList*> args) {
   wabt::ExprList* e = new wabt::ExprList();
@@ -176,6 +176,162 @@ EXTRACT_LANE_LIST(DECLARE_EXTRACT)
   STORE_INSTRUCTIONS_LIST(DECLARE_STORE)
 #undef DECLARE_STORE
 
+  // Make atomic loads
+#define ATOMIC_LOAD_INSTRUCTIONS_LIST(V) \
+  V(I32AtomicLoad)    \
+  V(I64AtomicLoad)    \
+  V(I32AtomicLoad8U)  \
+  V(I32AtomicLoad16U) \
+  V(I64AtomicLoad8U)  \
+  V(I64AtomicLoad16U) \
+  V(I64AtomicLoad32U)
+
+#define DECLARE_ATOMIC_LOAD(opcode) \
+  wabt::ExprList* Make##opcode(wabt::ExprList* index,  \
+  wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT, uint32_t offset = 0);
+  ATOMIC_LOAD_INSTRUCTIONS_LIST(DECLARE_ATOMIC_LOAD)
+#undef DECLARE_ATOMIC_LOAD
+
+  // Make atomic stores
+#define ATOMIC_STORE_INSTRUCTIONS_LIST(V) \
+  V(I32AtomicStore)   \
+  V(I64AtomicStore)   \
+  V(I32AtomicStore8)  \
+  V(I32AtomicStore16) \
+  V(I64AtomicStore8)  \
+  V(I64AtomicStore16) \
+  V(I64AtomicStore32)
+
+#define DECLARE_ATOMIC_STORE(opcode) \
+  wabt::ExprList* Make##opcode(wabt::ExprList* index, \
+  wabt::ExprList* val, wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT,  \
+  uint32_t offset = 0);
+  ATOMIC_STORE_INSTRUCTIONS_LIST(DECLARE_ATOMIC_STORE)
+#undef DECLARE_ATOMIC_STORE
+
+  // Make atomic read-modify-write operations
+  // returning the value read from memory
+#define ATOMIC_RMW_OPERATION_LIST(V, op) \
+  V(I32AtomicRmw##op)      \
+  V(I64AtomicRmw##op)      \
+  V(I32AtomicRmw8##op##U)  \
+  V(I32AtomicRmw16##op##U) \
+  V(I64AtomicRmw8##op##U)  \
+  V(I64AtomicRmw16##op##U) \
+  V(I64AtomicRmw32##op##U)
+
+#define ATOMIC_RMW_INSTRUCTIONS_LIST(V) \
+  ATOMIC_RMW_OPERATION_LIST(V, Add)  \
+  ATOMIC_RMW_OPERATION_LIST(V, Sub)  \
+  ATOMIC_RMW_OPERATION_LIST(V, And)  \
+  ATOMIC_RMW_OPERATION_LIST(V, Or)   \
+  ATOMIC_RMW_OPERATION_LIST(V, Xor)  \
+  ATOMIC_RMW_OPERATION_LIST(V, Xchg)
+
+#define DECLARE_ATOMIC_RMW(opcode) \
+  wabt::ExprList* Make##opcode(wabt::ExprList* index, \
+  wabt::ExprList* val, wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT,  \
+  uint32_t offset = 0);
+  ATOMIC_RMW_INSTRUCTIONS_LIST(DECLARE_ATOMIC_RMW)
+#undef DECLARE_ATOMIC_RMW
+
+  // Make atomic compare-exchange operations
+  // returning the value read from memory
+#define ATOMIC_CMPXCHG_INSTRUCTIONS_LIST(V) \
+  V(I32AtomicRmwCmpxchg)      \
+  V(I64AtomicRmwCmpxchg)      \
+  V(I32AtomicRmw8CmpxchgU)    \
+  V(I32AtomicRmw16CmpxchgU)   \
+  V(I64AtomicRmw8CmpxchgU)    \
+  V(I64AtomicRmw16CmpxchgU)   \
+  V(I64AtomicRmw32CmpxchgU)
+
+#define DECLARE_ATOMIC_CMPXCHG(opcode) \
+  wabt::ExprList* Make##opcode(wabt::ExprList* index, \
+  wabt::ExprList* expected, wabt::ExprList* replacement,  \
+  wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT, uint32_t offset = 0);
+  ATOMIC_CMPXCHG_INSTRUCTIONS_LIST(DECLARE_ATOMIC_CMPXCHG)
+#undef DECLARE_ATOMIC_CMPXCHG
+
+  // Make atomic waits
+#define ATOMIC_WAIT_INSTRUCTIONS_LIST(V) \
+  V(I32AtomicWait) \
+  V(I64AtomicWait)
+
+#define DECLARE_ATOMIC_WAIT(opcode) \
+  wabt::ExprList* Make##opcode(wabt::ExprList* index, \
+  wabt::ExprList* expected, wabt::ExprList* timeout,  \
+  wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT, uint32_t offset = 0);
+  ATOMIC_WAIT_INSTRUCTIONS_LIST(DECLARE_ATOMIC_WAIT)
+#undef DECLARE_ATOMIC_WAIT
+
+/*!
+ * Make a Wasm <code>memory.atomic.notify</code> instruction
+ * @param index Address of the waiters
+ * @param count Maximum number of waiters to wake up
+ * @param align Alignment
+ * @param offset Offset
+ * @return Expression list returning the number of woken waiters
+ */
+wabt::ExprList* MakeAtomicNotify(wabt::ExprList* index, wabt::ExprList* count,
+                                 wabt::Address align = wabt::WABT_USE_NATURAL_ALIGNMENT, uint32_t offset = 0);
+
+/*!
+ * Make a Wasm <code>atomic.fence</code> instruction
+ * @return Expression list
+ */
+wabt::ExprList* MakeAtomicFence();
+
+/*!
+ * Make a Wasm <code>memory.copy</code> instruction.
+ * The regions can overlap
+ * @param dst Destination address
+ * @param src Source address
+ * @param size Number of bytes
+ * @return Expression list
+ */
+wabt::ExprList* MakeMemoryCopy(wabt::ExprList* dst, wabt::ExprList* src, wabt::ExprList* size);
+
+/*!
+ * Make a Wasm <code>memory.fill</code> instruction
+ * @param dst Destination address
+ * @param val Byte value
+ * @param size Number of bytes
+ * @return Expression list
+ */
+wabt::ExprList* MakeMemoryFill(wabt::ExprList* dst, wabt::ExprList* val, wabt::ExprList* size);
+
+/*!
+ * Make a Wasm <code>memory.init</code> instruction
+ * @param segment Reference variable of a passive data segment
+ * @param dst Destination address
+ * @param src Offset in the data segment
+ * @param size Number of bytes
+ * @return Expression list
+ */
+wabt::ExprList* MakeMemoryInit(wabt::Var segment, wabt::ExprList* dst, wabt::ExprList* src, wabt::ExprList* size);
+
+/*!
+ * Make a Wasm <code>data.drop</code> instruction
+ * @param segment Reference variable of a passive data segment
+ * @return Expression list
+ */
+wabt::ExprList* MakeDataDrop(wabt::Var segment);
+
+/*!
+ * Make a Wasm <code>memory.size</code> instruction
+ * @return Expression list returning the number of pages
+ */
+wabt::ExprList* MakeMemorySize();
+
+/*!
+ * Make a Wasm <code>memory.grow</code> instruction
+ * @param pages Number of pages to add
+ * @return Expression list returning the previous number
+ * of pages, or -1 if the memory cannot grow
+ */
+wabt::ExprList* MakeMemoryGrow(wabt::ExprList* pages);
+
 /*!
  * Make a branch instruction
  * @param label Reference variable of a loop
@@ -10,6 +10,8 @@
 #include <sstream>
 #include <stack>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include "wasm-manager.h"
 
 namespace wasmpp {
@@ -60,6 +62,31 @@ DataEntry DataEntry::MakeByte(uint8_t val) {
   return entry;
 }
 
+std::vector<uint8_t> DataEntry::Encode(const std::vector<DataEntry>& entries) {
+  std::vector<uint8_t> data;
+  for(auto entry : entries) {
+    uint64_t value_bits;
+    uint64_t mask = 0x00000000000000ff;
+    if(entry.kind == DataEntry::Kind::I32) {
+      memcpy(&value_bits, &entry.val.i32, entry.Size());
+    } else if(entry.kind == DataEntry::Kind::I64) {
+      memcpy(&value_bits, &entry.val.i64, entry.Size());
+    } else if(entry.kind == DataEntry::Kind::F32) {
+      memcpy(&value_bits, &entry.val.f32, entry.Size());
+    } else if(entry.kind == DataEntry::Kind::F64) {
+      memcpy(&value_bits, &entry.val.f64, entry.Size());
+    } else {
+      assert(entry.kind == DataEntry::Kind::Byte);
+      memcpy(&value_bits, &entry.val.f64, entry.Size());
+    }
+    for(int i=0; i < entry.Size(); i++) {
+      data.push_back((uint8_t) (mask & value_bits));
+      value_bits >>= 8;
+    }
+  }
+  return data;
+}
+
 Memory::Memory(uint32_t begin, uint32_t end) {
   begin_ = begin;
   end_ = end;
@@ -109,6 +136,7 @@ const wabt::Module& ModuleManager::GetModule() const {
 }
 
 bool ModuleManager::Validate() {
+  ERROR_UNLESS(deferred_functions_.empty(), "Deferred functions must be generated before validating");
   wabt::Errors errors;
   wabt::ValidateOptions options;
   if(wabt::Succeeded(wabt::ResolveNamesModule(&module_, &errors))) {
@@ -123,6 +151,7 @@ bool ModuleManager::Validate() {
 }
 
 std::string ModuleManager::ToWat(bool folded, bool inline_import_export) const {
+  ERROR_UNLESS(deferred_functions_.empty(), "Deferred functions must be generated before writing the module");
   wabt::WriteWatOptions wat_options;
   wat_options.fold_exprs = folded;
   wat_options.inline_import = inline_import_export;
@@ -133,15 +162,24 @@ std::string ModuleManager::ToWat(bool folded, bool inline_import_export) const {
 }
 
 wabt::OutputBuffer ModuleManager::ToWasm() const {
+  ERROR_UNLESS(deferred_functions_.empty(), "Deferred functions must be generated before writing the module");
   wabt::WriteBinaryOptions binaryOptions;
+  // Write the data count section required
+  // by memory.init and data.drop
+  binaryOptions.features.enable_bulk_memory();
   wabt::MemoryStream stream;
   WriteBinaryModule(&stream, &module_, binaryOptions);
   return stream.output_buffer();
 }
 
+thread_local LabelManager* LabelManager::scope_ = nullptr;
+
 std::string LabelManager::Next() {
+  if(scope_ != nullptr && scope_ != this) {
+    return scope_->Next();
+  }
   std::stringstream ss;
-  ss << "$" << uid_++;
+  ss << "$" << prefix_ << uid_++;
   return ss.str();
 }
 
@@ -167,33 +205,31 @@ void ModuleManager::ResolveImplicitlyDefinedFunctionType(const wabt::FuncDeclara
   }
 }
 
-wabt::Var ModuleManager::MakeFunction(const char* name, wabt::FuncSignature sig, wabt::TypeVector locals,
-                                   std::function<void(FuncBody, std::vector<wabt::Var>,
-                                                      std::vector<wabt::Var>)> content) {
+wabt::Func* ModuleManager::AppendFunction(const char* name, wabt::Var func_name, wabt::FuncSignature sig,
+                                          wabt::TypeVector locals, std::vector<wabt::Var>* param_vars,
+                                          std::vector<wabt::Var>* local_vars) {
+  ERROR_UNLESS(!generating_deferred_, "Functions cannot be made while generating deferred functions");
   // Create a function field
-  wabt::Var func_name = wabt::Var(label_manager_.Next());
   auto field = wabt::MakeUnique<wabt::FuncModuleField>(wabt::Location(), func_name.name());
   field->func.decl.sig = sig;
 
   // Create params
-  std::vector<wabt::Var> param_vars;
   for(wabt::Index i=0; i < field->func.GetNumParams(); i++) {
     std::string uid = label_manager_.Next();
     field->func.bindings.emplace(uid, wabt::Binding(wabt::Location(), i));
-    param_vars.emplace_back(wabt::Var(uid));
+    param_vars->emplace_back(wabt::Var(uid));
   }
 
   // Create locals
-  std::vector<wabt::Var> local_vars;
   std::vector<wabt::Type> local_types;
   for(wabt::Index i=0; i < locals.size(); i++) {
     std::string uid = label_manager_.Next();
     field->func.bindings.emplace(uid, wabt::Binding(wabt::Location(), field->func.GetNumParams() + i));
-    local_vars.emplace_back(wabt::Var(uid));
+    local_vars->emplace_back(wabt::Var(uid));
     local_types.emplace_back(locals[i]);
   }
   field->func.local_types.Set(local_types);
-  FuncBody func_body(&label_manager_, &field->func.exprs);
+  wabt::Func* func = &field->func;
   ResolveImplicitlyDefinedFunctionType(field->func.decl);
   module_.AppendField(std::move(field));
 
@@ -207,12 +243,66 @@ wabt::Var ModuleManager::MakeFunction(const char* name, wabt::FuncSignature sig,
     export_fields.push_back(std::move(export_field));
     module_.AppendFields(&export_fields);
   }
+  return func;
+}
+
+wabt::Var ModuleManager::MakeFunction(const char* name, wabt::FuncSignature sig, wabt::TypeVector locals,
+                                   std::function<void(FuncBody, std::vector<wabt::Var>,
+                                                      std::vector<wabt::Var>)> content) {
+  wabt::Var func_name = wabt::Var(label_manager_.Next());
+  std::vector<wabt::Var> param_vars;
+  std::vector<wabt::Var> local_vars;
+  wabt::Func* func = AppendFunction(name, func_name, sig, locals, &param_vars, &local_vars);
 
   // Populate content
+  FuncBody func_body(&label_manager_, &func->exprs);
   content(func_body, param_vars, local_vars);
   return func_name;
 }
 
+wabt::Var ModuleManager::MakeDeferredFunction(const char* name, wabt::FuncSignature sig, wabt::TypeVector locals,
+                                              std::function<void(FuncBody, std::vector<wabt::Var>,
+                                                                 std::vector<wabt::Var>)> content) {
+  if(codegen_threads_ == 0) {
+    return MakeFunction(name, sig, locals, content);
+  }
+  wabt::Var func_name = wabt::Var(label_manager_.Next());
+  DeferredFunction deferred;
+  deferred.func = AppendFunction(name, func_name, sig, locals, &deferred.params, &deferred.locals);
+  deferred.content = content;
+  deferred_functions_.push_back(deferred);
+  return func_name;
+}
+
+void ModuleManager::GenerateDeferredFunctions() {
+  if(deferred_functions_.empty()) {
+    return;
+  }
+  generating_deferred_ = true;
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for(size_t i = next++; i < deferred_functions_.size(); i = next++) {
+      auto& deferred = deferred_functions_[i];
+      // Labels of the body are prefixed by the function
+      // name so they do not depend on the scheduling
+      LabelManager label_manager(deferred.func->name.substr(1) + "_");
+      LabelManager::Scope scope(&label_manager);
+      FuncBody func_body(&label_manager, &deferred.func->exprs);
+      deferred.content(func_body, deferred.params, deferred.locals);
+    }
+  };
+  std::vector<std::thread> threads;
+  for(uint32_t t = 1; t < std::min<size_t>(codegen_threads_, deferred_functions_.size()); t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& thread : threads) {
+    thread.join();
+  }
+  deferred_functions_.clear();
+  generating_deferred_ = false;
+}
+
 wabt::Var ModuleManager::MakeFuncImport(std::string module, std::string function, wabt::FuncSignature sig) {
   CheckImportOrdering();
   wabt::Var import_name(label_manager_.Next());
@@ -251,36 +341,46 @@ wabt::Var ModuleManager::MakeMemory(uint32_t init_page, uint32_t max, bool share
   return memory_name;
 }
 
+wabt::Var ModuleManager::MakeMemoryImport(std::string module, std::string name, uint32_t init_page, uint32_t max,
+                                          bool shared) {
+  CheckImportOrdering();
+  wabt::Var memory_name(label_manager_.Next());
+  auto import = wabt::MakeUnique<wabt::MemoryImport>(memory_name.name());
+  import->memory.page_limits.initial = init_page;
+  import->memory.page_limits.is_shared = shared;
+  import->memory.page_limits.max = max;
+  import->memory.page_limits.has_max = shared || max != 0;
+  auto field = wabt::MakeUnique<wabt::ImportModuleField>(std::move(import));
+  field->import->module_name = std::move(module);
+  field->import->field_name = std::move(name);
+  module_.AppendField(std::move(field));
+  return memory_name;
+}
+
+void ModuleManager::SetMemoryPages(wabt::Var var, uint32_t init_page, uint32_t max) {
+  wabt::Memory* memory = module_.GetMemory(var);
+  ERROR_UNLESS(memory != nullptr, "memory %s not found", var.name().c_str());
+  memory->page_limits.initial = init_page;
+  memory->page_limits.max = max;
+  memory->page_limits.has_max = memory->page_limits.is_shared || max != 0;
+}
+
 void ModuleManager::MakeData(wabt::Var var, uint32_t index, std::vector<wasmpp::DataEntry> entries) {
   assert(var.type() == wabt::VarType::Name);
   auto field = wabt::MakeUnique<wabt::DataSegmentModuleField>(wabt::Location(), var.name());
   field->data_segment.memory_var = var;
   field->data_segment.offset.splice(field->data_segment.offset.end(), *MakeI32Const(index));
+  field->data_segment.data = DataEntry::Encode(entries);
+  module_.AppendField(std::move(field));
+}
 
-  // Insert data in little endian
-  std::vector<uint8_t> data;
-  for(auto entry : entries) {
-    uint64_t value_bits;
-    uint64_t mask = 0x00000000000000ff;
-    if(entry.kind == DataEntry::Kind::I32) {
-      memcpy(&value_bits, &entry.val.i32, entry.Size());
-    } else if(entry.kind == DataEntry::Kind::I64) {
-      memcpy(&value_bits, &entry.val.i64, entry.Size());
-    } else if(entry.kind == DataEntry::Kind::F32) {
-      memcpy(&value_bits, &entry.val.f32, entry.Size());
-    } else if(entry.kind == DataEntry::Kind::F64) {
-      memcpy(&value_bits, &entry.val.f64, entry.Size());
-    } else {
-      assert(entry.kind == DataEntry::Kind::Byte);
-      memcpy(&value_bits, &entry.val.f64, entry.Size());
-    }
-    for(int i=0; i < entry.Size(); i++) {
-      data.push_back((uint8_t) (mask & value_bits));
-      value_bits >>= 8;
-    }
-  }
-  field->data_segment.data = data;
+wabt::Var ModuleManager::MakePassiveData(std::vector<wasmpp::DataEntry> entries) {
+  wabt::Var segment_name(label_manager_.Next());
+  auto field = wabt::MakeUnique<wabt::DataSegmentModuleField>(wabt::Location(), segment_name.name());
+  field->data_segment.kind = wabt::SegmentKind::Passive;
+  field->data_segment.data = DataEntry::Encode(entries);
   module_.AppendField(std::move(field));
+  return segment_name;
 }
 
 void ModuleManager::MakeExport(std::string name, wabt::Var var, wabt::ExternalKind kind) {
@@ -183,6 +183,13 @@ struct DataEntry {
    * @return Data entry
    */
   static DataEntry MakeByte(uint8_t val);
+
+  /*!
+   * Encode data entries in little-endian format
+   * @param entries List of data entries
+   * @return Bytes of the entries
+   */
+  static std::vector<uint8_t> Encode(const std::vector<DataEntry>& entries);
 };
 
 /*!
@@ -192,12 +199,37 @@ struct DataEntry {
 class LabelManager {
 private:
   int uid_ = 0;
+  std::string prefix_;
+  static thread_local LabelManager* scope_;
 public:
+  /*!
+   * Create a label manager
+   * @param prefix Prefix of all its labels
+   */
+  explicit LabelManager(std::string prefix = "") : prefix_(prefix) {}
   /*!
    * Next unique string
+   * @note Inside a scope, the label is generated
+   * by the label manager of the scope
    * @return unique string
    */
   std::string Next();
+
+  /*!
+   * @brief Redirect all labels generated by the current
+   * thread to a label manager while the scope is alive
+   */
+  class Scope {
+  private:
+    LabelManager* previous_;
+  public:
+    /*!
+     * Enter a label scope
+     * @param label_manager Label manager of the scope
+     */
+    explicit Scope(LabelManager* label_manager) : previous_(scope_) { scope_ = label_manager; }
+    ~Scope() { scope_ = previous_; }
+  };
 };
 
 /*!
@@ -209,12 +241,25 @@ private:
   FirstFit memory_manager_;
   LabelManager label_manager_;
 
+  // Functions whose body is generated later
+  struct DeferredFunction {
+    wabt::Func* func;
+    std::vector<wabt::Var> params;
+    std::vector<wabt::Var> locals;
+    std::function<void(FuncBody, std::vector<wabt::Var>, std::vector<wabt::Var>)> content;
+  };
+  std::vector<DeferredFunction> deferred_functions_;
+  uint32_t codegen_threads_ = 0;
+  bool generating_deferred_ = false;
+
   // Function copied from WastParser::CheckImportOrdering
   void CheckImportOrdering();
   void ResolveImplicitlyDefinedFunctionType(const wabt::FuncDeclaration& decl);
 
   // Helpers
   void MakeExport(std::string name, wabt::Var var, wabt::ExternalKind kind);
+  wabt::Func* AppendFunction(const char* name, wabt::Var func_name, wabt::FuncSignature sig, wabt::TypeVector locals,
+                             std::vector<wabt::Var>* param_vars, std::vector<wabt::Var>* local_vars);
 public:
   /*!
    * Get WABT module object
@@ -266,6 +311,43 @@ public:
   wabt::Var MakeFunction(const char* name, wabt::FuncSignature sig, wabt::TypeVector locals,
                            std::function<void(FuncBody, std::vector<wabt::Var>, std::vector<wabt::Var>)> content);
 
+  /*!
+   * Make a Wasm function whose body is generated later
+   * by GenerateDeferredFunctions(), in parallel with the
+   * other deferred functions. The function index and
+   * signature are reserved immediately. Each body uses its own
+   * label namespace so the output does not depend on the
+   * scheduling. If no codegen threads are set, this is the
+   * same as MakeFunction()
+   * @warning The content must not refer to variables
+   * of the caller which are destroyed before the
+   * generation, nor make functions
+   * @param name Export name
+   * @param sig Function signature
+   * @param locals Function locals
+   * @param content Function body
+   * @return Function variable used to call it e.g. <code>call $var</code>
+   */
+  wabt::Var MakeDeferredFunction(const char* name, wabt::FuncSignature sig, wabt::TypeVector locals,
+                                 std::function<void(FuncBody, std::vector<wabt::Var>, std::vector<wabt::Var>)> content);
+
+  /*!
+   * Set the number of threads generating the deferred functions
+   * @param threads Number of threads, or 0 to disable deferred generation
+   */
+  void SetCodegenThreads(uint32_t threads) { codegen_threads_ = threads; }
+
+  /*!
+   * Get the number of threads generating the deferred functions
+   * @return Number of threads
+   */
+  uint32_t CodegenThreads() const { return codegen_threads_; }
+
+  /*!
+   * Generate the bodies of all deferred functions
+   */
+  void GenerateDeferredFunctions();
+
   /*!
    * Make a Wasm import function <br/>
    * e.g. <code>("module" "function" (func $var (param i32) (result i32)))</code>
@@ -285,6 +367,30 @@ public:
    */
   wabt::Var MakeMemory(uint32_t init_page, uint32_t max = 0, bool shared = false);
 
+  /*!
+   * Make a Wasm import linear memory <br/>
+   * e.g. <code>("module" "memory" (memory $var 1 1 shared))</code>
+   * @note A shared memory imported by several instances
+   * of the module is how the instances share their state
+   * @param module Module name
+   * @param name Memory name
+   * @param init_page Number of pages
+   * @param max Maximum number of pages
+   * @param shared Mark shared linear memory
+   * @return Imported memory reference variable
+   */
+  wabt::Var MakeMemoryImport(std::string module, std::string name, uint32_t init_page, uint32_t max = 0,
+                             bool shared = false);
+
+  /*!
+   * Update the number of pages of a linear memory. This allows
+   * importing a memory before the memory size is known
+   * @param var Linear memory reference variable
+   * @param init_page Number of pages
+   * @param max Maximum number of pages
+   */
+  void SetMemoryPages(wabt::Var var, uint32_t init_page, uint32_t max = 0);
+
   /*!
    * Make a data section. <br/>
    * Insert data in little-endian format
@@ -294,6 +400,16 @@ public:
    */
   void MakeData(wabt::Var var, uint32_t index, std::vector<DataEntry> entries);
 
+  /*!
+   * Make a passive data section. <br/>
+   * Insert data in little-endian format. The data is
+   * not copied at instantiation but by <code>memory.init</code>
+   * until the segment is dropped by <code>data.drop</code>
+   * @param entries List of data entries
+   * @return Data segment reference variable
+   */
+  wabt::Var MakePassiveData(std::vector<DataEntry> entries);
+
   /*!
    * Export linear memory
    * @param name Export name
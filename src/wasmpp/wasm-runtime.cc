@@ -0,0 +1,102 @@
+#include <src/wasmpp/wasm-runtime.h>
+#include <src/binary-reader.h>
+#include <src/binary-reader-interp.h>
+#include <src/error-formatter.h>
+
+namespace wasmpp {
+
+using namespace wabt;
+
+void Runtime::MakeHostFunction(std::string module, std::string name, wabt::FuncSignature sig, HostFunction func) {
+  ERROR_UNLESS(module_ == nullptr, "Host functions must be bound before instantiating the module");
+  auto host_module = host_modules_.find(module);
+  if(host_module == host_modules_.end()) {
+    host_module = host_modules_.emplace(module, env_.AppendHostModule(module)).first;
+  }
+  interp::FuncSignature interp_sig(sig.param_types, sig.result_types);
+  host_module->second->AppendFuncExport(name, interp_sig,
+                                        [=](const interp::HostFunc*, const interp::FuncSignature* func_sig,
+                                            const interp::TypedValues& args, interp::TypedValues& results) {
+    for(uint32_t i = 0; i < func_sig->result_types.size(); i++) {
+      results[i].type = func_sig->result_types[i];
+    }
+    func(args, results);
+    return interp::Result::Ok;
+  });
+}
+
+bool Runtime::Instantiate(const ModuleManager& module_manager) {
+  return Instantiate(module_manager.ToWasm().data);
+}
+
+bool Runtime::Instantiate(const std::vector<uint8_t>& data) {
+  ERROR_UNLESS(module_ == nullptr, "Module already instantiated");
+  Features features;
+  features.EnableAll();
+  const bool kReadDebugNames = true;
+  const bool kStopOnFirstError = true;
+  const bool kFailOnCustomSectionError = true;
+  ReadBinaryOptions options(features, nullptr, kReadDebugNames, kStopOnFirstError, kFailOnCustomSectionError);
+  Errors errors;
+  if(Failed(ReadBinaryInterp(&env_, data.data(), data.size(), options, &errors, &module_))) {
+    module_ = nullptr;
+    fprintf(stderr, "%s", FormatErrorsToString(errors, Location::Type::Binary).c_str());
+    return false;
+  }
+  auto result = executor_.RunStartFunction(module_);
+  if(result.result != interp::Result::Ok) {
+    fprintf(stderr, "Start function trapped: %s\n", interp::ResultToString(result.result).c_str());
+    return false;
+  }
+  return true;
+}
+
+interp::TypedValues Runtime::Call(std::string name, const interp::TypedValues& args) {
+  ERROR_UNLESS(module_ != nullptr, "Module not instantiated");
+  ERROR_UNLESS(module_->GetExport(name) != nullptr, "Export %s not found", name.c_str());
+  auto result = executor_.RunExportByName(module_, name, args);
+  ERROR_UNLESS(result.result == interp::Result::Ok, "Call to %s trapped: %s", name.c_str(),
+               interp::ResultToString(result.result).c_str());
+  return result.values;
+}
+
+interp::Memory* Runtime::ExportedMemory(std::string name) {
+  ERROR_UNLESS(module_ != nullptr, "Module not instantiated");
+  auto export_ = module_->GetExport(name);
+  ERROR_UNLESS(export_ != nullptr && export_->kind == ExternalKind::Memory, "Memory %s not exported", name.c_str());
+  return env_.GetMemory(export_->index);
+}
+
+uint8_t* Runtime::Memory(std::string name) {
+  return reinterpret_cast<uint8_t*>(ExportedMemory(name)->data.data());
+}
+
+uint32_t Runtime::MemoryBytes(std::string name) {
+  return (uint32_t) ExportedMemory(name)->data.size();
+}
+
+interp::TypedValue Runtime::MakeI32(uint32_t val) {
+  interp::TypedValue value(Type::I32);
+  value.set_i32(val);
+  return value;
+}
+
+interp::TypedValue Runtime::MakeI64(uint64_t val) {
+  interp::TypedValue value(Type::I64);
+  value.set_i64(val);
+  return value;
+}
+
+interp::TypedValue Runtime::MakeF32(float val) {
+  interp::TypedValue value(Type::F32);
+  value.set_f32(val);
+  return value;
+}
+
+interp::TypedValue Runtime::MakeF64(double val) {
+  interp::TypedValue value(Type::F64);
+  value.set_f64(val);
+  return value;
+}
+
+} // namespace wasmpp
@@ -0,0 +1,114 @@
+/*!
+ * @file wasm-runtime.h
+ */
+
+#ifndef WASM_WASM_RUNTIME_H_
+#define WASM_WASM_RUNTIME_H_
+
+#include <src/interp/interp.h>
+#include <src/wasmpp/wasm-manager.h>
+#include <functional>
+#include <unordered_map>
+
+namespace wasmpp {
+
+/*!
+ * @brief In-process runtime executing a module
+ * using the <a href="https://github.com/WebAssembly/wabt">WABT</a> interpreter
+ *
+ * Imports are bound to native functions, and the exported
+ * linear memory is exposed as a raw pointer so that data can
+ * be loaded in place without copying it through a host engine
+ */
+class Runtime {
+public:
+  /*!
+   * Native function implementing an import
+   * @param args Arguments passed by the module
+   * @param results Results to set, already typed
+   * by the import signature
+   */
+  typedef std::function<void(const wabt::interp::TypedValues& args,
+                             wabt::interp::TypedValues& results)> HostFunction;
+private:
+  wabt::interp::Environment env_;
+  wabt::interp::Executor executor_;
+  wabt::interp::DefinedModule* module_ = nullptr;
+  std::unordered_map<std::string, wabt::interp::HostModule*> host_modules_;
+public:
+  Runtime() : executor_(&env_) {}
+  /*!
+   * Bind an import to a native function. Imports sharing
+   * the same name are resolved using their signature
+   * @param module Import module name
+   * @param name Import function name
+   * @param sig Import function signature
+   * @param func Native function
+   */
+  void MakeHostFunction(std::string module, std::string name, wabt::FuncSignature sig, HostFunction func);
+  /*!
+   * Instantiate a module. All its imports
+   * must be bound before calling this function
+   * @param module_manager Module manager
+   * @return true if successful
+   */
+  bool Instantiate(const ModuleManager& module_manager);
+  /*!
+   * Instantiate a binary module. All its imports
+   * must be bound before calling this function
+   * @param data Binary module
+   * @return true if successful
+   */
+  bool Instantiate(const std::vector<uint8_t>& data);
+  /*!
+   * Call an exported function. The execution
+   * terminates the program if it traps
+   * @param name Exported function name
+   * @param args Arguments
+   * @return Results
+   */
+  wabt::interp::TypedValues Call(std::string name, const wabt::interp::TypedValues& args = {});
+  /*!
+   * Get the exported linear memory. The pointer is
+   * invalidated when the memory grows
+   * @param name Exported memory name
+   * @return Pointer to the first byte of the memory
+   */
+  uint8_t* Memory(std::string name = "memory");
+  /*!
+   * Get the exported linear memory size
+   * @param name Exported memory name
+   * @return Number of bytes
+   */
+  uint32_t MemoryBytes(std::string name = "memory");
+  /*!
+   * Make an i32 argument
+   * @param val Value
+   * @return Typed value
+   */
+  static wabt::interp::TypedValue MakeI32(uint32_t val);
+  /*!
+   * Make an i64 argument
+   * @param val Value
+   * @return Typed value
+   */
+  static wabt::interp::TypedValue MakeI64(uint64_t val);
+  /*!
+   * Make an f32 argument
+   * @param val Value
+   * @return Typed value
+   */
+  static wabt::interp::TypedValue MakeF32(float val);
+  /*!
+   * Make an f64 argument
+   * @param val Value
+   * @return Typed value
+   */
+  static wabt::interp::TypedValue MakeF64(double val);
+private:
+  wabt::interp::Memory* ExportedMemory(std::string name);
+};
+
+} // namespace wasmpp
+
+#endif